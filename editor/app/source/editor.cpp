@@ -26,7 +26,6 @@ bool editor::initialize(const dictionary& config)
     initialize_camera();
 
     system<core::event>().subscribe<window::event_window_resize>(
-        "editor",
         [this](std::uint32_t width, std::uint32_t height) { resize(width, height); });
 
     return true;
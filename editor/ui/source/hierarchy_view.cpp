@@ -22,7 +22,7 @@ hierarchy_view::hierarchy_view(ui::dock_area* area, const ui::dock_window_theme&
     load_entity(scene.root());
 
     auto& event = system<core::event>();
-    event.subscribe<scene::event_enter_scene>("hierarchy view", [this](ecs::entity entity) {
+    event.subscribe<scene::event_enter_scene>([this](ecs::entity entity) {
         auto& world = system<ecs::world>();
         auto& link = world.component<core::link>(entity);
 
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace ash::core
+{
+template <typename Signature, std::size_t Size = sizeof(void*) * 4>
+class delegate;
+
+/**
+ * @brief Type erased callable stored in a fixed size inline buffer. Unlike std::function it never
+ * allocates, callables that don't fit in the buffer are rejected at compile time.
+ */
+template <typename R, typename... Args, std::size_t Size>
+class delegate<R(Args...), Size>
+{
+public:
+    delegate() noexcept : m_invoke(nullptr), m_manage(nullptr) {}
+
+    template <typename Functor>
+        requires(!std::is_same_v<std::decay_t<Functor>, delegate>)
+    delegate(Functor&& functor)
+    {
+        using functor_type = std::decay_t<Functor>;
+
+        static_assert(sizeof(functor_type) <= Size, "The functor is too large for the delegate.");
+        static_assert(alignof(functor_type) <= alignof(std::max_align_t));
+        static_assert(std::is_nothrow_move_constructible_v<functor_type>);
+
+        new (m_storage) functor_type(std::forward<Functor>(functor));
+        m_invoke = &invoke<functor_type>;
+        m_manage = &manage<functor_type>;
+    }
+
+    delegate(delegate&& other) noexcept : m_invoke(other.m_invoke), m_manage(other.m_manage)
+    {
+        if (m_manage != nullptr)
+            m_manage(m_storage, other.m_storage);
+        other.reset();
+    }
+
+    delegate(const delegate&) = delete;
+
+    ~delegate() { reset(); }
+
+    delegate& operator=(delegate&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            m_invoke = other.m_invoke;
+            m_manage = other.m_manage;
+            if (m_manage != nullptr)
+                m_manage(m_storage, other.m_storage);
+            other.reset();
+        }
+        return *this;
+    }
+
+    delegate& operator=(const delegate&) = delete;
+
+    R operator()(Args... args) const { return m_invoke(m_storage, std::forward<Args>(args)...); }
+
+    explicit operator bool() const noexcept { return m_invoke != nullptr; }
+
+private:
+    template <typename Functor>
+    static R invoke(void* storage, Args&&... args)
+    {
+        return (*static_cast<Functor*>(storage))(std::forward<Args>(args)...);
+    }
+
+    // Moves the functor from source to target, or destroys target if source is null.
+    template <typename Functor>
+    static void manage(void* target, void* source)
+    {
+        if (source != nullptr)
+            new (target) Functor(std::move(*static_cast<Functor*>(source)));
+        else
+            static_cast<Functor*>(target)->~Functor();
+    }
+
+    void reset() noexcept
+    {
+        if (m_manage != nullptr)
+            m_manage(m_storage, nullptr);
+        m_invoke = nullptr;
+        m_manage = nullptr;
+    }
+
+    alignas(std::max_align_t) mutable std::byte m_storage[Size];
+
+    R (*m_invoke)(void*, Args&&...);
+    void (*m_manage)(void*, void*);
+};
+} // namespace ash::core
@@ -2,8 +2,12 @@
 
 #include "assert.hpp"
 #include "core/context.hpp"
+#include "core/delegate.hpp"
+#include "log.hpp"
+#include <atomic>
+#include <bit>
 #include <memory>
-#include <string>
+#include <tuple>
 #include <vector>
 
 namespace ash::core
@@ -12,48 +16,194 @@ struct event_index : public index_generator<event_index, std::size_t>
 {
 };
 
+using event_handle = std::uint32_t;
+
 class dispatcher
 {
 public:
     virtual ~dispatcher() = default;
+
+    /**
+     * @brief Called once per frame on the main thread to dispatch buffered events.
+     */
+    virtual void flush() {}
 };
 
-template <typename Functor>
-class sequence_dispatcher : public dispatcher
+template <typename Signature>
+class sequence_dispatcher;
+
+/**
+ * @brief Calls subscribers immediately, in subscription order.
+ */
+template <typename... Args>
+class sequence_dispatcher<void(Args...)> : public dispatcher
 {
 public:
-    void subscribe(std::string_view name, Functor&& functor)
+    using functor = delegate<void(Args...)>;
+
+public:
+    sequence_dispatcher() : m_next_handle(0) {}
+
+    event_handle subscribe(functor&& function)
     {
-        m_process.push_back(std::pair<std::string, Functor>{name, std::forward<Functor>(functor)});
+        event_handle handle = m_next_handle++;
+        m_process.push_back(process{handle, std::move(function)});
+        return handle;
     }
 
-    void unsubscribe(std::string_view name)
+    void unsubscribe(event_handle handle)
     {
-        for (auto& process : m_process)
+        for (auto iter = m_process.begin(); iter != m_process.end(); ++iter)
         {
-            if (process.first == name)
+            if (iter->handle == handle)
             {
-                std::swap(process, m_process.back());
-                m_process.pop_back();
+                m_process.erase(iter);
+                return;
             }
         }
     }
 
-    template <typename... Args>
-    void publish(Args&&... args)
+    template <typename... PublishArgs>
+    void publish(PublishArgs&&... args)
     {
         for (auto& process : m_process)
-            process.second(std::forward<Args>(args)...);
+            process.function(args...);
+    }
+
+protected:
+    struct process
+    {
+        event_handle handle;
+        functor function;
+    };
+
+    event_handle m_next_handle;
+    std::vector<process> m_process;
+};
+
+/**
+ * @brief Buffers published events in a fixed size ring and dispatches them in a batch at the
+ * beginning of the next frame. Publishing is lock-free and can be done from any thread, the
+ * arguments are copied into the ring. Subscribing must be done on the main thread.
+ */
+template <typename Signature>
+class queued_dispatcher;
+
+template <typename... Args>
+class queued_dispatcher<void(Args...)> : public sequence_dispatcher<void(Args...)>
+{
+public:
+    using payload = std::tuple<std::decay_t<Args>...>;
+
+public:
+    queued_dispatcher(std::size_t capacity = 1024)
+        : m_slots(std::bit_ceil(capacity)),
+          m_mask(m_slots.size() - 1),
+          m_enqueue_index(0),
+          m_dequeue_index(0),
+          m_dropped(0)
+    {
+        for (std::size_t i = 0; i < m_slots.size(); ++i)
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    virtual ~queued_dispatcher()
+    {
+        for (std::size_t i = m_dequeue_index; i < m_enqueue_index.load(); ++i)
+        {
+            slot& s = m_slots[i & m_mask];
+            if (s.sequence.load(std::memory_order_acquire) == i + 1)
+                s.data()->~payload();
+        }
+    }
+
+    /**
+     * @brief Queues an event. Returns false if the ring is full and the event was dropped.
+     */
+    template <typename... PublishArgs>
+    bool publish(PublishArgs&&... args)
+    {
+        std::size_t index = m_enqueue_index.load(std::memory_order_relaxed);
+        while (true)
+        {
+            slot& s = m_slots[index & m_mask];
+            std::size_t sequence = s.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(index);
+            if (diff == 0)
+            {
+                if (m_enqueue_index.compare_exchange_weak(
+                        index,
+                        index + 1,
+                        std::memory_order_relaxed))
+                {
+                    new (s.storage) payload(std::forward<PublishArgs>(args)...);
+                    s.sequence.store(index + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            else
+            {
+                index = m_enqueue_index.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    virtual void flush() override
+    {
+        // Only dispatch what was queued before the flush started, events published by the
+        // subscribers are dispatched in the next frame.
+        std::size_t end = m_enqueue_index.load(std::memory_order_acquire);
+        while (m_dequeue_index < end)
+        {
+            slot& s = m_slots[m_dequeue_index & m_mask];
+            if (s.sequence.load(std::memory_order_acquire) != m_dequeue_index + 1)
+                break; // The producer is still writing this slot.
+
+            payload* data = s.data();
+            std::apply(
+                [this](auto&... args) {
+                    for (auto& process : this->m_process)
+                        process.function(args...);
+                },
+                *data);
+            data->~payload();
+
+            s.sequence.store(m_dequeue_index + m_slots.size(), std::memory_order_release);
+            ++m_dequeue_index;
+        }
+
+        std::size_t dropped = m_dropped.exchange(0, std::memory_order_relaxed);
+        if (dropped != 0)
+            log::warn("The event queue is full, {} events were dropped.", dropped);
     }
 
 private:
-    std::vector<std::pair<std::string, Functor>> m_process;
+    struct slot
+    {
+        payload* data() noexcept { return std::launder(reinterpret_cast<payload*>(storage)); }
+
+        std::atomic<std::size_t> sequence;
+        alignas(payload) std::byte storage[sizeof(payload)];
+    };
+
+    std::vector<slot> m_slots;
+    std::size_t m_mask;
+
+    std::atomic<std::size_t> m_enqueue_index;
+    std::size_t m_dequeue_index;
+
+    std::atomic<std::size_t> m_dropped;
 };
 
 /*
 struct sample_event
 {
-    using dispatcher = sequence_dispatcher<std::function<void()>>;
+    using dispatcher = sequence_dispatcher<void()>;
 };
 */
 
@@ -71,22 +221,31 @@ class event : public system_base
 public:
     event() : system_base("event") {}
 
-    template <typename Event, typename... Args>
-    void subscribe(std::string_view name, Args&&... args)
+    virtual void on_begin_frame() override
+    {
+        for (auto& dispatcher : m_dispatchers)
+        {
+            if (dispatcher != nullptr)
+                dispatcher->flush();
+        }
+    }
+
+    template <typename Event, typename Functor>
+    event_handle subscribe(Functor&& functor)
     {
-        event_dispatcher<Event>()->subscribe(name, std::forward<Args>(args)...);
+        return event_dispatcher<Event>()->subscribe(std::forward<Functor>(functor));
     }
 
     template <typename Event>
-    void unsubscribe(std::string_view name)
+    void unsubscribe(event_handle handle)
     {
-        event_dispatcher<Event>()->unsubscribe(name);
+        event_dispatcher<Event>()->unsubscribe(handle);
     }
 
     template <typename Event, typename... Args>
-    void publish(Args&&... args)
+    decltype(auto) publish(Args&&... args)
     {
-        event_dispatcher<Event>()->publish(std::forward<Args>(args)...);
+        return event_dispatcher<Event>()->publish(std::forward<Args>(args)...);
     }
 
     template <typename Event, typename... Args>
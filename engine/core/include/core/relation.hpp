@@ -3,16 +3,33 @@
 #include "core/context.hpp"
 #include "core/link.hpp"
 #include "ecs/world.hpp"
-#include <queue>
-#include <stack>
+#include <cstdint>
+#include <vector>
 
 namespace ash::core
 {
+/**
+ * @brief Node of the flattened hierarchy. Nodes are sorted by depth and the children of a node
+ * are stored contiguously, so the descendants of any node on each level form a contiguous range.
+ */
+struct hierarchy_node
+{
+    ecs::entity entity;
+
+    std::uint32_t parent;
+    std::uint32_t depth;
+
+    std::uint32_t first_child;
+    std::uint32_t child_count;
+};
+
 class relation : public system_base
 {
 public:
     using link_type = link;
 
+    static constexpr std::uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
 public:
     relation();
 
@@ -21,80 +38,221 @@ public:
     void link(ecs::entity child_entity, ecs::entity parent_entity);
     void unlink(ecs::entity entity);
 
+    /**
+     * @brief Visits the hierarchy under entity breadth first. If the functor returns false, the
+     * children of the node are skipped. The hierarchy must not be linked or unlinked during the
+     * traversal.
+     */
     template <typename Functor>
     void each_bfs(ecs::entity entity, Functor&& functor, bool ignore_root = false)
     {
-        auto& world = system<ecs::world>();
+        propagate(
+            entity,
+            [&](ecs::entity node, std::uint8_t) -> std::uint8_t {
+                if constexpr (std::is_same_v<std::invoke_result_t<Functor, ecs::entity>, bool>)
+                {
+                    return functor(node) ? 1 : 0;
+                }
+                else
+                {
+                    functor(node);
+                    return 1;
+                }
+            },
+            1,
+            ignore_root);
+    }
+
+    /**
+     * @brief Visits the hierarchy under entity depth first, children in link order. If the functor
+     * returns false, the children of the node are skipped. The hierarchy must not be linked or
+     * unlinked during the traversal.
+     */
+    template <typename Functor>
+    void each_dfs(ecs::entity entity, Functor&& functor, bool ignore_root = false)
+    {
+        std::uint32_t root = hierarchy_index(entity);
 
-        std::queue<ecs::entity> bfs;
+        // Siblings are contiguous, so the walk only needs the parent indices and child ranges of
+        // the nodes, and no stack.
+        std::uint32_t index = root;
         if (ignore_root)
         {
-            auto& node_link = world.component<link_type>(entity);
-            for (auto child : node_link.children)
-                bfs.push(child);
-        }
-        else
-        {
-            bfs.push(entity);
+            if (m_hierarchy[root].child_count == 0)
+                return;
+            index = m_hierarchy[root].first_child;
         }
 
-        while (!bfs.empty())
+        while (true)
         {
-            ecs::entity node = bfs.front();
-            bfs.pop();
-
+            bool descend = true;
             if constexpr (std::is_same_v<std::invoke_result_t<Functor, ecs::entity>, bool>)
+                descend = functor(m_hierarchy[index].entity);
+            else
+                functor(m_hierarchy[index].entity);
+
+            if (descend && m_hierarchy[index].child_count != 0)
             {
-                if (!functor(node))
-                    continue;
+                index = m_hierarchy[index].first_child;
+                continue;
             }
-            else
+
+            // Move to the next sibling of the closest ancestor that has one.
+            while (index != root)
             {
-                functor(node);
+                const hierarchy_node& parent = m_hierarchy[m_hierarchy[index].parent];
+                if (index + 1 < parent.first_child + parent.child_count)
+                    break;
+                index = m_hierarchy[index].parent;
             }
 
-            auto& node_link = world.component<link_type>(node);
-            for (auto child : node_link.children)
-                bfs.push(child);
+            if (index == root)
+                return;
+            ++index;
         }
     }
 
+    /**
+     * @brief Visits the hierarchy under entity breadth first and propagates a value from parents
+     * to children. The functor receives the node and the value returned by its parent (state for
+     * the root) and returns the value for its children, 0 skips the children. The hierarchy must
+     * not be linked or unlinked during the traversal, and traversals must not be nested.
+     */
     template <typename Functor>
-    void each_dfs(ecs::entity entity, Functor&& functor, bool ignore_root = false)
+    void propagate(
+        ecs::entity entity,
+        Functor&& functor,
+        std::uint8_t state = 1,
+        bool ignore_root = false)
     {
-        auto& world = system<ecs::world>();
+        std::uint32_t root = hierarchy_index(entity);
 
-        std::stack<ecs::entity> dfs;
-        if (ignore_root)
-        {
-            auto& node_link = world.component<link_type>(entity);
-            for (auto child : node_link.children)
-                dfs.push(child);
-        }
-        else
-        {
-            dfs.push(entity);
-        }
+        std::uint8_t root_state = ignore_root ? state : functor(entity, state);
+        if (root_state == 0)
+            return;
+
+        // States of the current level indexed from begin, the parents of the next level all lie
+        // in the current level.
+        std::vector<std::uint8_t>& level_state = m_level_state;
+        std::vector<std::uint8_t>& next_level_state = m_next_level_state;
+        level_state.assign(1, root_state);
 
-        while (!dfs.empty())
+        // The descendants of root on the next level lie between the children of the first and the
+        // last node of the current level.
+        std::uint32_t begin = root;
+        std::uint32_t end = root + 1;
+        while (true)
         {
-            ecs::entity node = dfs.top();
-            dfs.pop();
+            const hierarchy_node& last = m_hierarchy[end - 1];
+            std::uint32_t next_begin = m_hierarchy[begin].first_child;
+            std::uint32_t next_end = last.first_child + last.child_count;
 
-            if constexpr (std::is_same_v<std::invoke_result_t<Functor, ecs::entity>, bool>)
-            {
-                if (!functor(node))
-                    continue;
-            }
-            else
+            next_level_state.resize(next_end - next_begin);
+
+            bool visited = false;
+            for (std::uint32_t i = next_begin; i < next_end; ++i)
             {
-                functor(node);
+                std::uint8_t parent_state = level_state[m_hierarchy[i].parent - begin];
+                std::uint8_t node_state =
+                    parent_state == 0 ? 0 : functor(m_hierarchy[i].entity, parent_state);
+
+                next_level_state[i - next_begin] = node_state;
+                visited |= node_state != 0;
             }
 
-            auto& node_link = world.component<link_type>(node);
-            for (auto child : node_link.children)
-                dfs.push(child);
+            if (!visited)
+                break;
+
+            level_state.swap(next_level_state);
+            begin = next_begin;
+            end = next_end;
+        }
+    }
+
+    /**
+     * @brief Calls functor(begin, end) for each level of the hierarchy under entity, starting with
+     * the level below entity. [begin, end) is the range of hierarchy indices of the descendants of
+     * entity on that level. Levels are visited in order, so the nodes of a single level can be
+     * processed in parallel.
+     */
+    template <typename Functor>
+    void each_level(ecs::entity entity, Functor&& functor)
+    {
+        std::uint32_t begin = hierarchy_index(entity);
+        std::uint32_t end = begin + 1;
+        while (true)
+        {
+            const hierarchy_node& last = m_hierarchy[end - 1];
+            std::uint32_t next_begin = m_hierarchy[begin].first_child;
+            std::uint32_t next_end = last.first_child + last.child_count;
+            if (next_begin == next_end)
+                break;
+
+            functor(next_begin, next_end);
+
+            begin = next_begin;
+            end = next_end;
         }
     }
+
+    /**
+     * @brief The flattened hierarchy, sorted by depth. It holds the trees whose root was looked up
+     * with hierarchy_index and everything linked under them since. Link and unlink splice the
+     * changed subtree in place, so indices after the change move.
+     */
+    const std::vector<hierarchy_node>& hierarchy() const noexcept { return m_hierarchy; }
+
+    /**
+     * @brief Index of entity in the hierarchy. Adds the tree of entity on the first lookup.
+     */
+    std::uint32_t hierarchy_index(ecs::entity entity);
+
+private:
+    // Replaces erase_count nodes at position with the nodes [insert_begin, insert_end) of
+    // m_splice_nodes. Positions are indices before the splice.
+    struct splice_range
+    {
+        std::uint32_t position;
+        std::uint32_t erase_count;
+
+        std::uint32_t insert_begin;
+        std::uint32_t insert_end;
+    };
+
+    struct splice_node
+    {
+        ecs::entity entity;
+        ecs::entity parent;
+    };
+
+    std::uint32_t find(ecs::entity entity) const noexcept;
+
+    // Adds the tree under entity as the last child of parent, or as a root if parent is
+    // INVALID_INDEX.
+    void insert(ecs::entity entity, std::uint32_t parent);
+
+    // Removes the node at index and its descendants.
+    void erase(std::uint32_t index);
+
+    // Applies m_splice_ranges and updates the child ranges of the nodes from anchor on, whose
+    // first child is not moved by the splice.
+    void splice(std::uint32_t anchor);
+
+    std::vector<hierarchy_node> m_hierarchy;
+
+    // Roots are the first nodes of the hierarchy.
+    std::uint32_t m_root_count;
+
+    // Maps entity index to hierarchy index.
+    std::vector<std::uint32_t> m_entity_index;
+
+    // Scratch buffers of splice.
+    std::vector<splice_range> m_splice_ranges;
+    std::vector<splice_node> m_splice_nodes;
+    std::vector<hierarchy_node> m_layout;
+
+    // Scratch buffers of propagate.
+    std::vector<std::uint8_t> m_level_state;
+    std::vector<std::uint8_t> m_next_level_state;
 };
-} // namespace ash::core
\ No newline at end of file
+} // namespace ash::core
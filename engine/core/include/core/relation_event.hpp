@@ -8,14 +8,12 @@ namespace ash::core
 {
 struct event_link
 {
-    using functor = std::function<void(ecs::entity, link&)>;
-    using dispatcher = sequence_dispatcher<functor>;
+    using dispatcher = sequence_dispatcher<void(ecs::entity, link&)>;
 };
 
 struct event_unlink
 {
-    using functor = std::function<void(ecs::entity, link&)>;
-    using dispatcher = sequence_dispatcher<functor>;
+    using dispatcher = sequence_dispatcher<void(ecs::entity, link&)>;
 };
 
 } // namespace ash::core
\ No newline at end of file
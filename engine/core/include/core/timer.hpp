@@ -5,6 +5,11 @@
 #include <chrono>
 #include <thread>
 
+namespace ash::test
+{
+class timer_accessor;
+}
+
 namespace ash::core
 {
 class timer : public system_base
@@ -21,8 +26,28 @@ public:
 
     using steady_time_point = std::chrono::time_point<std::chrono::steady_clock>;
 
+    struct frame_statistics
+    {
+        // Frame time percentiles in seconds.
+        float p50;
+        float p95;
+        float p99;
+
+        float average;
+
+        // Standard deviation of the frame time in seconds.
+        float jitter;
+    };
+
+    static constexpr std::chrono::nanoseconds DEFAULT_SPIN_TIME = std::chrono::microseconds(1000);
+    static constexpr std::size_t FRAME_STATISTICS_SIZE = 256;
+
 public:
-    timer() : system_base("timer") {}
+    timer();
+    virtual ~timer();
+
+    virtual bool initialize(const dictionary& config) override;
+    virtual void shutdown() override;
 
     template <typename Clock = std::chrono::steady_clock>
     static std::chrono::time_point<Clock> now()
@@ -30,18 +55,25 @@ public:
         return Clock::now();
     }
 
+    /**
+     * @brief Sleeps for the given duration. The thread is suspended for most of the time and only
+     * the last spin_time is spent spinning, which keeps the wake-up accurate without burning a
+     * whole core.
+     */
     template <class Rep, class Period>
-    static void busy_sleep(const std::chrono::duration<Rep, Period>& duration)
+    static void sleep(
+        const std::chrono::duration<Rep, Period>& duration,
+        std::chrono::nanoseconds spin_time = DEFAULT_SPIN_TIME)
     {
-        auto current = std::chrono::steady_clock::now();
-        auto end_time = current + duration;
-        while (current < end_time)
-        {
-            current = std::chrono::steady_clock::now();
-            std::this_thread::yield();
-        }
+        sleep_until(
+            now() + std::chrono::duration_cast<std::chrono::nanoseconds>(duration),
+            spin_time);
     }
 
+    static void sleep_until(
+        steady_time_point end_time,
+        std::chrono::nanoseconds spin_time = DEFAULT_SPIN_TIME);
+
     template <point P>
     void tick()
     {
@@ -52,8 +84,19 @@ public:
         }
 
         m_time_point[P] = now<std::chrono::steady_clock>();
+
+        if constexpr (P == FRAME_START)
+        {
+            update_fixed_step(delta<PRE_FRAME_START, FRAME_START>());
+            update_statistics(frame_delta());
+        }
     }
 
+    /**
+     * @brief Waits until the next frame should start. Does nothing if the frame rate is unlimited.
+     */
+    void pace();
+
     template <point P>
     inline steady_time_point time_point() const noexcept
     {
@@ -71,8 +114,70 @@ public:
         return delta<PRE_FRAME_START, FRAME_START>().count() * 0.000000001f;
     }
 
+    /**
+     * @brief Length of a fixed simulation step in seconds. Equal to the frame delta when fixed
+     * stepping is disabled.
+     */
+    inline float fixed_delta() const noexcept
+    {
+        if (m_fixed_step.count() == 0)
+            return frame_delta();
+        else
+            return m_fixed_step.count() * 0.000000001f;
+    }
+
+    /**
+     * @brief Number of fixed steps that must be simulated this frame.
+     */
+    inline std::size_t fixed_steps() const noexcept { return m_fixed_steps; }
+
+    /**
+     * @brief Interpolation factor between the last two fixed steps, in the range [0, 1].
+     */
+    inline float fixed_alpha() const noexcept { return m_fixed_alpha; }
+
+    /**
+     * @brief Frame time statistics over the last FRAME_STATISTICS_SIZE frames.
+     */
+    frame_statistics statistics() const;
+
 private:
+    // Feeds frame deltas to the private updates in tests.
+    friend class ash::test::timer_accessor;
+
+    /**
+     * @brief Records the time of a frame in seconds, and logs the statistics every
+     * statistics_interval frames. Called by tick<FRAME_START>.
+     */
+    void update_statistics(float frame_delta);
+
+    /**
+     * @brief Adds the frame delta to the fixed step accumulator and computes the fixed steps and
+     * alpha of the frame. Called by tick<FRAME_START>.
+     */
+    void update_fixed_step(std::chrono::nanoseconds frame_delta);
+
     std::size_t m_index;
     std::array<steady_time_point, NUM_TIME_POINT> m_time_point;
+
+    std::chrono::nanoseconds m_fixed_step;
+    std::chrono::nanoseconds m_accumulator;
+    std::size_t m_max_fixed_steps;
+
+    std::size_t m_fixed_steps;
+    float m_fixed_alpha;
+
+    std::chrono::nanoseconds m_frame_time;
+    std::chrono::nanoseconds m_spin_time;
+    steady_time_point m_frame_deadline;
+
+    // File descriptor of the timerfd pacer, -1 when the hybrid sleep pacer is used.
+    int m_pacer;
+
+    std::array<float, FRAME_STATISTICS_SIZE> m_frame_times;
+    std::size_t m_frame_count;
+
+    // Frames between two statistics log lines, 0 disables logging.
+    std::size_t m_statistics_interval;
 };
 } // namespace ash::core
\ No newline at end of file
@@ -26,6 +26,7 @@ void application::run()
     task.run();
 
     auto root_task = task.find(task::TASK_ROOT);
+    auto fixed_root_task = task.find(task::TASK_FIXED_ROOT);
 
     timer& time = system<timer>();
 
@@ -35,16 +36,13 @@ void application::run()
     {
         time.tick<timer::point::FRAME_START>();
         context::begin_frame();
+        for (std::size_t i = 0; i < time.fixed_steps(); ++i)
+            task.execute(fixed_root_task);
         task.execute(root_task);
         context::end_frame();
         time.tick<timer::point::FRAME_END>();
 
-        /*
-        static constexpr nanoseconds time_per_frame(1000000000 / 240);
-        nanoseconds delta = time.delta<timer::point::FRAME_START, timer::point::FRAME_END>();
-        if (delta < time_per_frame)
-            timer::busy_sleep(time_per_frame - delta);
-        */
+        time.pace();
     }
 
     context::shutdown();
@@ -3,7 +3,7 @@
 
 namespace ash::core
 {
-relation::relation() : system_base("relation")
+relation::relation() : system_base("relation"), m_root_count(0)
 {
 }
 
@@ -29,6 +29,18 @@ void relation::link(ecs::entity child_entity, ecs::entity parent_entity)
     parent.children.push_back(child_entity);
     child.parent = parent_entity;
 
+    // A tracked root is no longer a root. It is moved under its new parent if that is tracked, and
+    // dropped otherwise.
+    std::uint32_t child_index = find(child_entity);
+    if (child_index != INVALID_INDEX)
+        erase(child_index);
+
+    // Trees that were never looked up are not tracked, they are added in one piece on the first
+    // lookup.
+    std::uint32_t parent_index = find(parent_entity);
+    if (parent_index != INVALID_INDEX)
+        insert(child_entity, parent_index);
+
     system<event>().publish<event_link>(child_entity, child);
 }
 
@@ -43,14 +55,210 @@ void relation::unlink(ecs::entity entity)
     {
         if (*iter == entity)
         {
-            std::swap(*iter, parent.children.back());
-            parent.children.pop_back();
+            parent.children.erase(iter);
             break;
         }
     }
 
+    // The detached tree is dropped, it is added again when it is linked or looked up.
+    std::uint32_t index = find(entity);
+    if (index != INVALID_INDEX)
+        erase(index);
+
     child.parent = ecs::INVALID_ENTITY;
 
     system<event>().publish<event_unlink>(entity, child);
 }
-} // namespace ash::core
\ No newline at end of file
+
+std::uint32_t relation::hierarchy_index(ecs::entity entity)
+{
+    std::uint32_t index = find(entity);
+    if (index != INVALID_INDEX)
+        return index;
+
+    // Add the whole tree, a subtree added on its own would be duplicated once its root is added.
+    auto& world = system<ecs::world>();
+    ecs::entity root = entity;
+    while (world.component<link_type>(root).parent != ecs::INVALID_ENTITY)
+        root = world.component<link_type>(root).parent;
+
+    insert(root, INVALID_INDEX);
+
+    index = find(entity);
+    ASH_ASSERT(index != INVALID_INDEX);
+    return index;
+}
+
+std::uint32_t relation::find(ecs::entity entity) const noexcept
+{
+    if (entity.index >= m_entity_index.size())
+        return INVALID_INDEX;
+
+    std::uint32_t index = m_entity_index[entity.index];
+    if (index == INVALID_INDEX || m_hierarchy[index].entity != entity)
+        return INVALID_INDEX;
+
+    return index;
+}
+
+void relation::insert(ecs::entity entity, std::uint32_t parent)
+{
+    auto& world = system<ecs::world>();
+
+    m_splice_ranges.clear();
+    m_splice_nodes.clear();
+
+    std::uint32_t size = static_cast<std::uint32_t>(m_hierarchy.size());
+
+    // Position of the children of the node at index on the next level, when the node would be at
+    // index on its level.
+    auto child_position = [&, this](std::uint32_t index, std::uint32_t depth) {
+        if (index < size && m_hierarchy[index].depth == depth)
+            return m_hierarchy[index].first_child;
+        else if (index == size)
+            return size;
+
+        // Index is the end of its level, the children go to the end of the next level.
+        const hierarchy_node& last = m_hierarchy[index - 1];
+        return last.first_child + last.child_count;
+    };
+
+    std::uint32_t position = m_root_count;
+    std::uint32_t depth = 0;
+    if (parent != INVALID_INDEX)
+    {
+        position = m_hierarchy[parent].first_child + m_hierarchy[parent].child_count;
+        depth = m_hierarchy[parent].depth + 1;
+    }
+
+    m_splice_nodes.push_back(splice_node{
+        entity,
+        parent == INVALID_INDEX ? ecs::INVALID_ENTITY : m_hierarchy[parent].entity});
+
+    // Each level of the new tree is a contiguous range, inserted behind the descendants of the
+    // nodes that precede it on the same level. Only the link components of the new tree are read.
+    std::uint32_t level_begin = 0;
+    while (level_begin != m_splice_nodes.size())
+    {
+        std::uint32_t level_end = static_cast<std::uint32_t>(m_splice_nodes.size());
+        m_splice_ranges.push_back(splice_range{position, 0, level_begin, level_end});
+
+        for (std::uint32_t i = level_begin; i < level_end; ++i)
+        {
+            ecs::entity node = m_splice_nodes[i].entity;
+            for (ecs::entity child : world.component<link_type>(node).children)
+                m_splice_nodes.push_back(splice_node{child, node});
+        }
+
+        position = child_position(position, depth);
+        ++depth;
+        level_begin = level_end;
+    }
+
+    if (parent == INVALID_INDEX)
+    {
+        ++m_root_count;
+        splice(0);
+    }
+    else
+    {
+        splice(parent);
+    }
+}
+
+void relation::erase(std::uint32_t index)
+{
+    m_splice_ranges.clear();
+
+    // The descendants on each level are a contiguous range.
+    std::uint32_t begin = index;
+    std::uint32_t end = index + 1;
+    while (begin != end)
+    {
+        m_splice_ranges.push_back(splice_range{begin, end - begin, 0, 0});
+
+        const hierarchy_node& last = m_hierarchy[end - 1];
+        begin = m_hierarchy[begin].first_child;
+        end = last.first_child + last.child_count;
+    }
+
+    std::uint32_t parent = m_hierarchy[index].parent;
+    if (parent == INVALID_INDEX)
+    {
+        --m_root_count;
+        splice(0);
+    }
+    else
+    {
+        splice(parent);
+    }
+}
+
+void relation::splice(std::uint32_t anchor)
+{
+    std::uint32_t begin = m_splice_ranges.front().position;
+    std::uint32_t size = static_cast<std::uint32_t>(m_hierarchy.size());
+
+    // Nodes before the first range keep their indices, the rest is written again behind them.
+    m_layout.assign(m_hierarchy.begin() + begin, m_hierarchy.end());
+    m_hierarchy.resize(begin);
+
+    // Parents always precede their children, so the parent is at its new index when a node is
+    // added.
+    auto add_node = [this](ecs::entity entity, ecs::entity parent) {
+        std::uint32_t parent_index =
+            parent == ecs::INVALID_ENTITY ? INVALID_INDEX : m_entity_index[parent.index];
+        std::uint32_t depth =
+            parent_index == INVALID_INDEX ? 0 : m_hierarchy[parent_index].depth + 1;
+
+        if (m_entity_index.size() <= entity.index)
+            m_entity_index.resize(entity.index + 1, INVALID_INDEX);
+        m_entity_index[entity.index] = static_cast<std::uint32_t>(m_hierarchy.size());
+
+        m_hierarchy.push_back(hierarchy_node{entity, parent_index, depth, 0, 0});
+    };
+
+    auto copy_nodes = [&, this](std::uint32_t first, std::uint32_t last) {
+        for (std::uint32_t i = first; i < last; ++i)
+        {
+            const hierarchy_node& node = m_layout[i - begin];
+
+            ecs::entity parent = ecs::INVALID_ENTITY;
+            if (node.parent != INVALID_INDEX)
+            {
+                parent = node.parent < begin ? m_hierarchy[node.parent].entity
+                                             : m_layout[node.parent - begin].entity;
+            }
+            add_node(node.entity, parent);
+        }
+    };
+
+    std::uint32_t next = begin;
+    for (const splice_range& range : m_splice_ranges)
+    {
+        copy_nodes(next, range.position);
+
+        for (std::uint32_t i = range.insert_begin; i < range.insert_end; ++i)
+            add_node(m_splice_nodes[i].entity, m_splice_nodes[i].parent);
+
+        for (std::uint32_t i = range.position; i < range.position + range.erase_count; ++i)
+            m_entity_index[m_layout[i - begin].entity.index] = INVALID_INDEX;
+
+        next = range.position + range.erase_count;
+    }
+    copy_nodes(next, size);
+
+    // Children are grouped by parent in parent order, so one cursor walks the child ranges of all
+    // the following nodes.
+    std::uint32_t cursor = anchor == 0 ? m_root_count : m_hierarchy[anchor].first_child;
+    size = static_cast<std::uint32_t>(m_hierarchy.size());
+    for (std::uint32_t i = anchor; i < size; ++i)
+    {
+        hierarchy_node& node = m_hierarchy[i];
+        node.first_child = cursor;
+        while (cursor < size && m_hierarchy[cursor].parent == i)
+            ++cursor;
+        node.child_count = cursor - node.first_child;
+    }
+}
+} // namespace ash::core
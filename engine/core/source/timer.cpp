@@ -0,0 +1,286 @@
+#include "core/timer.hpp"
+#include "log.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__linux__)
+#    include <cerrno>
+#    include <ctime>
+#    include <sys/timerfd.h>
+#    include <unistd.h>
+#elif defined(_WIN32)
+#    ifndef NOMINMAX
+#        define NOMINMAX
+#    endif
+#    include <Windows.h>
+#endif
+
+namespace ash::core
+{
+#if defined(__linux__)
+namespace
+{
+timespec to_timespec(std::chrono::nanoseconds time)
+{
+    timespec result = {};
+    result.tv_sec = static_cast<time_t>(time.count() / 1000000000);
+    result.tv_nsec = static_cast<long>(time.count() % 1000000000);
+    return result;
+}
+} // namespace
+#elif defined(_WIN32)
+namespace
+{
+/**
+ * @brief High resolution waitable timer of the calling thread. Sleep and sleep_until follow the
+ * system timer resolution of about 15.6 ms, which overshoots a whole frame.
+ */
+class waitable_timer
+{
+public:
+    waitable_timer()
+        : m_handle(CreateWaitableTimerExW(
+              nullptr,
+              nullptr,
+              CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,
+              TIMER_ALL_ACCESS))
+    {
+    }
+
+    ~waitable_timer()
+    {
+        if (m_handle != nullptr)
+            CloseHandle(m_handle);
+    }
+
+    bool wait(std::chrono::nanoseconds duration)
+    {
+        // Versions before Windows 10 1803 don't support high resolution timers.
+        if (m_handle == nullptr)
+            return false;
+
+        // Negative due times are relative, in 100 ns units.
+        LARGE_INTEGER due_time = {};
+        due_time.QuadPart = -static_cast<LONGLONG>(duration.count() / 100);
+        if (!SetWaitableTimerEx(m_handle, &due_time, 0, nullptr, nullptr, nullptr, 0))
+            return false;
+
+        return WaitForSingleObject(m_handle, INFINITE) == WAIT_OBJECT_0;
+    }
+
+private:
+    HANDLE m_handle;
+};
+} // namespace
+#endif
+
+timer::timer()
+    : system_base("timer"),
+      m_fixed_step(0),
+      m_accumulator(0),
+      m_max_fixed_steps(1),
+      m_fixed_steps(1),
+      m_fixed_alpha(1.0f),
+      m_frame_time(0),
+      m_spin_time(DEFAULT_SPIN_TIME),
+      m_pacer(-1),
+      m_frame_times{},
+      m_frame_count(0),
+      m_statistics_interval(0)
+{
+    m_time_point.fill(now());
+    m_frame_deadline = m_time_point[FRAME_START];
+}
+
+timer::~timer()
+{
+    shutdown();
+}
+
+bool timer::initialize(const dictionary& config)
+{
+    std::uint32_t frequency = config["fixed_frequency"];
+    if (frequency != 0)
+        m_fixed_step = std::chrono::nanoseconds(1000000000 / frequency);
+
+    m_max_fixed_steps = config["max_fixed_steps"];
+    if (m_max_fixed_steps == 0)
+        m_max_fixed_steps = 1;
+
+    std::uint32_t frame_rate = config["frame_rate"];
+    if (frame_rate != 0)
+        m_frame_time = std::chrono::nanoseconds(1000000000 / frame_rate);
+
+    std::uint32_t spin_time = config["spin_time"];
+    m_spin_time = std::chrono::microseconds(spin_time);
+
+    m_statistics_interval = config["statistics_interval"];
+
+    if (m_frame_time.count() != 0 && config["pacer"] == "timerfd")
+    {
+#if defined(__linux__)
+        m_pacer = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+        if (m_pacer != -1)
+        {
+            itimerspec spec = {};
+            spec.it_interval = to_timespec(m_frame_time);
+            spec.it_value = spec.it_interval;
+            timerfd_settime(m_pacer, 0, &spec, nullptr);
+        }
+        else
+        {
+            log::warn("Failed to create timerfd, fall back to the sleep pacer.");
+        }
+#else
+        log::warn("The timerfd pacer is only supported on linux, fall back to the sleep pacer.");
+#endif
+    }
+
+    m_frame_deadline = now();
+
+    return true;
+}
+
+void timer::shutdown()
+{
+#if defined(__linux__)
+    if (m_pacer != -1)
+    {
+        close(m_pacer);
+        m_pacer = -1;
+    }
+#endif
+}
+
+void timer::sleep_until(steady_time_point end_time, std::chrono::nanoseconds spin_time)
+{
+    steady_time_point wake_time = end_time - spin_time;
+    if (now() < wake_time)
+    {
+#if defined(__linux__)
+        // steady_clock is CLOCK_MONOTONIC on linux, so the time point can be used directly.
+        timespec wake = to_timespec(wake_time.time_since_epoch());
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, nullptr) == EINTR)
+            ;
+#elif defined(_WIN32)
+        thread_local waitable_timer waitable;
+        if (!waitable.wait(wake_time - now()))
+            std::this_thread::sleep_until(wake_time);
+#else
+        std::this_thread::sleep_until(wake_time);
+#endif
+    }
+
+    // The coarse sleep may wake up late or early by up to a scheduler quantum, spin for the rest.
+    while (now() < end_time)
+        std::this_thread::yield();
+}
+
+void timer::pace()
+{
+    if (m_frame_time.count() == 0)
+        return;
+
+#if defined(__linux__)
+    if (m_pacer != -1)
+    {
+        // Blocks until the next period boundary. Missed periods are coalesced by the kernel.
+        std::uint64_t expirations;
+        if (read(m_pacer, &expirations, sizeof(expirations)) == sizeof(expirations))
+            return;
+    }
+#endif
+
+    m_frame_deadline += m_frame_time;
+
+    steady_time_point current = now();
+    if (m_frame_deadline < current)
+    {
+        // The frame took longer than its budget, restart pacing from now instead of rushing the
+        // following frames to catch up.
+        m_frame_deadline = current;
+        return;
+    }
+
+    sleep_until(m_frame_deadline, m_spin_time);
+}
+
+timer::frame_statistics timer::statistics() const
+{
+    frame_statistics result = {};
+
+    std::size_t count = std::min(m_frame_count, FRAME_STATISTICS_SIZE);
+    if (count == 0)
+        return result;
+
+    std::array<float, FRAME_STATISTICS_SIZE> sorted;
+    std::copy_n(m_frame_times.begin(), count, sorted.begin());
+    std::sort(sorted.begin(), sorted.begin() + count);
+
+    auto percentile = [&](float p) {
+        std::size_t rank = static_cast<std::size_t>(std::ceil(p * count));
+        return sorted[std::clamp<std::size_t>(rank, 1, count) - 1];
+    };
+    result.p50 = percentile(0.50f);
+    result.p95 = percentile(0.95f);
+    result.p99 = percentile(0.99f);
+
+    float sum = 0.0f;
+    for (std::size_t i = 0; i < count; ++i)
+        sum += sorted[i];
+    result.average = sum / count;
+
+    float variance = 0.0f;
+    for (std::size_t i = 0; i < count; ++i)
+        variance += (sorted[i] - result.average) * (sorted[i] - result.average);
+    result.jitter = std::sqrt(variance / count);
+
+    return result;
+}
+
+void timer::update_fixed_step(std::chrono::nanoseconds frame_delta)
+{
+    if (m_fixed_step.count() == 0)
+    {
+        m_fixed_steps = 1;
+        m_fixed_alpha = 1.0f;
+        return;
+    }
+
+    m_accumulator += frame_delta;
+
+    m_fixed_steps = static_cast<std::size_t>(m_accumulator / m_fixed_step);
+    if (m_fixed_steps > m_max_fixed_steps)
+    {
+        // The simulation can't keep up, drop the time that exceeds the budget instead of
+        // accumulating more and more catch-up steps.
+        m_fixed_steps = m_max_fixed_steps;
+        m_accumulator = m_accumulator % m_fixed_step;
+    }
+    else
+    {
+        m_accumulator -= m_fixed_step * m_fixed_steps;
+    }
+
+    m_fixed_alpha = static_cast<float>(m_accumulator.count()) / m_fixed_step.count();
+}
+
+void timer::update_statistics(float frame_delta)
+{
+    m_frame_times[m_frame_count % FRAME_STATISTICS_SIZE] = frame_delta;
+    ++m_frame_count;
+
+    if (m_statistics_interval != 0 && m_frame_count % m_statistics_interval == 0)
+    {
+        frame_statistics result = statistics();
+        log::info(
+            "Frame time: p50 {:.3f} ms, p95 {:.3f} ms, p99 {:.3f} ms, average {:.3f} ms, jitter "
+            "{:.3f} ms.",
+            result.p50 * 1000.0f,
+            result.p95 * 1000.0f,
+            result.p99 * 1000.0f,
+            result.average * 1000.0f,
+            result.jitter * 1000.0f);
+    }
+}
+} // namespace ash::core
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "math/math.hpp"
+#include <span>
+#include <vector>
+
+namespace ash::graphics
+{
+enum skin_type
+{
+    SKIN_TYPE_BDEF1,
+    SKIN_TYPE_BDEF2,
+    SKIN_TYPE_BDEF4,
+    SKIN_TYPE_SDEF
+};
+
+struct skin_vertex
+{
+    skin_type type;
+
+    math::uint4 index;
+    math::float4 weight;
+
+    // SDEF only, r0 and r1 already corrected towards center.
+    math::float3 center;
+    math::float3 r0;
+    math::float3 r1;
+};
+
+struct cpu_skin_info
+{
+    std::span<const math::float3> position;
+    std::span<const math::float3> normal;
+    std::span<const math::float2> uv; // May be empty.
+    std::span<const skin_vertex> skin;
+
+    // Slots of skinned_mesh::skinned_vertex_buffers that receive the results.
+    std::size_t position_slot;
+    std::size_t normal_slot;
+    std::size_t uv_slot;
+};
+
+/**
+ * @brief Bind pose of a mesh skinned on the CPU with math::skin_batch. Vertices are grouped by skin
+ * type and cut into blocks of at most BLOCK_SIZE vertices, each block keeps its streams as
+ * structure of arrays and is one job for the task workers.
+ */
+class cpu_skin
+{
+public:
+    static constexpr std::size_t BLOCK_SIZE = 512;
+
+    cpu_skin(const cpu_skin_info& info);
+
+    void bones(std::span<const math::float4x4> bones);
+
+    /**
+     * @brief Per vertex offsets added before skinning, such as the results of vertex morphs. The
+     * arrays are read by skin and should be in system memory, nullptr disables them.
+     */
+    void position_offset(const math::float3* offset) noexcept { m_position_offset = offset; }
+    void uv_offset(const math::float2* offset) noexcept { m_uv_offset = offset; }
+
+    /**
+     * @brief Skins one block into arrays in the original vertex order. Different blocks can be
+     * skinned at the same time.
+     *
+     * @param uv Receives uv plus the uv offset, nullptr when the mesh has no uv.
+     */
+    void skin(std::size_t block, math::float3* position, math::float3* normal, math::float2* uv)
+        const;
+
+    std::size_t block_count() const noexcept { return m_blocks.size(); }
+    std::size_t vertex_count() const noexcept { return m_vertices.size(); }
+    bool has_uv() const noexcept { return !m_uv.empty(); }
+
+    std::size_t position_slot() const noexcept { return m_position_slot; }
+    std::size_t normal_slot() const noexcept { return m_normal_slot; }
+    std::size_t uv_slot() const noexcept { return m_uv_slot; }
+
+private:
+    struct block
+    {
+        skin_type type;
+        std::size_t count;
+
+        // Offsets of the streams in m_data, the components of a stream are count apart.
+        std::size_t position;
+        std::size_t normal;
+        std::size_t index;
+        std::size_t weight;
+        std::size_t center;
+        std::size_t r0;
+        std::size_t r1;
+
+        // Offset of the original vertex indices in m_vertices.
+        std::size_t vertex;
+    };
+
+    void add_block(const cpu_skin_info& info, std::span<const std::uint32_t> vertices);
+
+    std::vector<block> m_blocks;
+    std::vector<float> m_data;
+    std::vector<std::uint32_t> m_vertices;
+    std::vector<math::float2> m_uv;
+
+    std::vector<math::float4x4> m_bones;
+
+    // Rotations of the bones, only needed by SDEF.
+    bool m_spherical;
+    std::vector<math::float4> m_rotations;
+
+    const math::float3* m_position_offset;
+    const math::float2* m_uv_offset;
+
+    std::size_t m_position_slot;
+    std::size_t m_normal_slot;
+    std::size_t m_uv_slot;
+};
+} // namespace ash::graphics
\ No newline at end of file
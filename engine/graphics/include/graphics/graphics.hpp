@@ -4,6 +4,7 @@
 #include "graphics/compute_pipeline.hpp"
 #include "graphics/graphics_debug.hpp"
 #include "graphics/mesh_render.hpp"
+#include "graphics/render_queue.hpp"
 #include "graphics/skinned_mesh.hpp"
 #include "scene/bounding_box.hpp"
 #include "scene/transform.hpp"
@@ -42,10 +43,14 @@ public:
 
 private:
     void skin_meshes();
+    void update_objects();
     void render();
     void render_camera(ecs::entity camera_entity);
     void present();
 
+    // Counts the commands of the frame against the render concurrency.
+    render_command_interface* allocate_command();
+
     bool is_editor_mode() const noexcept { return m_editor_camera != ecs::INVALID_ENTITY; }
 
     std::size_t m_back_buffer_index;
@@ -56,6 +61,41 @@ private:
 
     std::queue<ecs::entity> m_render_queue;
 
+    // Render units of the camera being rendered, kept to reuse the storage.
+    render_queue m_draw_queue;
+
+    struct pending_render_unit
+    {
+        render_pipeline* pipeline;
+        render_unit unit;
+        std::size_t parameter_count;
+        float depth;
+        std::uint32_t object_index;
+    };
+
+    // Units gathered by each job before they enter the queue in job order.
+    std::vector<std::vector<pending_render_unit>> m_pending_units;
+
+    // Blocks of the meshes skinned on the CPU this frame, written straight into the mapped
+    // outputs.
+    struct cpu_skin_job
+    {
+        const cpu_skin* skin;
+        std::size_t block;
+
+        math::float3* position;
+        math::float3* normal;
+        math::float2* uv;
+    };
+    std::vector<cpu_skin_job> m_cpu_skin_jobs;
+
+    // Number of commands a frame may allocate, and the number allocated so far.
+    std::size_t m_render_concurrency;
+    std::size_t m_command_count;
+
+    // World matrices of the drawn objects, shared by all cameras.
+    std::unique_ptr<object_buffer> m_objects;
+
     std::unique_ptr<light_pipeline_parameter> m_light_parameter;
 
     // Sky.
@@ -24,7 +24,7 @@ public:
     static constexpr std::size_t MAX_VERTEX_COUNT = 4096 * 16;
 
 public:
-    graphics_debug(std::size_t frame_resource);
+    graphics_debug();
 
     void initialize();
     void sync();
@@ -46,7 +46,5 @@ private:
     std::unique_ptr<resource_interface> m_index_buffer;
 
     std::unique_ptr<debug_pipeline> m_pipeline;
-
-    std::size_t m_frame_resource;
 };
 } // namespace ash::graphics
\ No newline at end of file
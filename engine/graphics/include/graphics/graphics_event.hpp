@@ -6,6 +6,6 @@ namespace ash::graphics
 {
 struct event_render_extent_change
 {
-    using dispatcher = core::sequence_dispatcher<std::function<void(std::uint32_t, std::uint32_t)>>;
+    using dispatcher = core::sequence_dispatcher<void(std::uint32_t, std::uint32_t)>;
 };
 } // namespace ash::graphics
\ No newline at end of file
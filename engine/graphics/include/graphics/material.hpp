@@ -9,6 +9,8 @@ class render_pipeline;
 struct material
 {
     render_pipeline* pipeline;
+    // Per object parameters come first, the last one is shared by the units that use the same
+    // material and groups them in the render queue.
     std::vector<pipeline_parameter_interface*> parameters;
 
     scissor_extent scissor;
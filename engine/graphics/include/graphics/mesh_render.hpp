@@ -1,7 +1,7 @@
 #pragma once
 
 #include "graphics/material.hpp"
-#include "graphics/pipeline_parameter.hpp"
+#include "graphics/object_buffer.hpp"
 #include "graphics/render_group.hpp"
 
 namespace ash::graphics
@@ -13,16 +13,6 @@ struct submesh
     std::size_t vertex_base;
 };
 
-class object_pipeline_parameter : public pipeline_parameter
-{
-public:
-    object_pipeline_parameter();
-
-    void world_matrix(const math::float4x4& matrix);
-
-    static std::vector<pipeline_parameter_pair> layout();
-};
-
 struct mesh_render
 {
     std::vector<resource_interface*> vertex_buffers;
@@ -31,8 +21,9 @@ struct mesh_render
     std::vector<submesh> submeshes;
     std::vector<material> materials;
 
-    std::unique_ptr<object_pipeline_parameter> object_parameter;
-
     render_groups render_groups{RENDER_GROUP_1};
+
+    // Slot in the object buffer, assigned by graphics.
+    std::uint32_t object_index{INVALID_OBJECT_INDEX};
 };
 } // namespace ash::graphics
\ No newline at end of file
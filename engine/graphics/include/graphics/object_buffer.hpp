@@ -0,0 +1,106 @@
+#pragma once
+
+#include "graphics/pipeline_parameter.hpp"
+#include "math/math.hpp"
+#include <span>
+
+namespace ash::graphics
+{
+static constexpr std::uint32_t INVALID_OBJECT_INDEX = -1;
+
+/**
+ * @brief The ash_object layout: the world matrices of all objects, and the object of each instance
+ * drawn in the frame. Shaders read ash_objects[ash_instances[instance_index + SV_InstanceID]].
+ */
+class object_pipeline_parameter : public pipeline_parameter
+{
+public:
+    object_pipeline_parameter();
+
+    void objects(resource_interface* objects, resource_interface* instances);
+
+    static std::vector<pipeline_parameter_pair> layout();
+};
+
+// Constants of the ash_draw layout, pushed with render_command_interface::constant per draw.
+struct draw_constant_data
+{
+    std::uint32_t instance_index;
+
+    static std::vector<pipeline_parameter_pair> layout();
+};
+
+/**
+ * @brief World matrices of the objects in GPU memory. Every object keeps its slot as long as it
+ * lives, and only slots that changed are written, each frame resource copy once per change. The
+ * instances drawn in a frame only write the 32 bit index of their object.
+ */
+class object_buffer
+{
+public:
+    object_buffer(
+        std::size_t object_capacity,
+        std::size_t instance_capacity,
+        std::size_t frame_resource);
+
+    /**
+     * @brief Keeps an object alive for the current frame, objects that are not kept are released by
+     * upload.
+     *
+     * @param index Current slot of the object. A new slot is returned for INVALID_OBJECT_INDEX, and
+     * for a slot that was already kept this frame, which happens when a component is copied.
+     * @param added Set when a new slot is returned, its data must be written with update.
+     */
+    std::uint32_t keep(std::uint32_t index, bool& added);
+
+    void update(std::uint32_t index, const math::float4x4& world_matrix);
+
+    /**
+     * @brief Releases the objects that were not kept and writes the slots that changed since the
+     * current frame resource was last written, coalesced into contiguous ranges.
+     */
+    void upload();
+
+    /**
+     * @brief Writes the objects of instances drawn in the current frame.
+     *
+     * @return Index of the first instance, see draw_constant_data.
+     */
+    std::size_t add_instances(std::span<const std::uint32_t> objects);
+
+    void next_frame();
+
+    pipeline_parameter_interface* parameter() const noexcept { return m_parameter->interface(); }
+
+    // Number of objects written by the last upload.
+    std::size_t upload_count() const noexcept { return m_upload_count; }
+
+private:
+    void mark_dirty(std::uint32_t index);
+
+    std::size_t m_object_capacity;
+    std::size_t m_instance_capacity;
+
+    std::size_t m_frame_resource;
+    std::size_t m_frame_resource_index;
+
+    // Frame each slot was last kept in, 0 for free slots.
+    std::vector<std::size_t> m_kept_frames;
+    std::vector<std::uint32_t> m_free_slots;
+    std::size_t m_frame;
+
+    std::vector<math::float4x4> m_objects;
+
+    // One bit per frame resource copy that misses the current data of the slot, and the slots to
+    // write for each copy.
+    std::vector<std::uint8_t> m_dirty_masks;
+    std::vector<std::vector<std::uint32_t>> m_dirty_slots;
+
+    std::size_t m_instance_count;
+    std::size_t m_upload_count;
+
+    std::unique_ptr<resource_interface> m_object_gpu_buffer;
+    std::unique_ptr<resource_interface> m_instance_gpu_buffer;
+    std::unique_ptr<object_pipeline_parameter> m_parameter;
+};
+} // namespace ash::graphics
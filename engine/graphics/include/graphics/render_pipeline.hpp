@@ -1,6 +1,7 @@
 #pragma once
 
 #include "graphics/light.hpp"
+#include <span>
 
 namespace ash::graphics
 {
@@ -16,6 +17,11 @@ struct render_unit
     pipeline_parameter_interface** parameters;
 
     scissor_extent scissor;
+
+    // Instances [instance_start, instance_start + instance_count) of the frame, counted from
+    // render_scene::instance_offset. Units that are not instanced have one.
+    std::size_t instance_start;
+    std::size_t instance_count;
 };
 
 struct render_scene
@@ -28,15 +34,39 @@ struct render_scene
     resource_interface* render_target_resolve;
     resource_interface* depth_stencil_buffer;
 
-    std::vector<render_unit> units;
+    // Object data of the frame, see object_pipeline_parameter.
+    pipeline_parameter_interface* object_parameter;
+    std::size_t instance_offset;
+
+    std::span<const render_unit> units;
+};
+
+enum render_order
+{
+    RENDER_ORDER_FRONT_TO_BACK,
+    RENDER_ORDER_BACK_TO_FRONT,
+
+    // Units are drawn in the order they were added, for UI.
+    RENDER_ORDER_SUBMISSION
 };
 
 class render_pipeline
 {
 public:
-    render_pipeline();
+    /**
+     * @param instancing The pipeline reads world matrices from the instance buffer, units that only
+     * differ in their first parameter, the object parameter, are drawn as instances of one unit.
+     */
+    render_pipeline(render_order order = RENDER_ORDER_FRONT_TO_BACK, bool instancing = false);
     virtual ~render_pipeline() = default;
 
     virtual void render(const render_scene& scene, render_command_interface* command) = 0;
+
+    render_order order() const noexcept { return m_order; }
+    bool instancing() const noexcept { return m_instancing; }
+
+private:
+    render_order m_order;
+    bool m_instancing;
 };
 } // namespace ash::graphics
\ No newline at end of file
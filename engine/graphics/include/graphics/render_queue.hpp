@@ -0,0 +1,131 @@
+#pragma once
+
+#include "graphics/render_pipeline.hpp"
+#include <algorithm>
+#include <span>
+#include <unordered_map>
+
+namespace ash::graphics
+{
+/**
+ * @brief Render units of a frame sorted by a 64 bit key. The key starts with the pipeline, the
+ * rest depends on the order of the pipeline:
+ *
+ * front to back: pipeline 8 | material 16 | depth 24 | vertex buffer 16
+ * back to front: pipeline 8 | depth 24 | material 16 | vertex buffer 16
+ * submission:    pipeline 8 | submission index 56
+ *
+ * Front to back pipelines with instancing sort by material 16 | vertex buffer 16 | range 8 |
+ * depth 16 instead, so that the copies of a submesh end up next to each other. The range is the
+ * first index of the unit, numbered in order of first use within its vertex buffer.
+ *
+ * Material and vertex buffer are ids given in order of first use within the frame. The material
+ * is the last parameter of the unit, see material. The storage is kept from frame to frame.
+ */
+class render_queue
+{
+public:
+    render_queue();
+
+    void clear();
+
+    /**
+     * @param depth Any value that grows with the distance to the camera, must not be negative.
+     */
+    void add(
+        render_pipeline* pipeline,
+        const render_unit& unit,
+        std::size_t parameter_count,
+        float depth,
+        std::uint32_t object_index);
+
+    /**
+     * @brief Sorts the units with a radix sort and merges consecutive units that draw adjacent
+     * index ranges with the same state into one. Then consecutive units of instancing pipelines
+     * that only differ in their object become instances of the first one.
+     */
+    void sort();
+
+    /**
+     * @brief Calls functor(pipeline, units) for each pipeline in key order.
+     */
+    template <typename T>
+    void each(T&& functor) const
+    {
+        for (const batch& batch : m_batches)
+        {
+            functor(
+                batch.pipeline,
+                std::span<const render_unit>(m_sorted_units.data() + batch.begin, batch.count));
+        }
+    }
+
+    /**
+     * @brief Calls functor(pipeline, units) for the part of each pipeline that falls in the sorted
+     * units [begin, end), so that the queue can be recorded in slices.
+     */
+    template <typename T>
+    void each(std::size_t begin, std::size_t end, T&& functor) const
+    {
+        for (const batch& batch : m_batches)
+        {
+            std::size_t batch_begin = std::max(begin, batch.begin);
+            std::size_t batch_end = std::min(end, batch.begin + batch.count);
+            if (batch_begin < batch_end)
+            {
+                functor(
+                    batch.pipeline,
+                    std::span<const render_unit>(
+                        m_sorted_units.data() + batch_begin,
+                        batch_end - batch_begin));
+            }
+        }
+    }
+
+    std::size_t size() const noexcept { return m_units.size(); }
+
+    // Number of units after sort merged them.
+    std::size_t sorted_size() const noexcept { return m_sorted_units.size(); }
+
+    // Objects of the sorted units, see render_unit::instance_start.
+    std::span<const std::uint32_t> instances() const noexcept { return m_instances; }
+
+private:
+    struct sort_item
+    {
+        std::uint64_t key;
+        std::uint32_t index;
+    };
+
+    struct batch
+    {
+        render_pipeline* pipeline;
+        std::size_t begin;
+        std::size_t count;
+    };
+
+    std::uint32_t id(std::unordered_map<const void*, std::uint32_t>& ids, const void* key);
+    std::uint32_t range_id(std::uint64_t vertex_buffer_id, std::size_t index_start);
+
+    std::vector<render_unit> m_units;
+    std::vector<render_pipeline*> m_unit_pipelines;
+    std::vector<std::size_t> m_unit_parameter_counts;
+    std::vector<std::uint32_t> m_unit_objects;
+
+    std::vector<sort_item> m_items;
+    std::vector<sort_item> m_swap_items;
+
+    std::vector<render_unit> m_sorted_units;
+    std::vector<std::size_t> m_sorted_parameter_counts;
+    std::vector<std::uint32_t> m_sorted_objects;
+    std::vector<batch> m_batches;
+
+    std::vector<std::uint32_t> m_instances;
+
+    std::unordered_map<const void*, std::uint32_t> m_pipeline_ids;
+    std::unordered_map<const void*, std::uint32_t> m_material_ids;
+    std::unordered_map<const void*, std::uint32_t> m_vertex_buffer_ids;
+    std::unordered_map<std::uint64_t, std::uint32_t> m_range_ids;
+    std::vector<std::uint32_t> m_range_counts;
+};
+} // namespace ash::graphics
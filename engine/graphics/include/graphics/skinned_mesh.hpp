@@ -1,5 +1,6 @@
 #pragma once
 
+#include "cpu_skin.hpp"
 #include "pipeline_parameter.hpp"
 #include <memory>
 #include <vector>
@@ -7,13 +8,24 @@
 namespace ash::graphics
 {
 class skin_pipeline;
+
+enum skin_policy
+{
+    SKIN_POLICY_GPU, // Dispatched by pipeline with parameter.
+    SKIN_POLICY_CPU  // Skinned by cpu on the task workers, the outputs are dynamic frame resources.
+};
+
 struct skinned_mesh
 {
     std::vector<std::unique_ptr<resource_interface>> skinned_vertex_buffers;
 
+    skin_policy policy{SKIN_POLICY_GPU};
+
     skin_pipeline* pipeline;
     std::unique_ptr<pipeline_parameter> parameter;
 
+    std::unique_ptr<cpu_skin> cpu;
+
     std::size_t vertex_count;
 };
 } // namespace ash::graphics
\ No newline at end of file
@@ -50,6 +50,14 @@ public:
 
     virtual void* pointer() { return nullptr; }
     virtual void upload(const void* data, std::size_t size, std::size_t offset = 0) {}
+
+    /**
+     * @brief Returns a pointer to write size bytes at offset of a dynamic buffer in place. Dynamic
+     * buffers that are frame resources take new memory in the first call of each frame, so a frame
+     * that writes such a buffer must write every part of it that is drawn. Frames that do not write
+     * it draw what was written last.
+     */
+    virtual void* map(std::size_t size, std::size_t offset = 0) { return nullptr; }
 };
 
 enum vertex_attribute_type
@@ -79,7 +87,11 @@ enum pipeline_parameter_type
 {
     PIPELINE_PARAMETER_TYPE_CONSTANT_BUFFER,
     PIPELINE_PARAMETER_TYPE_SHADER_RESOURCE,
-    PIPELINE_PARAMETER_TYPE_UNORDERED_ACCESS
+    PIPELINE_PARAMETER_TYPE_UNORDERED_ACCESS,
+
+    // 32 bit values written into the command with render_command_interface::constant, a layout
+    // with constants must not have other parameters.
+    PIPELINE_PARAMETER_TYPE_CONSTANT
 };
 
 struct pipeline_parameter_pair
@@ -92,6 +104,9 @@ struct pipeline_parameter_layout_desc
 {
     pipeline_parameter_pair parameters[16];
     std::size_t parameter_count;
+
+    // Name the layout is registered with, only valid during make_pipeline_parameter_layout.
+    const char* name;
 };
 
 class pipeline_parameter_layout_interface
@@ -313,6 +328,7 @@ public:
     virtual void scissor(const scissor_extent* extents, std::size_t size) = 0;
 
     virtual void parameter(std::size_t i, pipeline_parameter_interface*) = 0;
+    virtual void constant(std::size_t i, const void* data, std::size_t size) = 0;
 
     virtual void input_assembly_state(
         resource_interface* const* vertex_buffers,
@@ -324,6 +340,12 @@ public:
         std::size_t index_start,
         std::size_t index_end,
         std::size_t vertex_base) = 0;
+    virtual void draw_indexed_instanced(
+        std::size_t index_start,
+        std::size_t index_end,
+        std::size_t vertex_base,
+        std::size_t instance_start,
+        std::size_t instance_count) = 0;
 
     virtual void clear_render_target(
         resource_interface* render_target,
@@ -337,6 +359,23 @@ public:
     virtual void compute_parameter(std::size_t index, pipeline_parameter_interface* parameter) {}
 };
 
+struct render_statistics
+{
+    std::size_t command_count;
+    std::size_t draw_count;
+    std::size_t instance_count;
+
+    // Pipeline, pass, scissor and input assembly changes.
+    std::size_t state_change_count;
+    std::size_t parameter_bind_count;
+
+    // Bytes written to resources and pipeline parameters.
+    std::size_t upload_size;
+
+    // Invalid command streams found by a validating backend.
+    std::size_t error_count;
+};
+
 class renderer_interface
 {
 public:
@@ -344,6 +383,9 @@ public:
 
     virtual void present() = 0;
 
+    // Counters of the last presented frame. Backends that do not count return zeros.
+    virtual render_statistics statistics() const { return {}; }
+
     virtual render_command_interface* allocate_command() = 0;
     virtual void execute(render_command_interface* command) = 0;
 
@@ -366,6 +408,9 @@ struct vertex_buffer_desc
     std::size_t vertex_count;
     vertex_buffer_flags flags;
     bool dynamic;
+
+    // The GPU reads a separate copy each frame, so a dynamic buffer can be written while earlier
+    // frames still draw it. See resource_interface::map for what a frame must write.
     bool frame_resource;
 };
 
@@ -375,6 +420,8 @@ struct index_buffer_desc
     std::size_t index_size;
     std::size_t index_count;
     bool dynamic;
+
+    // See vertex_buffer_desc::frame_resource.
     bool frame_resource;
 };
 
@@ -1,4 +1,5 @@
 #include "graphics/blinn_phong_pipeline.hpp"
+#include "graphics/object_buffer.hpp"
 #include "graphics/rhi.hpp"
 
 namespace ash::graphics
@@ -30,7 +31,7 @@ std::vector<pipeline_parameter_pair> blinn_phong_material_pipeline_parameter::la
     };
 }
 
-blinn_phong_pipeline::blinn_phong_pipeline()
+blinn_phong_pipeline::blinn_phong_pipeline() : render_pipeline(RENDER_ORDER_FRONT_TO_BACK, true)
 {
     // Color pass.
     render_pass_info color_pass_info = {};
@@ -46,8 +47,8 @@ blinn_phong_pipeline::blinn_phong_pipeline()
         {ATTACHMENT_REFERENCE_TYPE_RESOLVE, 0}
     };
     color_pass_info.primitive_topology = PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
-    color_pass_info
-        .parameters = {"ash_object", "ash_blinn_phong_material", "ash_camera", "ash_light"};
+    color_pass_info.parameters =
+        {"ash_object", "ash_draw", "ash_blinn_phong_material", "ash_camera", "ash_light"};
     color_pass_info.samples = 4;
 
     // Attachment.
@@ -107,15 +108,34 @@ void blinn_phong_pipeline::render(const render_scene& scene, render_command_inte
     extent.max_y = height;
     command->scissor(&extent, 1);
 
-    command->parameter(2, scene.camera_parameter);
-    command->parameter(3, scene.light_parameter);
+    command->parameter(0, scene.object_parameter);
+    command->parameter(3, scene.camera_parameter);
+    command->parameter(4, scene.light_parameter);
+
+    // Units come sorted by material, only bind what changes. The only per draw state is the index
+    // of the first instance, shaders add the instance id to it.
+    const render_unit* last = nullptr;
     for (auto& unit : scene.units)
     {
-        command->parameter(0, unit.parameters[0]);
-        command->parameter(1, unit.parameters[1]);
-
-        command->input_assembly_state(unit.vertex_buffers, 2, unit.index_buffer);
-        command->draw_indexed(unit.index_start, unit.index_end, unit.vertex_base);
+        if (last == nullptr || last->parameters[0] != unit.parameters[0])
+            command->parameter(2, unit.parameters[0]);
+
+        if (last == nullptr || last->vertex_buffers != unit.vertex_buffers ||
+            last->index_buffer != unit.index_buffer)
+            command->input_assembly_state(unit.vertex_buffers, 2, unit.index_buffer);
+
+        draw_constant_data draw = {};
+        draw.instance_index =
+            static_cast<std::uint32_t>(scene.instance_offset + unit.instance_start);
+        command->constant(1, &draw, sizeof(draw_constant_data));
+
+        command->draw_indexed_instanced(
+            unit.index_start,
+            unit.index_end,
+            unit.vertex_base,
+            0,
+            unit.instance_count);
+        last = &unit;
     }
 
     command->end(m_interface.get());
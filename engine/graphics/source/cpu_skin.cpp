@@ -0,0 +1,207 @@
+#include "graphics/cpu_skin.hpp"
+#include "assert.hpp"
+#include "math/batch.hpp"
+#include <algorithm>
+#include <numeric>
+
+namespace ash::graphics
+{
+namespace
+{
+std::size_t influence_count(skin_type type)
+{
+    switch (type)
+    {
+    case SKIN_TYPE_BDEF1:
+        return 1;
+    case SKIN_TYPE_BDEF4:
+        return 4;
+    default:
+        return 2;
+    }
+}
+} // namespace
+
+cpu_skin::cpu_skin(const cpu_skin_info& info)
+    : m_uv(info.uv.begin(), info.uv.end()),
+      m_spherical(false),
+      m_position_offset(nullptr),
+      m_uv_offset(nullptr),
+      m_position_slot(info.position_slot),
+      m_normal_slot(info.normal_slot),
+      m_uv_slot(info.uv_slot)
+{
+    ASH_ASSERT(info.position.size() == info.skin.size());
+    ASH_ASSERT(info.normal.size() == info.skin.size());
+    ASH_ASSERT(info.uv.empty() || info.uv.size() == info.skin.size());
+
+    // Each block runs a single kernel, so vertices of the same type are grouped. The sort is
+    // stable to keep the writes of a block close together.
+    std::vector<std::uint32_t> order(info.skin.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) {
+        return info.skin[a].type < info.skin[b].type;
+    });
+
+    for (std::size_t begin = 0; begin < order.size();)
+    {
+        skin_type type = info.skin[order[begin]].type;
+        std::size_t end = begin + 1;
+        while (end < order.size() && end - begin < BLOCK_SIZE && info.skin[order[end]].type == type)
+            ++end;
+
+        add_block(info, std::span<const std::uint32_t>(order.data() + begin, end - begin));
+        begin = end;
+    }
+}
+
+void cpu_skin::bones(std::span<const math::float4x4> bones)
+{
+    m_bones.assign(bones.begin(), bones.end());
+
+    if (!m_spherical)
+        return;
+
+    m_rotations.resize(m_bones.size());
+    for (std::size_t i = 0; i < m_bones.size(); ++i)
+    {
+        math::float4_simd q = math::quaternion_simd::rotation_matrix(math::simd::load(m_bones[i]));
+        math::simd::store(q, m_rotations[i]);
+    }
+}
+
+void cpu_skin::skin(
+    std::size_t index,
+    math::float3* position,
+    math::float3* normal,
+    math::float2* uv) const
+{
+    ASH_ASSERT(!m_bones.empty(), "Bones must be set before skinning.");
+
+    const block& block = m_blocks[index];
+    const std::uint32_t* vertices = m_vertices.data() + block.vertex;
+    const float* data = m_data.data();
+    std::size_t count = block.count;
+
+    // Offsets change every frame, they are added to a copy of the bind pose.
+    float morph_position[3 * BLOCK_SIZE];
+    const float* input_position = data + block.position;
+    if (m_position_offset != nullptr)
+    {
+        for (std::size_t c = 0; c < 3; ++c)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                morph_position[c * count + i] =
+                    input_position[c * count + i] + m_position_offset[vertices[i]][c];
+            }
+        }
+        input_position = morph_position;
+    }
+
+    float result_position[3 * BLOCK_SIZE];
+    float result_normal[3 * BLOCK_SIZE];
+    if (block.type == SKIN_TYPE_SDEF)
+    {
+        math::skin_batch::spherical_deform(
+            input_position,
+            data + block.normal,
+            data + block.index,
+            data + block.weight,
+            data + block.center,
+            data + block.r0,
+            data + block.r1,
+            m_bones.data(),
+            m_rotations.data(),
+            result_position,
+            result_normal,
+            count);
+    }
+    else
+    {
+        math::skin_batch::linear_blend(
+            input_position,
+            data + block.normal,
+            data + block.index,
+            data + block.weight,
+            influence_count(block.type),
+            m_bones.data(),
+            result_position,
+            result_normal,
+            count);
+    }
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        std::uint32_t vertex = vertices[i];
+        position[vertex] = {
+            result_position[i],
+            result_position[count + i],
+            result_position[count * 2 + i]};
+        normal[vertex] = {result_normal[i], result_normal[count + i], result_normal[count * 2 + i]};
+    }
+
+    if (uv == nullptr || m_uv.empty())
+        return;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        std::uint32_t vertex = vertices[i];
+        uv[vertex] = m_uv[vertex];
+        if (m_uv_offset != nullptr)
+        {
+            uv[vertex][0] += m_uv_offset[vertex][0];
+            uv[vertex][1] += m_uv_offset[vertex][1];
+        }
+    }
+}
+
+void cpu_skin::add_block(const cpu_skin_info& info, std::span<const std::uint32_t> vertices)
+{
+    block block = {};
+    block.type = info.skin[vertices[0]].type;
+    block.count = vertices.size();
+    block.vertex = m_vertices.size();
+    m_vertices.insert(m_vertices.end(), vertices.begin(), vertices.end());
+
+    // Appends a stream with components values per vertex and returns its offset.
+    auto stream = [&](std::size_t components, auto&& value) {
+        std::size_t offset = m_data.size();
+        m_data.resize(offset + components * block.count);
+        for (std::size_t c = 0; c < components; ++c)
+        {
+            for (std::size_t i = 0; i < block.count; ++i)
+                m_data[offset + c * block.count + i] = value(vertices[i], c);
+        }
+        return offset;
+    };
+
+    block.position = stream(3, [&](std::uint32_t v, std::size_t c) { return info.position[v][c]; });
+    block.normal = stream(3, [&](std::uint32_t v, std::size_t c) { return info.normal[v][c]; });
+
+    // Bone indices are stored as floats like every other stream, they are exact up to 2^24.
+    std::size_t influences = influence_count(block.type);
+    block.index = stream(influences, [&](std::uint32_t v, std::size_t c) {
+        return static_cast<float>(info.skin[v].index[c]);
+    });
+
+    if (block.type == SKIN_TYPE_SDEF)
+    {
+        block.weight =
+            stream(1, [&](std::uint32_t v, std::size_t) { return info.skin[v].weight[0]; });
+        block.center =
+            stream(3, [&](std::uint32_t v, std::size_t c) { return info.skin[v].center[c]; });
+        block.r0 = stream(3, [&](std::uint32_t v, std::size_t c) { return info.skin[v].r0[c]; });
+        block.r1 = stream(3, [&](std::uint32_t v, std::size_t c) { return info.skin[v].r1[c]; });
+        m_spherical = true;
+    }
+    else
+    {
+        block.weight = stream(influences, [&](std::uint32_t v, std::size_t c) {
+            return info.skin[v].weight[c];
+        });
+    }
+
+    m_blocks.push_back(block);
+}
+} // namespace ash::graphics
\ No newline at end of file
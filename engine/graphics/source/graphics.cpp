@@ -1,5 +1,6 @@
 #include "graphics/graphics.hpp"
 #include "core/context.hpp"
+#include "core/timer.hpp"
 #include "graphics/blinn_phong_pipeline.hpp"
 #include "graphics/camera.hpp"
 #include "graphics/graphics_event.hpp"
@@ -18,28 +19,57 @@ using namespace ash::math;
 
 namespace ash::graphics
 {
+namespace
+{
+// Visible entities gathered by one job.
+constexpr std::size_t GATHER_GRAIN = 256;
+
+// A command is only worth recording separately with at least this many units.
+constexpr std::size_t RECORD_GRAIN = 256;
+
+constexpr std::size_t MAX_OBJECT_COUNT = 16384;
+
+// Instances drawn by all cameras in a frame.
+constexpr std::size_t MAX_INSTANCE_COUNT = 16384;
+} // namespace
+
 graphics::graphics() noexcept
     : system_base("graphics"),
       m_back_buffer_index(0),
       m_game_camera(ecs::INVALID_ENTITY),
-      m_editor_camera(ecs::INVALID_ENTITY)
+      m_editor_camera(ecs::INVALID_ENTITY),
+      m_render_concurrency(1),
+      m_command_count(0)
 {
 }
 
 bool graphics::initialize(const dictionary& config)
 {
-    auto& window = system<ash::window::window>();
+    // Backends without a device, like ash-graphics-null, render without a window. The back buffer
+    // then has the size given in the config.
+    bool headless = config["headless"];
 
     rhi_info info = {};
-    info.window_handle = window.handle();
-    window::window_extent extent = window.extent();
-    info.width = extent.width;
-    info.height = extent.height;
+    if (headless)
+    {
+        info.width = config["width"];
+        info.height = config["height"];
+    }
+    else
+    {
+        auto& window = system<ash::window::window>();
+        info.window_handle = window.handle();
+        window::window_extent extent = window.extent();
+        info.width = extent.width;
+        info.height = extent.height;
+    }
     info.render_concurrency = config["render_concurrency"];
+    m_render_concurrency = std::max(info.render_concurrency, std::size_t(1));
     info.frame_resource = config["frame_resource"];
     rhi::initialize(config["plugin"], info);
 
     rhi::register_pipeline_parameter_layout("ash_object", object_pipeline_parameter::layout());
+    rhi::register_pipeline_parameter_layout("ash_draw", draw_constant_data::layout());
     rhi::register_pipeline_parameter_layout("ash_camera", camera_pipeline_parameter::layout());
     rhi::register_pipeline_parameter_layout(
         "ash_blinn_phong_material",
@@ -60,6 +90,11 @@ bool graphics::initialize(const dictionary& config)
     m_sky_parameter->texture(m_sky_texture.get());
     m_sky_pipeline = std::make_unique<sky_pipeline>();
 
+    m_objects = std::make_unique<object_buffer>(
+        MAX_OBJECT_COUNT,
+        MAX_INSTANCE_COUNT,
+        std::max(info.frame_resource, std::size_t(1)));
+
     auto& world = system<ecs::world>();
     auto& event = system<core::event>();
 
@@ -69,17 +104,20 @@ bool graphics::initialize(const dictionary& config)
     world.register_component<directional_light>();
 
     event.register_event<event_render_extent_change>();
-    event.subscribe<window::event_window_resize>(
-        "graphics",
-        [&, this](std::uint32_t width, std::uint32_t height) {
-            rhi::renderer().resize(width, height);
-
-            // The event_render_extent_change event is emitted by the editor module in editor mode.
-            if (!is_editor_mode())
-                event.publish<event_render_extent_change>(width, height);
-        });
+    if (!headless)
+    {
+        event.subscribe<window::event_window_resize>(
+            [&, this](std::uint32_t width, std::uint32_t height) {
+                rhi::renderer().resize(width, height);
+
+                // The event_render_extent_change event is emitted by the editor module in editor
+                // mode.
+                if (!is_editor_mode())
+                    event.publish<event_render_extent_change>(width, height);
+            });
+    }
 
-    m_debug = std::make_unique<graphics_debug>(config["frame_resource"]);
+    m_debug = std::make_unique<graphics_debug>();
     m_debug->initialize();
 
     auto& task = system<task::task_manager>();
@@ -95,11 +133,12 @@ bool graphics::initialize(const dictionary& config)
 void graphics::shutdown()
 {
     m_debug = nullptr;
+    m_objects = nullptr;
 }
 
 void graphics::compute(compute_pipeline* pipeline)
 {
-    auto command = rhi::renderer().allocate_command();
+    auto command = allocate_command();
     pipeline->compute(command);
     rhi::renderer().execute(command);
 }
@@ -130,20 +169,60 @@ void graphics::skin_meshes()
 {
     auto& world = system<ecs::world>();
 
-    auto command = rhi::renderer().allocate_command();
-
+    // Outputs of CPU skinning are frame resources, they are mapped here and every block writes
+    // its own vertices on the workers.
+    m_cpu_skin_jobs.clear();
     std::set<skin_pipeline*> pipelines;
     world.view<mesh_render, skinned_mesh>().each(
         [&](mesh_render& mesh_render, skinned_mesh& skinned_mesh) {
-            auto pipeline = skinned_mesh.pipeline;
-            pipelines.insert(pipeline);
-            pipeline->add(skinned_mesh);
+            if (skinned_mesh.policy == SKIN_POLICY_GPU)
+            {
+                auto pipeline = skinned_mesh.pipeline;
+                pipelines.insert(pipeline);
+                pipeline->add(skinned_mesh);
+                return;
+            }
+
+            auto& cpu = *skinned_mesh.cpu;
+            auto& outputs = skinned_mesh.skinned_vertex_buffers;
+            std::size_t vertex_count = cpu.vertex_count();
+
+            cpu_skin_job job = {};
+            job.skin = &cpu;
+            job.position = static_cast<math::float3*>(
+                outputs[cpu.position_slot()]->map(vertex_count * sizeof(math::float3)));
+            job.normal = static_cast<math::float3*>(
+                outputs[cpu.normal_slot()]->map(vertex_count * sizeof(math::float3)));
+            if (cpu.has_uv())
+            {
+                job.uv = static_cast<math::float2*>(
+                    outputs[cpu.uv_slot()]->map(vertex_count * sizeof(math::float2)));
+            }
+
+            for (job.block = 0; job.block < cpu.block_count(); ++job.block)
+                m_cpu_skin_jobs.push_back(job);
         });
 
-    for (auto pipeline : pipelines)
+    system<task::task_manager>().parallel_for(
+        m_cpu_skin_jobs.size(),
+        1,
+        [this](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                auto& job = m_cpu_skin_jobs[i];
+                job.skin->skin(job.block, job.position, job.normal, job.uv);
+            }
+        });
+
+    if (!pipelines.empty())
     {
-        pipeline->skin(command);
-        pipeline->clear();
+        auto command = allocate_command();
+        for (auto pipeline : pipelines)
+        {
+            pipeline->skin(command);
+            pipeline->clear();
+        }
+        rhi::renderer().execute(command);
     }
 
     world.view<mesh_render, skinned_mesh>().each(
@@ -154,8 +233,6 @@ void graphics::skin_meshes()
                     mesh_render.vertex_buffers[i] = skinned_mesh.skinned_vertex_buffers[i].get();
             }
         });
-
-    rhi::renderer().execute(command);
 }
 
 void graphics::render()
@@ -173,11 +250,7 @@ void graphics::render()
     // Skin.
     skin_meshes();
 
-    // Update object data.
-    world.view<mesh_render, scene::transform>().each(
-        [&, this](mesh_render& mesh_render, scene::transform& transform) {
-            mesh_render.object_parameter->world_matrix(transform.to_world());
-        });
+    update_objects();
 
     // Render camera.
     while (!m_render_queue.empty())
@@ -187,6 +260,32 @@ void graphics::render()
     }
 }
 
+void graphics::update_objects()
+{
+    auto& world = system<ecs::world>();
+    float alpha = system<core::timer>().fixed_alpha();
+
+    // Only transforms that were synced, edited or interpolated this frame can have moved, the
+    // others skip the matrix entirely. A static scene uploads nothing.
+    world.view<mesh_render>().each([&](ecs::entity entity, mesh_render& mesh_render) {
+        bool added = false;
+        mesh_render.object_index = m_objects->keep(mesh_render.object_index, added);
+
+        if (!world.has_component<scene::transform>(entity))
+        {
+            if (added)
+                m_objects->update(mesh_render.object_index, math::matrix::identity());
+            return;
+        }
+
+        auto& transform = world.component<scene::transform>(entity);
+        if (added || transform.sync_count() != 0 || transform.dirty() || transform.interpolation())
+            m_objects->update(mesh_render.object_index, transform.to_world_interpolated(alpha));
+    });
+
+    m_objects->upload();
+}
+
 void graphics::render_camera(ecs::entity camera_entity)
 {
     auto& world = system<ecs::world>();
@@ -197,7 +296,7 @@ void graphics::render_camera(ecs::entity camera_entity)
 
     // Update camera data.
     auto& to_world = transform.to_world();
-    math::float4x4_simd transform_v = math::matrix_simd::inverse(math::simd::load(to_world));
+    math::float4x4_simd transform_v = math::matrix_simd::inverse_affine(math::simd::load(to_world));
     math::float4x4_simd transform_p = math::simd::load(render_camera.projection());
     math::float4x4_simd transform_vp = math::matrix_simd::mul(transform_v, transform_p);
 
@@ -250,7 +349,7 @@ void graphics::render_camera(ecs::entity camera_entity)
         ps[i] = math::vector_simd::div(ps[i], length);
         math::simd::store(ps[i], planes[i]);
     }
-    scene.frustum_culling(planes);
+    scene.frustum_culling(planes, view_projection);
 
     // Update light.
     world.view<directional_light, scene::transform>().each(
@@ -264,60 +363,161 @@ void graphics::render_camera(ecs::entity camera_entity)
     m_light_parameter->directional_light_count(1);
 
     // Render.
-    std::unordered_map<render_pipeline*, render_scene> render_scenes;
-    world.view<mesh_render>().each([&, this](mesh_render& mesh_render) {
+    math::float4_simd camera_position = math::simd::load(to_world[3]);
+
+    auto gather = [&](ecs::entity entity,
+                      mesh_render& mesh_render,
+                      std::vector<pending_render_unit>& pending) {
         if ((mesh_render.render_groups & render_camera.render_groups) == 0)
             return;
-        // if ((mesh_render.render_groups & RENDER_GROUP_UI) == 0 && !bounding_box.visible())
-        //     return;
+
+        float depth = 0.0f;
+        if (world.has_component<scene::transform>(entity))
+        {
+            math::float4_simd position =
+                math::simd::load(world.component<scene::transform>(entity).to_world()[3]);
+            depth = math::vector_simd::length_vec3(
+                math::vector_simd::sub(position, camera_position));
+        }
 
         for (std::size_t i = 0; i < mesh_render.materials.size(); ++i)
         {
-            auto& render_scene = render_scenes[mesh_render.materials[i].pipeline];
-            render_scene.units.emplace_back(render_unit{
+            auto& material = mesh_render.materials[i];
+            render_unit unit = {
                 .vertex_buffers = mesh_render.vertex_buffers.data(),
                 .index_buffer = mesh_render.index_buffer,
                 .index_start = mesh_render.submeshes[i].index_start,
                 .index_end = mesh_render.submeshes[i].index_end,
                 .vertex_base = mesh_render.submeshes[i].vertex_base,
-                .parameters = mesh_render.materials[i].parameters.data(),
-                .scissor = mesh_render.materials[i].scissor});
+                .parameters = material.parameters.data(),
+                .scissor = material.scissor};
+            pending.push_back({
+                material.pipeline,
+                unit,
+                material.parameters.size(),
+                depth,
+                mesh_render.object_index});
         }
-    });
+    };
 
-    auto command = rhi::renderer().allocate_command();
-    command->clear_render_target(render_camera.render_target(), {0.0f, 0.0f, 0.0f, 1.0f});
-    command->clear_depth_stencil(render_camera.depth_stencil_buffer());
+    // Meshes with a bounding box are only drawn when the culling found them visible, they are
+    // gathered in chunks on the workers. The others, like UI and debug geometry, are always drawn
+    // and go in the last list.
+    auto& task = system<task::task_manager>();
+    const auto& visible_entities = scene.visible_entities();
+    std::size_t chunk_count = (visible_entities.size() + GATHER_GRAIN - 1) / GATHER_GRAIN;
+
+    m_pending_units.resize(chunk_count + 1);
+    for (auto& pending : m_pending_units)
+        pending.clear();
+
+    task.parallel_for(
+        visible_entities.size(),
+        GATHER_GRAIN,
+        [&](std::size_t begin, std::size_t end) {
+            auto& pending = m_pending_units[begin / GATHER_GRAIN];
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                ecs::entity entity = visible_entities[i];
+                if (world.has_component<mesh_render>(entity))
+                    gather(entity, world.component<mesh_render>(entity), pending);
+            }
+        });
 
-    for (auto& [pipeline, render_scene] : render_scenes)
-    {
-        render_scene.camera_parameter = render_camera.pipeline_parameter()->interface();
-        render_scene.light_parameter = m_light_parameter->interface();
-        render_scene.render_target = render_camera.render_target();
-        render_scene.render_target_resolve = render_camera.render_target_resolve();
-        render_scene.depth_stencil_buffer = render_camera.depth_stencil_buffer();
-        pipeline->render(render_scene, command);
-    }
+    world.view<mesh_render>().each([&](ecs::entity entity, mesh_render& mesh_render) {
+        if (!world.has_component<scene::bounding_box>(entity))
+            gather(entity, mesh_render, m_pending_units.back());
+    });
 
-    if (camera_entity != m_editor_camera)
+    m_draw_queue.clear();
+    for (auto& pending : m_pending_units)
     {
-        // Render sky.
-        render_scene sky_scene;
-        sky_scene.camera_parameter = render_camera.pipeline_parameter()->interface();
-        sky_scene.light_parameter = m_light_parameter->interface();
-        sky_scene.sky_parameter = m_sky_parameter->interface();
-        sky_scene.render_target = render_camera.render_target();
-        sky_scene.render_target_resolve = render_camera.render_target_resolve();
-        sky_scene.depth_stencil_buffer = render_camera.depth_stencil_buffer();
-        m_sky_pipeline->render(sky_scene, command);
+        for (auto& unit : pending)
+        {
+            m_draw_queue.add(
+                unit.pipeline,
+                unit.unit,
+                unit.parameter_count,
+                unit.depth,
+                unit.object_index);
+        }
     }
+    m_draw_queue.sort();
 
-    rhi::renderer().execute(command);
+    std::size_t instance_offset = m_objects->add_instances(m_draw_queue.instances());
+
+    // Record slices of the queue into separate commands. The commands are allocated here, in the
+    // order they execute, and every camera still in the queue keeps at least one.
+    std::size_t unit_count = m_draw_queue.sorted_size();
+    std::size_t reserved = m_command_count + m_render_queue.size() - 1;
+    std::size_t available = m_render_concurrency > reserved ? m_render_concurrency - reserved : 1;
+    std::size_t command_count = std::clamp(unit_count / RECORD_GRAIN, std::size_t(1), available);
+
+    std::vector<render_command_interface*> commands(command_count);
+    for (auto& command : commands)
+        command = allocate_command();
+
+    auto record = [&](std::size_t index) {
+        render_command_interface* command = commands[index];
+        if (index == 0)
+        {
+            command->clear_render_target(render_camera.render_target(), {0.0f, 0.0f, 0.0f, 1.0f});
+            command->clear_depth_stencil(render_camera.depth_stencil_buffer());
+        }
+
+        std::size_t begin = unit_count * index / command_count;
+        std::size_t end = unit_count * (index + 1) / command_count;
+        m_draw_queue.each(
+            begin,
+            end,
+            [&](render_pipeline* pipeline, std::span<const render_unit> units) {
+                render_scene render_scene = {};
+                render_scene.camera_parameter = render_camera.pipeline_parameter()->interface();
+                render_scene.light_parameter = m_light_parameter->interface();
+                render_scene.render_target = render_camera.render_target();
+                render_scene.render_target_resolve = render_camera.render_target_resolve();
+                render_scene.depth_stencil_buffer = render_camera.depth_stencil_buffer();
+                render_scene.units = units;
+                render_scene.object_parameter = m_objects->parameter();
+                render_scene.instance_offset = instance_offset;
+                pipeline->render(render_scene, command);
+            });
+
+        if (index == command_count - 1 && camera_entity != m_editor_camera)
+        {
+            // Render sky.
+            render_scene sky_scene = {};
+            sky_scene.camera_parameter = render_camera.pipeline_parameter()->interface();
+            sky_scene.light_parameter = m_light_parameter->interface();
+            sky_scene.sky_parameter = m_sky_parameter->interface();
+            sky_scene.render_target = render_camera.render_target();
+            sky_scene.render_target_resolve = render_camera.render_target_resolve();
+            sky_scene.depth_stencil_buffer = render_camera.depth_stencil_buffer();
+            m_sky_pipeline->render(sky_scene, command);
+        }
+    };
+
+    task.parallel_for(command_count, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i)
+            record(i);
+    });
+
+    for (auto command : commands)
+        rhi::renderer().execute(command);
 }
 
 void graphics::present()
 {
     rhi::renderer().present();
     m_debug->next_frame();
+
+    m_command_count = 0;
+    m_objects->next_frame();
+}
+
+render_command_interface* graphics::allocate_command()
+{
+    ++m_command_count;
+    return rhi::renderer().allocate_command();
 }
 } // namespace ash::graphics
\ No newline at end of file
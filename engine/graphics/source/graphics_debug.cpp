@@ -103,9 +103,7 @@ void debug_pipeline::render(const render_scene& scene, render_command_interface*
     command->end(m_interface.get());
 }
 
-graphics_debug::graphics_debug(std::size_t frame_resource)
-    : m_vertex_buffers(2),
-      m_frame_resource(frame_resource)
+graphics_debug::graphics_debug() : m_vertex_buffers(2)
 {
 }
 
@@ -115,12 +113,12 @@ void graphics_debug::initialize()
 
     m_vertex_buffers[0] = rhi::make_vertex_buffer<math::float3>(
         nullptr,
-        MAX_VERTEX_COUNT * m_frame_resource,
+        MAX_VERTEX_COUNT,
         VERTEX_BUFFER_FLAG_NONE,
         true);
     m_vertex_buffers[1] = rhi::make_vertex_buffer<math::float3>(
         nullptr,
-        MAX_VERTEX_COUNT * m_frame_resource,
+        MAX_VERTEX_COUNT,
         VERTEX_BUFFER_FLAG_NONE,
         true);
 
@@ -161,11 +159,11 @@ void graphics_debug::sync()
     m_vertex_buffers[0]->upload(
         m_vertex_position.data(),
         sizeof(math::float3) * m_vertex_position.size(),
-        sizeof(math::float3) * v.submeshes[0].vertex_base);
+        0);
     m_vertex_buffers[1]->upload(
         m_vertex_color.data(),
         sizeof(math::float3) * m_vertex_color.size(),
-        sizeof(math::float3) * v.submeshes[0].vertex_base);
+        0);
 
     v.submeshes[0].index_start = 0;
     v.submeshes[0].index_end = m_vertex_position.size();
@@ -175,12 +173,6 @@ void graphics_debug::next_frame()
 {
     m_vertex_position.clear();
     m_vertex_color.clear();
-
-    auto& world = system<ecs::world>();
-    auto& v = world.component<mesh_render>(m_entity);
-
-    v.submeshes[0].vertex_base += MAX_VERTEX_COUNT;
-    v.submeshes[0].vertex_base %= MAX_VERTEX_COUNT * m_frame_resource;
 }
 
 void graphics_debug::draw_line(
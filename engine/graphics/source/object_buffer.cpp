@@ -0,0 +1,178 @@
+#include "graphics/object_buffer.hpp"
+#include "assert.hpp"
+#include "graphics/rhi.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace ash::graphics
+{
+object_pipeline_parameter::object_pipeline_parameter() : pipeline_parameter("ash_object")
+{
+}
+
+void object_pipeline_parameter::objects(resource_interface* objects, resource_interface* instances)
+{
+    interface()->set(0, objects);
+    interface()->set(1, instances);
+}
+
+std::vector<pipeline_parameter_pair> object_pipeline_parameter::layout()
+{
+    return {
+        {PIPELINE_PARAMETER_TYPE_SHADER_RESOURCE, 1}, // ash_objects
+        {PIPELINE_PARAMETER_TYPE_SHADER_RESOURCE, 1}  // ash_instances
+    };
+}
+
+std::vector<pipeline_parameter_pair> draw_constant_data::layout()
+{
+    return {
+        {PIPELINE_PARAMETER_TYPE_CONSTANT, sizeof(draw_constant_data)}
+    };
+}
+
+object_buffer::object_buffer(
+    std::size_t object_capacity,
+    std::size_t instance_capacity,
+    std::size_t frame_resource)
+    : m_object_capacity(object_capacity),
+      m_instance_capacity(instance_capacity),
+      m_frame_resource(frame_resource),
+      m_frame_resource_index(0),
+      m_frame(1),
+      m_dirty_slots(frame_resource),
+      m_instance_count(0),
+      m_upload_count(0)
+{
+    ASH_ASSERT(frame_resource != 0 && frame_resource <= 8);
+
+    // The copies of the frame resources follow each other, the GPU buffers are not frame resources
+    // themselves so that their contents persist.
+    m_object_gpu_buffer = rhi::make_vertex_buffer<math::float4x4>(
+        nullptr,
+        m_object_capacity * m_frame_resource,
+        VERTEX_BUFFER_FLAG_COMPUTE_IN,
+        true);
+    m_instance_gpu_buffer = rhi::make_vertex_buffer<std::uint32_t>(
+        nullptr,
+        m_instance_capacity * m_frame_resource,
+        VERTEX_BUFFER_FLAG_COMPUTE_IN,
+        true);
+
+    m_parameter = std::make_unique<object_pipeline_parameter>();
+    m_parameter->objects(m_object_gpu_buffer.get(), m_instance_gpu_buffer.get());
+}
+
+std::uint32_t object_buffer::keep(std::uint32_t index, bool& added)
+{
+    added = index >= m_kept_frames.size() || m_kept_frames[index] == 0 ||
+            m_kept_frames[index] == m_frame;
+
+    if (added)
+    {
+        if (!m_free_slots.empty())
+        {
+            index = m_free_slots.back();
+            m_free_slots.pop_back();
+        }
+        else
+        {
+            ASH_ASSERT(m_kept_frames.size() < m_object_capacity, "Too many objects.");
+
+            index = static_cast<std::uint32_t>(m_kept_frames.size());
+            m_kept_frames.push_back(0);
+            m_objects.push_back(math::matrix::identity());
+            m_dirty_masks.push_back(0);
+        }
+
+        mark_dirty(index);
+    }
+
+    m_kept_frames[index] = m_frame;
+    return index;
+}
+
+void object_buffer::update(std::uint32_t index, const math::float4x4& world_matrix)
+{
+    if (std::memcmp(&m_objects[index], &world_matrix, sizeof(math::float4x4)) == 0)
+        return;
+
+    m_objects[index] = world_matrix;
+    mark_dirty(index);
+}
+
+void object_buffer::upload()
+{
+    for (std::uint32_t i = 0; i < m_kept_frames.size(); ++i)
+    {
+        if (m_kept_frames[i] != 0 && m_kept_frames[i] != m_frame)
+        {
+            m_kept_frames[i] = 0;
+            m_free_slots.push_back(i);
+        }
+    }
+
+    auto& dirty_slots = m_dirty_slots[m_frame_resource_index];
+    std::sort(dirty_slots.begin(), dirty_slots.end());
+
+    std::uint8_t frame_resource_bit = static_cast<std::uint8_t>(1 << m_frame_resource_index);
+    std::size_t base = m_frame_resource_index * m_object_capacity;
+
+    m_upload_count = 0;
+    for (std::size_t i = 0; i < dirty_slots.size();)
+    {
+        std::size_t begin = dirty_slots[i];
+        std::size_t end = begin;
+        for (; i < dirty_slots.size() && dirty_slots[i] == end; ++i, ++end)
+            m_dirty_masks[end] &= ~frame_resource_bit;
+
+        void* target = m_object_gpu_buffer->map(
+            (end - begin) * sizeof(math::float4x4),
+            (base + begin) * sizeof(math::float4x4));
+        std::copy(
+            m_objects.begin() + begin,
+            m_objects.begin() + end,
+            static_cast<math::float4x4*>(target));
+
+        m_upload_count += end - begin;
+    }
+    dirty_slots.clear();
+}
+
+std::size_t object_buffer::add_instances(std::span<const std::uint32_t> objects)
+{
+    ASH_ASSERT(m_instance_count + objects.size() <= m_instance_capacity, "Too many instances.");
+
+    std::size_t first = m_frame_resource_index * m_instance_capacity + m_instance_count;
+    m_instance_count += objects.size();
+    if (objects.empty())
+        return first;
+
+    // Instances point into the object copy of the same frame resource.
+    std::uint32_t base = static_cast<std::uint32_t>(m_frame_resource_index * m_object_capacity);
+    auto target = static_cast<std::uint32_t*>(m_instance_gpu_buffer->map(
+        objects.size_bytes(),
+        first * sizeof(std::uint32_t)));
+    for (std::uint32_t object : objects)
+        *target++ = base + object;
+
+    return first;
+}
+
+void object_buffer::next_frame()
+{
+    m_frame_resource_index = (m_frame_resource_index + 1) % m_frame_resource;
+    m_instance_count = 0;
+    ++m_frame;
+}
+
+void object_buffer::mark_dirty(std::uint32_t index)
+{
+    for (std::size_t i = 0; i < m_frame_resource; ++i)
+    {
+        if ((m_dirty_masks[index] & (1 << i)) == 0)
+            m_dirty_slots[i].push_back(index);
+    }
+    m_dirty_masks[index] = static_cast<std::uint8_t>((1 << m_frame_resource) - 1);
+}
+} // namespace ash::graphics
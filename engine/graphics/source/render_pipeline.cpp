@@ -2,7 +2,9 @@
 
 namespace ash::graphics
 {
-render_pipeline::render_pipeline()
+render_pipeline::render_pipeline(render_order order, bool instancing)
+    : m_order(order),
+      m_instancing(instancing)
 {
 }
 } // namespace ash::graphics
\ No newline at end of file
@@ -0,0 +1,249 @@
+#include "graphics/render_queue.hpp"
+#include "assert.hpp"
+#include <algorithm>
+#include <bit>
+
+namespace ash::graphics
+{
+namespace
+{
+constexpr std::uint64_t MAX_PIPELINE_COUNT = 1 << 8;
+constexpr std::uint64_t MAX_MATERIAL_COUNT = 1 << 16;
+constexpr std::uint64_t MAX_VERTEX_BUFFER_COUNT = 1 << 16;
+constexpr std::uint32_t MAX_RANGE_COUNT = 1 << 8;
+
+std::uint64_t depth_bits(float depth)
+{
+    // Non negative floats order like their bits, the top 24 bits are enough.
+    return std::bit_cast<std::uint32_t>(std::max(depth, 0.0f)) >> 7;
+}
+
+bool same_state(const render_unit& a, const render_unit& b, std::size_t parameter_count)
+{
+    if (a.vertex_buffers != b.vertex_buffers || a.index_buffer != b.index_buffer ||
+        a.vertex_base != b.vertex_base)
+        return false;
+
+    if (a.scissor.min_x != b.scissor.min_x || a.scissor.min_y != b.scissor.min_y ||
+        a.scissor.max_x != b.scissor.max_x || a.scissor.max_y != b.scissor.max_y)
+        return false;
+
+    return std::equal(a.parameters, a.parameters + parameter_count, b.parameters);
+}
+
+bool same_instance(const render_unit& a, const render_unit& b, std::size_t parameter_count)
+{
+    if (a.index_start != b.index_start || a.index_end != b.index_end)
+        return false;
+
+    return same_state(a, b, parameter_count);
+}
+} // namespace
+
+render_queue::render_queue()
+{
+}
+
+void render_queue::clear()
+{
+    m_units.clear();
+    m_unit_pipelines.clear();
+    m_unit_parameter_counts.clear();
+    m_unit_objects.clear();
+    m_items.clear();
+    m_sorted_units.clear();
+    m_sorted_parameter_counts.clear();
+    m_sorted_objects.clear();
+    m_batches.clear();
+    m_instances.clear();
+
+    m_pipeline_ids.clear();
+    m_material_ids.clear();
+    m_vertex_buffer_ids.clear();
+    m_range_ids.clear();
+    m_range_counts.clear();
+}
+
+void render_queue::add(
+    render_pipeline* pipeline,
+    const render_unit& unit,
+    std::size_t parameter_count,
+    float depth,
+    std::uint32_t object_index)
+{
+    std::uint64_t pipeline_id = id(m_pipeline_ids, pipeline);
+    ASH_ASSERT(pipeline_id < MAX_PIPELINE_COUNT, "Too many pipelines in a frame.");
+
+    std::uint64_t key = pipeline_id << 56;
+    if (pipeline->order() == RENDER_ORDER_SUBMISSION)
+    {
+        key |= m_units.size();
+    }
+    else
+    {
+        const void* material = nullptr;
+        if (parameter_count != 0)
+            material = unit.parameters[parameter_count - 1];
+
+        const void* vertex_buffer = nullptr;
+        if (unit.vertex_buffers != nullptr)
+            vertex_buffer = unit.vertex_buffers[0];
+
+        std::uint64_t material_id = id(m_material_ids, material);
+        ASH_ASSERT(material_id < MAX_MATERIAL_COUNT, "Too many materials in a frame.");
+
+        std::uint64_t vertex_buffer_id = id(m_vertex_buffer_ids, vertex_buffer);
+        ASH_ASSERT(
+            vertex_buffer_id < MAX_VERTEX_BUFFER_COUNT,
+            "Too many vertex buffers in a frame.");
+
+        if (pipeline->order() == RENDER_ORDER_FRONT_TO_BACK && pipeline->instancing())
+        {
+            std::uint64_t range = range_id(vertex_buffer_id, unit.index_start);
+            key |=
+                material_id << 40 | vertex_buffer_id << 24 | range << 16 | depth_bits(depth) >> 8;
+        }
+        else if (pipeline->order() == RENDER_ORDER_FRONT_TO_BACK)
+        {
+            key |= material_id << 40 | depth_bits(depth) << 16 | vertex_buffer_id;
+        }
+        else
+        {
+            std::uint64_t far_first = 0xFFFFFF - depth_bits(depth);
+            key |= far_first << 32 | material_id << 16 | vertex_buffer_id;
+        }
+    }
+
+    m_items.push_back({key, static_cast<std::uint32_t>(m_units.size())});
+    m_units.push_back(unit);
+    m_unit_pipelines.push_back(pipeline);
+    m_unit_parameter_counts.push_back(parameter_count);
+    m_unit_objects.push_back(object_index);
+}
+
+void render_queue::sort()
+{
+    m_sorted_units.clear();
+    m_sorted_parameter_counts.clear();
+    m_sorted_objects.clear();
+    m_batches.clear();
+    m_instances.clear();
+
+    if (m_items.empty())
+        return;
+
+    // Least significant digit first, 8 bits per pass. Passes where every key has the same digit
+    // are skipped, which is common for the high bits.
+    m_swap_items.resize(m_items.size());
+    for (std::uint32_t shift = 0; shift < 64; shift += 8)
+    {
+        std::size_t count[256] = {};
+        for (const sort_item& item : m_items)
+            ++count[(item.key >> shift) & 0xFF];
+
+        if (count[(m_items[0].key >> shift) & 0xFF] == m_items.size())
+            continue;
+
+        std::size_t offset = 0;
+        for (std::size_t& c : count)
+        {
+            std::size_t next = offset + c;
+            c = offset;
+            offset = next;
+        }
+
+        for (const sort_item& item : m_items)
+            m_swap_items[count[(item.key >> shift) & 0xFF]++] = item;
+        m_items.swap(m_swap_items);
+    }
+
+    for (const sort_item& item : m_items)
+    {
+        const render_unit& unit = m_units[item.index];
+        render_pipeline* pipeline = m_unit_pipelines[item.index];
+        std::size_t parameter_count = m_unit_parameter_counts[item.index];
+
+        if (m_batches.empty() || m_batches.back().pipeline != pipeline)
+        {
+            m_batches.push_back({pipeline, m_sorted_units.size(), 0});
+        }
+        else
+        {
+            // Adjacent index ranges of the same object, mesh and state become one draw.
+            render_unit& last = m_sorted_units.back();
+            if (last.index_end == unit.index_start &&
+                m_sorted_parameter_counts.back() == parameter_count &&
+                same_state(last, unit, parameter_count) &&
+                m_sorted_objects.back() == m_unit_objects[item.index])
+            {
+                last.index_end = unit.index_end;
+                continue;
+            }
+        }
+
+        m_sorted_units.push_back(unit);
+        m_sorted_parameter_counts.push_back(parameter_count);
+        m_sorted_objects.push_back(m_unit_objects[item.index]);
+        ++m_batches.back().count;
+    }
+
+    // Group instances in place, every unit keeps at least its own object.
+    std::size_t write = 0;
+    for (batch& batch : m_batches)
+    {
+        std::size_t begin = write;
+        for (std::size_t i = batch.begin; i < batch.begin + batch.count; ++i)
+        {
+            render_unit unit = m_sorted_units[i];
+            std::size_t parameter_count = m_sorted_parameter_counts[i];
+
+            if (write != begin && batch.pipeline->instancing())
+            {
+                render_unit& last = m_sorted_units[write - 1];
+                if (m_sorted_parameter_counts[write - 1] == parameter_count &&
+                    same_instance(last, unit, parameter_count))
+                {
+                    ++last.instance_count;
+                    m_instances.push_back(m_sorted_objects[i]);
+                    continue;
+                }
+            }
+
+            unit.instance_start = m_instances.size();
+            unit.instance_count = 1;
+            m_instances.push_back(m_sorted_objects[i]);
+
+            m_sorted_units[write] = unit;
+            m_sorted_parameter_counts[write] = parameter_count;
+            ++write;
+        }
+
+        batch.begin = begin;
+        batch.count = write - begin;
+    }
+    m_sorted_units.resize(write);
+    m_sorted_parameter_counts.resize(write);
+}
+
+std::uint32_t render_queue::id(
+    std::unordered_map<const void*, std::uint32_t>& ids,
+    const void* key)
+{
+    return ids.try_emplace(key, static_cast<std::uint32_t>(ids.size())).first->second;
+}
+
+std::uint32_t render_queue::range_id(std::uint64_t vertex_buffer_id, std::size_t index_start)
+{
+    auto [iter, inserted] = m_range_ids.try_emplace(vertex_buffer_id << 32 | index_start, 0);
+    if (inserted)
+    {
+        if (m_range_counts.size() <= vertex_buffer_id)
+            m_range_counts.resize(vertex_buffer_id + 1, 0);
+
+        // Ranges past the limit share the last id, their units are still compared before they
+        // become instances.
+        iter->second = std::min(m_range_counts[vertex_buffer_id]++, MAX_RANGE_COUNT - 1);
+    }
+    return iter->second;
+}
+} // namespace ash::graphics
@@ -71,6 +71,7 @@ pipeline_parameter_layout_interface* rhi::register_pipeline_parameter_layout(
     const std::vector<pipeline_parameter_pair>& parameters)
 {
     pipeline_parameter_layout_desc desc = {};
+    desc.name = name.data();
     for (auto& parameter : parameters)
     {
         desc.parameters[desc.parameter_count] = parameter;
@@ -0,0 +1,199 @@
+#pragma once
+
+#include "simd.hpp"
+
+namespace ash::math
+{
+using float8_simd = __m256;
+using float16_simd = __m512;
+
+enum class simd_level : std::uint32_t
+{
+    SSE,
+    AVX2,
+    AVX512
+};
+
+/**
+ * @brief Selects the instruction set used by the batch kernels. The kernels are compiled for
+ * every level and the widest one supported by the CPU and the OS is picked at runtime.
+ */
+struct simd_dispatch
+{
+public:
+    /**
+     * @brief The widest level supported by this machine.
+     */
+    static simd_level detect() noexcept;
+
+    static simd_level level() noexcept;
+
+    /**
+     * @brief Overrides the level used by the batch kernels, clamped to the detected level.
+     */
+    static void level(simd_level level) noexcept;
+};
+
+/**
+ * Batch kernels operate on structure of arrays data. An array of count elements with C components
+ * stores component c of element i at data[c * count + i], for matrices the component of row r and
+ * column c is r * 4 + c. Arrays need no particular alignment.
+ */
+struct matrix_batch
+{
+public:
+    /**
+     * @brief result[i] = a[i] * b[i]. The result may alias a or b.
+     *
+     * @param a Array of count 4x4 matrices.
+     * @param b Array of count 4x4 matrices.
+     * @param result Array of count 4x4 matrices.
+     */
+    static void mul(const float* a, const float* b, float* result, std::size_t count) noexcept;
+
+    /**
+     * @brief General 4x4 inverse of every element. The result may alias m.
+     *
+     * @param m Array of count 4x4 matrices.
+     * @param result Array of count 4x4 matrices.
+     */
+    static void inverse(const float* m, float* result, std::size_t count) noexcept;
+
+    /**
+     * @brief Same as matrix_simd::affine_transform for every element.
+     *
+     * @param scale Array of count float3.
+     * @param rotation Array of count quaternions.
+     * @param translation Array of count float3.
+     * @param result Array of count 4x4 matrices.
+     */
+    static void affine_transform(
+        const float* scale,
+        const float* rotation,
+        const float* translation,
+        float* result,
+        std::size_t count) noexcept;
+};
+
+struct quaternion_batch
+{
+public:
+    /**
+     * @brief Same as quaternion_simd::slerp for every element. The trigonometric functions are
+     * evaluated with polynomial approximations, the error is below 1e-6.
+     *
+     * @param a Array of count quaternions.
+     * @param b Array of count quaternions.
+     * @param t Array of count interpolation factors in [0, 1].
+     * @param result Array of count quaternions, may alias a or b.
+     */
+    static void slerp(
+        const float* a,
+        const float* b,
+        const float* t,
+        float* result,
+        std::size_t count) noexcept;
+};
+
+struct bounding_box_batch
+{
+public:
+    /**
+     * @brief Computes the axis aligned bounding boxes of the boxes [min, max] transformed by
+     * matrix.
+     *
+     * @param min Array of count float3.
+     * @param max Array of count float3.
+     * @param matrix Array of count 4x4 matrices.
+     * @param result_min Array of count float3.
+     * @param result_max Array of count float3.
+     */
+    static void transform(
+        const float* min,
+        const float* max,
+        const float* matrix,
+        float* result_min,
+        float* result_max,
+        std::size_t count) noexcept;
+
+    /**
+     * @brief Tests boxes against the six planes of a frustum without branches. A point p is on the
+     * inner side of a plane when dot(plane.xyz, p) + plane.w >= 0.
+     *
+     * @param min Structure of arrays of count boxes, component c of box i is min[c * count + i].
+     * @param max Same layout as min.
+     * @param frustum Six planes.
+     * @param visible Bitset of (count + 31) / 32 words, bit i is set when box i intersects the
+     * frustum.
+     * @param inside Bitset of (count + 31) / 32 words, bit i is set when box i is completely
+     * inside the frustum. May be nullptr.
+     */
+    static void frustum_culling(
+        const float* min,
+        const float* max,
+        const float4* frustum,
+        std::uint32_t* visible,
+        std::uint32_t* inside,
+        std::size_t count) noexcept;
+};
+
+struct skin_batch
+{
+public:
+    /**
+     * @brief Linear blend skinning, the BDEF1, BDEF2 and BDEF4 deformations of PMX. Each vertex is
+     * transformed by the sum of its bone matrices scaled by their weights, normals by the upper 3x3
+     * of the same matrix without normalization.
+     *
+     * @param position Array of count float3.
+     * @param normal Array of count float3.
+     * @param index Array of count elements with influence_count bone indices, stored as floats.
+     * @param weight Array of count elements with influence_count weights, not read when
+     * influence_count is 1.
+     * @param influence_count Bones per vertex, 1, 2 or 4.
+     * @param bones Bone matrices, the last column is ignored.
+     * @param result_position Array of count float3.
+     * @param result_normal Array of count float3.
+     */
+    static void linear_blend(
+        const float* position,
+        const float* normal,
+        const float* index,
+        const float* weight,
+        std::size_t influence_count,
+        const float4x4* bones,
+        float* result_position,
+        float* result_normal,
+        std::size_t count) noexcept;
+
+    /**
+     * @brief Spherical deformation, the SDEF of PMX. Vertices rotate around center by the slerp of
+     * the rotations of two bones and move by the blend of r0 and r1 transformed by the bones.
+     *
+     * @param position Array of count float3.
+     * @param normal Array of count float3.
+     * @param index Array of count elements with 2 bone indices, stored as floats.
+     * @param weight Array of count weights of the first bone, the second one gets 1 - weight.
+     * @param center Array of count float3.
+     * @param r0 Array of count float3, corrected towards center as PMX viewers do.
+     * @param r1 Array of count float3, corrected towards center as PMX viewers do.
+     * @param bones Bone matrices, the last column is ignored.
+     * @param rotations Rotation of each bone matrix as a quaternion.
+     * @param result_position Array of count float3.
+     * @param result_normal Array of count float3.
+     */
+    static void spherical_deform(
+        const float* position,
+        const float* normal,
+        const float* index,
+        const float* weight,
+        const float* center,
+        const float* r0,
+        const float* r1,
+        const float4x4* bones,
+        const float4* rotations,
+        float* result_position,
+        float* result_normal,
+        std::size_t count) noexcept;
+};
+} // namespace ash::math
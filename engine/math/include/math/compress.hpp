@@ -0,0 +1,289 @@
+#pragma once
+
+#include "simd.hpp"
+#include "type.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace ash::math
+{
+/**
+ * @brief IEEE 754 binary16 value.
+ */
+struct half
+{
+    std::uint16_t value;
+};
+
+using half2 = packed<half, 2>;
+using half3 = packed<half, 3>;
+using half4 = packed<half, 4>;
+
+/**
+ * @brief Unit quaternion packed in 48 bits with the smallest three method. The largest component
+ * is dropped and rebuilt from the other three, each stored in 15 bits. The maximum error per
+ * component is about 2e-5.
+ */
+struct quaternion48
+{
+    std::uint16_t data[3];
+};
+
+struct compress
+{
+public:
+    /**
+     * @brief Converts to half with round to nearest even. Values out of range become infinity.
+     */
+    static inline half to_half(float value)
+    {
+        constexpr std::uint32_t f32_infinity = 255u << 23;
+        constexpr std::uint32_t f16_max = (127u + 16u) << 23;
+        constexpr std::uint32_t denorm_magic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+        std::uint32_t f = std::bit_cast<std::uint32_t>(value);
+        std::uint32_t sign = f & 0x80000000u;
+        f ^= sign;
+
+        std::uint32_t result;
+        if (f >= f16_max)
+        {
+            // Infinity or NaN.
+            result = f > f32_infinity ? 0x7E00 : 0x7C00;
+        }
+        else if (f < (113u << 23))
+        {
+            // Subnormal or zero, the addition rounds the mantissa into place.
+            float rounded = std::bit_cast<float>(f) + std::bit_cast<float>(denorm_magic);
+            result = std::bit_cast<std::uint32_t>(rounded) - denorm_magic;
+        }
+        else
+        {
+            std::uint32_t mantissa_odd = (f >> 13) & 1;
+            f += (static_cast<std::uint32_t>(15 - 127) << 23) + 0xFFF;
+            f += mantissa_odd;
+            result = f >> 13;
+        }
+
+        return half{static_cast<std::uint16_t>(result | (sign >> 16))};
+    }
+
+    static inline float to_float(half value)
+    {
+        constexpr std::uint32_t shifted_exponent = 0x7C00u << 13;
+
+        std::uint32_t result = (value.value & 0x7FFFu) << 13;
+        std::uint32_t exponent = result & shifted_exponent;
+        result += (127u - 15u) << 23;
+
+        if (exponent == shifted_exponent)
+        {
+            // Infinity or NaN.
+            result += (128u - 16u) << 23;
+        }
+        else if (exponent == 0)
+        {
+            // Subnormal, renormalize.
+            result += 1u << 23;
+            float f = std::bit_cast<float>(result) - std::bit_cast<float>(113u << 23);
+            result = std::bit_cast<std::uint32_t>(f);
+        }
+
+        result |= static_cast<std::uint32_t>(value.value & 0x8000u) << 16;
+        return std::bit_cast<float>(result);
+    }
+
+    static inline half3 to_half(const float3& v)
+    {
+        return {to_half(v[0]), to_half(v[1]), to_half(v[2])};
+    }
+
+    static inline half4 to_half(const float4& v)
+    {
+        return {to_half(v[0]), to_half(v[1]), to_half(v[2]), to_half(v[3])};
+    }
+
+    static inline float3 to_float(const half3& v)
+    {
+        return {to_float(v[0]), to_float(v[1]), to_float(v[2])};
+    }
+
+    static inline float4 to_float(const half4& v)
+    {
+        return {to_float(v[0]), to_float(v[1]), to_float(v[2]), to_float(v[3])};
+    }
+
+    /**
+     * @brief Packs a unit quaternion. The sign of the result may be flipped, which represents the
+     * same rotation.
+     */
+    static inline quaternion48 to_quaternion48(const float4& quaternion)
+    {
+        std::uint32_t largest = 0;
+        for (std::uint32_t i = 1; i < 4; ++i)
+        {
+            if (std::abs(quaternion[i]) > std::abs(quaternion[largest]))
+                largest = i;
+        }
+
+        // The largest component is kept positive, so the others lie in [-1/sqrt(2), 1/sqrt(2)].
+        float scale = quaternion[largest] < 0.0f ? -SQRT2 : SQRT2;
+
+        std::uint64_t bits = static_cast<std::uint64_t>(largest) << 45;
+        std::uint32_t shift = 0;
+        for (std::uint32_t i = 0; i < 4; ++i)
+        {
+            if (i == largest)
+                continue;
+
+            float v = std::clamp(quaternion[i] * scale, -1.0f, 1.0f);
+            auto quantized = static_cast<std::uint64_t>(std::lround((v * 0.5f + 0.5f) * MAX_15));
+            bits |= quantized << shift;
+            shift += 15;
+        }
+
+        quaternion48 result;
+        result.data[0] = static_cast<std::uint16_t>(bits);
+        result.data[1] = static_cast<std::uint16_t>(bits >> 16);
+        result.data[2] = static_cast<std::uint16_t>(bits >> 32);
+        return result;
+    }
+
+    static inline float4 to_quaternion(const quaternion48& quaternion)
+    {
+        std::uint64_t bits = static_cast<std::uint64_t>(quaternion.data[0]) |
+                             (static_cast<std::uint64_t>(quaternion.data[1]) << 16) |
+                             (static_cast<std::uint64_t>(quaternion.data[2]) << 32);
+
+        std::uint32_t largest = static_cast<std::uint32_t>(bits >> 45) & 0x3;
+
+        float4 result;
+        float sum = 0.0f;
+        std::uint32_t shift = 0;
+        for (std::uint32_t i = 0; i < 4; ++i)
+        {
+            if (i == largest)
+                continue;
+
+            auto quantized = static_cast<float>((bits >> shift) & 0x7FFF);
+            result[i] = (quantized * (2.0f / MAX_15) - 1.0f) * INV_SQRT2;
+            sum += result[i] * result[i];
+            shift += 15;
+        }
+        result[largest] = std::sqrt(std::max(0.0f, 1.0f - sum));
+
+        return result;
+    }
+
+private:
+    friend struct compress_simd;
+
+    static constexpr float SQRT2 = 1.41421356f;
+    static constexpr float INV_SQRT2 = 0.707106781f;
+    static constexpr float MAX_15 = 32767.0f;
+};
+
+struct compress_simd
+{
+public:
+    static inline float4_simd load(const half4& v)
+    {
+        __m128i h = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&v[0]));
+        return to_float(_mm_unpacklo_epi16(h, _mm_setzero_si128()));
+    }
+
+    /**
+     * @brief Loads a half3, w is 0.
+     */
+    static inline float4_simd load(const half3& v)
+    {
+        return to_float(_mm_setr_epi32(v[0].value, v[1].value, v[2].value, 0));
+    }
+
+    static inline float4_simd load(const quaternion48& quaternion)
+    {
+        std::uint64_t bits = static_cast<std::uint64_t>(quaternion.data[0]) |
+                             (static_cast<std::uint64_t>(quaternion.data[1]) << 16) |
+                             (static_cast<std::uint64_t>(quaternion.data[2]) << 32);
+
+        __m128i quantized = _mm_setr_epi32(
+            static_cast<int>(bits & 0x7FFF),
+            static_cast<int>((bits >> 15) & 0x7FFF),
+            static_cast<int>((bits >> 30) & 0x7FFF),
+            0);
+
+        // (a, b, c, 0) in [-1/sqrt(2), 1/sqrt(2)], the last lane is masked off.
+        __m128 v = _mm_cvtepi32_ps(quantized);
+        v = _mm_mul_ps(v, _mm_set_ps1(2.0f / compress::MAX_15 * compress::INV_SQRT2));
+        v = _mm_sub_ps(v, _mm_set_ps1(compress::INV_SQRT2));
+        v = _mm_and_ps(v, simd::mask<0x1110>());
+
+        // Rebuild the largest component into the last lane.
+        __m128 square = _mm_mul_ps(v, v);
+        __m128 sum = _mm_add_ps(square, simd::shuffle<1, 0, 3, 2>(square));
+        sum = _mm_add_ps(sum, simd::shuffle<2, 3, 0, 1>(sum));
+        __m128 w = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(_mm_set_ps1(1.0f), sum), _mm_setzero_ps()));
+        v = _mm_or_ps(v, _mm_andnot_ps(simd::mask<0x1110>(), w));
+
+        switch ((bits >> 45) & 0x3)
+        {
+        case 0:
+            return simd::shuffle<3, 0, 1, 2>(v);
+        case 1:
+            return simd::shuffle<0, 3, 1, 2>(v);
+        case 2:
+            return simd::shuffle<0, 1, 3, 2>(v);
+        default:
+            return v;
+        }
+    }
+
+    static inline void decompress(const half4* source, float4* destination, std::size_t count)
+    {
+        std::size_t i = 0;
+        for (; i + 2 <= count; i += 2)
+        {
+            __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&source[i]));
+            _mm_storeu_ps(&destination[i][0], to_float(_mm_unpacklo_epi16(h, _mm_setzero_si128())));
+            _mm_storeu_ps(
+                &destination[i + 1][0],
+                to_float(_mm_unpackhi_epi16(h, _mm_setzero_si128())));
+        }
+
+        if (i < count)
+            _mm_storeu_ps(&destination[i][0], load(source[i]));
+    }
+
+    static inline void decompress(
+        const quaternion48* source,
+        float4* destination,
+        std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            _mm_storeu_ps(&destination[i][0], load(source[i]));
+    }
+
+private:
+    // Converts four halves stored in the low 16 bits of each lane.
+    static inline float4_simd to_float(__m128i h)
+    {
+        const __m128i mask_no_sign = _mm_set1_epi32(0x7FFF);
+        const __m128i was_infinity_nan = _mm_set1_epi32(0x7BFF);
+        const __m128 magic = _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23));
+        const __m128 exponent_infinity_nan = _mm_castsi128_ps(_mm_set1_epi32(255 << 23));
+
+        __m128i exponent_mantissa = _mm_and_si128(mask_no_sign, h);
+        __m128i sign = _mm_slli_epi32(_mm_xor_si128(h, exponent_mantissa), 16);
+
+        // Rescaling the shifted bits by 2^112 handles normals and subnormals alike.
+        __m128i shifted = _mm_slli_epi32(exponent_mantissa, 13);
+        __m128 scaled = _mm_mul_ps(_mm_castsi128_ps(shifted), magic);
+
+        __m128i infinity_nan = _mm_cmpgt_epi32(exponent_mantissa, was_infinity_nan);
+        __m128 exponent = _mm_and_ps(_mm_castsi128_ps(infinity_nan), exponent_infinity_nan);
+
+        return _mm_or_ps(scaled, _mm_or_ps(_mm_castsi128_ps(sign), exponent));
+    }
+};
+} // namespace ash::math
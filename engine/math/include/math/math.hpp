@@ -1,5 +1,7 @@
 #pragma once
 
+#include "batch.hpp"
+#include "compress.hpp"
 #include "euler.hpp"
 #include "matrix.hpp"
 #include "misc.hpp"
@@ -11,7 +11,7 @@ namespace ash::math
 class matrix
 {
 public:
-    static inline float4x4 mul(const float4x4& m1, const float4x4& m2)
+    static constexpr inline float4x4 mul(const float4x4& m1, const float4x4& m2)
     {
         float4x4 result = {};
         for (std::size_t i = 0; i < 4; ++i)
@@ -25,7 +25,7 @@ public:
         return result;
     }
 
-    static inline float4 mul(const float4& v, const float4x4& m)
+    static constexpr inline float4 mul(const float4& v, const float4x4& m)
     {
         return {
             m[0][0] * v[0] + m[1][0] * v[1] + m[2][0] * v[2] + m[3][0] * v[3],
@@ -34,7 +34,7 @@ public:
             m[0][3] * v[0] + m[1][3] * v[1] + m[2][3] * v[2] + m[3][3] * v[3]};
     }
 
-    static inline float4x4 mul(const float4x4& m, float scale)
+    static constexpr inline float4x4 mul(const float4x4& m, float scale)
     {
         float4x4 result = {};
         for (std::size_t i = 0; i < 4; ++i)
@@ -45,7 +45,7 @@ public:
         return result;
     }
 
-    static inline float4x4 transpose(const float4x4& m)
+    static constexpr inline float4x4 transpose(const float4x4& m)
     {
         float4x4 result = {};
         for (std::size_t i = 0; i < 4; ++i)
@@ -56,7 +56,7 @@ public:
         return result;
     }
 
-    static inline float determinant(const float4x4& m)
+    static constexpr inline float determinant(const float4x4& m)
     {
         float det11 = m[0][0] * (m[1][1] * (m[2][2] * m[3][3] - m[2][3] * m[3][2]) -
                                  m[1][2] * (m[2][1] * m[3][3] - m[2][3] * m[3][1]) +
@@ -74,7 +74,54 @@ public:
         return det11 - det12 + det13 - det14;
     }
 
-    static inline float4x4 inverse(const float4x4& m)
+    static constexpr inline float4x4 inverse(const float4x4& m)
+    {
+        float s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+        float s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+        float s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+        float s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+        float s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+        float s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+
+        float c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+        float c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+        float c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+        float c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+        float c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+        float c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+
+        float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+        float det_inv = 1.0f / det;
+
+        float4x4 result;
+
+        result[0][0] = det_inv * (m[1][1] * c5 - m[1][2] * c4 + m[1][3] * c3);
+        result[0][1] = det_inv * (-m[0][1] * c5 + m[0][2] * c4 - m[0][3] * c3);
+        result[0][2] = det_inv * (m[3][1] * s5 - m[3][2] * s4 + m[3][3] * s3);
+        result[0][3] = det_inv * (-m[2][1] * s5 + m[2][2] * s4 - m[2][3] * s3);
+
+        result[1][0] = det_inv * (-m[1][0] * c5 + m[1][2] * c2 - m[1][3] * c1);
+        result[1][1] = det_inv * (m[0][0] * c5 - m[0][2] * c2 + m[0][3] * c1);
+        result[1][2] = det_inv * (-m[3][0] * s5 + m[3][2] * s2 - m[3][3] * s1);
+        result[1][3] = det_inv * (m[2][0] * s5 - m[2][2] * s2 + m[2][3] * s1);
+
+        result[2][0] = det_inv * (m[1][0] * c4 - m[1][1] * c2 + m[1][3] * c0);
+        result[2][1] = det_inv * (-m[0][0] * c4 + m[0][1] * c2 - m[0][3] * c0);
+        result[2][2] = det_inv * (m[3][0] * s4 - m[3][1] * s2 + m[3][3] * s0);
+        result[2][3] = det_inv * (-m[2][0] * s4 + m[2][1] * s2 - m[2][3] * s0);
+
+        result[3][0] = det_inv * (-m[1][0] * c3 + m[1][1] * c1 - m[1][2] * c0);
+        result[3][1] = det_inv * (m[0][0] * c3 - m[0][1] * c1 + m[0][2] * c0);
+        result[3][2] = det_inv * (-m[3][0] * s3 + m[3][1] * s1 - m[3][2] * s0);
+        result[3][3] = det_inv * (m[2][0] * s3 - m[2][1] * s1 + m[2][2] * s0);
+
+        return result;
+    }
+
+    /**
+     * @brief Inverse of a matrix whose last column is (0, 0, 0, 1).
+     */
+    static constexpr inline float4x4 inverse_affine(const float4x4& m)
     {
         float4x4 result = {};
 
@@ -108,6 +155,25 @@ public:
         return result;
     }
 
+    /**
+     * @brief Inverse of a matrix made of a rotation and a translation only.
+     */
+    static constexpr inline float4x4 inverse_rigid(const float4x4& m)
+    {
+        float4x4 result = {
+            float4{m[0][0], m[1][0], m[2][0], 0.0f},
+            float4{m[0][1], m[1][1], m[2][1], 0.0f},
+            float4{m[0][2], m[1][2], m[2][2], 0.0f},
+            float4{0.0f,    0.0f,    0.0f,    1.0f}
+        };
+
+        result[3][0] = -(m[3][0] * m[0][0] + m[3][1] * m[0][1] + m[3][2] * m[0][2]);
+        result[3][1] = -(m[3][0] * m[1][0] + m[3][1] * m[1][1] + m[3][2] * m[1][2]);
+        result[3][2] = -(m[3][0] * m[2][0] + m[3][1] * m[2][1] + m[3][2] * m[2][2]);
+
+        return result;
+    }
+
     static constexpr inline float4x4 identity()
     {
         return float4x4{
@@ -118,7 +184,7 @@ public:
         };
     }
 
-    static inline float4x4 scale(float x, float y, float z)
+    static constexpr inline float4x4 scale(float x, float y, float z)
     {
         return float4x4{
             float4{x,    0.0f, 0.0f, 0.0f},
@@ -128,10 +194,10 @@ public:
         };
     }
 
-    static inline float4x4 scale(const float3& v) { return scale(v[0], v[1], v[2]); }
-    static inline float4x4 scale(const float4& v) { return scale(v[0], v[1], v[2]); }
+    static constexpr inline float4x4 scale(const float3& v) { return scale(v[0], v[1], v[2]); }
+    static constexpr inline float4x4 scale(const float4& v) { return scale(v[0], v[1], v[2]); }
 
-    static inline float4x4 scale_axis(const float4& axis, float scale)
+    static constexpr inline float4x4 scale_axis(const float4& axis, float scale)
     {
         float x2 = axis[0] * axis[0];
         float xy = axis[0] * axis[1];
@@ -156,7 +222,7 @@ public:
         return result;
     }
 
-    static inline float4x4 rotation_axis(const float4& axis, float radians)
+    static constexpr inline float4x4 rotation_axis(const float4& axis, float radians)
     {
         auto [sin, cos] = sin_cos(radians);
 
@@ -183,7 +249,7 @@ public:
         return result;
     }
 
-    static inline float4x4 rotation_x_axis(float radians)
+    static constexpr inline float4x4 rotation_x_axis(float radians)
     {
         auto [sin, cos] = sin_cos(radians);
 
@@ -196,7 +262,7 @@ public:
         return result;
     }
 
-    static inline float4x4 rotation_y_axis(float radians)
+    static constexpr inline float4x4 rotation_y_axis(float radians)
     {
         auto [sin, cos] = sin_cos(radians);
 
@@ -209,7 +275,7 @@ public:
         return result;
     }
 
-    static inline float4x4 rotation_z_axis(float radians)
+    static constexpr inline float4x4 rotation_z_axis(float radians)
     {
         auto [sin, cos] = sin_cos(radians);
 
@@ -222,7 +288,7 @@ public:
         return result;
     }
 
-    static inline float4x4 rotation_quaternion(const float4& quaternion)
+    static constexpr inline float4x4 rotation_quaternion(const float4& quaternion)
     {
         float xxd = 2.0f * quaternion[0] * quaternion[0];
         float xyd = 2.0f * quaternion[0] * quaternion[1];
@@ -243,7 +309,7 @@ public:
         };
     }
 
-    static inline float4x4 affine_transform(
+    static constexpr inline float4x4 affine_transform(
         const float3& scale,
         const float4& rotation,
         const float3& translation)
@@ -258,7 +324,7 @@ public:
         };
     }
 
-    static inline float4x4 affine_transform(
+    static constexpr inline float4x4 affine_transform(
         const float4& scale,
         const float4& rotation,
         const float4& translation)
@@ -273,7 +339,7 @@ public:
         };
     }
 
-    static inline void decompose(
+    static constexpr inline void decompose(
         const float4x4& m,
         float3& scale,
         float4& rotation,
@@ -294,7 +360,7 @@ public:
         translation = {m[3][0], m[3][1], m[3][2]};
     }
 
-    static inline void decompose(
+    static constexpr inline void decompose(
         const float4x4& m,
         float4& scale,
         float4& rotation,
@@ -315,7 +381,7 @@ public:
         translation = m[3];
     }
 
-    static inline float4x4 orthographic(
+    static constexpr inline float4x4 orthographic(
         float left,
         float right,
         float bottom,
@@ -334,7 +400,11 @@ public:
         };
     }
 
-    static inline float4x4 orthographic(float width, float height, float near_z, float far_z)
+    static constexpr inline float4x4 orthographic(
+        float width,
+        float height,
+        float near_z,
+        float far_z)
     {
         float d = 1.0f / (far_z - near_z);
         return float4x4{
@@ -445,16 +515,131 @@ public:
 
     static inline float determinant(const float4x4_simd& m)
     {
-        // TODO
+        // Split m into the 2x2 blocks | A B |
+        //                             | C D |, each stored row major in one register.
+        __m128 a = simd::shuffle<0, 1, 0, 1>(m[0], m[1]);
+        __m128 b = simd::shuffle<2, 3, 2, 3>(m[0], m[1]);
+        __m128 c = simd::shuffle<0, 1, 0, 1>(m[2], m[3]);
+        __m128 d = simd::shuffle<2, 3, 2, 3>(m[2], m[3]);
+
+        // (|A|, |B|, |C|, |D|)
+        __m128 det_sub = _mm_sub_ps(
+            _mm_mul_ps(
+                simd::shuffle<0, 2, 0, 2>(m[0], m[2]),
+                simd::shuffle<1, 3, 1, 3>(m[1], m[3])),
+            _mm_mul_ps(
+                simd::shuffle<1, 3, 1, 3>(m[0], m[2]),
+                simd::shuffle<0, 2, 0, 2>(m[1], m[3])));
+
+        // |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+        __m128 ab = adjugate_mul2(a, b);
+        __m128 dc = adjugate_mul2(d, c);
+        __m128 tr = _mm_mul_ps(ab, simd::shuffle<0, 2, 1, 3>(dc));
+
+        float4 v;
+        simd::store(det_sub, v);
+
+        float4 t;
+        simd::store(tr, t);
+
+        return v[0] * v[3] + v[1] * v[2] - (t[0] + t[1] + t[2] + t[3]);
     }
 
+    /**
+     * @brief General 4x4 inverse, computed blockwise from the 2x2 sub matrices.
+     */
     static inline float4x4_simd inverse(const float4x4_simd& m)
     {
-        // TODO
-        float4x4 result;
-        simd::store(m, result);
-        result = matrix::inverse(result);
-        return simd::load(result);
+        __m128 a = simd::shuffle<0, 1, 0, 1>(m[0], m[1]);
+        __m128 b = simd::shuffle<2, 3, 2, 3>(m[0], m[1]);
+        __m128 c = simd::shuffle<0, 1, 0, 1>(m[2], m[3]);
+        __m128 d = simd::shuffle<2, 3, 2, 3>(m[2], m[3]);
+
+        __m128 det_sub = _mm_sub_ps(
+            _mm_mul_ps(
+                simd::shuffle<0, 2, 0, 2>(m[0], m[2]),
+                simd::shuffle<1, 3, 1, 3>(m[1], m[3])),
+            _mm_mul_ps(
+                simd::shuffle<1, 3, 1, 3>(m[0], m[2]),
+                simd::shuffle<0, 2, 0, 2>(m[1], m[3])));
+        __m128 det_a = simd::replicate<0>(det_sub);
+        __m128 det_b = simd::replicate<1>(det_sub);
+        __m128 det_c = simd::replicate<2>(det_sub);
+        __m128 det_d = simd::replicate<3>(det_sub);
+
+        // inverse(M) = 1 / |M| * | X Y |
+        //                        | Z W |, the blocks are computed as their adjugates first.
+        __m128 dc = adjugate_mul2(d, c);
+        __m128 ab = adjugate_mul2(a, b);
+
+        // X# = |D|A - B(D#C)
+        __m128 x = _mm_sub_ps(_mm_mul_ps(det_d, a), mul2(b, dc));
+        // W# = |A|D - C(A#B)
+        __m128 w = _mm_sub_ps(_mm_mul_ps(det_a, d), mul2(c, ab));
+        // Y# = |B|C - D(A#B)#
+        __m128 y = _mm_sub_ps(_mm_mul_ps(det_b, c), mul_adjugate2(d, ab));
+        // Z# = |C|B - A(D#C)#
+        __m128 z = _mm_sub_ps(_mm_mul_ps(det_c, b), mul_adjugate2(a, dc));
+
+        // |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+        __m128 tr = _mm_mul_ps(ab, simd::shuffle<0, 2, 1, 3>(dc));
+        tr = _mm_add_ps(tr, simd::shuffle<2, 3, 0, 1>(tr));
+        tr = _mm_add_ps(tr, simd::shuffle<1, 0, 3, 2>(tr));
+
+        __m128 det = _mm_add_ps(_mm_mul_ps(det_a, det_d), _mm_mul_ps(det_b, det_c));
+        det = _mm_sub_ps(det, tr);
+
+        // The signs of the adjugate are folded into the reciprocal.
+        __m128 det_inv = _mm_div_ps(simd::set(1.0f, -1.0f, -1.0f, 1.0f), det);
+        x = _mm_mul_ps(x, det_inv);
+        y = _mm_mul_ps(y, det_inv);
+        z = _mm_mul_ps(z, det_inv);
+        w = _mm_mul_ps(w, det_inv);
+
+        // Transpose the adjugate blocks back into rows.
+        float4x4_simd result;
+        result[0] = simd::shuffle<3, 1, 3, 1>(x, y);
+        result[1] = simd::shuffle<2, 0, 2, 0>(x, y);
+        result[2] = simd::shuffle<3, 1, 3, 1>(z, w);
+        result[3] = simd::shuffle<2, 0, 2, 0>(z, w);
+
+        return result;
+    }
+
+    /**
+     * @brief Inverse of a matrix whose last column is (0, 0, 0, 1).
+     */
+    static inline float4x4_simd inverse_affine(const float4x4_simd& m)
+    {
+        // The columns of the inverse 3x3 are the cross products of the rows divided by |M|.
+        __m128 c0 = vector_simd::cross(m[1], m[2]);
+        __m128 c1 = vector_simd::cross(m[2], m[0]);
+        __m128 c2 = vector_simd::cross(m[0], m[1]);
+
+        __m128 det_inv = _mm_div_ps(simd::set(1.0f), vector_simd::dot_v(m[0], c0));
+        c0 = _mm_mul_ps(c0, det_inv);
+        c1 = _mm_mul_ps(c1, det_inv);
+        c2 = _mm_mul_ps(c2, det_inv);
+
+        float4x4_simd result = transpose({c0, c1, c2, _mm_setzero_ps()});
+        result[3] = inverse_translation(result, m[3]);
+
+        return result;
+    }
+
+    /**
+     * @brief Inverse of a matrix made of a rotation and a translation only.
+     */
+    static inline float4x4_simd inverse_rigid(const float4x4_simd& m)
+    {
+        float4x4_simd result =
+            transpose({_mm_and_ps(m[0], simd::mask<0x1110>()),
+                       _mm_and_ps(m[1], simd::mask<0x1110>()),
+                       _mm_and_ps(m[2], simd::mask<0x1110>()),
+                       _mm_setzero_ps()});
+        result[3] = inverse_translation(result, m[3]);
+
+        return result;
     }
 
     static inline float4x4_simd identity()
@@ -606,5 +791,41 @@ public:
         float4x4 result = matrix::perspective(fov, aspect, zn, zf);
         return simd::load(result);
     }
+
+private:
+    // 2x2 row major matrix products, A# is the adjugate of A.
+
+    // A * B
+    static inline float4_simd mul2(float4_simd a, float4_simd b)
+    {
+        return _mm_add_ps(
+            _mm_mul_ps(a, simd::shuffle<0, 3, 0, 3>(b)),
+            _mm_mul_ps(simd::shuffle<1, 0, 3, 2>(a), simd::shuffle<2, 1, 2, 1>(b)));
+    }
+
+    // A# * B
+    static inline float4_simd adjugate_mul2(float4_simd a, float4_simd b)
+    {
+        return _mm_sub_ps(
+            _mm_mul_ps(simd::shuffle<3, 3, 0, 0>(a), b),
+            _mm_mul_ps(simd::shuffle<1, 1, 2, 2>(a), simd::shuffle<2, 3, 0, 1>(b)));
+    }
+
+    // A * B#
+    static inline float4_simd mul_adjugate2(float4_simd a, float4_simd b)
+    {
+        return _mm_sub_ps(
+            _mm_mul_ps(a, simd::shuffle<3, 0, 3, 0>(b)),
+            _mm_mul_ps(simd::shuffle<1, 0, 3, 2>(a), simd::shuffle<2, 1, 2, 1>(b)));
+    }
+
+    // Last row of an affine inverse whose first three rows are in m.
+    static inline float4_simd inverse_translation(const float4x4_simd& m, float4_simd translation)
+    {
+        __m128 t = _mm_mul_ps(simd::replicate<0>(translation), m[0]);
+        t = _mm_add_ps(t, _mm_mul_ps(simd::replicate<1>(translation), m[1]));
+        t = _mm_add_ps(t, _mm_mul_ps(simd::replicate<2>(translation), m[2]));
+        return _mm_sub_ps(simd::identity_row<3>(), t);
+    }
 };
 } // namespace ash::math
\ No newline at end of file
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cmath>
+#include <limits>
+#include <type_traits>
 #include <utility>
 
 namespace ash::math
@@ -13,17 +16,17 @@ static constexpr float PI_PIDIV4 = PI / 4.0f;
 static constexpr float PI_PIDIV180 = PI / 180.0f;
 static constexpr float PI_180DIVPI = 180.0f / PI;
 
-inline float to_radians(float degrees)
+constexpr float to_radians(float degrees)
 {
     return degrees * PI_PIDIV180;
 }
 
-inline float to_degrees(float radians)
+constexpr float to_degrees(float radians)
 {
     return radians * PI_180DIVPI;
 }
 
-inline std::pair<float, float> sin_cos(float radians)
+constexpr std::pair<float, float> sin_cos(float radians)
 {
     float temp = radians * PI_1DIV2PI;
     if (temp > 0.0f)
@@ -64,7 +67,7 @@ inline std::pair<float, float> sin_cos(float radians)
     return {sin, cos * sign};
 }
 
-inline float clamp(float value, float min, float max)
+constexpr float clamp(float value, float min, float max)
 {
     if (value < min)
         return min;
@@ -73,4 +76,29 @@ inline float clamp(float value, float min, float max)
     else
         return value;
 }
+
+/**
+ * @brief Square root that can be evaluated at compile time, std::sqrt is used at runtime.
+ */
+constexpr float sqrt(float value)
+{
+    if (!std::is_constant_evaluated())
+        return std::sqrt(value);
+
+    if (value < 0.0f || value != value)
+        return std::numeric_limits<float>::quiet_NaN();
+    if (value == 0.0f || value == std::numeric_limits<float>::infinity())
+        return value;
+
+    // Newton's method converges from above, it stops once the estimate no longer decreases.
+    double x = value < 1.0f ? 1.0 : static_cast<double>(value);
+    for (std::size_t i = 0; i < 256; ++i)
+    {
+        double next = 0.5 * (x + value / x);
+        if (next >= x)
+            break;
+        x = next;
+    }
+    return static_cast<float>(x);
+}
 } // namespace ash::math
\ No newline at end of file
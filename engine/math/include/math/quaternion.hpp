@@ -10,19 +10,19 @@ class quaternion
 public:
     static constexpr inline float4 identity() { return {0.0f, 0.0f, 0.0f, 1.0f}; }
 
-    static inline float4 rotation_axis(const float3& axis, float radians)
+    static constexpr inline float4 rotation_axis(const float3& axis, float radians)
     {
         auto [sin, cos] = sin_cos(radians * 0.5f);
         return {axis[0] * sin, axis[1] * sin, axis[2] * sin, cos};
     }
 
-    static inline float4 rotation_axis(const float4& axis, float radians)
+    static constexpr inline float4 rotation_axis(const float4& axis, float radians)
     {
         auto [sin, cos] = sin_cos(radians * 0.5f);
         return {axis[0] * sin, axis[1] * sin, axis[2] * sin, cos};
     }
 
-    static inline float4 rotation_euler(float pitch, float heading, float bank)
+    static constexpr inline float4 rotation_euler(float pitch, float heading, float bank)
     {
         auto [p_sin, p_cos] = sin_cos(pitch * 0.5f);
         auto [h_sin, h_cos] = sin_cos(heading * 0.5f);
@@ -35,17 +35,17 @@ public:
             h_cos * p_cos * b_cos + h_sin * p_sin * b_sin};
     }
 
-    static inline float4 rotation_euler(const float3& euler)
+    static constexpr inline float4 rotation_euler(const float3& euler)
     {
         return rotation_euler(euler[0], euler[1], euler[2]);
     }
 
-    static inline float4 rotation_euler(const float4& euler)
+    static constexpr inline float4 rotation_euler(const float4& euler)
     {
         return rotation_euler(euler[0], euler[1], euler[2]);
     }
 
-    static inline float4 rotation_matrix(const float4x4& m)
+    static constexpr inline float4 rotation_matrix(const float4x4& m)
     {
         float4 result;
         float t;
@@ -77,11 +77,11 @@ public:
             }
         }
 
-        result = vector::mul(result, 0.5f / sqrtf(t));
+        result = vector::mul(result, 0.5f / math::sqrt(t));
         return result;
     }
 
-    static inline float4 mul(const float4& a, const float4& b)
+    static constexpr inline float4 mul(const float4& a, const float4& b)
     {
         return float4{
             a[3] * b[0] + a[0] * b[3] + a[1] * b[2] - a[2] * b[1],
@@ -90,7 +90,7 @@ public:
             a[3] * b[3] - a[0] * b[0] - a[1] * b[1] - a[2] * b[2]};
     }
 
-    static inline float4 mul_vec(const float4& q, const float4& v)
+    static constexpr inline float4 mul_vec(const float4& q, const float4& v)
     {
         float xxd = 2.0f * q[0] * q[0];
         float xyd = 2.0f * q[0] * q[1];
@@ -110,9 +110,12 @@ public:
             0.0f};
     }
 
-    static inline float4 conjugate(const float4& q) { return float4{-q[0], -q[1], -q[2], q[3]}; }
+    static constexpr inline float4 conjugate(const float4& q)
+    {
+        return float4{-q[0], -q[1], -q[2], q[3]};
+    }
 
-    static inline float4 inverse(const float4& q)
+    static constexpr inline float4 inverse(const float4& q)
     {
         return vector::mul(conjugate(q), 1.0f / vector::dot(q, q));
     }
@@ -82,8 +82,8 @@ public:
     template <std::uint32_t Mask>
     static inline float4_simd mask()
     {
-        static const float4_simd value = make_mask(Mask);
-        return value;
+        return _mm_castsi128_ps(
+            _mm_load_si128(reinterpret_cast<const __m128i*>(mask_value<Mask>::value)));
     }
 
     template <std::uint32_t C1, std::uint32_t C2, std::uint32_t C3, std::uint32_t C4>
@@ -221,26 +221,8 @@ public:
     template <std::uint32_t I>
     static inline float4_simd identity_row()
     {
-        if constexpr (I == 0)
-        {
-            static const float4_simd result = set(1.0f, 0.0f, 0.0f, 0.0f);
-            return result;
-        }
-        else if constexpr (I == 1)
-        {
-            static const float4_simd result = set(0.0f, 1.0f, 0.0f, 0.0f);
-            return result;
-        }
-        else if constexpr (I == 2)
-        {
-            static const float4_simd result = set(0.0f, 0.0f, 1.0f, 0.0f);
-            return result;
-        }
-        else if constexpr (I == 3)
-        {
-            static const float4_simd result = set(0.0f, 0.0f, 0.0f, 1.0f);
-            return result;
-        }
+        static_assert(I < 4);
+        return _mm_load_ps(IDENTITY[I]);
     }
 
 private:
@@ -250,13 +232,22 @@ private:
         static constexpr std::uint32_t value = (C4 << 6) | (C3 << 4) | (C2 << 2) | C1;
     };
 
-    static inline float4_simd make_mask(std::uint32_t mask)
+    // Constant initialized, loading them needs no guard check like function local statics do.
+    template <std::uint32_t Mask>
+    struct mask_value
     {
-        std::uint32_t x = (mask & 0x1000) == 0x1000 ? 0xFFFFFFFF : 0x00000000;
-        std::uint32_t y = (mask & 0x0100) == 0x0100 ? 0xFFFFFFFF : 0x00000000;
-        std::uint32_t z = (mask & 0x0010) == 0x0010 ? 0xFFFFFFFF : 0x00000000;
-        std::uint32_t w = (mask & 0x0001) == 0x0001 ? 0xFFFFFFFF : 0x00000000;
-        return set(x, y, z, w);
-    }
+        alignas(16) static constexpr std::uint32_t value[4] = {
+            (Mask & 0x1000) == 0x1000 ? 0xFFFFFFFF : 0x00000000,
+            (Mask & 0x0100) == 0x0100 ? 0xFFFFFFFF : 0x00000000,
+            (Mask & 0x0010) == 0x0010 ? 0xFFFFFFFF : 0x00000000,
+            (Mask & 0x0001) == 0x0001 ? 0xFFFFFFFF : 0x00000000};
+    };
+
+    alignas(16) static constexpr float IDENTITY[4][4] = {
+        {1.0f, 0.0f, 0.0f, 0.0f},
+        {0.0f, 1.0f, 0.0f, 0.0f},
+        {0.0f, 0.0f, 1.0f, 0.0f},
+        {0.0f, 0.0f, 0.0f, 1.0f}
+    };
 };
 } // namespace ash::math
\ No newline at end of file
@@ -10,8 +10,8 @@ struct packed
 {
     using value_type = T;
 
-    inline value_type& operator[](std::size_t index) { return this->data[index]; }
-    inline const value_type& operator[](std::size_t index) const { return this->data[index]; }
+    constexpr value_type& operator[](std::size_t index) { return this->data[index]; }
+    constexpr const value_type& operator[](std::size_t index) const { return this->data[index]; }
 
     value_type data[S];
 };
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "misc.hpp"
 #include "simd.hpp"
 #include "type.hpp"
 
@@ -8,111 +9,117 @@ namespace ash::math
 class vector
 {
 public:
-    inline static float2 add(const float2& a, const float2& b)
+    inline static constexpr float2 add(const float2& a, const float2& b)
     {
         return {a[0] + b[0], a[1] + b[1]};
     }
 
-    inline static float3 add(const float3& a, const float3& b)
+    inline static constexpr float3 add(const float3& a, const float3& b)
     {
         return {a[0] + b[0], a[1] + b[1], a[2] + b[2]};
     }
 
-    inline static float4 add(const float4& a, const float4& b)
+    inline static constexpr float4 add(const float4& a, const float4& b)
     {
         return {a[0] + b[0], a[1] + b[1], a[2] + b[2], a[3] + b[3]};
     }
 
-    inline static float2 sub(const float2& a, const float2& b)
+    inline static constexpr float2 sub(const float2& a, const float2& b)
     {
         return {a[0] - b[0], a[1] - b[1]};
     }
 
-    inline static float3 sub(const float3& a, const float3& b)
+    inline static constexpr float3 sub(const float3& a, const float3& b)
     {
         return {a[0] - b[0], a[1] - b[1], a[2] - b[2]};
     }
 
-    inline static float4 sub(const float4& a, const float4& b)
+    inline static constexpr float4 sub(const float4& a, const float4& b)
     {
         return {a[0] - b[0], a[1] - b[1], a[2] - b[2], a[3] - b[3]};
     }
 
-    inline static float2 mul(const float2& a, const float2& b)
+    inline static constexpr float2 mul(const float2& a, const float2& b)
     {
         return {a[0] * b[0], a[1] * b[1]};
     }
 
-    inline static float3 mul(const float3& a, const float3& b)
+    inline static constexpr float3 mul(const float3& a, const float3& b)
     {
         return {a[0] * b[0], a[1] * b[1], a[2] * b[2]};
     }
 
-    inline static float4 mul(const float4& a, const float4& b)
+    inline static constexpr float4 mul(const float4& a, const float4& b)
     {
         return {a[0] * b[0], a[1] * b[1], a[2] * b[2], a[3] * b[3]};
     }
 
-    inline static float2 mul(const float2& v, float scale) { return {v[0] * scale, v[1] * scale}; }
+    inline static constexpr float2 mul(const float2& v, float scale)
+    {
+        return {v[0] * scale, v[1] * scale};
+    }
 
-    inline static float3 mul(const float3& v, float scale)
+    inline static constexpr float3 mul(const float3& v, float scale)
     {
         return {v[0] * scale, v[1] * scale, v[2] * scale};
     }
 
-    inline static float4 mul(const float4& v, float scale)
+    inline static constexpr float4 mul(const float4& v, float scale)
     {
         return {v[0] * scale, v[1] * scale, v[2] * scale, v[3] * scale};
     }
 
-    inline static float2 div(const float2& a, const float2& b)
+    inline static constexpr float2 div(const float2& a, const float2& b)
     {
         return {a[0] / b[0], a[1] / b[1]};
     }
 
-    inline static float3 div(const float3& a, const float3& b)
+    inline static constexpr float3 div(const float3& a, const float3& b)
     {
         return {a[0] / b[0], a[1] / b[1], a[2] / b[2]};
     }
 
-    inline static float4 div(const float4& a, const float4& b)
+    inline static constexpr float4 div(const float4& a, const float4& b)
     {
         return {a[0] / b[0], a[1] / b[1], a[2] / b[2], a[3] / b[3]};
     }
 
-    inline static float dot(const float2& a, const float2& b) { return a[0] * b[0] + a[1] * b[1]; }
+    inline static constexpr float dot(const float2& a, const float2& b)
+    {
+        return a[0] * b[0] + a[1] * b[1];
+    }
 
-    inline static float dot(const float3& a, const float3& b)
+    inline static constexpr float dot(const float3& a, const float3& b)
     {
         return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
     }
 
-    inline static float dot(const float4& a, const float4& b)
+    inline static constexpr float dot(const float4& a, const float4& b)
     {
         return a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
     }
 
-    inline static float3 cross(const float3& a, const float3& b)
+    inline static constexpr float3 cross(const float3& a, const float3& b)
     {
         return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]};
     }
 
-    inline static float4 cross(const float4& a, const float4& b)
+    inline static constexpr float4 cross(const float4& a, const float4& b)
     {
         return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]};
     }
 
-    inline static float2 lerp(const float2& a, const float2& b, float m)
+    inline static constexpr float2 lerp(const float2& a, const float2& b, float m)
     {
         return {a[0] + m * (b[0] - a[0]), a[1] + m * (b[1] - a[1])};
     }
 
-    inline static float3 lerp(const float3& a, const float3& b, float m)
+    inline static constexpr float3 lerp(const float3& a, const float3& b, float m)
     {
         return {a[0] + m * (b[0] - a[0]), a[1] + m * (b[1] - a[1]), a[2] + m * (b[2] - a[2])};
     }
 
-    inline static float3 lerp(const float3& a, const float3& b, const float3& m)
+    inline static constexpr float3 lerp(const float3& a, const float3& b, const float3& m)
     {
         return {
             a[0] + m[0] * (b[0] - a[0]),
@@ -120,7 +127,7 @@ public:
             a[2] + m[2] * (b[2] - a[2])};
     }
 
-    inline static float4 lerp(const float4& a, const float4& b, float m)
+    inline static constexpr float4 lerp(const float4& a, const float4& b, float m)
     {
         return {
             a[0] + m * (b[0] - a[0]),
@@ -129,7 +136,7 @@ public:
             a[3] + m * (b[3] - a[3])};
     }
 
-    inline static float4 lerp(const float4& a, const float4& b, const float4& m)
+    inline static constexpr float4 lerp(const float4& a, const float4& b, const float4& m)
     {
         return {
             a[0] + m[0] * (b[0] - a[0]),
@@ -138,38 +145,42 @@ public:
             a[3] + m[3] * (b[3] - a[3])};
     }
 
-    inline static float length(const float2& v) { return sqrtf(dot(v, v)); }
+    inline static constexpr float length(const float2& v) { return math::sqrt(dot(v, v)); }
 
-    inline static float length(const float3& v) { return sqrtf(dot(v, v)); }
+    inline static constexpr float length(const float3& v) { return math::sqrt(dot(v, v)); }
 
-    inline static float length(const float4& v) { return sqrtf(dot(v, v)); }
+    inline static constexpr float length(const float4& v) { return math::sqrt(dot(v, v)); }
 
-    inline static float2 normalize(const float2& v)
+    inline static constexpr float2 normalize(const float2& v)
     {
         float s = 1.0f / length(v);
         return mul(v, s);
     }
 
-    inline static float3 normalize(const float3& v)
+    inline static constexpr float3 normalize(const float3& v)
     {
         float s = 1.0f / length(v);
         return mul(v, s);
     }
 
-    inline static float4 normalize(const float4& v)
+    inline static constexpr float4 normalize(const float4& v)
     {
         float s = 1.0f / length(v);
         return mul(v, s);
     }
 
-    inline static float4 sqrt(const float4& v)
+    inline static constexpr float4 sqrt(const float4& v)
     {
-        return {sqrtf(v[0]), sqrtf(v[1]), sqrtf(v[2]), sqrtf(v[3])};
+        return {math::sqrt(v[0]), math::sqrt(v[1]), math::sqrt(v[2]), math::sqrt(v[3])};
     }
 
-    inline static float4 reciprocal_sqrt(const float4& v)
+    inline static constexpr float4 reciprocal_sqrt(const float4& v)
     {
-        return {1.0f / sqrtf(v[0]), 1.0f / sqrtf(v[1]), 1.0f / sqrtf(v[2]), 1.0f / sqrtf(v[3])};
+        return {
+            1.0f / math::sqrt(v[0]),
+            1.0f / math::sqrt(v[1]),
+            1.0f / math::sqrt(v[2]),
+            1.0f / math::sqrt(v[3])};
     }
 };
 
@@ -0,0 +1,213 @@
+#include "math/batch.hpp"
+#include "batch_kernel.hpp"
+#include <atomic>
+
+#if defined(_MSC_VER)
+#    include <intrin.h>
+#else
+#    include <cpuid.h>
+#endif
+
+namespace ash::math
+{
+namespace
+{
+void cpuid(std::uint32_t leaf, std::uint32_t subleaf, std::uint32_t (&registers)[4])
+{
+#if defined(_MSC_VER)
+    int result[4];
+    __cpuidex(result, static_cast<int>(leaf), static_cast<int>(subleaf));
+    for (std::size_t i = 0; i < 4; ++i)
+        registers[i] = static_cast<std::uint32_t>(result[i]);
+#else
+    __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+// The register state the OS saves on context switches.
+std::uint64_t xgetbv()
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    std::uint32_t eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<std::uint64_t>(edx) << 32) | eax;
+#endif
+}
+
+simd_level detect_level() noexcept
+{
+    std::uint32_t registers[4];
+    cpuid(0, 0, registers);
+    std::uint32_t max_leaf = registers[0];
+    if (max_leaf < 7)
+        return simd_level::SSE;
+
+    cpuid(1, 0, registers);
+    bool osxsave = (registers[2] & (1u << 27)) != 0;
+    bool avx = (registers[2] & (1u << 28)) != 0;
+    bool fma = (registers[2] & (1u << 12)) != 0;
+    if (!osxsave || !avx || !fma)
+        return simd_level::SSE;
+
+    // XMM and YMM state.
+    std::uint64_t xcr0 = xgetbv();
+    if ((xcr0 & 0x6) != 0x6)
+        return simd_level::SSE;
+
+    cpuid(7, 0, registers);
+    bool avx2 = (registers[1] & (1u << 5)) != 0;
+    bool avx512f = (registers[1] & (1u << 16)) != 0;
+    if (!avx2)
+        return simd_level::SSE;
+
+    // Opmask, upper ZMM0-15 and ZMM16-31 state.
+    if (avx512f && (xcr0 & 0xE6) == 0xE6)
+        return simd_level::AVX512;
+    else
+        return simd_level::AVX2;
+}
+
+std::atomic<simd_level>& current_level() noexcept
+{
+    static std::atomic<simd_level> level = simd_dispatch::detect();
+    return level;
+}
+
+const batch_kernels& kernels() noexcept
+{
+    switch (current_level().load(std::memory_order_relaxed))
+    {
+    case simd_level::AVX512:
+        return batch_kernels_avx512();
+    case simd_level::AVX2:
+        return batch_kernels_avx2();
+    default:
+        return batch_kernels_sse();
+    }
+}
+} // namespace
+
+simd_level simd_dispatch::detect() noexcept
+{
+    static const simd_level level = detect_level();
+    return level;
+}
+
+simd_level simd_dispatch::level() noexcept
+{
+    return current_level().load(std::memory_order_relaxed);
+}
+
+void simd_dispatch::level(simd_level level) noexcept
+{
+    if (level > detect())
+        level = detect();
+    current_level().store(level, std::memory_order_relaxed);
+}
+
+void matrix_batch::mul(const float* a, const float* b, float* result, std::size_t count) noexcept
+{
+    kernels().matrix_mul(a, b, result, count);
+}
+
+void matrix_batch::inverse(const float* m, float* result, std::size_t count) noexcept
+{
+    kernels().matrix_inverse(m, result, count);
+}
+
+void matrix_batch::affine_transform(
+    const float* scale,
+    const float* rotation,
+    const float* translation,
+    float* result,
+    std::size_t count) noexcept
+{
+    kernels().affine_transform(scale, rotation, translation, result, count);
+}
+
+void quaternion_batch::slerp(
+    const float* a,
+    const float* b,
+    const float* t,
+    float* result,
+    std::size_t count) noexcept
+{
+    kernels().slerp(a, b, t, result, count);
+}
+
+void bounding_box_batch::transform(
+    const float* min,
+    const float* max,
+    const float* matrix,
+    float* result_min,
+    float* result_max,
+    std::size_t count) noexcept
+{
+    kernels().bounding_box_transform(min, max, matrix, result_min, result_max, count);
+}
+
+void bounding_box_batch::frustum_culling(
+    const float* min,
+    const float* max,
+    const float4* frustum,
+    std::uint32_t* visible,
+    std::uint32_t* inside,
+    std::size_t count) noexcept
+{
+    kernels().frustum_culling(min, max, frustum, visible, inside, count);
+}
+
+void skin_batch::linear_blend(
+    const float* position,
+    const float* normal,
+    const float* index,
+    const float* weight,
+    std::size_t influence_count,
+    const float4x4* bones,
+    float* result_position,
+    float* result_normal,
+    std::size_t count) noexcept
+{
+    kernels().linear_blend(
+        position,
+        normal,
+        index,
+        weight,
+        influence_count,
+        bones,
+        result_position,
+        result_normal,
+        count);
+}
+
+void skin_batch::spherical_deform(
+    const float* position,
+    const float* normal,
+    const float* index,
+    const float* weight,
+    const float* center,
+    const float* r0,
+    const float* r1,
+    const float4x4* bones,
+    const float4* rotations,
+    float* result_position,
+    float* result_normal,
+    std::size_t count) noexcept
+{
+    kernels().spherical_deform(
+        position,
+        normal,
+        index,
+        weight,
+        center,
+        r0,
+        r1,
+        bones,
+        rotations,
+        result_position,
+        result_normal,
+        count);
+}
+} // namespace ash::math
@@ -0,0 +1,9 @@
+#include "batch_kernel.hpp"
+
+namespace ash::math
+{
+const batch_kernels& batch_kernels_avx512() noexcept
+{
+    return make_batch_kernels<simd_lane<16>>();
+}
+} // namespace ash::math
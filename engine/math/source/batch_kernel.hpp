@@ -0,0 +1,812 @@
+#pragma once
+
+#include "simd_lane.hpp"
+#include <cmath>
+#include <cstring>
+
+namespace ash::math
+{
+/**
+ * @brief The batch kernels compiled for one instruction set.
+ */
+struct batch_kernels
+{
+    void (*matrix_mul)(const float*, const float*, float*, std::size_t);
+    void (*matrix_inverse)(const float*, float*, std::size_t);
+    void (*affine_transform)(const float*, const float*, const float*, float*, std::size_t);
+    void (*slerp)(const float*, const float*, const float*, float*, std::size_t);
+    void (*bounding_box_transform)(
+        const float*,
+        const float*,
+        const float*,
+        float*,
+        float*,
+        std::size_t);
+    void (*frustum_culling)(
+        const float*,
+        const float*,
+        const float4*,
+        std::uint32_t*,
+        std::uint32_t*,
+        std::size_t);
+    void (*linear_blend)(
+        const float*,
+        const float*,
+        const float*,
+        const float*,
+        std::size_t,
+        const float4x4*,
+        float*,
+        float*,
+        std::size_t);
+    void (*spherical_deform)(
+        const float*,
+        const float*,
+        const float*,
+        const float*,
+        const float*,
+        const float*,
+        const float*,
+        const float4x4*,
+        const float4*,
+        float*,
+        float*,
+        std::size_t);
+};
+
+const batch_kernels& batch_kernels_sse() noexcept;
+const batch_kernels& batch_kernels_avx2() noexcept;
+const batch_kernels& batch_kernels_avx512() noexcept;
+
+// This header is compiled once per instruction set. Everything below lives in the anonymous
+// namespace and calls nothing but intrinsics and C functions. An inline function of another
+// header, std::abs for example, would be emitted as a weak copy built for the wider instruction
+// set, and the linker may keep that copy for the whole program.
+namespace
+{
+constexpr std::size_t BATCH_MAX_COMPONENTS = 16;
+
+/**
+ * @brief Calls kernel(inputs, outputs, stride) for every Lane::SIZE elements of the arrays, where
+ * stride is the distance between two components. The remaining elements are copied to zero padded
+ * buffers and processed as one more full group.
+ */
+template <typename Lane, std::size_t I, std::size_t O, typename Kernel>
+inline void batch_run(
+    const float* const (&inputs)[I],
+    const std::size_t (&input_components)[I],
+    float* const (&outputs)[O],
+    const std::size_t (&output_components)[O],
+    std::size_t count,
+    Kernel&& kernel)
+{
+    constexpr std::size_t W = Lane::SIZE;
+
+    std::size_t full = count - count % W;
+    for (std::size_t i = 0; i < full; i += W)
+    {
+        const float* in[I];
+        for (std::size_t k = 0; k < I; ++k)
+            in[k] = inputs[k] + i;
+
+        float* out[O];
+        for (std::size_t k = 0; k < O; ++k)
+            out[k] = outputs[k] + i;
+
+        kernel(in, out, count);
+    }
+
+    std::size_t rest = count - full;
+    if (rest == 0)
+        return;
+
+    alignas(64) float in_buffer[I][BATCH_MAX_COMPONENTS * W] = {};
+    alignas(64) float out_buffer[O][BATCH_MAX_COMPONENTS * W];
+
+    const float* in[I];
+    for (std::size_t k = 0; k < I; ++k)
+    {
+        for (std::size_t c = 0; c < input_components[k]; ++c)
+        {
+            for (std::size_t j = 0; j < rest; ++j)
+                in_buffer[k][c * W + j] = inputs[k][c * count + full + j];
+        }
+        in[k] = in_buffer[k];
+    }
+
+    float* out[O];
+    for (std::size_t k = 0; k < O; ++k)
+        out[k] = out_buffer[k];
+
+    kernel(in, out, W);
+
+    for (std::size_t k = 0; k < O; ++k)
+    {
+        for (std::size_t c = 0; c < output_components[k]; ++c)
+        {
+            for (std::size_t j = 0; j < rest; ++j)
+                outputs[k][c * count + full + j] = out_buffer[k][c * W + j];
+        }
+    }
+}
+
+template <typename Lane>
+void batch_matrix_mul(const float* a, const float* b, float* result, std::size_t count)
+{
+    using V = typename Lane::value_type;
+
+    batch_run<Lane>(
+        {a, b},
+        {16, 16},
+        {result},
+        {16},
+        count,
+        [](const float* const* in, float* const* out, std::size_t stride) {
+            V m[16];
+            for (std::size_t i = 0; i < 16; ++i)
+                m[i] = Lane::load(in[1] + i * stride);
+
+            for (std::size_t r = 0; r < 4; ++r)
+            {
+                V x = Lane::load(in[0] + (r * 4 + 0) * stride);
+                V y = Lane::load(in[0] + (r * 4 + 1) * stride);
+                V z = Lane::load(in[0] + (r * 4 + 2) * stride);
+                V w = Lane::load(in[0] + (r * 4 + 3) * stride);
+
+                for (std::size_t c = 0; c < 4; ++c)
+                {
+                    V v = Lane::mul(w, m[12 + c]);
+                    v = Lane::mul_add(z, m[8 + c], v);
+                    v = Lane::mul_add(y, m[4 + c], v);
+                    v = Lane::mul_add(x, m[c], v);
+                    Lane::store(out[0] + (r * 4 + c) * stride, v);
+                }
+            }
+        });
+}
+
+template <typename Lane>
+void batch_matrix_inverse(const float* m, float* result, std::size_t count)
+{
+    using V = typename Lane::value_type;
+
+    batch_run<Lane>(
+        {m},
+        {16},
+        {result},
+        {16},
+        count,
+        [](const float* const* in, float* const* out, std::size_t stride) {
+            V a[16];
+            for (std::size_t i = 0; i < 16; ++i)
+                a[i] = Lane::load(in[0] + i * stride);
+
+            // 2x2 minors of the upper and the lower two rows.
+            V s0 = Lane::sub(Lane::mul(a[0], a[5]), Lane::mul(a[4], a[1]));
+            V s1 = Lane::sub(Lane::mul(a[0], a[6]), Lane::mul(a[4], a[2]));
+            V s2 = Lane::sub(Lane::mul(a[0], a[7]), Lane::mul(a[4], a[3]));
+            V s3 = Lane::sub(Lane::mul(a[1], a[6]), Lane::mul(a[5], a[2]));
+            V s4 = Lane::sub(Lane::mul(a[1], a[7]), Lane::mul(a[5], a[3]));
+            V s5 = Lane::sub(Lane::mul(a[2], a[7]), Lane::mul(a[6], a[3]));
+
+            V c0 = Lane::sub(Lane::mul(a[8], a[13]), Lane::mul(a[12], a[9]));
+            V c1 = Lane::sub(Lane::mul(a[8], a[14]), Lane::mul(a[12], a[10]));
+            V c2 = Lane::sub(Lane::mul(a[8], a[15]), Lane::mul(a[12], a[11]));
+            V c3 = Lane::sub(Lane::mul(a[9], a[14]), Lane::mul(a[13], a[10]));
+            V c4 = Lane::sub(Lane::mul(a[9], a[15]), Lane::mul(a[13], a[11]));
+            V c5 = Lane::sub(Lane::mul(a[10], a[15]), Lane::mul(a[14], a[11]));
+
+            V det = Lane::mul(s0, c5);
+            det = Lane::sub(det, Lane::mul(s1, c4));
+            det = Lane::mul_add(s2, c3, det);
+            det = Lane::mul_add(s3, c2, det);
+            det = Lane::sub(det, Lane::mul(s4, c1));
+            det = Lane::mul_add(s5, c0, det);
+
+            V det_inv = Lane::div(Lane::set(1.0f), det);
+            V det_inv_negative = Lane::sub(Lane::set(0.0f), det_inv);
+
+            // (x * p - y * q + z * r) * scale
+            auto cofactor = [](V x, V p, V y, V q, V z, V r, V scale) {
+                V v = Lane::sub(Lane::mul(x, p), Lane::mul(y, q));
+                return Lane::mul(Lane::mul_add(z, r, v), scale);
+            };
+
+            V r[16] = {
+                cofactor(a[5], c5, a[6], c4, a[7], c3, det_inv),
+                cofactor(a[1], c5, a[2], c4, a[3], c3, det_inv_negative),
+                cofactor(a[13], s5, a[14], s4, a[15], s3, det_inv),
+                cofactor(a[9], s5, a[10], s4, a[11], s3, det_inv_negative),
+
+                cofactor(a[4], c5, a[6], c2, a[7], c1, det_inv_negative),
+                cofactor(a[0], c5, a[2], c2, a[3], c1, det_inv),
+                cofactor(a[12], s5, a[14], s2, a[15], s1, det_inv_negative),
+                cofactor(a[8], s5, a[10], s2, a[11], s1, det_inv),
+
+                cofactor(a[4], c4, a[5], c2, a[7], c0, det_inv),
+                cofactor(a[0], c4, a[1], c2, a[3], c0, det_inv_negative),
+                cofactor(a[12], s4, a[13], s2, a[15], s0, det_inv),
+                cofactor(a[8], s4, a[9], s2, a[11], s0, det_inv_negative),
+
+                cofactor(a[4], c3, a[5], c1, a[6], c0, det_inv_negative),
+                cofactor(a[0], c3, a[1], c1, a[2], c0, det_inv),
+                cofactor(a[12], s3, a[13], s1, a[14], s0, det_inv_negative),
+                cofactor(a[8], s3, a[9], s1, a[10], s0, det_inv)};
+
+            for (std::size_t i = 0; i < 16; ++i)
+                Lane::store(out[0] + i * stride, r[i]);
+        });
+}
+
+template <typename Lane>
+void batch_affine_transform(
+    const float* scale,
+    const float* rotation,
+    const float* translation,
+    float* result,
+    std::size_t count)
+{
+    using V = typename Lane::value_type;
+
+    batch_run<Lane>(
+        {scale, rotation, translation},
+        {3, 4, 3},
+        {result},
+        {16},
+        count,
+        [](const float* const* in, float* const* out, std::size_t stride) {
+            V x = Lane::load(in[1]);
+            V y = Lane::load(in[1] + stride);
+            V z = Lane::load(in[1] + stride * 2);
+            V w = Lane::load(in[1] + stride * 3);
+
+            V x2 = Lane::add(x, x);
+            V y2 = Lane::add(y, y);
+            V z2 = Lane::add(z, z);
+
+            V xx = Lane::mul(x, x2);
+            V xy = Lane::mul(x, y2);
+            V xz = Lane::mul(x, z2);
+            V xw = Lane::mul(w, x2);
+            V yy = Lane::mul(y, y2);
+            V yz = Lane::mul(y, z2);
+            V yw = Lane::mul(w, y2);
+            V zz = Lane::mul(z, z2);
+            V zw = Lane::mul(w, z2);
+
+            V zero = Lane::set(0.0f);
+            V one = Lane::set(1.0f);
+            V sx = Lane::load(in[0]);
+            V sy = Lane::load(in[0] + stride);
+            V sz = Lane::load(in[0] + stride * 2);
+
+            float* m = out[0];
+            Lane::store(m + stride * 0, Lane::mul(sx, Lane::sub(one, Lane::add(yy, zz))));
+            Lane::store(m + stride * 1, Lane::mul(sx, Lane::add(xy, zw)));
+            Lane::store(m + stride * 2, Lane::mul(sx, Lane::sub(xz, yw)));
+            Lane::store(m + stride * 3, zero);
+
+            Lane::store(m + stride * 4, Lane::mul(sy, Lane::sub(xy, zw)));
+            Lane::store(m + stride * 5, Lane::mul(sy, Lane::sub(one, Lane::add(xx, zz))));
+            Lane::store(m + stride * 6, Lane::mul(sy, Lane::add(yz, xw)));
+            Lane::store(m + stride * 7, zero);
+
+            Lane::store(m + stride * 8, Lane::mul(sz, Lane::add(xz, yw)));
+            Lane::store(m + stride * 9, Lane::mul(sz, Lane::sub(yz, xw)));
+            Lane::store(m + stride * 10, Lane::mul(sz, Lane::sub(one, Lane::add(xx, yy))));
+            Lane::store(m + stride * 11, zero);
+
+            Lane::store(m + stride * 12, Lane::load(in[2]));
+            Lane::store(m + stride * 13, Lane::load(in[2] + stride));
+            Lane::store(m + stride * 14, Lane::load(in[2] + stride * 2));
+            Lane::store(m + stride * 15, one);
+        });
+}
+
+// sin(x) for x in [0, pi / 2].
+template <typename Lane>
+inline typename Lane::value_type batch_sin(typename Lane::value_type x)
+{
+    using V = typename Lane::value_type;
+
+    V x2 = Lane::mul(x, x);
+    V p = Lane::set(-2.5052108e-8f);
+    p = Lane::mul_add(p, x2, Lane::set(2.7557319e-6f));
+    p = Lane::mul_add(p, x2, Lane::set(-1.9841270e-4f));
+    p = Lane::mul_add(p, x2, Lane::set(8.3333333e-3f));
+    p = Lane::mul_add(p, x2, Lane::set(-1.6666667e-1f));
+    p = Lane::mul_add(p, x2, Lane::set(1.0f));
+    return Lane::mul(p, x);
+}
+
+// acos(x) for x in [0, 1], Abramowitz and Stegun 4.4.46.
+template <typename Lane>
+inline typename Lane::value_type batch_acos(typename Lane::value_type x)
+{
+    using V = typename Lane::value_type;
+
+    V p = Lane::set(-0.0012624911f);
+    p = Lane::mul_add(p, x, Lane::set(0.0066700901f));
+    p = Lane::mul_add(p, x, Lane::set(-0.0170881256f));
+    p = Lane::mul_add(p, x, Lane::set(0.0308918810f));
+    p = Lane::mul_add(p, x, Lane::set(-0.0501743046f));
+    p = Lane::mul_add(p, x, Lane::set(0.0889789874f));
+    p = Lane::mul_add(p, x, Lane::set(-0.2145988016f));
+    p = Lane::mul_add(p, x, Lane::set(1.5707963050f));
+    return Lane::mul(p, Lane::sqrt(Lane::sub(Lane::set(1.0f), x)));
+}
+
+template <typename Lane>
+inline void batch_quaternion_slerp(
+    const typename Lane::value_type (&qa)[4],
+    const typename Lane::value_type (&qb)[4],
+    typename Lane::value_type factor,
+    typename Lane::value_type (&result)[4])
+{
+    using V = typename Lane::value_type;
+
+    V zero = Lane::set(0.0f);
+    V one = Lane::set(1.0f);
+
+    V cos_omega = Lane::mul(qa[0], qb[0]);
+    cos_omega = Lane::mul_add(qa[1], qb[1], cos_omega);
+    cos_omega = Lane::mul_add(qa[2], qb[2], cos_omega);
+    cos_omega = Lane::mul_add(qa[3], qb[3], cos_omega);
+
+    // Take the shorter path.
+    V sign = Lane::select_less(cos_omega, zero, Lane::set(-1.0f), one);
+    cos_omega = Lane::mul(cos_omega, sign);
+
+    V sin_omega = Lane::sqrt(Lane::max(Lane::sub(one, Lane::mul(cos_omega, cos_omega)), zero));
+    V omega = batch_acos<Lane>(Lane::min(cos_omega, one));
+    V div = Lane::div(one, sin_omega);
+
+    V linear_k0 = Lane::sub(one, factor);
+    V k0 = Lane::mul(batch_sin<Lane>(Lane::mul(linear_k0, omega)), div);
+    V k1 = Lane::mul(batch_sin<Lane>(Lane::mul(factor, omega)), div);
+
+    // Fall back to linear interpolation for nearly parallel quaternions.
+    V threshold = Lane::set(0.9999f);
+    k0 = Lane::select_less(threshold, cos_omega, linear_k0, k0);
+    k1 = Lane::select_less(threshold, cos_omega, factor, k1);
+    k1 = Lane::mul(k1, sign);
+
+    for (std::size_t i = 0; i < 4; ++i)
+        result[i] = Lane::mul_add(qa[i], k0, Lane::mul(qb[i], k1));
+}
+
+template <typename Lane>
+void batch_slerp(const float* a, const float* b, const float* t, float* result, std::size_t count)
+{
+    using V = typename Lane::value_type;
+
+    batch_run<Lane>(
+        {a, b, t},
+        {4, 4, 1},
+        {result},
+        {4},
+        count,
+        [](const float* const* in, float* const* out, std::size_t stride) {
+            V qa[4];
+            V qb[4];
+            for (std::size_t i = 0; i < 4; ++i)
+            {
+                qa[i] = Lane::load(in[0] + i * stride);
+                qb[i] = Lane::load(in[1] + i * stride);
+            }
+
+            V q[4];
+            batch_quaternion_slerp<Lane>(qa, qb, Lane::load(in[2]), q);
+            for (std::size_t i = 0; i < 4; ++i)
+                Lane::store(out[0] + i * stride, q[i]);
+        });
+}
+
+template <typename Lane>
+void batch_bounding_box_transform(
+    const float* min,
+    const float* max,
+    const float* matrix,
+    float* result_min,
+    float* result_max,
+    std::size_t count)
+{
+    using V = typename Lane::value_type;
+
+    batch_run<Lane>(
+        {min, max, matrix},
+        {3, 3, 16},
+        {result_min, result_max},
+        {3, 3},
+        count,
+        [](const float* const* in, float* const* out, std::size_t stride) {
+            V box_min[3];
+            V box_max[3];
+            for (std::size_t i = 0; i < 3; ++i)
+            {
+                box_min[i] = Lane::load(in[0] + i * stride);
+                box_max[i] = Lane::load(in[1] + i * stride);
+            }
+
+            for (std::size_t j = 0; j < 3; ++j)
+            {
+                V new_min = Lane::load(in[2] + (12 + j) * stride);
+                V new_max = new_min;
+
+                for (std::size_t i = 0; i < 3; ++i)
+                {
+                    V axis = Lane::load(in[2] + (i * 4 + j) * stride);
+                    V a = Lane::mul(axis, box_min[i]);
+                    V b = Lane::mul(axis, box_max[i]);
+                    new_min = Lane::add(new_min, Lane::min(a, b));
+                    new_max = Lane::add(new_max, Lane::max(a, b));
+                }
+
+                Lane::store(out[0] + j * stride, new_min);
+                Lane::store(out[1] + j * stride, new_max);
+            }
+        });
+}
+
+template <typename Lane>
+void batch_frustum_culling(
+    const float* min,
+    const float* max,
+    const float4* frustum,
+    std::uint32_t* visible,
+    std::uint32_t* inside,
+    std::size_t count)
+{
+    using V = typename Lane::value_type;
+    constexpr std::size_t W = Lane::SIZE;
+    constexpr std::uint32_t LANE_BITS = (1u << W) - 1;
+
+    std::size_t words = (count + 31) / 32;
+    std::memset(visible, 0, words * sizeof(std::uint32_t));
+    if (inside != nullptr)
+        std::memset(inside, 0, words * sizeof(std::uint32_t));
+
+    // The vertex farthest along a plane normal picks max where the normal is positive and min
+    // where it is negative, so its distance is dot(n, center) + dot(|n|, extent). The nearest
+    // vertex subtracts the same term.
+    V zero = Lane::set(0.0f);
+    V normal[6][3];
+    V normal_abs[6][3];
+    V distance[6];
+    const float* plane = reinterpret_cast<const float*>(frustum);
+    for (std::size_t i = 0; i < 6; ++i)
+    {
+        for (std::size_t c = 0; c < 3; ++c)
+        {
+            float n = plane[i * 4 + c];
+            normal[i][c] = Lane::set(n);
+            normal_abs[i][c] = Lane::set(n < 0.0f ? -n : n);
+        }
+        distance[i] = Lane::set(plane[i * 4 + 3]);
+    }
+
+    // Writes the visible and inside bits of the W boxes starting at index.
+    auto cull = [&](const float* box_min,
+                    const float* box_max,
+                    std::size_t stride,
+                    std::size_t index,
+                    std::uint32_t valid) {
+        V half = Lane::set(0.5f);
+        V center[3];
+        V extent[3];
+        for (std::size_t c = 0; c < 3; ++c)
+        {
+            V a = Lane::load(box_min + c * stride);
+            V b = Lane::load(box_max + c * stride);
+            center[c] = Lane::mul(Lane::add(a, b), half);
+            extent[c] = Lane::mul(Lane::sub(b, a), half);
+        }
+
+        // The smallest signed distance of the farthest and the nearest vertex over all planes.
+        V far_distance = Lane::set(INFINITY);
+        V near_distance = far_distance;
+        for (std::size_t i = 0; i < 6; ++i)
+        {
+            V d = Lane::mul_add(normal[i][0], center[0], distance[i]);
+            d = Lane::mul_add(normal[i][1], center[1], d);
+            d = Lane::mul_add(normal[i][2], center[2], d);
+
+            V r = Lane::mul(normal_abs[i][0], extent[0]);
+            r = Lane::mul_add(normal_abs[i][1], extent[1], r);
+            r = Lane::mul_add(normal_abs[i][2], extent[2], r);
+
+            far_distance = Lane::min(far_distance, Lane::add(d, r));
+            near_distance = Lane::min(near_distance, Lane::sub(d, r));
+        }
+
+        std::uint32_t shift = static_cast<std::uint32_t>(index % 32);
+        std::uint32_t visible_bits = ~Lane::less_mask(far_distance, zero) & valid;
+        visible[index / 32] |= visible_bits << shift;
+
+        if (inside != nullptr)
+        {
+            std::uint32_t inside_bits = ~Lane::less_mask(near_distance, zero) & valid;
+            inside[index / 32] |= inside_bits << shift;
+        }
+    };
+
+    std::size_t full = count - count % W;
+    for (std::size_t i = 0; i < full; i += W)
+        cull(min + i, max + i, count, i, LANE_BITS);
+
+    std::size_t rest = count - full;
+    if (rest == 0)
+        return;
+
+    alignas(64) float min_buffer[3 * W] = {};
+    alignas(64) float max_buffer[3 * W] = {};
+    for (std::size_t c = 0; c < 3; ++c)
+    {
+        for (std::size_t j = 0; j < rest; ++j)
+        {
+            min_buffer[c * W + j] = min[c * count + full + j];
+            max_buffer[c * W + j] = max[c * count + full + j];
+        }
+    }
+    cull(min_buffer, max_buffer, W, full, (1u << rest) - 1);
+}
+
+// Gathers the first three columns of the bone matrices at index, 12 values in row order.
+template <typename Lane>
+inline void batch_gather_bone(
+    const float* bones,
+    typename Lane::value_type index,
+    typename Lane::value_type (&m)[12])
+{
+    auto offset = Lane::to_index(Lane::mul(index, Lane::set(16.0f)));
+    for (std::size_t r = 0; r < 4; ++r)
+    {
+        for (std::size_t c = 0; c < 3; ++c)
+            m[r * 3 + c] = Lane::gather(bones + r * 4 + c, offset);
+    }
+}
+
+template <typename Lane, std::size_t N>
+void batch_linear_blend(
+    const float* position,
+    const float* normal,
+    const float* index,
+    const float* weight,
+    const float4x4* bones,
+    float* result_position,
+    float* result_normal,
+    std::size_t count)
+{
+    using V = typename Lane::value_type;
+
+    batch_run<Lane>(
+        {position, normal, index, weight},
+        {3, 3, N, N},
+        {result_position, result_normal},
+        {3, 3},
+        count,
+        [bones = reinterpret_cast<const float*>(bones)](
+            const float* const* in,
+            float* const* out,
+            std::size_t stride) {
+            // Blending the matrices first costs 12 multiply adds per bone, transforming the
+            // vertex by every bone would cost 18.
+            V m[12];
+            batch_gather_bone<Lane>(bones, Lane::load(in[2]), m);
+            if constexpr (N > 1)
+            {
+                V w = Lane::load(in[3]);
+                for (V& v : m)
+                    v = Lane::mul(v, w);
+
+                for (std::size_t k = 1; k < N; ++k)
+                {
+                    V b[12];
+                    batch_gather_bone<Lane>(bones, Lane::load(in[2] + k * stride), b);
+                    w = Lane::load(in[3] + k * stride);
+                    for (std::size_t i = 0; i < 12; ++i)
+                        m[i] = Lane::mul_add(b[i], w, m[i]);
+                }
+            }
+
+            V p[3];
+            V n[3];
+            for (std::size_t i = 0; i < 3; ++i)
+            {
+                p[i] = Lane::load(in[0] + i * stride);
+                n[i] = Lane::load(in[1] + i * stride);
+            }
+
+            for (std::size_t c = 0; c < 3; ++c)
+            {
+                V rp = Lane::mul_add(p[0], m[c], m[9 + c]);
+                rp = Lane::mul_add(p[1], m[3 + c], rp);
+                rp = Lane::mul_add(p[2], m[6 + c], rp);
+                Lane::store(out[0] + c * stride, rp);
+
+                V rn = Lane::mul(n[0], m[c]);
+                rn = Lane::mul_add(n[1], m[3 + c], rn);
+                rn = Lane::mul_add(n[2], m[6 + c], rn);
+                Lane::store(out[1] + c * stride, rn);
+            }
+        });
+}
+
+template <typename Lane>
+void batch_linear_blend(
+    const float* position,
+    const float* normal,
+    const float* index,
+    const float* weight,
+    std::size_t influence_count,
+    const float4x4* bones,
+    float* result_position,
+    float* result_normal,
+    std::size_t count)
+{
+    switch (influence_count)
+    {
+    case 1:
+        batch_linear_blend<Lane, 1>(
+            position,
+            normal,
+            index,
+            weight,
+            bones,
+            result_position,
+            result_normal,
+            count);
+        break;
+    case 2:
+        batch_linear_blend<Lane, 2>(
+            position,
+            normal,
+            index,
+            weight,
+            bones,
+            result_position,
+            result_normal,
+            count);
+        break;
+    default:
+        batch_linear_blend<Lane, 4>(
+            position,
+            normal,
+            index,
+            weight,
+            bones,
+            result_position,
+            result_normal,
+            count);
+        break;
+    }
+}
+
+template <typename Lane>
+void batch_spherical_deform(
+    const float* position,
+    const float* normal,
+    const float* index,
+    const float* weight,
+    const float* center,
+    const float* r0,
+    const float* r1,
+    const float4x4* bones,
+    const float4* rotations,
+    float* result_position,
+    float* result_normal,
+    std::size_t count)
+{
+    using V = typename Lane::value_type;
+
+    batch_run<Lane>(
+        {position, normal, index, weight, center, r0, r1},
+        {3, 3, 2, 1, 3, 3, 3},
+        {result_position, result_normal},
+        {3, 3},
+        count,
+        [bones = reinterpret_cast<const float*>(bones),
+         rotations = reinterpret_cast<const float*>(rotations)](
+            const float* const* in,
+            float* const* out,
+            std::size_t stride) {
+            V index0 = Lane::load(in[2]);
+            V index1 = Lane::load(in[2] + stride);
+            V w0 = Lane::load(in[3]);
+            V w1 = Lane::sub(Lane::set(1.0f), w0);
+
+            V qa[4];
+            V qb[4];
+            auto offset0 = Lane::to_index(Lane::mul(index0, Lane::set(4.0f)));
+            auto offset1 = Lane::to_index(Lane::mul(index1, Lane::set(4.0f)));
+            for (std::size_t i = 0; i < 4; ++i)
+            {
+                qa[i] = Lane::gather(rotations + i, offset0);
+                qb[i] = Lane::gather(rotations + i, offset1);
+            }
+
+            V q[4];
+            batch_quaternion_slerp<Lane>(qa, qb, w1, q);
+
+            V x2 = Lane::add(q[0], q[0]);
+            V y2 = Lane::add(q[1], q[1]);
+            V z2 = Lane::add(q[2], q[2]);
+            V xx = Lane::mul(q[0], x2);
+            V xy = Lane::mul(q[0], y2);
+            V xz = Lane::mul(q[0], z2);
+            V xw = Lane::mul(q[3], x2);
+            V yy = Lane::mul(q[1], y2);
+            V yz = Lane::mul(q[1], z2);
+            V yw = Lane::mul(q[3], y2);
+            V zz = Lane::mul(q[2], z2);
+            V zw = Lane::mul(q[3], z2);
+
+            V one = Lane::set(1.0f);
+            V rotate[9] = {
+                Lane::sub(one, Lane::add(yy, zz)),
+                Lane::add(xy, zw),
+                Lane::sub(xz, yw),
+                Lane::sub(xy, zw),
+                Lane::sub(one, Lane::add(xx, zz)),
+                Lane::add(yz, xw),
+                Lane::add(xz, yw),
+                Lane::sub(yz, xw),
+                Lane::sub(one, Lane::add(xx, yy))};
+
+            V m0[12];
+            V m1[12];
+            batch_gather_bone<Lane>(bones, index0, m0);
+            batch_gather_bone<Lane>(bones, index1, m1);
+
+            V d[3];
+            V n[3];
+            V a[3];
+            V b[3];
+            for (std::size_t i = 0; i < 3; ++i)
+            {
+                d[i] = Lane::sub(Lane::load(in[0] + i * stride), Lane::load(in[4] + i * stride));
+                n[i] = Lane::load(in[1] + i * stride);
+                a[i] = Lane::load(in[5] + i * stride);
+                b[i] = Lane::load(in[6] + i * stride);
+            }
+
+            for (std::size_t c = 0; c < 3; ++c)
+            {
+                V ra = Lane::mul_add(a[0], m0[c], m0[9 + c]);
+                ra = Lane::mul_add(a[1], m0[3 + c], ra);
+                ra = Lane::mul_add(a[2], m0[6 + c], ra);
+
+                V rb = Lane::mul_add(b[0], m1[c], m1[9 + c]);
+                rb = Lane::mul_add(b[1], m1[3 + c], rb);
+                rb = Lane::mul_add(b[2], m1[6 + c], rb);
+
+                V rp = Lane::mul_add(ra, w0, Lane::mul(rb, w1));
+                rp = Lane::mul_add(d[0], rotate[c], rp);
+                rp = Lane::mul_add(d[1], rotate[3 + c], rp);
+                rp = Lane::mul_add(d[2], rotate[6 + c], rp);
+                Lane::store(out[0] + c * stride, rp);
+
+                V rn = Lane::mul(n[0], rotate[c]);
+                rn = Lane::mul_add(n[1], rotate[3 + c], rn);
+                rn = Lane::mul_add(n[2], rotate[6 + c], rn);
+                Lane::store(out[1] + c * stride, rn);
+            }
+        });
+}
+
+template <typename Lane>
+const batch_kernels& make_batch_kernels() noexcept
+{
+    static constexpr batch_kernels kernels = {
+        &batch_matrix_mul<Lane>,
+        &batch_matrix_inverse<Lane>,
+        &batch_affine_transform<Lane>,
+        &batch_slerp<Lane>,
+        &batch_bounding_box_transform<Lane>,
+        &batch_frustum_culling<Lane>,
+        &batch_linear_blend<Lane>,
+        &batch_spherical_deform<Lane>};
+    return kernels;
+}
+} // namespace
+} // namespace ash::math
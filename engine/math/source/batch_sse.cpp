@@ -0,0 +1,9 @@
+#include "batch_kernel.hpp"
+
+namespace ash::math
+{
+const batch_kernels& batch_kernels_sse() noexcept
+{
+    return make_batch_kernels<simd_lane<4>>();
+}
+} // namespace ash::math
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "math/batch.hpp"
+
+namespace ash::math
+{
+// Each kernel source is compiled for its own instruction set, internal linkage keeps the linker
+// from merging instantiations compiled for different instruction sets.
+namespace
+{
+/**
+ * @brief Uniform lane operations over the SIMD register types, the batch kernels are written once
+ * against this interface and instantiated for every lane count.
+ */
+template <std::size_t Size>
+struct simd_lane;
+
+template <>
+struct simd_lane<4>
+{
+    using value_type = float4_simd;
+    using index_type = __m128i;
+    static constexpr std::size_t SIZE = 4;
+
+    static inline value_type load(const float* p) { return _mm_loadu_ps(p); }
+    static inline void store(float* p, value_type v) { _mm_storeu_ps(p, v); }
+    static inline value_type set(float v) { return _mm_set_ps1(v); }
+
+    // Element offsets stored as floats, truncated.
+    static inline index_type to_index(value_type v) { return _mm_cvttps_epi32(v); }
+
+    // base[index[i]]
+    static inline value_type gather(const float* base, index_type index)
+    {
+        alignas(16) std::int32_t i[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(i), index);
+        return _mm_setr_ps(base[i[0]], base[i[1]], base[i[2]], base[i[3]]);
+    }
+
+    static inline value_type add(value_type a, value_type b) { return _mm_add_ps(a, b); }
+    static inline value_type sub(value_type a, value_type b) { return _mm_sub_ps(a, b); }
+    static inline value_type mul(value_type a, value_type b) { return _mm_mul_ps(a, b); }
+    static inline value_type div(value_type a, value_type b) { return _mm_div_ps(a, b); }
+    static inline value_type sqrt(value_type v) { return _mm_sqrt_ps(v); }
+
+    // a * b + c
+    static inline value_type mul_add(value_type a, value_type b, value_type c)
+    {
+        return _mm_add_ps(_mm_mul_ps(a, b), c);
+    }
+
+    static inline value_type min(value_type a, value_type b) { return _mm_min_ps(a, b); }
+    static inline value_type max(value_type a, value_type b) { return _mm_max_ps(a, b); }
+
+    // a < b ? x : y
+    static inline value_type select_less(value_type a, value_type b, value_type x, value_type y)
+    {
+        __m128 mask = _mm_cmplt_ps(a, b);
+        return _mm_or_ps(_mm_and_ps(mask, x), _mm_andnot_ps(mask, y));
+    }
+
+    // Bit i is set when a[i] < b[i].
+    static inline std::uint32_t less_mask(value_type a, value_type b)
+    {
+        return static_cast<std::uint32_t>(_mm_movemask_ps(_mm_cmplt_ps(a, b)));
+    }
+};
+
+#if defined(__AVX2__)
+template <>
+struct simd_lane<8>
+{
+    using value_type = float8_simd;
+    using index_type = __m256i;
+    static constexpr std::size_t SIZE = 8;
+
+    static inline value_type load(const float* p) { return _mm256_loadu_ps(p); }
+    static inline void store(float* p, value_type v) { _mm256_storeu_ps(p, v); }
+    static inline value_type set(float v) { return _mm256_set1_ps(v); }
+
+    static inline index_type to_index(value_type v) { return _mm256_cvttps_epi32(v); }
+
+    static inline value_type gather(const float* base, index_type index)
+    {
+        return _mm256_i32gather_ps(base, index, 4);
+    }
+
+    static inline value_type add(value_type a, value_type b) { return _mm256_add_ps(a, b); }
+    static inline value_type sub(value_type a, value_type b) { return _mm256_sub_ps(a, b); }
+    static inline value_type mul(value_type a, value_type b) { return _mm256_mul_ps(a, b); }
+    static inline value_type div(value_type a, value_type b) { return _mm256_div_ps(a, b); }
+    static inline value_type sqrt(value_type v) { return _mm256_sqrt_ps(v); }
+
+    static inline value_type mul_add(value_type a, value_type b, value_type c)
+    {
+        return _mm256_fmadd_ps(a, b, c);
+    }
+
+    static inline value_type min(value_type a, value_type b) { return _mm256_min_ps(a, b); }
+    static inline value_type max(value_type a, value_type b) { return _mm256_max_ps(a, b); }
+
+    static inline value_type select_less(value_type a, value_type b, value_type x, value_type y)
+    {
+        return _mm256_blendv_ps(y, x, _mm256_cmp_ps(a, b, _CMP_LT_OQ));
+    }
+
+    static inline std::uint32_t less_mask(value_type a, value_type b)
+    {
+        return static_cast<std::uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_LT_OQ)));
+    }
+};
+#endif
+
+#if defined(__AVX512F__)
+template <>
+struct simd_lane<16>
+{
+    using value_type = float16_simd;
+    using index_type = __m512i;
+    static constexpr std::size_t SIZE = 16;
+
+    static inline value_type load(const float* p) { return _mm512_loadu_ps(p); }
+    static inline void store(float* p, value_type v) { _mm512_storeu_ps(p, v); }
+    static inline value_type set(float v) { return _mm512_set1_ps(v); }
+
+    static inline index_type to_index(value_type v) { return _mm512_cvttps_epi32(v); }
+
+    static inline value_type gather(const float* base, index_type index)
+    {
+        return _mm512_i32gather_ps(index, base, 4);
+    }
+
+    static inline value_type add(value_type a, value_type b) { return _mm512_add_ps(a, b); }
+    static inline value_type sub(value_type a, value_type b) { return _mm512_sub_ps(a, b); }
+    static inline value_type mul(value_type a, value_type b) { return _mm512_mul_ps(a, b); }
+    static inline value_type div(value_type a, value_type b) { return _mm512_div_ps(a, b); }
+    static inline value_type sqrt(value_type v) { return _mm512_sqrt_ps(v); }
+
+    static inline value_type mul_add(value_type a, value_type b, value_type c)
+    {
+        return _mm512_fmadd_ps(a, b, c);
+    }
+
+    static inline value_type min(value_type a, value_type b) { return _mm512_min_ps(a, b); }
+    static inline value_type max(value_type a, value_type b) { return _mm512_max_ps(a, b); }
+
+    static inline value_type select_less(value_type a, value_type b, value_type x, value_type y)
+    {
+        return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(a, b, _CMP_LT_OQ), y, x);
+    }
+
+    static inline std::uint32_t less_mask(value_type a, value_type b)
+    {
+        return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ);
+    }
+};
+#endif
+} // namespace
+} // namespace ash::math
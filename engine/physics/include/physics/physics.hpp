@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/context.hpp"
+#include "core/event.hpp"
 #include "ecs/world.hpp"
 #include "physics/joint.hpp"
 #include "physics/physics_plugin.hpp"
@@ -38,9 +39,18 @@ public:
             m_plugin.factory().make_collision_shape(child, offset, size));
     }
 
+    /**
+     * @brief Adds rigidbodies of entities that entered the scene and moves kinematic rigidbodies to
+     * the transforms edited this frame. The world itself is stepped by the TASK_PHYSICS_STEP task
+     * of the fixed step graph, which syncs the scene before the step and writes dynamic rigidbodies
+     * back to their local transforms after it.
+     */
     void simulation();
 
 private:
+    void step();
+    void sync_kinematic();
+
     void initialize_entity(ecs::entity entity);
 
     std::unique_ptr<world_interface> m_world;
@@ -50,6 +60,8 @@ private:
     std::queue<ecs::entity> m_enter_world_list;
     std::queue<ecs::entity> m_exit_world_list;
 
+    core::event_handle m_enter_scene_handle;
+
     physics_plugin m_plugin;
 };
 } // namespace ash::physics
\ No newline at end of file
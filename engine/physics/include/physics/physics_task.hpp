@@ -0,0 +1,6 @@
+#pragma once
+
+namespace ash::physics
+{
+static constexpr char TASK_PHYSICS_STEP[] = "physics step";
+}
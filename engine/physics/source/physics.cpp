@@ -1,8 +1,10 @@
 #include "physics/physics.hpp"
 #include "core/relation.hpp"
 #include "core/timer.hpp"
+#include "physics/physics_task.hpp"
 #include "scene/scene.hpp"
 #include "scene/scene_event.hpp"
+#include "task/task_manager.hpp"
 
 #if defined(ASH_PHYSICS_DEBUG_DRAW)
 #    include "graphics/graphics.hpp"
@@ -38,7 +40,7 @@ private:
 };
 #endif
 
-physics::physics() noexcept : system_base("physics")
+physics::physics() noexcept : system_base("physics"), m_enter_scene_handle(0)
 {
 }
 
@@ -65,16 +67,21 @@ bool physics::initialize(const dictionary& config)
     world.register_component<joint>();
 
     auto& event = system<core::event>();
-    event.subscribe<scene::event_enter_scene>("physics", [this](ecs::entity entity) {
+    m_enter_scene_handle = event.subscribe<scene::event_enter_scene>([this](ecs::entity entity) {
         m_enter_world_list.push(entity);
     });
 
+    auto& task = system<task::task_manager>();
+    auto step_task = task.schedule(TASK_PHYSICS_STEP, [this]() { step(); });
+    step_task->add_dependency(*task.find(task::TASK_FIXED_LOGIC_START));
+    task.find(task::TASK_FIXED_LOGIC_END)->add_dependency(*step_task);
+
     return true;
 }
 
 void physics::shutdown()
 {
-    system<core::event>().unsubscribe<scene::event_enter_scene>("physics");
+    system<core::event>().unsubscribe<scene::event_enter_scene>(m_enter_scene_handle);
 
     auto& world = system<ecs::world>();
     world.view<joint>().each([](joint& joint) { joint.reset_interface(nullptr); });
@@ -86,8 +93,6 @@ void physics::shutdown()
 
 void physics::simulation()
 {
-    auto& world = system<ecs::world>();
-
     system<scene::scene>().sync_local();
 
     while (!m_enter_world_list.empty())
@@ -96,20 +101,25 @@ void physics::simulation()
         m_enter_world_list.pop();
     }
 
-    world.view<rigidbody, scene::transform>().each(
-        [&](rigidbody& rigidbody, scene::transform& transform) {
-            if (rigidbody.type() == rigidbody_type::KINEMATIC && transform.sync_count() != 0)
-            {
-                math::float4x4_simd to_world = math::simd::load(transform.to_world());
-                math::float4x4_simd offset = math::simd::load(rigidbody.offset());
+    sync_kinematic();
 
-                math::float4x4 rigidbody_to_world;
-                math::simd::store(math::matrix_simd::mul(offset, to_world), rigidbody_to_world);
-                rigidbody.interface()->transform(rigidbody_to_world);
-            }
-        });
+#if defined(ASH_PHYSICS_DEBUG_DRAW)
+    m_world->debug();
+#endif
+}
+
+void physics::step()
+{
+    auto& world = system<ecs::world>();
+    auto& scene = system<scene::scene>();
 
-    m_world->simulation(system<core::timer>().frame_delta());
+    // Runs once per fixed step after scene saved the previous matrices, so the transforms written
+    // here are the end points of the interpolation. Local edits are synced first so kinematic
+    // rigidbodies enter the step at their latest pose.
+    scene.sync_local();
+    sync_kinematic();
+
+    m_world->simulation(system<core::timer>().fixed_delta());
 
     while (true)
     {
@@ -123,11 +133,29 @@ void physics::simulation()
         r.sync_world(updated->transform(), t);
     }
 
-    system<scene::scene>().sync_world();
+    // Write the new world matrices back to position, rotation and scale, otherwise the next
+    // sync_local rebuilds them from the stale local values.
+    scene.sync_world();
+}
 
-#if defined(ASH_PHYSICS_DEBUG_DRAW)
-    m_world->debug();
-#endif
+void physics::sync_kinematic()
+{
+    auto& world = system<ecs::world>();
+    world.view<rigidbody, scene::transform>().each(
+        [&](rigidbody& rigidbody, scene::transform& transform) {
+            if (rigidbody.interface() == nullptr)
+                return;
+
+            if (rigidbody.type() == rigidbody_type::KINEMATIC && transform.sync_count() != 0)
+            {
+                math::float4x4_simd to_world = math::simd::load(transform.to_world());
+                math::float4x4_simd offset = math::simd::load(rigidbody.offset());
+
+                math::float4x4 rigidbody_to_world;
+                math::simd::store(math::matrix_simd::mul(offset, to_world), rigidbody_to_world);
+                rigidbody.interface()->transform(rigidbody_to_world);
+            }
+        });
 }
 
 void physics::initialize_entity(ecs::entity entity)
@@ -162,6 +190,10 @@ void physics::initialize_entity(ecs::entity entity)
             m_user_data.push_back({node});
         }
 
+        // Dynamic rigidbodies only move on fixed steps, render them between the last two.
+        if (r.type() == rigidbody_type::DYNAMIC)
+            transform.interpolation(true);
+
         m_world->add(r.interface(), r.collision_group(), r.collision_mask());
     };
 
@@ -79,7 +79,8 @@ void bt3_world::remove(rigidbody_interface* rigidbody)
 void bt3_world::simulation(float time_step)
 {
     m_updated_rigidbodies.clear();
-    m_world->stepSimulation(time_step);
+    // The engine drives fixed stepping, so bullet advances exactly one step here.
+    m_world->stepSimulation(time_step, 0);
 
 #ifndef NDEBUG
     if (m_world->getDebugDrawer())
@@ -4,9 +4,13 @@
 #include "d3d12_frame_resource.hpp"
 #include <mutex>
 #include <queue>
+#include <vector>
 
 namespace ash::graphics::d3d12
 {
+class d3d12_resource;
+class d3d12_frame_buffer;
+
 class d3d12_render_command : public render_command_interface
 {
 public:
@@ -23,6 +27,7 @@ public:
     virtual void scissor(const scissor_extent* extents, std::size_t size) override;
 
     virtual void parameter(std::size_t index, pipeline_parameter_interface* parameter) override;
+    virtual void constant(std::size_t index, const void* data, std::size_t size) override;
 
     virtual void input_assembly_state(
         resource_interface* const* vertex_buffers,
@@ -35,6 +40,12 @@ public:
         std::size_t index_start,
         std::size_t index_end,
         std::size_t vertex_base) override;
+    virtual void draw_indexed_instanced(
+        std::size_t index_start,
+        std::size_t index_end,
+        std::size_t vertex_base,
+        std::size_t instance_start,
+        std::size_t instance_count) override;
 
     virtual void clear_render_target(resource_interface* render_target, const math::float4& color)
         override;
@@ -46,6 +57,24 @@ public:
     virtual void compute_parameter(std::size_t index, pipeline_parameter_interface* parameter)
         override;
 
+    /**
+     * @brief Moves a resource into state. Commands are recorded in parallel, so the states are
+     * tracked per command: the first state a resource is used in is only resolved in execute
+     * order, see resolve_transitions.
+     */
+    void transition(d3d12_resource* resource, D3D12_RESOURCE_STATES state);
+
+    // Records the transitions added since the last flush.
+    void flush_transitions();
+
+    /**
+     * @brief Called in execute order. Records the barriers from the states left by the commands
+     * executed before into a list that must execute right before this command.
+     *
+     * @return The closed list, nullptr when no barrier is needed.
+     */
+    D3D12GraphicsCommandList* resolve_transitions();
+
     void allocator(D3D12CommandAllocator* allocator) noexcept;
     void reset();
     void close();
@@ -53,8 +82,23 @@ public:
     D3D12GraphicsCommandList* get() { return m_command_list.Get(); }
 
 private:
+    struct resource_state
+    {
+        d3d12_resource* resource;
+        D3D12_RESOURCE_STATES initial; // State the command expects when it starts.
+        D3D12_RESOURCE_STATES current; // State the command leaves behind.
+    };
+
     d3d12_ptr<D3D12GraphicsCommandList> m_command_list;
+    d3d12_ptr<D3D12GraphicsCommandList> m_transition_list;
     D3D12CommandAllocator* m_allocator;
+
+    std::vector<resource_state> m_resource_states;
+    std::vector<D3D12_RESOURCE_BARRIER> m_barriers;
+
+    // Render pipeline being recorded.
+    d3d12_frame_buffer* m_frame_buffer;
+    std::size_t m_pass_index;
 };
 
 class d3d12_dynamic_command
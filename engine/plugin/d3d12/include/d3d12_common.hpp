@@ -70,4 +70,7 @@ struct d3d12_utility
 
 static constexpr DXGI_FORMAT RENDER_TARGET_FORMAT = DXGI_FORMAT_R8G8B8A8_UNORM;
 static constexpr DXGI_FORMAT DEPTH_STENCIL_FORMAT = DXGI_FORMAT_D24_UNORM_S8_UINT;
+
+// Upload ring memory of each frame resource.
+static constexpr std::size_t UPLOAD_RING_FRAME_SIZE = 8 * 1024 * 1024;
 } // namespace ash::graphics::d3d12
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "d3d12_common.hpp"
 #include "d3d12_resource.hpp"
+#include <mutex>
 #include <string_view>
 #include <unordered_map>
 
@@ -34,6 +35,12 @@ public:
 
     inline std::size_t constant_buffer_size() const noexcept { return m_constant_buffer_size; }
 
+    // Number of 32 bit root constants, see PIPELINE_PARAMETER_TYPE_CONSTANT.
+    inline std::size_t root_constant_count() const noexcept
+    {
+        return m_root_constant_size / sizeof(std::uint32_t);
+    }
+
 private:
     struct parameter_info
     {
@@ -49,6 +56,7 @@ private:
     std::size_t m_uav_count;
 
     std::size_t m_constant_buffer_size;
+    std::size_t m_root_constant_size;
 };
 
 enum class d3d12_parameter_tier_type
@@ -146,6 +154,7 @@ struct d3d12_camera_info
     }
 };
 
+class d3d12_render_command;
 class d3d12_render_pipeline;
 class d3d12_frame_buffer
 {
@@ -160,8 +169,8 @@ public:
 public:
     d3d12_frame_buffer(d3d12_render_pipeline* pipeline, const d3d12_camera_info& camera_info);
 
-    void begin_render(D3D12GraphicsCommandList* command_list);
-    void end_render(D3D12GraphicsCommandList* command_list);
+    void begin_render(d3d12_render_command* command);
+    void end_render(d3d12_render_command* command);
 
     const std::vector<attachment_info>& attachments() const noexcept { return m_attachments; }
 
@@ -179,7 +188,7 @@ public:
     d3d12_render_pass(const render_pass_desc& desc);
 
     void begin(D3D12GraphicsCommandList* command_list, d3d12_frame_buffer* frame_buffer);
-    void end(D3D12GraphicsCommandList* command_list, bool final = false);
+    void end(d3d12_render_command* command, d3d12_frame_buffer* frame_buffer, bool final = false);
     inline D3D12PipelineState* pipeline_state() const noexcept { return m_pipeline_state.Get(); }
 
 private:
@@ -191,8 +200,6 @@ private:
     std::unique_ptr<d3d12_root_signature> m_root_signature;
     d3d12_ptr<D3D12PipelineState> m_pipeline_state;
 
-    d3d12_frame_buffer* m_current_frame_buffer;
-
     std::vector<std::size_t> m_color_indices;
     std::size_t m_depth_index;
     // first: resolve target, second: resolve source
@@ -204,9 +211,17 @@ class d3d12_render_pipeline : public render_pipeline_interface
 public:
     d3d12_render_pipeline(const render_pipeline_desc& desc);
 
-    void begin(D3D12GraphicsCommandList* command_list, const d3d12_camera_info& camera_info);
-    void end(D3D12GraphicsCommandList* command_list);
-    void next(D3D12GraphicsCommandList* command_list);
+    // The frame buffer and the pass index are kept by the command, several commands may record
+    // the same pipeline at once.
+    d3d12_frame_buffer* begin(d3d12_render_command* command, const d3d12_camera_info& camera_info);
+    void end(
+        d3d12_render_command* command,
+        d3d12_frame_buffer* frame_buffer,
+        std::size_t pass_index);
+    void next(
+        d3d12_render_command* command,
+        d3d12_frame_buffer* frame_buffer,
+        std::size_t pass_index);
 
     const d3d12_frame_buffer_layout& frame_buffer_layout() const noexcept
     {
@@ -224,9 +239,6 @@ private:
         D3D12_CPU_DESCRIPTOR_HANDLE depth_stencil;
     };
 
-    std::size_t m_current_index;
-    d3d12_frame_buffer* m_current_frame_buffer;
-
     d3d12_frame_buffer_layout m_frame_buffer_layout;
 };
 
@@ -265,6 +277,7 @@ private:
         std::unique_ptr<d3d12_frame_buffer>,
         d3d12_camera_info_hash>
         m_frame_buffers;
+    std::mutex m_lock;
 };
 
 class d3d12_compute_pipeline : public compute_pipeline_interface
@@ -3,6 +3,8 @@
 #include "d3d12_common.hpp"
 #include "d3d12_context.hpp"
 #include "d3d12_descriptor_heap.hpp"
+#include <mutex>
+#include <vector>
 
 namespace ash::graphics::d3d12
 {
@@ -26,6 +28,7 @@ public:
 
     virtual void* pointer() override;
     virtual void upload(const void* data, std::size_t size, std::size_t offset) override;
+    virtual void* map(std::size_t size, std::size_t offset) override;
 
     inline void resource_state(D3D12_RESOURCE_STATES state) noexcept { m_resource_state = state; }
     inline D3D12_RESOURCE_STATES resource_state() const noexcept { return m_resource_state; }
@@ -163,6 +166,72 @@ private:
     void* m_mapped;
 };
 
+struct d3d12_upload_allocation
+{
+    void* pointer;
+    D3D12_GPU_VIRTUAL_ADDRESS address;
+};
+
+/**
+ * @brief Upload heap mapped once and split into a region per frame resource. Allocations are
+ * linear in the region of the current frame, which is reused after the fence of the frame it was
+ * last used by has completed. Allocations that do not fit get their own upload heap that lives for
+ * one frame.
+ */
+class d3d12_upload_ring
+{
+public:
+    d3d12_upload_ring(std::size_t frame_size);
+    ~d3d12_upload_ring();
+
+    d3d12_upload_allocation allocate(std::size_t size, std::size_t alignment);
+
+    void switch_frame_resources();
+
+    D3D12Resource* handle() const noexcept { return m_resource.Get(); }
+
+private:
+    d3d12_ptr<D3D12Resource> m_resource;
+    std::uint8_t* m_mapped;
+
+    std::size_t m_frame_size;
+    std::size_t m_offset;
+
+    d3d12_frame_resource<std::vector<d3d12_ptr<D3D12Resource>>> m_overflow;
+
+    std::mutex m_lock;
+};
+
+/**
+ * @brief Frame resource buffers that live in the upload ring. The ring reuses memory
+ * frame_resource_count frames after it was allocated, so the resource manager refreshes these
+ * buffers at the start of each frame, and those that were not written since copy their contents
+ * into new memory.
+ *
+ * The ring is write combined and must not be read, so writes go to a shadow copy in system memory
+ * and the resource manager flushes the written range to the ring before the frame executes.
+ */
+class d3d12_ring_resource
+{
+public:
+    d3d12_ring_resource();
+    virtual ~d3d12_ring_resource() = default;
+
+    virtual void refresh_frame_resource() = 0;
+    virtual void flush_frame_resource() = 0;
+
+protected:
+    // Marks [offset, offset + size) as written this frame and returns it in the shadow copy.
+    void* write_shadow(std::size_t size, std::size_t offset);
+
+    // Copies the range written since the last flush to target.
+    void flush_shadow(void* target);
+
+    std::vector<std::uint8_t> m_shadow;
+    std::size_t m_dirty_begin;
+    std::size_t m_dirty_end;
+};
+
 class d3d12_vertex_buffer : public d3d12_resource
 {
 public:
@@ -193,32 +262,42 @@ private:
     std::size_t m_uav_offset;
 };
 
-class d3d12_vertex_buffer_dynamic : public d3d12_vertex_buffer
+class d3d12_vertex_buffer_dynamic : public d3d12_vertex_buffer, public d3d12_ring_resource
 {
 public:
     d3d12_vertex_buffer_dynamic(const vertex_buffer_desc& desc);
-    virtual ~d3d12_vertex_buffer_dynamic() = default;
+    virtual ~d3d12_vertex_buffer_dynamic();
 
-    virtual void* pointer() override { return m_buffer->pointer(); }
+    virtual void* pointer() override;
     virtual void upload(const void* data, std::size_t size, std::size_t offset) override;
+    virtual void* map(std::size_t size, std::size_t offset) override;
 
     virtual const D3D12_VERTEX_BUFFER_VIEW& view() const noexcept override;
     virtual D3D12_CPU_DESCRIPTOR_HANDLE srv() const override;
     virtual D3D12_CPU_DESCRIPTOR_HANDLE uav() const override;
 
-    virtual D3D12Resource* handle() const noexcept override { return m_buffer->handle(); }
-    virtual std::size_t size() const noexcept override { return m_buffer->size(); }
+    virtual D3D12Resource* handle() const noexcept override;
+    virtual std::size_t size() const noexcept override { return m_size; }
+
+    virtual void refresh_frame_resource() override;
+    virtual void flush_frame_resource() override;
 
 private:
+    void sync_frame_resource();
+
+    // Frame resources live in the upload ring instead, unless compute uses them, then the buffer
+    // holds one copy per frame resource. Copies are used in turn and only change when written.
     std::unique_ptr<d3d12_upload_buffer> m_buffer;
 
     std::size_t m_size;
     bool m_frame_resource;
 
-    std::vector<D3D12_VERTEX_BUFFER_VIEW> m_views;
+    void* m_mapped;
+    D3D12_VERTEX_BUFFER_VIEW m_view;
     std::size_t m_srv_offset;
     std::size_t m_uav_offset;
 
+    // Copy of the current frame, the descriptors of each copy follow each other.
     std::size_t m_current_index;
     std::size_t m_last_sync_frame;
 };
@@ -253,27 +332,35 @@ private:
     D3D12_INDEX_BUFFER_VIEW m_view;
 };
 
-class d3d12_index_buffer_dynamic : public d3d12_index_buffer
+class d3d12_index_buffer_dynamic : public d3d12_index_buffer, public d3d12_ring_resource
 {
 public:
     d3d12_index_buffer_dynamic(const index_buffer_desc& desc);
+    virtual ~d3d12_index_buffer_dynamic();
 
-    virtual void* pointer() override { return m_buffer->pointer(); }
+    virtual void* pointer() override;
     virtual void upload(const void* data, std::size_t size, std::size_t offset) override;
+    virtual void* map(std::size_t size, std::size_t offset) override;
 
     virtual const D3D12_INDEX_BUFFER_VIEW& view() const noexcept override;
-    virtual D3D12Resource* handle() const noexcept override { return m_buffer->handle(); }
-    virtual std::size_t size() const noexcept override { return m_buffer->size(); }
+    virtual D3D12Resource* handle() const noexcept override;
+    virtual std::size_t size() const noexcept override { return m_size; }
+
+    virtual void refresh_frame_resource() override;
+    virtual void flush_frame_resource() override;
 
 private:
+    void sync_frame_resource();
+
+    // Frame resources live in the upload ring instead.
     std::unique_ptr<d3d12_upload_buffer> m_buffer;
 
     std::size_t m_size;
     bool m_frame_resource;
 
-    std::vector<D3D12_INDEX_BUFFER_VIEW> m_views;
+    void* m_mapped;
+    D3D12_INDEX_BUFFER_VIEW m_view;
 
-    std::size_t m_current_index;
     std::size_t m_last_sync_frame;
 };
 
@@ -297,6 +384,14 @@ public:
         return m_visible_heaps[type].get();
     }
 
+    d3d12_upload_ring& upload_ring() noexcept { return *m_upload_ring; }
+
+    void register_ring_resource(d3d12_ring_resource* resource);
+    void unregister_ring_resource(d3d12_ring_resource* resource);
+
+    // Copies what was written to ring resources this frame to the ring, before it executes.
+    void flush_ring_resources();
+
     void delay_delete(d3d12_ptr<D3D12Resource> resource);
     void switch_frame_resources();
 
@@ -304,6 +399,10 @@ private:
     heap_list m_heaps;
     heap_list m_visible_heaps;
 
+    std::unique_ptr<d3d12_upload_ring> m_upload_ring;
+    std::vector<d3d12_ring_resource*> m_ring_resources;
+    std::mutex m_ring_lock;
+
     d3d12_frame_resource<temporary_list> m_temporary;
 };
 } // namespace ash::graphics::d3d12
\ No newline at end of file
@@ -2,11 +2,14 @@
 #include "d3d12_context.hpp"
 #include "d3d12_pipeline.hpp"
 #include "d3d12_utility.hpp"
+#include <algorithm>
 
 namespace ash::graphics::d3d12
 {
 d3d12_render_command::d3d12_render_command(D3D12CommandAllocator* allocator, std::wstring_view name)
-    : m_allocator(allocator)
+    : m_allocator(allocator),
+      m_frame_buffer(nullptr),
+      m_pass_index(0)
 {
     auto device = d3d12_context::device();
     throw_if_failed(device->CreateCommandList(
@@ -18,6 +21,14 @@ d3d12_render_command::d3d12_render_command(D3D12CommandAllocator* allocator, std
 
     m_command_list->SetName(name.data());
     m_command_list->Close();
+
+    throw_if_failed(device->CreateCommandList(
+        0,
+        D3D12_COMMAND_LIST_TYPE_DIRECT,
+        allocator,
+        nullptr,
+        IID_PPV_ARGS(&m_transition_list)));
+    m_transition_list->Close();
 }
 
 void d3d12_render_command::begin(
@@ -31,19 +42,22 @@ void d3d12_render_command::begin(
         .render_target = static_cast<d3d12_resource*>(render_target),
         .render_target_resolve = static_cast<d3d12_resource*>(render_target_resolve),
         .depth_stencil_buffer = static_cast<d3d12_resource*>(depth_stencil_buffer)};
-    rp->begin(m_command_list.Get(), info);
+    m_frame_buffer = rp->begin(this, info);
+    m_pass_index = 0;
 }
 
 void d3d12_render_command::end(render_pipeline_interface* pipeline)
 {
     auto rp = static_cast<d3d12_render_pipeline*>(pipeline);
-    rp->end(m_command_list.Get());
+    rp->end(this, m_frame_buffer, m_pass_index);
+    m_frame_buffer = nullptr;
 }
 
 void d3d12_render_command::next_pass(render_pipeline_interface* pipeline)
 {
     auto rp = static_cast<d3d12_render_pipeline*>(pipeline);
-    rp->next(m_command_list.Get());
+    rp->next(this, m_frame_buffer, m_pass_index);
+    ++m_pass_index;
 }
 
 void d3d12_render_command::parameter(std::size_t index, pipeline_parameter_interface* parameter)
@@ -70,6 +84,15 @@ void d3d12_render_command::parameter(std::size_t index, pipeline_parameter_inter
     }
 }
 
+void d3d12_render_command::constant(std::size_t index, const void* data, std::size_t size)
+{
+    m_command_list->SetGraphicsRoot32BitConstants(
+        static_cast<UINT>(index),
+        static_cast<UINT>(size / sizeof(std::uint32_t)),
+        data,
+        0);
+}
+
 void d3d12_render_command::scissor(const scissor_extent* extents, std::size_t size)
 {
     std::vector<D3D12_RECT> r;
@@ -138,17 +161,36 @@ void d3d12_render_command::draw_indexed(
         0);
 }
 
+void d3d12_render_command::draw_indexed_instanced(
+    std::size_t index_start,
+    std::size_t index_end,
+    std::size_t vertex_base,
+    std::size_t instance_start,
+    std::size_t instance_count)
+{
+    m_command_list->DrawIndexedInstanced(
+        static_cast<UINT>(index_end - index_start),
+        static_cast<UINT>(instance_count),
+        static_cast<UINT>(index_start),
+        static_cast<UINT>(vertex_base),
+        static_cast<UINT>(instance_start));
+}
+
 void d3d12_render_command::clear_render_target(
     resource_interface* render_target,
     const math::float4& color)
 {
     auto rt = static_cast<d3d12_resource*>(render_target);
+    transition(rt, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    flush_transitions();
     m_command_list->ClearRenderTargetView(rt->rtv(), color.data, 0, nullptr);
 }
 
 void d3d12_render_command::clear_depth_stencil(resource_interface* depth_stencil)
 {
     auto ds = static_cast<d3d12_resource*>(depth_stencil);
+    transition(ds, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+    flush_transitions();
     m_command_list->ClearDepthStencilView(
         ds->dsv(),
         D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL,
@@ -208,6 +250,60 @@ void d3d12_render_command::compute_parameter(
     }
 }
 
+void d3d12_render_command::transition(d3d12_resource* resource, D3D12_RESOURCE_STATES state)
+{
+    auto iter = std::find_if(
+        m_resource_states.begin(),
+        m_resource_states.end(),
+        [resource](const resource_state& s) { return s.resource == resource; });
+
+    if (iter == m_resource_states.end())
+    {
+        m_resource_states.push_back({resource, state, state});
+    }
+    else if (iter->current != state)
+    {
+        m_barriers.push_back(
+            CD3DX12_RESOURCE_BARRIER::Transition(resource->handle(), iter->current, state));
+        iter->current = state;
+    }
+}
+
+void d3d12_render_command::flush_transitions()
+{
+    if (!m_barriers.empty())
+    {
+        m_command_list->ResourceBarrier(static_cast<UINT>(m_barriers.size()), m_barriers.data());
+        m_barriers.clear();
+    }
+}
+
+D3D12GraphicsCommandList* d3d12_render_command::resolve_transitions()
+{
+    for (auto& state : m_resource_states)
+    {
+        if (state.resource->resource_state() != state.initial)
+        {
+            m_barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(
+                state.resource->handle(),
+                state.resource->resource_state(),
+                state.initial));
+        }
+        state.resource->resource_state(state.current);
+    }
+
+    if (m_barriers.empty())
+        return nullptr;
+
+    // The command list is closed by now, so the allocator is free to record another one.
+    throw_if_failed(m_transition_list->Reset(m_allocator, nullptr));
+    m_transition_list->ResourceBarrier(static_cast<UINT>(m_barriers.size()), m_barriers.data());
+    throw_if_failed(m_transition_list->Close());
+    m_barriers.clear();
+
+    return m_transition_list.Get();
+}
+
 void d3d12_render_command::allocator(D3D12CommandAllocator* allocator) noexcept
 {
     m_allocator = allocator;
@@ -216,6 +312,9 @@ void d3d12_render_command::allocator(D3D12CommandAllocator* allocator) noexcept
 void d3d12_render_command::reset()
 {
     throw_if_failed(m_command_list->Reset(m_allocator, nullptr));
+    m_resource_states.clear();
+    m_barriers.clear();
+    m_frame_buffer = nullptr;
 }
 
 void d3d12_render_command::close()
@@ -370,9 +469,14 @@ void d3d12_command_queue::execute_batch()
         m_batch.clear();
     }
 
-    // execute render command
+    // execute render command, in the order they were allocated. Each command may be preceded by
+    // the barriers that bring its resources from the states left by the commands before it.
     for (std::size_t i = 0; i < m_render_command_counter; ++i)
+    {
+        if (auto transition_list = m_render_command[i]->resolve_transitions())
+            m_batch.push_back(transition_list);
         m_batch.push_back(m_render_command[i]->get());
+    }
 
     m_queue->ExecuteCommandLists(static_cast<UINT>(m_batch.size()), m_batch.data());
     m_batch.clear();
@@ -84,6 +84,7 @@ void d3d12_context::on_shutdown()
 
 void d3d12_context::on_present()
 {
+    m_resource->flush_ring_resources();
     m_command->execute_batch();
     m_swap_chain->present();
 
@@ -1,4 +1,5 @@
 #include "d3d12_pipeline.hpp"
+#include "d3d12_command.hpp"
 #include "d3d12_context.hpp"
 #include "d3d12_utility.hpp"
 #include <d3dcompiler.h>
@@ -235,7 +236,8 @@ d3d12_pipeline_parameter_layout::d3d12_pipeline_parameter_layout(
     : m_cbv_count(0),
       m_srv_count(0),
       m_uav_count(0),
-      m_constant_buffer_size(0)
+      m_constant_buffer_size(0),
+      m_root_constant_size(0)
 {
     auto cal_align = [](std::size_t begin, std::size_t align) {
         return (begin + align - 1) & ~(align - 1);
@@ -251,12 +253,20 @@ d3d12_pipeline_parameter_layout::d3d12_pipeline_parameter_layout(
         case PIPELINE_PARAMETER_TYPE_UNORDERED_ACCESS:
             ++m_uav_count;
             break;
+        case PIPELINE_PARAMETER_TYPE_CONSTANT:
+            if (desc.parameters[i].size % sizeof(std::uint32_t) != 0)
+                throw d3d12_exception("Root constants must be a multiple of 32 bits.");
+            m_root_constant_size += desc.parameters[i].size;
+            break;
         default:
             m_cbv_count = 1;
             break;
         }
     }
 
+    if (m_root_constant_size != 0 && view_count() != 0)
+        throw d3d12_exception("Root constants cannot share a layout with other parameters.");
+
     std::size_t constant_offset = 0;
     std::size_t descriptor_offset = m_cbv_count;
     m_parameters.reserve(desc.parameter_count);
@@ -276,6 +286,11 @@ d3d12_pipeline_parameter_layout::d3d12_pipeline_parameter_layout(
             offset = descriptor_offset;
             ++descriptor_offset;
             break;
+        case PIPELINE_PARAMETER_TYPE_CONSTANT:
+            offset = constant_offset;
+            size = desc.parameters[i].size;
+            constant_offset = offset + size;
+            break;
         default:
             break;
         }
@@ -463,7 +478,14 @@ d3d12_root_signature::d3d12_root_signature(
         UINT uav_count = static_cast<UINT>(layout->uav_count());
 
         UINT register_space = static_cast<UINT>(i);
-        if (cbv_count == 1 && srv_count == 0 && uav_count == 0)
+        if (layout->root_constant_count() != 0)
+        {
+            root_parameter[i].InitAsConstants(
+                static_cast<UINT>(layout->root_constant_count()),
+                0,
+                register_space);
+        }
+        else if (cbv_count == 1 && srv_count == 0 && uav_count == 0)
         {
             root_parameter[i].InitAsConstantBufferView(0, register_space);
         }
@@ -591,49 +613,21 @@ d3d12_frame_buffer::d3d12_frame_buffer(
     }
 }
 
-void d3d12_frame_buffer::begin_render(D3D12GraphicsCommandList* command_list)
+void d3d12_frame_buffer::begin_render(d3d12_render_command* command)
 {
-    std::vector<D3D12_RESOURCE_BARRIER> barriers;
-    barriers.reserve(m_attachments.size());
     for (auto& attachment : m_attachments)
-    {
-        if (attachment.resource->resource_state() != attachment.initial_state)
-        {
-            barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(
-                attachment.resource->handle(),
-                attachment.resource->resource_state(),
-                attachment.initial_state));
-            attachment.resource->resource_state(attachment.initial_state);
-        }
-    }
-
-    if (!barriers.empty())
-        command_list->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+        command->transition(attachment.resource, attachment.initial_state);
+    command->flush_transitions();
 }
 
-void d3d12_frame_buffer::end_render(D3D12GraphicsCommandList* command_list)
+void d3d12_frame_buffer::end_render(d3d12_render_command* command)
 {
-    std::vector<D3D12_RESOURCE_BARRIER> barriers;
-    barriers.reserve(m_attachments.size());
     for (auto& attachment : m_attachments)
-    {
-        if (attachment.resource->resource_state() != attachment.final_state)
-        {
-            barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(
-                attachment.resource->handle(),
-                attachment.resource->resource_state(),
-                attachment.final_state));
-            attachment.resource->resource_state(attachment.final_state);
-        }
-    }
-
-    if (!barriers.empty())
-        command_list->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+        command->transition(attachment.resource, attachment.final_state);
+    command->flush_transitions();
 }
 
-d3d12_render_pass::d3d12_render_pass(const render_pass_desc& desc)
-    : m_current_frame_buffer(nullptr),
-      m_depth_index(-1)
+d3d12_render_pass::d3d12_render_pass(const render_pass_desc& desc) : m_depth_index(-1)
 {
     m_root_signature =
         std::make_unique<d3d12_root_signature>(desc.parameters, desc.parameter_count);
@@ -681,43 +675,32 @@ void d3d12_render_pass::begin(
         render_targets.data(),
         false,
         &depth_stencil);
-
-    m_current_frame_buffer = frame_buffer;
 }
 
-void d3d12_render_pass::end(D3D12GraphicsCommandList* command_list, bool final)
+void d3d12_render_pass::end(
+    d3d12_render_command* command,
+    d3d12_frame_buffer* frame_buffer,
+    bool final)
 {
     if (m_resolve_indices.empty())
         return;
 
-    auto& attachments = m_current_frame_buffer->attachments();
+    auto& attachments = frame_buffer->attachments();
 
-    std::vector<D3D12_RESOURCE_BARRIER> barriers;
     for (auto [target_index, source_index] : m_resolve_indices)
     {
-        auto target = attachments[target_index].resource;
-        barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(
-            target->handle(),
-            target->resource_state(),
-            D3D12_RESOURCE_STATE_RESOLVE_DEST));
-        target->resource_state(D3D12_RESOURCE_STATE_RESOLVE_DEST);
-
-        auto source = attachments[source_index].resource;
-        barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(
-            source->handle(),
-            source->resource_state(),
-            D3D12_RESOURCE_STATE_RESOLVE_SOURCE));
-        source->resource_state(D3D12_RESOURCE_STATE_RESOLVE_SOURCE);
+        command->transition(attachments[target_index].resource, D3D12_RESOURCE_STATE_RESOLVE_DEST);
+        command->transition(
+            attachments[source_index].resource,
+            D3D12_RESOURCE_STATE_RESOLVE_SOURCE);
     }
-
-    if (!barriers.empty())
-        command_list->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+    command->flush_transitions();
 
     for (auto [target_index, source_index] : m_resolve_indices)
     {
         auto target = attachments[target_index].resource;
         auto source = attachments[source_index].resource;
-        command_list->ResolveSubresource(
+        command->get()->ResolveSubresource(
             target->handle(),
             0,
             source->handle(),
@@ -727,27 +710,16 @@ void d3d12_render_pass::end(D3D12GraphicsCommandList* command_list, bool final)
 
     if (!final)
     {
-        barriers.clear();
-
         for (auto [target_index, source_index] : m_resolve_indices)
         {
-            auto target = attachments[target_index].resource;
-            barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(
-                target->handle(),
-                target->resource_state(),
-                attachments[target_index].initial_state));
-            target->resource_state(attachments[target_index].initial_state);
-
-            auto source = attachments[source_index].resource;
-            barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(
-                source->handle(),
-                source->resource_state(),
-                attachments[source_index].initial_state));
-            source->resource_state(attachments[source_index].initial_state);
+            command->transition(
+                attachments[target_index].resource,
+                attachments[target_index].initial_state);
+            command->transition(
+                attachments[source_index].resource,
+                attachments[source_index].initial_state);
         }
-
-        if (!barriers.empty())
-            command_list->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+        command->flush_transitions();
     }
 }
 
@@ -843,22 +815,19 @@ void d3d12_render_pass::initialize_pipeline_state(const render_pass_desc& desc)
 }
 
 d3d12_render_pipeline::d3d12_render_pipeline(const render_pipeline_desc& desc)
-    : m_current_index(0),
-      m_current_frame_buffer(0),
-      m_frame_buffer_layout(desc.attachments, desc.attachment_count)
+    : m_frame_buffer_layout(desc.attachments, desc.attachment_count)
 {
     for (std::size_t i = 0; i < desc.pass_count; ++i)
         m_passes.push_back(std::make_unique<d3d12_render_pass>(desc.passes[i]));
 }
 
-void d3d12_render_pipeline::begin(
-    D3D12GraphicsCommandList* command_list,
+d3d12_frame_buffer* d3d12_render_pipeline::begin(
+    d3d12_render_command* command,
     const d3d12_camera_info& camera_info)
 {
-    m_current_index = 0;
-    m_current_frame_buffer =
+    d3d12_frame_buffer* frame_buffer =
         d3d12_context::frame_buffer().get_or_create_frame_buffer(this, camera_info);
-    m_current_frame_buffer->begin_render(command_list);
+    frame_buffer->begin_render(command);
 
     auto [width, height] = camera_info.render_target->extent();
 
@@ -869,28 +838,37 @@ void d3d12_render_pipeline::begin(
     viewport.MaxDepth = 1.0f;
     viewport.TopLeftX = 0.0f;
     viewport.TopLeftY = 0.0f;
-    command_list->RSSetViewports(1, &viewport);
+    command->get()->RSSetViewports(1, &viewport);
 
-    m_passes[m_current_index]->begin(command_list, m_current_frame_buffer);
+    m_passes[0]->begin(command->get(), frame_buffer);
+
+    return frame_buffer;
 }
 
-void d3d12_render_pipeline::end(D3D12GraphicsCommandList* command_list)
+void d3d12_render_pipeline::end(
+    d3d12_render_command* command,
+    d3d12_frame_buffer* frame_buffer,
+    std::size_t pass_index)
 {
-    m_passes[m_current_index]->end(command_list, true);
-    m_current_frame_buffer->end_render(command_list);
+    m_passes[pass_index]->end(command, frame_buffer, true);
+    frame_buffer->end_render(command);
 }
 
-void d3d12_render_pipeline::next(D3D12GraphicsCommandList* command_list)
+void d3d12_render_pipeline::next(
+    d3d12_render_command* command,
+    d3d12_frame_buffer* frame_buffer,
+    std::size_t pass_index)
 {
-    m_passes[m_current_index]->end(command_list);
-    ++m_current_index;
-    m_passes[m_current_index]->begin(command_list, m_current_frame_buffer);
+    m_passes[pass_index]->end(command, frame_buffer);
+    m_passes[pass_index + 1]->begin(command->get(), frame_buffer);
 }
 
 d3d12_frame_buffer* d3d12_frame_buffer_manager::get_or_create_frame_buffer(
     d3d12_render_pipeline* pipeline,
     const d3d12_camera_info& camera_info)
 {
+    std::lock_guard<std::mutex> lg(m_lock);
+
     auto& result = m_frame_buffers[camera_info];
     if (result == nullptr)
         result = std::make_unique<d3d12_frame_buffer>(pipeline, camera_info);
@@ -900,6 +878,8 @@ d3d12_frame_buffer* d3d12_frame_buffer_manager::get_or_create_frame_buffer(
 
 void d3d12_frame_buffer_manager::notify_destroy(d3d12_resource* resource)
 {
+    std::lock_guard<std::mutex> lg(m_lock);
+
     for (auto iter = m_frame_buffers.begin(); iter != m_frame_buffers.end();)
     {
         if (iter->first.render_target == resource ||
@@ -2,6 +2,8 @@
 #include "d3d12_context.hpp"
 #include "d3d12_image_loader.hpp"
 #include "d3d12_pipeline.hpp"
+#include <algorithm>
+#include <cstring>
 
 namespace ash::graphics::d3d12
 {
@@ -39,6 +41,11 @@ void d3d12_resource::upload(const void* data, std::size_t size, std::size_t offs
     throw d3d12_exception("This resource cannot be uploaded.");
 }
 
+void* d3d12_resource::map(std::size_t size, std::size_t offset)
+{
+    throw d3d12_exception("This resource is not a upload buffer.");
+}
+
 resource_format d3d12_image::format() const noexcept
 {
     return d3d12_utility::convert_format(m_resource->GetDesc().Format);
@@ -449,15 +456,114 @@ void d3d12_upload_buffer::upload(const void* data, std::size_t size, std::size_t
 
 void d3d12_upload_buffer::copy(std::size_t begin, std::size_t size, std::size_t target)
 {
-    void* mapped;
+    void* source_ptr = static_cast<std::uint8_t*>(m_mapped) + begin;
+    void* target_ptr = static_cast<std::uint8_t*>(m_mapped) + target;
+
+    std::memcpy(target_ptr, source_ptr, size);
+}
+
+d3d12_upload_ring::d3d12_upload_ring(std::size_t frame_size)
+    : m_mapped(nullptr),
+      m_frame_size(frame_size),
+      m_offset(0)
+{
+    CD3DX12_HEAP_PROPERTIES heap_properties(D3D12_HEAP_TYPE_UPLOAD);
+    CD3DX12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Buffer(
+        m_frame_size * d3d12_frame_counter::frame_resource_count());
+
+    throw_if_failed(d3d12_context::device()->CreateCommittedResource(
+        &heap_properties,
+        D3D12_HEAP_FLAG_NONE,
+        &desc,
+        D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr,
+        IID_PPV_ARGS(&m_resource)));
+
+    // Upload heaps can stay mapped while the GPU reads them.
+    void* mapped = nullptr;
     throw_if_failed(m_resource->Map(0, nullptr, &mapped));
+    m_mapped = static_cast<std::uint8_t*>(mapped);
+}
+
+d3d12_upload_ring::~d3d12_upload_ring()
+{
+    if (m_mapped)
+        m_resource->Unmap(0, nullptr);
+}
 
-    void* source_ptr = static_cast<std::uint8_t*>(mapped) + begin;
-    void* target_ptr = static_cast<std::uint8_t*>(mapped) + target;
+d3d12_upload_allocation d3d12_upload_ring::allocate(std::size_t size, std::size_t alignment)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
 
-    std::memcpy(target_ptr, source_ptr, size);
+    std::size_t offset = (m_offset + alignment - 1) & ~(alignment - 1);
+    if (offset + size <= m_frame_size)
+    {
+        m_offset = offset + size;
+
+        std::size_t frame_offset = d3d12_frame_counter::frame_resource_index() * m_frame_size;
+        return {
+            m_mapped + frame_offset + offset,
+            m_resource->GetGPUVirtualAddress() + frame_offset + offset};
+    }
+
+    // The ring is full, fall back to a heap released with the frame.
+    CD3DX12_HEAP_PROPERTIES heap_properties(D3D12_HEAP_TYPE_UPLOAD);
+    CD3DX12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Buffer(size);
+
+    d3d12_ptr<D3D12Resource> resource;
+    throw_if_failed(d3d12_context::device()->CreateCommittedResource(
+        &heap_properties,
+        D3D12_HEAP_FLAG_NONE,
+        &desc,
+        D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr,
+        IID_PPV_ARGS(&resource)));
+
+    void* mapped = nullptr;
+    throw_if_failed(resource->Map(0, nullptr, &mapped));
+    m_overflow.get().push_back(resource);
+
+    return {mapped, resource->GetGPUVirtualAddress()};
+}
 
-    m_resource->Unmap(0, nullptr);
+void d3d12_upload_ring::switch_frame_resources()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    // The command queue has waited for the last frame that used this region.
+    m_offset = 0;
+    m_overflow.get().clear();
+}
+
+d3d12_ring_resource::d3d12_ring_resource() : m_dirty_begin(0), m_dirty_end(0)
+{
+}
+
+void* d3d12_ring_resource::write_shadow(std::size_t size, std::size_t offset)
+{
+    if (m_dirty_begin == m_dirty_end)
+    {
+        m_dirty_begin = offset;
+        m_dirty_end = offset + size;
+    }
+    else
+    {
+        m_dirty_begin = std::min(m_dirty_begin, offset);
+        m_dirty_end = std::max(m_dirty_end, offset + size);
+    }
+    return m_shadow.data() + offset;
+}
+
+void d3d12_ring_resource::flush_shadow(void* target)
+{
+    if (m_dirty_begin == m_dirty_end)
+        return;
+
+    std::memcpy(
+        static_cast<std::uint8_t*>(target) + m_dirty_begin,
+        m_shadow.data() + m_dirty_begin,
+        m_dirty_end - m_dirty_begin);
+    m_dirty_begin = m_dirty_end = 0;
 }
 
 d3d12_vertex_buffer_default::d3d12_vertex_buffer_default(
@@ -538,28 +644,40 @@ D3D12_CPU_DESCRIPTOR_HANDLE d3d12_vertex_buffer_default::uav() const
 
 d3d12_vertex_buffer_dynamic::d3d12_vertex_buffer_dynamic(const vertex_buffer_desc& desc)
     : m_frame_resource(desc.frame_resource),
+      m_mapped(nullptr),
+      m_view{},
       m_current_index(0),
       m_last_sync_frame(0)
 {
     m_size = desc.vertex_size * desc.vertex_count;
-    D3D12_RESOURCE_FLAGS flags = (desc.flags & VERTEX_BUFFER_FLAG_COMPUTE_OUT)
-                                     ? D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS
-                                     : D3D12_RESOURCE_FLAG_NONE;
-
-    std::size_t copy_count = desc.frame_resource ? d3d12_frame_counter::frame_resource_count() : 1;
-    m_buffer = std::make_unique<d3d12_upload_buffer>(m_size * copy_count, flags);
 
-    D3D12_VERTEX_BUFFER_VIEW view = {};
-    view.BufferLocation = m_buffer->handle()->GetGPUVirtualAddress();
-    view.SizeInBytes = static_cast<UINT>(m_size);
-    view.StrideInBytes = static_cast<UINT>(desc.vertex_size);
+    m_view.SizeInBytes = static_cast<UINT>(m_size);
+    m_view.StrideInBytes = static_cast<UINT>(desc.vertex_size);
 
-    for (std::size_t i = 0; i < copy_count; ++i)
+    // Ring memory has no descriptors, so frame resources used by compute keep one copy per frame
+    // resource in their own buffer instead.
+    if (m_frame_resource && desc.flags == VERTEX_BUFFER_FLAG_NONE)
     {
-        m_views.push_back(view);
-        view.BufferLocation += m_size;
+        m_last_sync_frame = d3d12_frame_counter::frame_counter() - 1;
+        sync_frame_resource();
+
+        m_shadow.resize(m_size);
+        if (desc.vertices != nullptr && m_size != 0)
+            std::memcpy(write_shadow(m_size, 0), desc.vertices, m_size);
+
+        d3d12_context::resource()->register_ring_resource(this);
+        return;
     }
 
+    std::size_t copy_count = m_frame_resource ? d3d12_frame_counter::frame_resource_count() : 1;
+
+    D3D12_RESOURCE_FLAGS flags = (desc.flags & VERTEX_BUFFER_FLAG_COMPUTE_OUT)
+                                     ? D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS
+                                     : D3D12_RESOURCE_FLAG_NONE;
+    m_buffer = std::make_unique<d3d12_upload_buffer>(m_size * copy_count, flags);
+    m_mapped = m_buffer->mapped_pointer();
+    m_view.BufferLocation = m_buffer->handle()->GetGPUVirtualAddress();
+
     if (desc.flags & VERTEX_BUFFER_FLAG_COMPUTE_IN)
     {
         auto srv_heap = d3d12_context::resource()->heap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
@@ -580,7 +698,7 @@ d3d12_vertex_buffer_dynamic::d3d12_vertex_buffer_dynamic(const vertex_buffer_des
                 &srv_desc,
                 srv_heap->cpu_handle(m_srv_offset + i));
 
-            srv_desc.Buffer.FirstElement += static_cast<UINT>(desc.vertex_count);
+            srv_desc.Buffer.FirstElement += desc.vertex_count;
         }
     }
 
@@ -603,45 +721,54 @@ d3d12_vertex_buffer_dynamic::d3d12_vertex_buffer_dynamic(const vertex_buffer_des
                 m_buffer->handle(),
                 nullptr,
                 &uav_desc,
-                uav_heap->cpu_handle(m_uav_offset));
+                uav_heap->cpu_handle(m_uav_offset + i));
 
-            uav_desc.Buffer.FirstElement += static_cast<UINT>(desc.vertex_count);
+            uav_desc.Buffer.FirstElement += desc.vertex_count;
         }
     }
 
+    if (m_frame_resource)
+    {
+        m_last_sync_frame = d3d12_frame_counter::frame_counter() - 1;
+        sync_frame_resource();
+    }
+
     if (desc.vertices != nullptr && m_size != 0)
-        m_buffer->upload(desc.vertices, m_size, 0);
+        std::memcpy(m_mapped, desc.vertices, m_size);
 }
 
-void d3d12_vertex_buffer_dynamic::upload(const void* data, std::size_t size, std::size_t offset)
+d3d12_vertex_buffer_dynamic::~d3d12_vertex_buffer_dynamic()
 {
-    if (m_frame_resource)
-    {
-        std::size_t current_frame = d3d12_frame_counter::frame_counter();
-        if (m_last_sync_frame != current_frame)
-        {
-            std::size_t frame_resource_count = d3d12_frame_counter::frame_resource_count();
-            std::size_t next_index = (m_current_index + 1) % frame_resource_count;
+    if (m_frame_resource && !m_buffer)
+        d3d12_context::resource()->unregister_ring_resource(this);
+}
+
+void* d3d12_vertex_buffer_dynamic::pointer()
+{
+    sync_frame_resource();
+    return m_frame_resource && !m_buffer ? write_shadow(m_size, 0) : m_mapped;
+}
 
-            std::size_t begin = m_current_index * m_size;
-            std::size_t target = next_index * m_size;
-            m_buffer->copy(begin, m_size, target);
+void d3d12_vertex_buffer_dynamic::upload(const void* data, std::size_t size, std::size_t offset)
+{
+    std::memcpy(map(size, offset), data, size);
+}
 
-            m_last_sync_frame = current_frame;
-            m_current_index = next_index;
-        }
+void* d3d12_vertex_buffer_dynamic::map(std::size_t size, std::size_t offset)
+{
+    if (offset + size > m_size)
+        throw std::out_of_range("Map out of the range of the vertex buffer.");
 
-        m_buffer->upload(data, size, offset + m_size * m_current_index);
-    }
+    sync_frame_resource();
+    if (m_frame_resource && !m_buffer)
+        return write_shadow(size, offset);
     else
-    {
-        m_buffer->upload(data, size, offset);
-    }
+        return static_cast<std::uint8_t*>(m_mapped) + offset;
 }
 
 const D3D12_VERTEX_BUFFER_VIEW& d3d12_vertex_buffer_dynamic::view() const noexcept
 {
-    return m_views[m_current_index];
+    return m_view;
 }
 
 D3D12_CPU_DESCRIPTOR_HANDLE d3d12_vertex_buffer_dynamic::srv() const
@@ -656,6 +783,54 @@ D3D12_CPU_DESCRIPTOR_HANDLE d3d12_vertex_buffer_dynamic::uav() const
     return heap->cpu_handle(m_uav_offset + m_current_index);
 }
 
+D3D12Resource* d3d12_vertex_buffer_dynamic::handle() const noexcept
+{
+    return m_buffer ? m_buffer->handle() : d3d12_context::resource()->upload_ring().handle();
+}
+
+void d3d12_vertex_buffer_dynamic::refresh_frame_resource()
+{
+    // The ring reuses the memory of m_last_sync_frame at the start of the next frame.
+    std::size_t current_frame = d3d12_frame_counter::frame_counter();
+    if (current_frame - m_last_sync_frame + 1 < d3d12_frame_counter::frame_resource_count())
+        return;
+
+    sync_frame_resource();
+    std::memcpy(m_mapped, m_shadow.data(), m_size);
+}
+
+void d3d12_vertex_buffer_dynamic::flush_frame_resource()
+{
+    flush_shadow(m_mapped);
+}
+
+void d3d12_vertex_buffer_dynamic::sync_frame_resource()
+{
+    std::size_t current_frame = d3d12_frame_counter::frame_counter();
+    if (!m_frame_resource || m_last_sync_frame == current_frame)
+        return;
+
+    if (m_buffer)
+    {
+        // Copies are written in turn and drawn until the next write, so the next copy was last
+        // drawn frame_resource_count frames ago at the latest and the GPU is done with it.
+        m_current_index = (m_current_index + 1) % d3d12_frame_counter::frame_resource_count();
+        std::size_t offset = m_current_index * m_size;
+        m_mapped = static_cast<std::uint8_t*>(m_buffer->mapped_pointer()) + offset;
+        m_view.BufferLocation = m_buffer->handle()->GetGPUVirtualAddress() + offset;
+    }
+    else
+    {
+        auto allocation = d3d12_context::resource()->upload_ring().allocate(
+            m_size,
+            D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+        m_mapped = allocation.pointer;
+        m_view.BufferLocation = allocation.address;
+    }
+
+    m_last_sync_frame = current_frame;
+}
+
 d3d12_index_buffer::d3d12_index_buffer(std::size_t index_count) : m_index_count(index_count)
 {
 }
@@ -691,66 +866,112 @@ const D3D12_INDEX_BUFFER_VIEW& d3d12_index_buffer_default::view() const noexcept
 d3d12_index_buffer_dynamic::d3d12_index_buffer_dynamic(const index_buffer_desc& desc)
     : d3d12_index_buffer(desc.index_count),
       m_frame_resource(desc.frame_resource),
-      m_current_index(0),
+      m_mapped(nullptr),
+      m_view{},
       m_last_sync_frame(0)
 {
     m_size = desc.index_size * desc.index_count;
 
-    std::size_t copy_count = desc.frame_resource ? d3d12_frame_counter::frame_resource_count() : 1;
-    m_buffer = std::make_unique<d3d12_upload_buffer>(m_size * copy_count);
-
-    D3D12_INDEX_BUFFER_VIEW view = {};
-    view.BufferLocation = m_buffer->handle()->GetGPUVirtualAddress();
-    view.SizeInBytes = static_cast<UINT>(m_size);
+    m_view.SizeInBytes = static_cast<UINT>(m_size);
 
     if (desc.index_size == 1)
-        view.Format = DXGI_FORMAT_R8_UINT;
+        m_view.Format = DXGI_FORMAT_R8_UINT;
     else if (desc.index_size == 2)
-        view.Format = DXGI_FORMAT_R16_UINT;
+        m_view.Format = DXGI_FORMAT_R16_UINT;
     else if (desc.index_size == 4)
-        view.Format = DXGI_FORMAT_R32_UINT;
+        m_view.Format = DXGI_FORMAT_R32_UINT;
     else
         throw std::out_of_range("Invalid index size.");
 
-    for (std::size_t i = 0; i < copy_count; ++i)
+    if (m_frame_resource)
+    {
+        m_last_sync_frame = d3d12_frame_counter::frame_counter() - 1;
+        sync_frame_resource();
+        m_shadow.resize(m_size);
+    }
+    else
     {
-        m_views.push_back(view);
-        view.BufferLocation += m_size;
+        m_buffer = std::make_unique<d3d12_upload_buffer>(m_size);
+        m_mapped = m_buffer->mapped_pointer();
+        m_view.BufferLocation = m_buffer->handle()->GetGPUVirtualAddress();
     }
 
     if (desc.indices != nullptr && m_size != 0)
-        m_buffer->upload(desc.indices, m_size, 0);
+        std::memcpy(map(m_size, 0), desc.indices, m_size);
+
+    if (m_frame_resource)
+        d3d12_context::resource()->register_ring_resource(this);
 }
 
-void d3d12_index_buffer_dynamic::upload(const void* data, std::size_t size, std::size_t offset)
+d3d12_index_buffer_dynamic::~d3d12_index_buffer_dynamic()
 {
     if (m_frame_resource)
-    {
-        std::size_t current_frame = d3d12_frame_counter::frame_counter();
-        if (m_last_sync_frame != current_frame)
-        {
-            std::size_t frame_resource_count = d3d12_frame_counter::frame_resource_count();
-            std::size_t next_index = (m_current_index + 1) % frame_resource_count;
+        d3d12_context::resource()->unregister_ring_resource(this);
+}
 
-            std::size_t begin = (m_current_index % frame_resource_count) * m_size;
-            std::size_t target = next_index * m_size;
-            m_buffer->copy(begin, m_size, target);
+void* d3d12_index_buffer_dynamic::pointer()
+{
+    sync_frame_resource();
+    return m_frame_resource ? write_shadow(m_size, 0) : m_mapped;
+}
 
-            m_last_sync_frame = current_frame;
-            m_current_index = next_index;
-        }
+void d3d12_index_buffer_dynamic::upload(const void* data, std::size_t size, std::size_t offset)
+{
+    std::memcpy(map(size, offset), data, size);
+}
 
-        m_buffer->upload(data, size, offset + m_size * m_current_index);
-    }
+void* d3d12_index_buffer_dynamic::map(std::size_t size, std::size_t offset)
+{
+    if (offset + size > m_size)
+        throw std::out_of_range("Map out of the range of the index buffer.");
+
+    sync_frame_resource();
+    if (m_frame_resource)
+        return write_shadow(size, offset);
     else
-    {
-        m_buffer->upload(data, size, offset);
-    }
+        return static_cast<std::uint8_t*>(m_mapped) + offset;
 }
 
 const D3D12_INDEX_BUFFER_VIEW& d3d12_index_buffer_dynamic::view() const noexcept
 {
-    return m_views[m_current_index];
+    return m_view;
+}
+
+D3D12Resource* d3d12_index_buffer_dynamic::handle() const noexcept
+{
+    return m_buffer ? m_buffer->handle() : d3d12_context::resource()->upload_ring().handle();
+}
+
+void d3d12_index_buffer_dynamic::refresh_frame_resource()
+{
+    // See d3d12_vertex_buffer_dynamic::refresh_frame_resource.
+    std::size_t current_frame = d3d12_frame_counter::frame_counter();
+    if (current_frame - m_last_sync_frame + 1 < d3d12_frame_counter::frame_resource_count())
+        return;
+
+    sync_frame_resource();
+    std::memcpy(m_mapped, m_shadow.data(), m_size);
+}
+
+void d3d12_index_buffer_dynamic::flush_frame_resource()
+{
+    flush_shadow(m_mapped);
+}
+
+void d3d12_index_buffer_dynamic::sync_frame_resource()
+{
+    std::size_t current_frame = d3d12_frame_counter::frame_counter();
+    if (!m_frame_resource || m_last_sync_frame == current_frame)
+        return;
+
+    // Index buffers that are frame resources always live in the upload ring.
+    auto allocation = d3d12_context::resource()->upload_ring().allocate(
+        m_size,
+        D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+    m_mapped = allocation.pointer;
+    m_view.BufferLocation = allocation.address;
+
+    m_last_sync_frame = current_frame;
 }
 
 d3d12_resource_manager::d3d12_resource_manager()
@@ -790,6 +1011,32 @@ d3d12_resource_manager::d3d12_resource_manager()
             1024,
             descriptor_size[D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV],
             D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE);
+
+    m_upload_ring = std::make_unique<d3d12_upload_ring>(UPLOAD_RING_FRAME_SIZE);
+}
+
+void d3d12_resource_manager::register_ring_resource(d3d12_ring_resource* resource)
+{
+    std::lock_guard<std::mutex> lg(m_ring_lock);
+    m_ring_resources.push_back(resource);
+}
+
+void d3d12_resource_manager::unregister_ring_resource(d3d12_ring_resource* resource)
+{
+    std::lock_guard<std::mutex> lg(m_ring_lock);
+    auto iter = std::find(m_ring_resources.begin(), m_ring_resources.end(), resource);
+    if (iter != m_ring_resources.end())
+    {
+        *iter = m_ring_resources.back();
+        m_ring_resources.pop_back();
+    }
+}
+
+void d3d12_resource_manager::flush_ring_resources()
+{
+    std::lock_guard<std::mutex> lg(m_ring_lock);
+    for (d3d12_ring_resource* resource : m_ring_resources)
+        resource->flush_frame_resource();
 }
 
 void d3d12_resource_manager::delay_delete(d3d12_ptr<D3D12Resource> resource)
@@ -800,5 +1047,10 @@ void d3d12_resource_manager::delay_delete(d3d12_ptr<D3D12Resource> resource)
 void d3d12_resource_manager::switch_frame_resources()
 {
     m_temporary.get().clear();
+    m_upload_ring->switch_frame_resources();
+
+    std::lock_guard<std::mutex> lg(m_ring_lock);
+    for (d3d12_ring_resource* resource : m_ring_resources)
+        resource->refresh_frame_resource();
 }
 } // namespace ash::graphics::d3d12
\ No newline at end of file
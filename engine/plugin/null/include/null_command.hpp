@@ -0,0 +1,92 @@
+#pragma once
+
+#include "graphics_interface.hpp"
+#include <vector>
+
+namespace ash::graphics::null
+{
+class null_buffer;
+class null_pipeline_parameter;
+class null_render_pipeline;
+class null_compute_pipeline;
+
+/**
+ * @brief Checks the command stream as it is recorded and counts what a real backend would submit.
+ * Nothing is drawn.
+ */
+class null_render_command : public render_command_interface
+{
+public:
+    null_render_command();
+
+    virtual void begin(
+        render_pipeline_interface* pipeline,
+        resource_interface* render_target,
+        resource_interface* render_target_resolve,
+        resource_interface* depth_stencil_buffer) override;
+    virtual void end(render_pipeline_interface* pipeline) override;
+    virtual void next_pass(render_pipeline_interface* pipeline) override;
+
+    virtual void scissor(const scissor_extent* extents, std::size_t size) override;
+
+    virtual void parameter(std::size_t index, pipeline_parameter_interface* parameter) override;
+    virtual void constant(std::size_t index, const void* data, std::size_t size) override;
+
+    virtual void input_assembly_state(
+        resource_interface* const* vertex_buffers,
+        std::size_t vertex_buffer_count,
+        resource_interface* index_buffer,
+        primitive_topology primitive_topology) override;
+
+    virtual void draw(std::size_t vertex_start, std::size_t vertex_end) override;
+    virtual void draw_indexed(
+        std::size_t index_start,
+        std::size_t index_end,
+        std::size_t vertex_base) override;
+    virtual void draw_indexed_instanced(
+        std::size_t index_start,
+        std::size_t index_end,
+        std::size_t vertex_base,
+        std::size_t instance_start,
+        std::size_t instance_count) override;
+
+    virtual void clear_render_target(resource_interface* render_target, const math::float4& color)
+        override;
+    virtual void clear_depth_stencil(resource_interface* depth_stencil) override;
+
+    virtual void begin(compute_pipeline_interface* pipeline) override;
+    virtual void end(compute_pipeline_interface* pipeline) override;
+    virtual void dispatch(std::size_t x, std::size_t y, std::size_t z) override;
+    virtual void compute_parameter(std::size_t index, pipeline_parameter_interface* parameter)
+        override;
+
+    void reset();
+
+    // A command can only be executed outside of any pipeline.
+    bool closed() const noexcept
+    {
+        return m_render_pipeline == nullptr && m_compute_pipeline == nullptr;
+    }
+
+    const render_statistics& statistics() const noexcept { return m_statistics; }
+
+private:
+    bool check_draw();
+
+    null_render_pipeline* m_render_pipeline;
+    null_compute_pipeline* m_compute_pipeline;
+    std::size_t m_pass_index;
+
+    bool m_input_assembly;
+    null_buffer* m_index_buffer;
+
+    // Parameters bound in the current pass, instanced draws must stay within the buffers they
+    // hold, see null_pipeline_parameter::instance_capacity.
+    std::vector<null_pipeline_parameter*> m_parameters;
+
+    // Last value pushed to the ash_draw constant of the current pass.
+    std::uint32_t m_instance_index;
+
+    render_statistics m_statistics;
+};
+} // namespace ash::graphics::null
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "graphics_interface.hpp"
+#include <atomic>
+#include <string_view>
+
+namespace ash::graphics::null
+{
+class null_context
+{
+public:
+    static void initialize(const rhi_desc& desc) { instance().m_desc = desc; }
+
+    static const rhi_desc& desc() noexcept { return instance().m_desc; }
+
+    // Counts bytes written by the host, resources may be written from any thread.
+    static void upload(std::size_t size) noexcept { instance().m_upload_size += size; }
+
+    // Reports an invalid use of the interface without stopping the frame.
+    static void error(std::string_view message);
+
+    // Returns the counters since the last call and starts over.
+    static std::size_t take_upload_size() noexcept { return instance().m_upload_size.exchange(0); }
+    static std::size_t take_error_count() noexcept { return instance().m_error_count.exchange(0); }
+
+private:
+    null_context() noexcept;
+    static null_context& instance() noexcept;
+
+    rhi_desc m_desc;
+
+    std::atomic<std::size_t> m_upload_size;
+    std::atomic<std::size_t> m_error_count;
+};
+} // namespace ash::graphics::null
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "graphics_interface.hpp"
+#include <vector>
+
+namespace ash::graphics::null
+{
+class null_pipeline_parameter_layout : public pipeline_parameter_layout_interface
+{
+public:
+    null_pipeline_parameter_layout(const pipeline_parameter_layout_desc& desc);
+
+    pipeline_parameter_type parameter_type(std::size_t index) const
+    {
+        return m_parameters[index].type;
+    }
+    std::size_t parameter_offset(std::size_t index) const { return m_parameters[index].offset; }
+    std::size_t parameter_size(std::size_t index) const { return m_parameters[index].size; }
+    std::size_t parameter_count() const noexcept { return m_parameters.size(); }
+
+    std::size_t constant_buffer_size() const noexcept { return m_constant_buffer_size; }
+
+    // Total size of the PIPELINE_PARAMETER_TYPE_CONSTANT parameters.
+    std::size_t constant_size() const noexcept { return m_constant_size; }
+
+    // The ash_draw layout, its constant starts with the index of the first instance of a draw.
+    bool draw_constant() const noexcept { return m_draw_constant; }
+
+private:
+    struct parameter_info
+    {
+        pipeline_parameter_type type;
+        std::size_t size;
+        std::size_t offset;
+    };
+
+    std::vector<parameter_info> m_parameters;
+    std::size_t m_constant_buffer_size;
+    std::size_t m_constant_size;
+    bool m_draw_constant;
+};
+
+class null_pipeline_parameter : public pipeline_parameter_interface
+{
+public:
+    null_pipeline_parameter(pipeline_parameter_layout_interface* layout);
+
+    virtual void set(std::size_t index, const void* data, size_t size) override;
+    virtual void set(std::size_t index, resource_interface* texture) override;
+
+    virtual void* constant_buffer_pointer(std::size_t index) override;
+
+    // Smallest element count of the buffers set as shader resources, the instances a draw may
+    // read through this parameter. -1 without buffers.
+    std::size_t instance_capacity() const noexcept;
+
+private:
+    null_pipeline_parameter_layout* m_layout;
+    std::vector<std::uint8_t> m_constant_buffer;
+    std::vector<resource_interface*> m_resources;
+};
+
+class null_render_pipeline : public render_pipeline_interface
+{
+public:
+    null_render_pipeline(const render_pipeline_desc& desc);
+
+    std::size_t pass_count() const noexcept { return m_pass_parameters.size(); }
+    std::size_t parameter_count(std::size_t pass) const { return m_pass_parameters[pass].size(); }
+
+    const null_pipeline_parameter_layout* parameter_layout(std::size_t pass, std::size_t index)
+        const
+    {
+        return m_pass_parameters[pass][index];
+    }
+
+private:
+    std::vector<std::vector<null_pipeline_parameter_layout*>> m_pass_parameters;
+};
+
+class null_compute_pipeline : public compute_pipeline_interface
+{
+public:
+    null_compute_pipeline(const compute_pipeline_desc& desc);
+
+    std::size_t parameter_count() const noexcept { return m_parameter_count; }
+
+private:
+    std::size_t m_parameter_count;
+};
+} // namespace ash::graphics::null
\ No newline at end of file
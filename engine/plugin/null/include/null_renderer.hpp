@@ -0,0 +1,40 @@
+#pragma once
+
+#include "null_command.hpp"
+#include "null_resource.hpp"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ash::graphics::null
+{
+class null_renderer : public renderer_interface
+{
+public:
+    null_renderer();
+
+    virtual void present() override;
+
+    virtual render_command_interface* allocate_command() override;
+    virtual void execute(render_command_interface* command) override;
+
+    virtual render_statistics statistics() const override { return m_statistics; }
+
+    virtual resource_interface* back_buffer() override { return m_back_buffer.get(); }
+
+    virtual void resize(std::uint32_t width, std::uint32_t height) override;
+
+private:
+    // Commands are reused from frame to frame like the command allocators of a real backend.
+    std::vector<std::unique_ptr<null_render_command>> m_commands;
+    std::size_t m_allocated_count;
+    std::vector<bool> m_executed;
+
+    std::unique_ptr<null_image> m_back_buffer;
+
+    render_statistics m_frame_statistics;
+    render_statistics m_statistics;
+
+    std::mutex m_lock;
+};
+} // namespace ash::graphics::null
\ No newline at end of file
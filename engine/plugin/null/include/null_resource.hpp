@@ -0,0 +1,50 @@
+#pragma once
+
+#include "graphics_interface.hpp"
+#include <vector>
+
+namespace ash::graphics::null
+{
+class null_image : public resource_interface
+{
+public:
+    null_image(std::uint32_t width, std::uint32_t height, resource_format format);
+
+    virtual resource_format format() const noexcept override { return m_format; }
+    virtual resource_extent extent() const noexcept override { return m_extent; }
+    virtual std::size_t size() const noexcept override;
+
+private:
+    resource_format m_format;
+    resource_extent m_extent;
+};
+
+/**
+ * @brief Vertex and index buffers. Dynamic buffers keep their data in host memory so that
+ * pointer and upload behave like mapped memory, the content of other buffers is dropped.
+ */
+class null_buffer : public resource_interface
+{
+public:
+    null_buffer(const void* data, std::size_t element_size, std::size_t count, bool dynamic);
+
+    virtual resource_format format() const noexcept override { return RESOURCE_FORMAT_UNDEFINED; }
+    virtual resource_extent extent() const noexcept override { return {0, 0}; }
+    virtual std::size_t size() const noexcept override { return m_element_size * m_count; }
+
+    virtual void* pointer() override;
+    virtual void upload(const void* data, std::size_t size, std::size_t offset) override;
+    virtual void* map(std::size_t size, std::size_t offset) override;
+
+    std::size_t count() const noexcept { return m_count; }
+
+private:
+    std::size_t m_element_size;
+    std::size_t m_count;
+
+    bool m_dynamic;
+    std::vector<std::uint8_t> m_data;
+};
+
+std::size_t format_size(resource_format format) noexcept;
+} // namespace ash::graphics::null
\ No newline at end of file
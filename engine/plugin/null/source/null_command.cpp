@@ -0,0 +1,285 @@
+#include "null_command.hpp"
+#include "null_context.hpp"
+#include "null_pipeline.hpp"
+#include "null_resource.hpp"
+#include <cstring>
+
+namespace ash::graphics::null
+{
+null_render_command::null_render_command()
+{
+    reset();
+}
+
+void null_render_command::begin(
+    render_pipeline_interface* pipeline,
+    resource_interface* render_target,
+    resource_interface* render_target_resolve,
+    resource_interface* depth_stencil_buffer)
+{
+    if (!closed())
+        null_context::error("Begin a render pipeline before the last one ended.");
+
+    if (render_target == nullptr || depth_stencil_buffer == nullptr)
+        null_context::error("Render pipeline without render target or depth stencil buffer.");
+
+    m_render_pipeline = static_cast<null_render_pipeline*>(pipeline);
+    m_compute_pipeline = nullptr;
+    m_pass_index = 0;
+    m_input_assembly = false;
+    m_index_buffer = nullptr;
+    m_parameters.assign(m_render_pipeline->parameter_count(0), nullptr);
+    m_instance_index = 0;
+
+    ++m_statistics.state_change_count;
+}
+
+void null_render_command::end(render_pipeline_interface* pipeline)
+{
+    if (m_render_pipeline == nullptr || m_render_pipeline != pipeline)
+        null_context::error("End a render pipeline that did not begin.");
+    else if (m_pass_index + 1 != m_render_pipeline->pass_count())
+        null_context::error("End a render pipeline before its last pass.");
+
+    m_render_pipeline = nullptr;
+}
+
+void null_render_command::next_pass(render_pipeline_interface* pipeline)
+{
+    if (m_render_pipeline == nullptr || m_render_pipeline != pipeline)
+    {
+        null_context::error("Next pass of a render pipeline that did not begin.");
+        return;
+    }
+
+    if (m_pass_index + 1 >= m_render_pipeline->pass_count())
+    {
+        null_context::error("Next pass after the last pass.");
+        return;
+    }
+
+    ++m_pass_index;
+    m_parameters.assign(m_render_pipeline->parameter_count(m_pass_index), nullptr);
+    m_instance_index = 0;
+    ++m_statistics.state_change_count;
+}
+
+void null_render_command::scissor(const scissor_extent* extents, std::size_t size)
+{
+    if (m_render_pipeline == nullptr)
+        null_context::error("Scissor outside of a render pipeline.");
+
+    ++m_statistics.state_change_count;
+}
+
+void null_render_command::parameter(std::size_t index, pipeline_parameter_interface* parameter)
+{
+    if (m_render_pipeline == nullptr)
+    {
+        null_context::error("Parameter outside of a render pipeline.");
+        return;
+    }
+
+    if (index >= m_render_pipeline->parameter_count(m_pass_index) || parameter == nullptr)
+        null_context::error("Invalid parameter of the render pass.");
+    else
+        m_parameters[index] = static_cast<null_pipeline_parameter*>(parameter);
+
+    ++m_statistics.parameter_bind_count;
+}
+
+void null_render_command::constant(std::size_t index, const void* data, std::size_t size)
+{
+    if (m_render_pipeline == nullptr)
+    {
+        null_context::error("Constant outside of a render pipeline.");
+        return;
+    }
+
+    if (index >= m_render_pipeline->parameter_count(m_pass_index) || data == nullptr)
+    {
+        null_context::error("Invalid constant of the render pass.");
+        return;
+    }
+
+    auto layout = m_render_pipeline->parameter_layout(m_pass_index, index);
+    if (layout->constant_size() != size)
+        null_context::error("Constant size does not match the parameter layout.");
+    else if (layout->draw_constant() && size >= sizeof(std::uint32_t))
+        std::memcpy(&m_instance_index, data, sizeof(std::uint32_t));
+
+    ++m_statistics.parameter_bind_count;
+}
+
+void null_render_command::input_assembly_state(
+    resource_interface* const* vertex_buffers,
+    std::size_t vertex_buffer_count,
+    resource_interface* index_buffer,
+    primitive_topology primitive_topology)
+{
+    if (m_render_pipeline == nullptr)
+    {
+        null_context::error("Input assembly state outside of a render pipeline.");
+        return;
+    }
+
+    for (std::size_t i = 0; i < vertex_buffer_count; ++i)
+    {
+        if (vertex_buffers[i] == nullptr)
+            null_context::error("Null vertex buffer.");
+    }
+
+    m_input_assembly = true;
+    m_index_buffer = static_cast<null_buffer*>(index_buffer);
+
+    ++m_statistics.state_change_count;
+}
+
+void null_render_command::draw(std::size_t vertex_start, std::size_t vertex_end)
+{
+    if (!check_draw())
+        return;
+
+    if (vertex_start > vertex_end)
+        null_context::error("Invalid vertex range.");
+
+    ++m_statistics.draw_count;
+    ++m_statistics.instance_count;
+}
+
+void null_render_command::draw_indexed(
+    std::size_t index_start,
+    std::size_t index_end,
+    std::size_t vertex_base)
+{
+    if (!check_draw())
+        return;
+
+    if (m_index_buffer == nullptr)
+        null_context::error("Draw indexed without an index buffer.");
+    else if (index_start > index_end || index_end > m_index_buffer->count())
+        null_context::error("Index range out of the index buffer.");
+
+    ++m_statistics.draw_count;
+    ++m_statistics.instance_count;
+}
+
+void null_render_command::draw_indexed_instanced(
+    std::size_t index_start,
+    std::size_t index_end,
+    std::size_t vertex_base,
+    std::size_t instance_start,
+    std::size_t instance_count)
+{
+    if (!check_draw())
+        return;
+
+    if (m_index_buffer == nullptr)
+        null_context::error("Draw indexed without an index buffer.");
+    else if (index_start > index_end || index_end > m_index_buffer->count())
+        null_context::error("Index range out of the index buffer.");
+
+    if (instance_count == 0)
+        null_context::error("Draw without instances.");
+
+    // Shaders add the instance id to the first instance of the ash_draw constant.
+    std::size_t instance_end = m_instance_index + instance_start + instance_count;
+    for (null_pipeline_parameter* parameter : m_parameters)
+    {
+        if (parameter != nullptr && instance_end > parameter->instance_capacity())
+        {
+            null_context::error("Instances out of the range of the instance buffer.");
+            break;
+        }
+    }
+
+    ++m_statistics.draw_count;
+    m_statistics.instance_count += instance_count;
+}
+
+void null_render_command::clear_render_target(
+    resource_interface* render_target,
+    const math::float4& color)
+{
+    if (render_target == nullptr)
+        null_context::error("Clear a null render target.");
+}
+
+void null_render_command::clear_depth_stencil(resource_interface* depth_stencil)
+{
+    if (depth_stencil == nullptr)
+        null_context::error("Clear a null depth stencil buffer.");
+}
+
+void null_render_command::begin(compute_pipeline_interface* pipeline)
+{
+    if (!closed())
+        null_context::error("Begin a compute pipeline before the last one ended.");
+
+    m_render_pipeline = nullptr;
+    m_compute_pipeline = static_cast<null_compute_pipeline*>(pipeline);
+
+    ++m_statistics.state_change_count;
+}
+
+void null_render_command::end(compute_pipeline_interface* pipeline)
+{
+    if (m_compute_pipeline == nullptr || m_compute_pipeline != pipeline)
+        null_context::error("End a compute pipeline that did not begin.");
+
+    m_compute_pipeline = nullptr;
+}
+
+void null_render_command::dispatch(std::size_t x, std::size_t y, std::size_t z)
+{
+    if (m_compute_pipeline == nullptr)
+        null_context::error("Dispatch outside of a compute pipeline.");
+}
+
+void null_render_command::compute_parameter(
+    std::size_t index,
+    pipeline_parameter_interface* parameter)
+{
+    if (m_compute_pipeline == nullptr)
+    {
+        null_context::error("Compute parameter outside of a compute pipeline.");
+        return;
+    }
+
+    if (index >= m_compute_pipeline->parameter_count() || parameter == nullptr)
+        null_context::error("Invalid parameter of the compute pipeline.");
+
+    ++m_statistics.parameter_bind_count;
+}
+
+void null_render_command::reset()
+{
+    m_render_pipeline = nullptr;
+    m_compute_pipeline = nullptr;
+    m_pass_index = 0;
+
+    m_input_assembly = false;
+    m_index_buffer = nullptr;
+    m_parameters.clear();
+    m_instance_index = 0;
+
+    m_statistics = {};
+}
+
+bool null_render_command::check_draw()
+{
+    if (m_render_pipeline == nullptr)
+    {
+        null_context::error("Draw outside of a render pipeline.");
+        return false;
+    }
+
+    if (!m_input_assembly)
+    {
+        null_context::error("Draw without input assembly state.");
+        return false;
+    }
+
+    return true;
+}
+} // namespace ash::graphics::null
\ No newline at end of file
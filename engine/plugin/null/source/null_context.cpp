@@ -0,0 +1,21 @@
+#include "null_context.hpp"
+#include "log.hpp"
+
+namespace ash::graphics::null
+{
+null_context::null_context() noexcept : m_desc{}, m_upload_size(0), m_error_count(0)
+{
+}
+
+null_context& null_context::instance() noexcept
+{
+    static null_context instance;
+    return instance;
+}
+
+void null_context::error(std::string_view message)
+{
+    ++instance().m_error_count;
+    log::error("Null rhi: {}", message);
+}
+} // namespace ash::graphics::null
\ No newline at end of file
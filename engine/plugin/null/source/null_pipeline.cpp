@@ -0,0 +1,107 @@
+#include "null_pipeline.hpp"
+#include "null_context.hpp"
+#include "null_resource.hpp"
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+namespace ash::graphics::null
+{
+null_pipeline_parameter_layout::null_pipeline_parameter_layout(
+    const pipeline_parameter_layout_desc& desc)
+    : m_constant_buffer_size(0),
+      m_constant_size(0),
+      m_draw_constant(desc.name != nullptr && std::string_view(desc.name) == "ash_draw")
+{
+    for (std::size_t i = 0; i < desc.parameter_count; ++i)
+    {
+        const pipeline_parameter_pair& parameter = desc.parameters[i];
+        if (parameter.type == PIPELINE_PARAMETER_TYPE_CONSTANT_BUFFER)
+        {
+            m_parameters.push_back({parameter.type, parameter.size, m_constant_buffer_size});
+            m_constant_buffer_size += parameter.size;
+        }
+        else if (parameter.type == PIPELINE_PARAMETER_TYPE_CONSTANT)
+        {
+            m_parameters.push_back({parameter.type, parameter.size, m_constant_size});
+            m_constant_size += parameter.size;
+        }
+        else
+        {
+            m_parameters.push_back({parameter.type, parameter.size, 0});
+        }
+    }
+}
+
+null_pipeline_parameter::null_pipeline_parameter(pipeline_parameter_layout_interface* layout)
+    : m_layout(static_cast<null_pipeline_parameter_layout*>(layout))
+{
+    m_constant_buffer.resize(m_layout->constant_buffer_size());
+    m_resources.resize(m_layout->parameter_count());
+}
+
+void null_pipeline_parameter::set(std::size_t index, const void* data, size_t size)
+{
+    if (index >= m_layout->parameter_count() ||
+        m_layout->parameter_type(index) != PIPELINE_PARAMETER_TYPE_CONSTANT_BUFFER)
+    {
+        null_context::error("The parameter is not a constant buffer.");
+        return;
+    }
+
+    if (size > m_layout->parameter_size(index))
+    {
+        null_context::error("Upload out of the range of the constant buffer.");
+        return;
+    }
+
+    std::memcpy(m_constant_buffer.data() + m_layout->parameter_offset(index), data, size);
+    null_context::upload(size);
+}
+
+void null_pipeline_parameter::set(std::size_t index, resource_interface* texture)
+{
+    if (index >= m_layout->parameter_count() ||
+        m_layout->parameter_type(index) == PIPELINE_PARAMETER_TYPE_CONSTANT_BUFFER)
+    {
+        null_context::error("The parameter is not a shader resource or unordered access.");
+        return;
+    }
+
+    m_resources[index] = texture;
+}
+
+void* null_pipeline_parameter::constant_buffer_pointer(std::size_t index)
+{
+    return m_constant_buffer.data() + m_layout->parameter_offset(index);
+}
+
+std::size_t null_pipeline_parameter::instance_capacity() const noexcept
+{
+    std::size_t result = -1;
+    for (resource_interface* resource : m_resources)
+    {
+        if (auto buffer = dynamic_cast<null_buffer*>(resource))
+            result = std::min(result, buffer->count());
+    }
+    return result;
+}
+
+null_render_pipeline::null_render_pipeline(const render_pipeline_desc& desc)
+{
+    m_pass_parameters.resize(desc.pass_count);
+    for (std::size_t i = 0; i < desc.pass_count; ++i)
+    {
+        for (std::size_t j = 0; j < desc.passes[i].parameter_count; ++j)
+        {
+            m_pass_parameters[i].push_back(
+                static_cast<null_pipeline_parameter_layout*>(desc.passes[i].parameters[j]));
+        }
+    }
+}
+
+null_compute_pipeline::null_compute_pipeline(const compute_pipeline_desc& desc)
+    : m_parameter_count(desc.parameter_count)
+{
+}
+} // namespace ash::graphics::null
\ No newline at end of file
@@ -0,0 +1,117 @@
+#include "null_command.hpp"
+#include "null_context.hpp"
+#include "null_pipeline.hpp"
+#include "null_renderer.hpp"
+#include "null_resource.hpp"
+#include "graphics_interface.hpp"
+#include <cstring>
+
+namespace ash::graphics::null
+{
+/**
+ * @brief Backend without a device or a window. Resources live in host memory and command streams
+ * are only validated and counted, see renderer_interface::statistics.
+ */
+class null_rhi : public rhi_interface
+{
+public:
+    virtual void initialize(const rhi_desc& desc) override { null_context::initialize(desc); }
+
+    virtual renderer_interface* make_renderer() override { return new null_renderer(); }
+
+    virtual render_pipeline_interface* make_render_pipeline(
+        const render_pipeline_desc& desc) override
+    {
+        return new null_render_pipeline(desc);
+    }
+
+    virtual compute_pipeline_interface* make_compute_pipeline(
+        const compute_pipeline_desc& desc) override
+    {
+        return new null_compute_pipeline(desc);
+    }
+
+    virtual pipeline_parameter_layout_interface* make_pipeline_parameter_layout(
+        const pipeline_parameter_layout_desc& desc) override
+    {
+        return new null_pipeline_parameter_layout(desc);
+    }
+
+    virtual pipeline_parameter_interface* make_pipeline_parameter(
+        pipeline_parameter_layout_interface* layout) override
+    {
+        return new null_pipeline_parameter(layout);
+    }
+
+    virtual resource_interface* make_vertex_buffer(const vertex_buffer_desc& desc) override
+    {
+        return new null_buffer(desc.vertices, desc.vertex_size, desc.vertex_count, desc.dynamic);
+    }
+
+    virtual resource_interface* make_index_buffer(const index_buffer_desc& desc) override
+    {
+        return new null_buffer(desc.indices, desc.index_size, desc.index_count, desc.dynamic);
+    }
+
+    virtual resource_interface* make_texture(
+        const std::uint8_t* data,
+        std::uint32_t width,
+        std::uint32_t height,
+        resource_format format) override
+    {
+        null_image* result = new null_image(width, height, format);
+        if (data != nullptr)
+            null_context::upload(result->size());
+        return result;
+    }
+
+    virtual resource_interface* make_texture(const char* file) override
+    {
+        // Files are not read, the texture only stands in for the real one.
+        return new null_image(1, 1, RESOURCE_FORMAT_R8G8B8A8_UNORM);
+    }
+
+    virtual resource_interface* make_texture_cube(
+        const char* left,
+        const char* right,
+        const char* top,
+        const char* bottom,
+        const char* front,
+        const char* back) override
+    {
+        return new null_image(1, 1, RESOURCE_FORMAT_R8G8B8A8_UNORM);
+    }
+
+    virtual resource_interface* make_render_target(const render_target_desc& desc) override
+    {
+        return new null_image(desc.width, desc.height, desc.format);
+    }
+
+    virtual resource_interface* make_depth_stencil_buffer(
+        const depth_stencil_buffer_desc& desc) override
+    {
+        return new null_image(desc.width, desc.height, desc.format);
+    }
+};
+} // namespace ash::graphics::null
+
+extern "C"
+{
+    PLUGIN_API ash::core::plugin_info get_plugin_info()
+    {
+        ash::core::plugin_info info = {};
+
+        char name[] = "graphics-null";
+        memcpy(info.name, name, sizeof(name));
+
+        info.version.major = 1;
+        info.version.minor = 0;
+
+        return info;
+    }
+
+    PLUGIN_API ash::graphics::rhi_interface* make_rhi()
+    {
+        return new ash::graphics::null::null_rhi();
+    }
+}
\ No newline at end of file
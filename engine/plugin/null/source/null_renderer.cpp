@@ -0,0 +1,91 @@
+#include "null_renderer.hpp"
+#include "null_context.hpp"
+
+namespace ash::graphics::null
+{
+null_renderer::null_renderer() : m_allocated_count(0), m_frame_statistics{}, m_statistics{}
+{
+    const rhi_desc& desc = null_context::desc();
+    m_back_buffer =
+        std::make_unique<null_image>(desc.width, desc.height, RESOURCE_FORMAT_R8G8B8A8_UNORM);
+}
+
+void null_renderer::present()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    for (std::size_t i = 0; i < m_allocated_count; ++i)
+    {
+        if (!m_executed[i])
+            null_context::error("Command allocated but not executed.");
+    }
+
+    m_frame_statistics.upload_size += null_context::take_upload_size();
+    m_frame_statistics.error_count += null_context::take_error_count();
+
+    m_statistics = m_frame_statistics;
+    m_frame_statistics = {};
+    m_allocated_count = 0;
+}
+
+render_command_interface* null_renderer::allocate_command()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    // The d3d12 backend has a fixed number of commands per frame, report it but keep going.
+    if (m_allocated_count == null_context::desc().render_concurrency)
+        null_context::error("More commands than render concurrency in a frame.");
+
+    if (m_allocated_count == m_commands.size())
+    {
+        m_commands.push_back(std::make_unique<null_render_command>());
+        m_executed.push_back(false);
+    }
+
+    null_render_command* command = m_commands[m_allocated_count].get();
+    command->reset();
+    m_executed[m_allocated_count] = false;
+    ++m_allocated_count;
+
+    return command;
+}
+
+void null_renderer::execute(render_command_interface* command)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    std::size_t index = 0;
+    while (index < m_allocated_count && m_commands[index].get() != command)
+        ++index;
+
+    if (index == m_allocated_count)
+    {
+        null_context::error("Execute a command that was not allocated in this frame.");
+        return;
+    }
+
+    if (m_executed[index])
+    {
+        null_context::error("Execute a command twice.");
+        return;
+    }
+
+    null_render_command* null_command = m_commands[index].get();
+    if (!null_command->closed())
+        null_context::error("Execute a command inside of a pipeline.");
+
+    const render_statistics& statistics = null_command->statistics();
+    ++m_frame_statistics.command_count;
+    m_frame_statistics.draw_count += statistics.draw_count;
+    m_frame_statistics.instance_count += statistics.instance_count;
+    m_frame_statistics.state_change_count += statistics.state_change_count;
+    m_frame_statistics.parameter_bind_count += statistics.parameter_bind_count;
+
+    m_executed[index] = true;
+}
+
+void null_renderer::resize(std::uint32_t width, std::uint32_t height)
+{
+    m_back_buffer = std::make_unique<null_image>(width, height, m_back_buffer->format());
+}
+} // namespace ash::graphics::null
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include "null_resource.hpp"
+#include "null_context.hpp"
+#include <cstring>
+
+namespace ash::graphics::null
+{
+null_image::null_image(std::uint32_t width, std::uint32_t height, resource_format format)
+    : m_format(format),
+      m_extent{width, height}
+{
+}
+
+std::size_t null_image::size() const noexcept
+{
+    return format_size(m_format) * m_extent.width * m_extent.height;
+}
+
+null_buffer::null_buffer(
+    const void* data,
+    std::size_t element_size,
+    std::size_t count,
+    bool dynamic)
+    : m_element_size(element_size),
+      m_count(count),
+      m_dynamic(dynamic)
+{
+    if (m_dynamic)
+        m_data.resize(size());
+
+    if (data != nullptr)
+        upload(data, size(), 0);
+}
+
+void* null_buffer::pointer()
+{
+    if (!m_dynamic)
+    {
+        null_context::error("This resource is not a upload buffer.");
+        return nullptr;
+    }
+
+    return m_data.data();
+}
+
+void null_buffer::upload(const void* data, std::size_t size, std::size_t offset)
+{
+    if (offset + size > this->size())
+    {
+        null_context::error("Upload out of the range of the buffer.");
+        return;
+    }
+
+    if (m_dynamic)
+        std::memcpy(m_data.data() + offset, data, size);
+
+    null_context::upload(size);
+}
+
+void* null_buffer::map(std::size_t size, std::size_t offset)
+{
+    if (!m_dynamic || offset + size > this->size())
+    {
+        null_context::error("Map out of the range of the buffer.");
+        return nullptr;
+    }
+
+    // Counted as written, the caller fills the range in place.
+    null_context::upload(size);
+    return m_data.data() + offset;
+}
+
+std::size_t format_size(resource_format format) noexcept
+{
+    switch (format)
+    {
+    case RESOURCE_FORMAT_R8_UNORM:
+    case RESOURCE_FORMAT_R8_UINT:
+        return 1;
+    case RESOURCE_FORMAT_R8G8B8A8_UNORM:
+    case RESOURCE_FORMAT_B8G8R8A8_UNORM:
+    case RESOURCE_FORMAT_D24_UNORM_S8_UINT:
+        return 4;
+    case RESOURCE_FORMAT_R32G32B32A32_FLOAT:
+    case RESOURCE_FORMAT_R32G32B32A32_SINT:
+    case RESOURCE_FORMAT_R32G32B32A32_UINT:
+        return 16;
+    default:
+        return 0;
+    }
+}
+} // namespace ash::graphics::null
\ No newline at end of file
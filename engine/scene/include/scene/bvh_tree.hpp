@@ -1,9 +1,16 @@
 #pragma once
 
 #include "scene/bounding_box.hpp"
-#include <queue>
+#include <algorithm>
+#include <limits>
+#include <span>
 #include <stack>
 
+namespace ash::task
+{
+class task_manager;
+}
+
 namespace ash::scene
 {
 class bvh_tree
@@ -16,18 +23,263 @@ public:
 
     void clear();
 
+    /**
+     * @brief Moves a leaf. Small moves refit the leaf in place, larger ones reinsert it.
+     *
+     * @return The new proxy id, which is proxy_id when the leaf was refitted.
+     */
     std::size_t update(std::size_t proxy_id, const bounding_volume_aabb& aabb);
 
-    bool visible(std::size_t proxy_id) const noexcept { return m_nodes[proxy_id].visible; }
-    void frustum_culling(const std::vector<math::float4>& frustum);
+    /**
+     * @brief Whether update would refit the leaf in place. Leaves that pass can be collected and
+     * moved together with the batched refit instead.
+     */
+    bool refittable(std::size_t proxy_id, const bounding_volume_aabb& aabb) const;
+
+    /**
+     * @brief Moves a leaf without reinserting it. The ancestors are resized to fit and the proxy id
+     * does not change, but the tree gets worse when the box moves far from its siblings.
+     */
+    void refit(std::size_t proxy_id, const bounding_volume_aabb& aabb);
+
+    /**
+     * @brief Moves many leaves without reinserting them. Each changed ancestor is resized once,
+     * bottom up.
+     *
+     * @param optimize Swaps a child of each resized node with a grandchild when that gives a
+     * smaller surface area, which recovers some of the quality lost by refitting.
+     */
+    void refit(
+        std::span<const std::size_t> proxy_ids,
+        std::span<const bounding_volume_aabb> boxes,
+        bool optimize = false);
+
+    /**
+     * @brief Replaces the tree with a top down build that splits every node with the surface area
+     * heuristic evaluated over binned centroids. The proxy id of boxes[i] is i.
+     *
+     * @param task Splits the binning of large nodes and the subtrees across the workers, the build
+     * runs on the calling thread when null.
+     */
+    void build(std::span<const bounding_volume_aabb> boxes, task::task_manager* task = nullptr);
+
+    /**
+     * @brief Rebuilds the depth first copy of the tree used by the queries if the tree changed
+     * since the last call. Queries see the tree as it was at the last call.
+     *
+     * @return Whether the copy was rebuilt.
+     */
+    bool flatten();
+
+    /**
+     * @brief Node lists of the level walk of frustum_culling, kept by the caller so that culling
+     * does not allocate once they have grown.
+     */
+    struct culling_scratch
+    {
+        std::vector<std::uint32_t> level;
+        std::vector<std::uint32_t> next_level;
+    };
+
+    /**
+     * @brief Appends the proxy ids of the leaves that intersect the frustum to visible. The nodes
+     * of each level are tested in groups with math::bounding_box_batch::frustum_culling.
+     */
+    void frustum_culling(
+        const std::vector<math::float4>& frustum,
+        std::vector<std::size_t>& visible,
+        culling_scratch& scratch) const;
+
+    /**
+     * @brief Calls functor(proxy_id, distance) for every leaf whose box the ray hits within
+     * max_distance, in no particular order. distance is where the ray enters the box, 0 if the
+     * origin is inside.
+     *
+     * The functor returns the new max_distance: max_distance to keep every hit, the distance of an
+     * exact hit to only look for closer ones, or 0 to stop.
+     *
+     * Queries read the depth first copy, so any number of threads may query at the same time as
+     * long as none of them modifies or flattens the tree.
+     */
+    template <typename T>
+    void raycast(
+        const math::float3& origin,
+        const math::float3& direction,
+        float max_distance,
+        T&& functor) const
+    {
+        math::float3 inverse_direction = {
+            1.0f / direction[0],
+            1.0f / direction[1],
+            1.0f / direction[2]};
+
+        float entry = 0.0f;
+        traverse(
+            [&](const bounding_volume_aabb& aabb) {
+                float near = 0.0f;
+                float far = max_distance;
+                for (std::size_t i = 0; i < 3; ++i)
+                {
+                    // Parallel to the slab, 0 * inf would give NaN when the origin lies on one of
+                    // its planes.
+                    if (direction[i] == 0.0f)
+                    {
+                        if (origin[i] < aabb.min[i] || origin[i] > aabb.max[i])
+                            return false;
+                        continue;
+                    }
+
+                    float t1 = (aabb.min[i] - origin[i]) * inverse_direction[i];
+                    float t2 = (aabb.max[i] - origin[i]) * inverse_direction[i];
+                    near = std::max(near, std::min(t1, t2));
+                    far = std::min(far, std::max(t1, t2));
+                }
+                entry = near;
+                return near <= far;
+            },
+            [&](std::size_t proxy_id) {
+                max_distance = std::min(max_distance, functor(proxy_id, entry));
+                return max_distance > 0.0f;
+            });
+    }
 
+    /**
+     * @brief Calls functor(proxy_id) for every leaf that overlaps aabb.
+     */
     template <typename T>
-    void print(T&& functor)
+    void query_aabb(const bounding_volume_aabb& aabb, T&& functor) const
     {
-        if (m_root_index == -1)
+        traverse(
+            [&](const bounding_volume_aabb& node) {
+                return node.min[0] <= aabb.max[0] && node.max[0] >= aabb.min[0] &&
+                       node.min[1] <= aabb.max[1] && node.max[1] >= aabb.min[1] &&
+                       node.min[2] <= aabb.max[2] && node.max[2] >= aabb.min[2];
+            },
+            [&](std::size_t proxy_id) {
+                functor(proxy_id);
+                return true;
+            });
+    }
+
+    /**
+     * @brief Writes the proxy ids of the leaves that overlap aabb to result.
+     *
+     * @return The number of overlapping leaves, which may be larger than result.size(). Only the
+     * first result.size() are written.
+     */
+    std::size_t query_aabb(const bounding_volume_aabb& aabb, std::span<std::size_t> result) const
+    {
+        std::size_t count = 0;
+        query_aabb(aabb, [&](std::size_t proxy_id) {
+            if (count < result.size())
+                result[count] = proxy_id;
+            ++count;
+        });
+        return count;
+    }
+
+    /**
+     * @brief Calls functor(proxy_id) for every leaf that overlaps the sphere.
+     */
+    template <typename T>
+    void query_sphere(const math::float3& center, float radius, T&& functor) const
+    {
+        float radius_squared = radius * radius;
+        traverse(
+            [&](const bounding_volume_aabb& node) {
+                return distance_squared(node, center) <= radius_squared;
+            },
+            [&](std::size_t proxy_id) {
+                functor(proxy_id);
+                return true;
+            });
+    }
+
+    /**
+     * @brief Writes the proxy ids of the leaves that overlap the sphere to result.
+     *
+     * @return The number of overlapping leaves, which may be larger than result.size(). Only the
+     * first result.size() are written.
+     */
+    std::size_t query_sphere(
+        const math::float3& center,
+        float radius,
+        std::span<std::size_t> result) const
+    {
+        std::size_t count = 0;
+        query_sphere(center, radius, [&](std::size_t proxy_id) {
+            if (count < result.size())
+                result[count] = proxy_id;
+            ++count;
+        });
+        return count;
+    }
+
+    /**
+     * @brief Finds the result.size() leaves closest to point, measured to the boxes.
+     *
+     * @param result Proxy ids sorted by increasing distance.
+     * @param distance Distance of each result, at least result.size() long.
+     * @return The number of leaves written, less than result.size() when the tree is smaller.
+     */
+    std::size_t k_nearest(
+        const math::float3& point,
+        std::span<std::size_t> result,
+        std::span<float> distance) const;
+
+    /**
+     * @brief Merges the leaves closest to point into a list of the result.size() closest entries
+     * found so far, which may hold the leaves of other trees. Leaves farther than the last entry
+     * of a full list are skipped without visiting their subtrees.
+     *
+     * @param result Entries sorted by increasing distance, convert(proxy_id) gives the entry of a
+     * leaf.
+     * @param distance Squared distance of each entry, at least result.size() long.
+     * @param count Number of entries in the list, updated.
+     */
+    template <typename T, typename Convert>
+    void merge_nearest(
+        const math::float3& point,
+        std::span<T> result,
+        std::span<float> distance,
+        std::size_t& count,
+        Convert&& convert) const
+    {
+        std::size_t k = result.size();
+        if (k == 0)
             return;
 
-        std::stack<std::size_t> dfs;
+        float bound = count < k ? std::numeric_limits<float>::infinity() : distance[k - 1];
+        float entry = 0.0f;
+        traverse(
+            [&](const bounding_volume_aabb& aabb) {
+                entry = bvh_tree::distance_squared(aabb, point);
+                return entry <= bound;
+            },
+            [&](std::size_t proxy_id) {
+                // Insertion into the sorted list, the last entry drops out when it is full.
+                std::size_t i = count < k ? count++ : k - 1;
+                for (; i > 0 && distance[i - 1] > entry; --i)
+                {
+                    result[i] = result[i - 1];
+                    distance[i] = distance[i - 1];
+                }
+                result[i] = convert(proxy_id);
+                distance[i] = entry;
+
+                if (count == k)
+                    bound = distance[k - 1];
+                return true;
+            });
+    }
+
+    template <typename T>
+    void print(T&& functor) const
+    {
+        if (m_root_index == INVALID_NODE_INDEX)
+            return;
+
+        std::stack<std::uint32_t> dfs;
         dfs.push(m_root_index);
 
         while (!dfs.empty())
@@ -35,9 +287,10 @@ public:
             auto index = dfs.top();
             dfs.pop();
 
-            functor(m_nodes[index].aabb, m_nodes[index].visible);
+            bool leaf = m_nodes[index].depth == 0;
+            functor(m_nodes[index].aabb, leaf);
 
-            if (m_nodes[index].depth > 0)
+            if (!leaf)
             {
                 dfs.push(m_nodes[index].left_child);
                 dfs.push(m_nodes[index].right_child);
@@ -46,31 +299,108 @@ public:
     }
 
 private:
+    static constexpr std::uint32_t INVALID_NODE_INDEX = -1;
+
     struct bvh_node
     {
         bounding_volume_aabb aabb;
 
-        std::size_t parent;
-        std::size_t left_child;
-        std::size_t right_child;
+        std::uint32_t parent;
+        std::uint32_t left_child;
+        std::uint32_t right_child;
 
-        int depth;
+        // 0 for leaves.
+        std::int32_t depth;
+    };
 
-        bool visible;
+    /**
+     * @brief Node of the depth first copy. The left child of an internal node is the next node,
+     * skip is the index of the first node after the subtree, so a traversal that rejects a node
+     * continues at skip and needs no stack.
+     */
+    struct linear_node
+    {
+        bounding_volume_aabb aabb;
+
+        std::uint32_t skip;
+
+        // INVALID_NODE_INDEX for internal nodes.
+        std::uint32_t proxy_id;
     };
+    static_assert(sizeof(linear_node) == 32);
+
+    /**
+     * @brief Stackless walk over the depth first copy. Subtrees whose box fails overlap are
+     * skipped, visit is called for every leaf that passes and returns false to stop.
+     */
+    template <typename Overlap, typename Visit>
+    void traverse(Overlap&& overlap, Visit&& visit) const
+    {
+        auto count = static_cast<std::uint32_t>(m_linear_nodes.size());
+        std::uint32_t i = 0;
+        while (i < count)
+        {
+            const linear_node& node = m_linear_nodes[i];
+            if (!overlap(node.aabb))
+            {
+                i = node.skip;
+                continue;
+            }
+
+            if (node.proxy_id != INVALID_NODE_INDEX && !visit(node.proxy_id))
+                return;
+
+            ++i;
+        }
+    }
+
+    // 0 when the point is inside the box.
+    static float distance_squared(const bounding_volume_aabb& aabb, const math::float3& point)
+    {
+        float result = 0.0f;
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            float d = std::max(std::max(aabb.min[i] - point[i], point[i] - aabb.max[i]), 0.0f);
+            result += d * d;
+        }
+        return result;
+    }
+
+    struct build_context;
+    struct build_bin;
+
+    std::uint32_t build_node(
+        build_context& context,
+        std::uint32_t begin,
+        std::uint32_t end,
+        std::uint32_t node_index,
+        std::uint32_t parent,
+        const build_bin& bounds);
+
+    void balance(std::uint32_t index);
+    bool refit_node(std::uint32_t index);
+    void optimize_node(std::uint32_t index);
+    std::uint32_t rotate(std::uint32_t index);
+
+    float calculate_cost(const bounding_volume_aabb& aabb) const;
+    bounding_volume_aabb union_box(const bounding_volume_aabb& a, const bounding_volume_aabb& b)
+        const;
 
-    void balance(std::size_t index);
-    std::size_t rotate(std::size_t index);
+    std::uint32_t allocate_node();
+    void deallocate_node(std::uint32_t index);
 
-    float calculate_cost(const bounding_volume_aabb& aabb);
-    bounding_volume_aabb union_box(const bounding_volume_aabb& a, const bounding_volume_aabb& b);
+    std::uint32_t m_root_index;
 
-    std::size_t allocate_node();
-    void deallocate_node(std::size_t index);
+    std::vector<bvh_node> m_nodes;
+    std::vector<std::uint32_t> m_free_nodes;
 
-    std::size_t m_root_index;
+    // Internal nodes touched by a batched refit, and their order by depth.
+    std::vector<std::uint32_t> m_refit_nodes;
+    std::vector<bool> m_refit_mark;
+    std::vector<std::uint32_t> m_refit_depth_offset;
+    std::vector<std::uint32_t> m_refit_order;
 
-    std::deque<bvh_node> m_nodes;
-    std::queue<std::size_t> m_free_nodes;
+    std::vector<linear_node> m_linear_nodes;
+    bool m_linear_dirty;
 };
 } // namespace ash::scene
\ No newline at end of file
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "scene/bounding_box.hpp"
+#include <span>
+#include <vector>
+
+namespace ash::task
+{
+class task_manager;
+}
+
+namespace ash::scene
+{
+/**
+ * @brief Triangles rasterized into the occlusion buffer. They should stay inside the rendered mesh,
+ * usually a few boxes or quads for walls and large props, so that nothing hidden behind the
+ * occluder shows through the real mesh.
+ */
+struct occluder
+{
+    // Object space.
+    std::vector<math::float3> vertices;
+    std::vector<std::uint32_t> indices;
+};
+
+/**
+ * @brief Low resolution depth buffer rasterized on the CPU. Occluders are drawn with the nearest
+ * depth per pixel, then boxes are tested against a coarse level of tiles holding the farthest
+ * depth of their pixels, and against the pixels only when a tile is not conclusive.
+ */
+class occlusion_buffer
+{
+public:
+    // Width and height are rounded up to multiples of TILE_SIZE.
+    occlusion_buffer(std::uint32_t width = 256, std::uint32_t height = 128);
+
+    void resize(std::uint32_t width, std::uint32_t height);
+
+    /**
+     * @brief Clears the occluders and the depth of the previous frame.
+     */
+    void begin(const math::float4x4& view_projection);
+
+    /**
+     * @brief Transforms the triangles of an occluder to screen space. Triangles that cross the near
+     * plane are dropped, which only makes the buffer less occluding.
+     */
+    void add_occluder(
+        std::span<const math::float3> vertices,
+        std::span<const std::uint32_t> indices,
+        const math::float4x4& to_world);
+
+    /**
+     * @brief Rasterizes the occluders added since begin.
+     *
+     * @param task Rasterizes horizontal bands of the buffer on the workers, runs on the calling
+     * thread when null.
+     */
+    void rasterize(task::task_manager* task = nullptr);
+
+    /**
+     * @brief Returns false when the box is completely behind the occluders. Boxes that cross the
+     * near plane are always visible. Any number of threads may test at the same time.
+     */
+    bool test(const bounding_volume_aabb& aabb) const;
+
+    bool empty() const noexcept { return m_triangles.empty(); }
+
+    std::uint32_t width() const noexcept { return m_width; }
+    std::uint32_t height() const noexcept { return m_height; }
+
+    // Nearest depth of each pixel, row major.
+    const std::vector<float>& depth() const noexcept { return m_depth; }
+
+    static constexpr std::uint32_t TILE_SIZE = 8;
+
+private:
+    struct triangle
+    {
+        // Screen space, y down.
+        float x[3];
+        float y[3];
+        float z[3];
+
+        std::uint32_t min_y;
+        std::uint32_t max_y;
+    };
+
+    void rasterize(const triangle& triangle, std::uint32_t begin_y, std::uint32_t end_y);
+    void update_tiles(std::uint32_t begin_y, std::uint32_t end_y);
+
+    std::uint32_t m_width;
+    std::uint32_t m_height;
+
+    math::float4x4 m_view_projection;
+
+    std::vector<triangle> m_triangles;
+
+    std::vector<float> m_depth;
+
+    // Farthest depth of each tile.
+    std::vector<float> m_tile_depth;
+};
+} // namespace ash::scene
@@ -3,9 +3,13 @@
 #include "core/context.hpp"
 #include "core/link.hpp"
 #include "ecs/world.hpp"
+#include "scene/bounding_box.hpp"
 #include "scene/bvh_tree.hpp"
+#include "scene/occlusion_buffer.hpp"
 #include "scene/transform.hpp"
+#include <algorithm>
 #include <memory>
+#include <span>
 
 namespace ash::scene
 {
@@ -25,17 +29,136 @@ public:
     void sync_world();
     void sync_world(ecs::entity root);
 
+    void save_previous();
+
     void frustum_culling(const std::vector<math::float4>& frustum);
 
+    /**
+     * @brief Frustum culling followed by occlusion culling. The occluder components are rasterized
+     * into the occlusion buffer and the boxes that passed the frustum are tested against it.
+     */
+    void frustum_culling(
+        const std::vector<math::float4>& frustum,
+        const math::float4x4& view_projection);
+
+    /**
+     * @brief Entities whose bounding box intersected the frustum of the last frustum_culling.
+     */
+    const std::vector<ecs::entity>& visible_entities() const noexcept { return m_visible_entities; }
+
+    /**
+     * @brief Calls functor(entity, distance) for every bounding box the ray hits, the functor
+     * returns the new max_distance like bvh_tree::raycast.
+     *
+     * The spatial queries see the boxes as they were at the last frustum_culling, the entities may
+     * have been unlinked since. Any number of threads may query at the same time as long as the
+     * scene is not updated meanwhile.
+     */
+    template <typename T>
+    void raycast(
+        const math::float3& origin,
+        const math::float3& direction,
+        float max_distance,
+        T&& functor) const
+    {
+        auto hit = [&](const std::vector<ecs::entity>& proxies) {
+            return [&](std::size_t proxy_id, float distance) {
+                max_distance = std::min(max_distance, functor(proxies[proxy_id], distance));
+                return max_distance;
+            };
+        };
+
+        m_static_bvh.raycast(origin, direction, max_distance, hit(m_static_query_proxies));
+        if (max_distance > 0.0f)
+            m_dynamic_bvh.raycast(origin, direction, max_distance, hit(m_dynamic_query_proxies));
+    }
+
+    /**
+     * @brief Calls functor(entity) for every bounding box that overlaps aabb.
+     */
+    template <typename T>
+    void query_aabb(const bounding_volume_aabb& aabb, T&& functor) const
+    {
+        m_static_bvh.query_aabb(aabb, [&](std::size_t proxy_id) {
+            functor(m_static_query_proxies[proxy_id]);
+        });
+        m_dynamic_bvh.query_aabb(aabb, [&](std::size_t proxy_id) {
+            functor(m_dynamic_query_proxies[proxy_id]);
+        });
+    }
+
+    /**
+     * @brief Calls functor(entity) for every bounding box that overlaps the sphere.
+     */
+    template <typename T>
+    void query_sphere(const math::float3& center, float radius, T&& functor) const
+    {
+        m_static_bvh.query_sphere(center, radius, [&](std::size_t proxy_id) {
+            functor(m_static_query_proxies[proxy_id]);
+        });
+        m_dynamic_bvh.query_sphere(center, radius, [&](std::size_t proxy_id) {
+            functor(m_dynamic_query_proxies[proxy_id]);
+        });
+    }
+
+    /**
+     * @brief Finds the result.size() bounding boxes closest to point, sorted by distance. Both
+     * trees are merged straight into the spans, so the query does not allocate and may run on
+     * several threads at once.
+     *
+     * @param distance Distance of each result, at least result.size() long.
+     * @return The number of entities written.
+     */
+    std::size_t k_nearest(
+        const math::float3& point,
+        std::span<ecs::entity> result,
+        std::span<float> distance) const;
+
     void draw_aabb();
 
 private:
     void on_entity_link(ecs::entity entity, core::link& link);
     void on_entity_unlink(ecs::entity entity, core::link& link);
 
+    void remove_proxy(bounding_box& bounding);
+
+    // Culls the boxes of proxies with math::bounding_box_batch::frustum_culling, without a tree.
+    void flat_culling(
+        const std::vector<math::float4>& frustum,
+        const std::vector<ecs::entity>& proxies);
+
+    void occlusion_culling(const math::float4x4& view_projection);
+
     ash::ecs::entity m_root;
 
     bvh_tree m_static_bvh;
     bvh_tree m_dynamic_bvh;
+
+    // The entity of every proxy, indexed by proxy id.
+    std::vector<ecs::entity> m_static_proxies;
+    std::vector<ecs::entity> m_dynamic_proxies;
+
+    // The proxies as they were when the trees were last flattened, used by the queries.
+    std::vector<ecs::entity> m_static_query_proxies;
+    std::vector<ecs::entity> m_dynamic_query_proxies;
+
+    // Static proxies were linked or unlinked since the static tree was built, unlinked ones are
+    // INVALID_ENTITY until the next build compacts them.
+    bool m_static_dirty;
+    std::size_t m_static_build_count;
+
+    // Dynamic proxies that moved little this frame and are refitted in one batch.
+    std::vector<std::size_t> m_refit_proxies;
+    std::vector<bounding_volume_aabb> m_refit_boxes;
+
+    std::vector<std::size_t> m_visible_proxies;
+    bvh_tree::culling_scratch m_culling_scratch;
+    std::vector<ecs::entity> m_visible_entities;
+
+    occlusion_buffer m_occlusion_buffer;
+    std::vector<std::uint8_t> m_occlusion_visible;
+
+    // Per hierarchy node propagation state of sync_local.
+    std::vector<std::uint8_t> m_sync_state;
 };
 } // namespace ash::scene
\ No newline at end of file
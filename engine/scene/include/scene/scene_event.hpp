@@ -6,11 +6,11 @@ namespace ash::scene
 {
 struct event_enter_scene
 {
-    using dispatcher = core::sequence_dispatcher<std::function<void(ecs::entity)>>;
+    using dispatcher = core::sequence_dispatcher<void(ecs::entity)>;
 };
 
 struct event_exit_scene
 {
-    using dispatcher = core::sequence_dispatcher<std::function<void(ecs::entity)>>;
+    using dispatcher = core::sequence_dispatcher<void(ecs::entity)>;
 };
 } // namespace ash::scene
\ No newline at end of file
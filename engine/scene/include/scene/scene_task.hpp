@@ -0,0 +1,6 @@
+#pragma once
+
+namespace ash::scene
+{
+static constexpr char TASK_SCENE_SAVE_PREVIOUS[] = "scene save previous";
+}
@@ -5,7 +5,7 @@
 
 namespace ash::scene
 {
-class transform
+class alignas(16) transform
 {
 public:
     transform() noexcept;
@@ -71,6 +71,17 @@ public:
 
     void in_scene(bool in_scene) noexcept { m_in_scene = in_scene; }
 
+    void interpolation(bool interpolation) noexcept
+    {
+        m_interpolation = interpolation;
+        m_previous_to_world = m_to_world;
+    }
+
+    /**
+     * @brief Records the current world matrix as the start point of the next fixed step.
+     */
+    void save_previous() noexcept { m_previous_to_world = m_to_world; }
+
     const math::float3& position() const noexcept { return m_position; }
     const math::float4& rotation() const noexcept { return m_rotation; }
     const math::float3& scale() const noexcept { return m_scale; }
@@ -78,7 +89,16 @@ public:
     const math::float4x4& to_parent() const noexcept { return m_to_parent; }
     const math::float4x4& to_world() const noexcept { return m_to_world; }
 
+    /**
+     * @brief World matrix blended between the previous and the current fixed step. Returns the
+     * current world matrix when interpolation is disabled.
+     *
+     * @param alpha Interpolation factor, usually timer::fixed_alpha.
+     */
+    math::float4x4 to_world_interpolated(float alpha) const;
+
     bool in_scene() const noexcept { return m_in_scene; }
+    bool interpolation() const noexcept { return m_interpolation; }
 
     bool dirty() const noexcept { return m_dirty; }
     void mark_dirty() noexcept { m_dirty = true; }
@@ -87,14 +107,18 @@ public:
     void reset_sync_count() noexcept { m_sync_count = 0; }
 
 private:
-    math::float3 m_position;
-    math::float4 m_rotation;
-    math::float3 m_scale;
+    // Matrices come first and every member starts on a 16 byte boundary, so simd::load and
+    // simd::store never straddle cache lines.
+    alignas(16) math::float4x4 m_to_parent;
+    alignas(16) math::float4x4 m_to_world;
+    alignas(16) math::float4x4 m_previous_to_world;
 
-    math::float4x4 m_to_parent;
-    math::float4x4 m_to_world;
+    alignas(16) math::float3 m_position;
+    alignas(16) math::float4 m_rotation;
+    alignas(16) math::float3 m_scale;
 
     bool m_in_scene;
+    bool m_interpolation;
 
     bool m_dirty;
     std::size_t m_sync_count;
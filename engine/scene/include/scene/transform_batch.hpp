@@ -0,0 +1,40 @@
+#pragma once
+
+#include "math/math.hpp"
+#include "scene/transform.hpp"
+
+namespace ash::scene
+{
+/**
+ * @brief Structure of arrays copy of up to SIZE transforms. The local matrices of the whole batch
+ * are built in one pass by math::matrix_batch.
+ */
+class alignas(32) transform_batch
+{
+public:
+    static constexpr std::size_t SIZE = 8;
+
+public:
+    transform_batch() noexcept;
+
+    void push(const transform& transform) noexcept;
+    void clear() noexcept { m_size = 0; }
+
+    /**
+     * @brief Computes scale * rotation * translation for every transform in the batch.
+     *
+     * @param result Array of at least SIZE matrices.
+     */
+    void affine_transform(math::float4x4_simd* result) const noexcept;
+
+    std::size_t size() const noexcept { return m_size; }
+    bool full() const noexcept { return m_size == SIZE; }
+
+private:
+    alignas(32) float m_position[3][SIZE];
+    alignas(32) float m_rotation[4][SIZE];
+    alignas(32) float m_scale[3][SIZE];
+
+    std::size_t m_size;
+};
+} // namespace ash::scene
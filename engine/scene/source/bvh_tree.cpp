@@ -1,18 +1,112 @@
 #include "scene/bvh_tree.hpp"
+#include "assert.hpp"
 #include "log.hpp"
-#include <stack>
+#include "task/task_manager.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <queue>
 
 namespace ash::scene
 {
-static constexpr std::size_t INVALID_NODE_INDEX = -1;
+namespace
+{
+constexpr std::size_t BUILD_BIN_COUNT = 16;
+
+// Nodes with fewer boxes are binned and split on one thread.
+constexpr std::size_t BUILD_PARALLEL_THRESHOLD = 4096;
+constexpr std::size_t BUILD_BIN_GRAIN = 4096;
+
+// A moved leaf is refitted in place while the box of its parent grows less than this.
+constexpr float REFIT_MAX_GROWTH = 1.25f;
+
+// Nodes of a level tested by one call of the batched frustum culling kernel.
+constexpr std::size_t CULL_GROUP_SIZE = 256;
+
+bool equal_box(const bounding_volume_aabb& a, const bounding_volume_aabb& b)
+{
+    return a.min[0] == b.min[0] && a.min[1] == b.min[1] && a.min[2] == b.min[2] &&
+           a.max[0] == b.max[0] && a.max[1] == b.max[1] && a.max[2] == b.max[2];
+}
+} // namespace
+
+struct bvh_tree::build_bin
+{
+    void reset()
+    {
+        float inf = std::numeric_limits<float>::infinity();
+        min = centroid_min = math::simd::set(inf);
+        max = centroid_max = math::simd::set(-inf);
+        count = 0;
+    }
+
+    void add(math::float4_simd box_min, math::float4_simd box_max, math::float4_simd centroid)
+    {
+        min = math::simd::min(min, box_min);
+        max = math::simd::max(max, box_max);
+        centroid_min = math::simd::min(centroid_min, centroid);
+        centroid_max = math::simd::max(centroid_max, centroid);
+        ++count;
+    }
+
+    void merge(const build_bin& other)
+    {
+        min = math::simd::min(min, other.min);
+        max = math::simd::max(max, other.max);
+        centroid_min = math::simd::min(centroid_min, other.centroid_min);
+        centroid_max = math::simd::max(centroid_max, other.centroid_max);
+        count += other.count;
+    }
+
+    float cost() const
+    {
+        math::float4 d;
+        math::simd::store(math::vector_simd::sub(max, min), d);
+        return (d[0] * d[1] + d[1] * d[2] + d[2] * d[0]) * static_cast<float>(count);
+    }
+
+    math::float4_simd min;
+    math::float4_simd max;
+    math::float4_simd centroid_min;
+    math::float4_simd centroid_max;
+    std::uint32_t count;
+};
+
+struct bvh_tree::build_context
+{
+    // Partitioned in place of an index array, so that binning reads the boxes sequentially.
+    struct reference
+    {
+        bounding_volume_aabb aabb;
+
+        // Twice the box center.
+        math::float3 centroid;
+
+        std::uint32_t index;
+    };
+
+    std::vector<reference> references;
+
+    task::task_manager* task;
 
-bvh_tree::bvh_tree() : m_root_index(INVALID_NODE_INDEX)
+    static void add(build_bin& bin, const reference& reference)
+    {
+        bin.add(
+            math::simd::load(reference.aabb.min),
+            math::simd::load(reference.aabb.max),
+            math::simd::load(reference.centroid));
+    }
+};
+
+bvh_tree::bvh_tree() : m_root_index(INVALID_NODE_INDEX), m_linear_dirty(false)
 {
 }
 
 std::size_t bvh_tree::add(const bounding_volume_aabb& aabb)
 {
-    std::size_t new_node_index = allocate_node();
+    m_linear_dirty = true;
+
+    std::uint32_t new_node_index = allocate_node();
     m_nodes[new_node_index].aabb = aabb;
 
     if (m_root_index == INVALID_NODE_INDEX)
@@ -23,8 +117,8 @@ std::size_t bvh_tree::add(const bounding_volume_aabb& aabb)
     }
 
     // Find the best sibling.
-    std::size_t best_sibling_index = m_root_index;
-    std::queue<std::pair<std::size_t, float>> bfs;
+    std::uint32_t best_sibling_index = m_root_index;
+    std::queue<std::pair<std::uint32_t, float>> bfs;
     bfs.push({m_root_index, 0.0f});
     float min_cost = std::numeric_limits<float>::infinity();
     while (!bfs.empty())
@@ -51,8 +145,8 @@ std::size_t bvh_tree::add(const bounding_volume_aabb& aabb)
     }
 
     // Create a new parent.
-    std::size_t old_parent_index = m_nodes[best_sibling_index].parent;
-    std::size_t new_parent_index = allocate_node();
+    std::uint32_t old_parent_index = m_nodes[best_sibling_index].parent;
+    std::uint32_t new_parent_index = allocate_node();
 
     m_nodes[new_parent_index].left_child = best_sibling_index;
     m_nodes[new_parent_index].right_child = new_node_index;
@@ -82,18 +176,20 @@ std::size_t bvh_tree::add(const bounding_volume_aabb& aabb)
 
 void bvh_tree::remove(std::size_t proxy_id)
 {
+    m_linear_dirty = true;
+
     if (proxy_id == m_root_index)
     {
         m_root_index = INVALID_NODE_INDEX;
     }
     else
     {
-        std::size_t parent_index = m_nodes[proxy_id].parent;
-        std::size_t sibling_index = m_nodes[parent_index].left_child == proxy_id
-                                        ? m_nodes[parent_index].right_child
-                                        : m_nodes[parent_index].left_child;
+        std::uint32_t parent_index = m_nodes[proxy_id].parent;
+        std::uint32_t sibling_index = m_nodes[parent_index].left_child == proxy_id
+                                          ? m_nodes[parent_index].right_child
+                                          : m_nodes[parent_index].left_child;
 
-        std::size_t grandparent_index = m_nodes[parent_index].parent;
+        std::uint32_t grandparent_index = m_nodes[parent_index].parent;
 
         m_nodes[sibling_index].parent = grandparent_index;
         if (grandparent_index != INVALID_NODE_INDEX)
@@ -113,127 +209,475 @@ void bvh_tree::remove(std::size_t proxy_id)
         deallocate_node(parent_index);
     }
 
-    deallocate_node(proxy_id);
+    deallocate_node(static_cast<std::uint32_t>(proxy_id));
 }
 
 void bvh_tree::clear()
 {
+    m_root_index = INVALID_NODE_INDEX;
+    m_nodes.clear();
+    m_free_nodes.clear();
+    m_linear_nodes.clear();
+    m_linear_dirty = false;
 }
 
 std::size_t bvh_tree::update(std::size_t proxy_id, const bounding_volume_aabb& aabb)
 {
-    remove(proxy_id);
-    return add(aabb);
+    if (!refittable(proxy_id, aabb))
+    {
+        remove(proxy_id);
+        return add(aabb);
+    }
+
+    refit(proxy_id, aabb);
+    return proxy_id;
 }
 
-void bvh_tree::frustum_culling(const std::vector<math::float4>& frustum)
+bool bvh_tree::refittable(std::size_t proxy_id, const bounding_volume_aabb& aabb) const
 {
-    if (m_root_index == -1)
+    std::uint32_t parent_index = m_nodes[proxy_id].parent;
+    if (parent_index == INVALID_NODE_INDEX)
+        return true;
+
+    std::uint32_t sibling_index = m_nodes[parent_index].left_child == proxy_id
+                                      ? m_nodes[parent_index].right_child
+                                      : m_nodes[parent_index].left_child;
+
+    float old_cost = calculate_cost(m_nodes[parent_index].aabb);
+    float new_cost = calculate_cost(union_box(m_nodes[sibling_index].aabb, aabb));
+    return new_cost <= old_cost * REFIT_MAX_GROWTH;
+}
+
+void bvh_tree::refit(std::size_t proxy_id, const bounding_volume_aabb& aabb)
+{
+    ASH_ASSERT(m_nodes[proxy_id].depth == 0, "Proxy id is not a leaf.");
+
+    m_linear_dirty = true;
+
+    m_nodes[proxy_id].aabb = aabb;
+
+    // Ancestors above the first unchanged box are unchanged too.
+    std::uint32_t index = m_nodes[proxy_id].parent;
+    while (index != INVALID_NODE_INDEX && refit_node(index))
+        index = m_nodes[index].parent;
+}
+
+void bvh_tree::refit(
+    std::span<const std::size_t> proxy_ids,
+    std::span<const bounding_volume_aabb> boxes,
+    bool optimize)
+{
+    ASH_ASSERT(proxy_ids.size() == boxes.size());
+
+    if (proxy_ids.empty())
+        return;
+
+    m_linear_dirty = true;
+
+    m_refit_mark.assign(m_nodes.size(), false);
+    m_refit_nodes.clear();
+
+    for (std::size_t i = 0; i < proxy_ids.size(); ++i)
+    {
+        ASH_ASSERT(m_nodes[proxy_ids[i]].depth == 0, "Proxy id is not a leaf.");
+        m_nodes[proxy_ids[i]].aabb = boxes[i];
+
+        // Stop at the first ancestor already collected by another leaf.
+        std::uint32_t index = m_nodes[proxy_ids[i]].parent;
+        while (index != INVALID_NODE_INDEX && !m_refit_mark[index])
+        {
+            m_refit_mark[index] = true;
+            m_refit_nodes.push_back(index);
+            index = m_nodes[index].parent;
+        }
+    }
+
+    // Children have a smaller depth than their parent, so visiting the nodes by increasing depth
+    // resizes the children first. Depths are small, a counting sort is enough.
+    std::vector<std::uint32_t>& depth_offset = m_refit_depth_offset;
+    depth_offset.assign(m_nodes[m_root_index].depth + 2, 0);
+    for (std::uint32_t index : m_refit_nodes)
+        ++depth_offset[m_nodes[index].depth + 1];
+    for (std::size_t i = 1; i < depth_offset.size(); ++i)
+        depth_offset[i] += depth_offset[i - 1];
+
+    std::vector<std::uint32_t>& order = m_refit_order;
+    order.resize(m_refit_nodes.size());
+    for (std::uint32_t index : m_refit_nodes)
+        order[depth_offset[m_nodes[index].depth]++] = index;
+
+    for (std::uint32_t index : order)
+    {
+        if (optimize)
+            optimize_node(index);
+        refit_node(index);
+    }
+}
+
+void bvh_tree::build(std::span<const bounding_volume_aabb> boxes, task::task_manager* task)
+{
+    clear();
+    if (boxes.empty())
         return;
 
-    for (bvh_node& node : m_nodes)
-        node.visible = false;
+    auto leaf_count = static_cast<std::uint32_t>(boxes.size());
 
-    std::stack<std::size_t> dfs;
-    dfs.push(m_root_index);
+    // Leaves take the first indices, so the proxy id of a box is its index, the internal nodes
+    // follow.
+    m_nodes.resize(leaf_count * 2 - 1);
+    for (std::uint32_t i = 0; i < leaf_count; ++i)
+    {
+        m_nodes[i].aabb = boxes[i];
+        m_nodes[i].left_child = INVALID_NODE_INDEX;
+        m_nodes[i].right_child = INVALID_NODE_INDEX;
+        m_nodes[i].depth = 0;
+    }
 
-    std::stack<std::size_t> inside_nodes;
+    build_context context = {};
+    context.task = task;
+    context.references.resize(leaf_count);
+
+    build_bin bounds;
+    bounds.reset();
+    for (std::uint32_t i = 0; i < leaf_count; ++i)
+    {
+        build_context::reference& reference = context.references[i];
+        reference.aabb = boxes[i];
+        reference.index = i;
+        math::simd::store(
+            math::vector_simd::add(math::simd::load(boxes[i].min), math::simd::load(boxes[i].max)),
+            reference.centroid);
+        context.add(bounds, reference);
+    }
+
+    m_root_index = build_node(context, 0, leaf_count, leaf_count, INVALID_NODE_INDEX, bounds);
+    m_linear_dirty = true;
+}
+
+bool bvh_tree::flatten()
+{
+    if (!m_linear_dirty)
+        return false;
+    m_linear_dirty = false;
+
+    m_linear_nodes.clear();
+    if (m_root_index == INVALID_NODE_INDEX)
+        return true;
+
+    // Pre-order, the left child is pushed last so that it directly follows its parent.
+    std::vector<std::uint32_t> dfs = {m_root_index};
     while (!dfs.empty())
     {
-        std::size_t index = dfs.top();
-        dfs.pop();
+        std::uint32_t index = dfs.back();
+        dfs.pop_back();
 
-        bool cull = false;
-        bool inside = true;
-        for (std::size_t i = 0; i < 6; ++i)
+        const bvh_node& node = m_nodes[index];
+        if (node.depth == 0)
         {
-            math::float4_align max_vertex = {};
-            math::float4_align min_vertex = {};
-            if (frustum[i][0] < 0.0f)
-            {
-                max_vertex[0] = m_nodes[index].aabb.min[0];
-                min_vertex[0] = m_nodes[index].aabb.max[0];
-            }
-            else
-            {
-                max_vertex[0] = m_nodes[index].aabb.max[0];
-                min_vertex[0] = m_nodes[index].aabb.min[0];
-            }
+            m_linear_nodes.push_back({node.aabb, 0, index});
+        }
+        else
+        {
+            m_linear_nodes.push_back({node.aabb, 0, INVALID_NODE_INDEX});
+            dfs.push_back(node.right_child);
+            dfs.push_back(node.left_child);
+        }
+    }
 
-            if (frustum[i][1] < 0.0f)
-            {
-                max_vertex[1] = m_nodes[index].aabb.min[1];
-                min_vertex[1] = m_nodes[index].aabb.max[1];
-            }
-            else
-            {
-                max_vertex[1] = m_nodes[index].aabb.max[1];
-                min_vertex[1] = m_nodes[index].aabb.min[1];
-            }
+    // The right child starts where the left subtree ends, so the skip indices of both subtrees
+    // are known when walking backwards.
+    auto count = static_cast<std::uint32_t>(m_linear_nodes.size());
+    for (std::uint32_t i = count; i-- > 0;)
+    {
+        if (m_linear_nodes[i].proxy_id != INVALID_NODE_INDEX)
+            m_linear_nodes[i].skip = i + 1;
+        else
+            m_linear_nodes[i].skip = m_linear_nodes[m_linear_nodes[i + 1].skip].skip;
+    }
+
+    return true;
+}
+
+void bvh_tree::frustum_culling(
+    const std::vector<math::float4>& frustum,
+    std::vector<std::size_t>& visible,
+    culling_scratch& scratch) const
+{
+    ASH_ASSERT(frustum.size() == 6);
+    ASH_ASSERT(!m_linear_dirty, "The tree must be flattened before queries.");
 
-            if (frustum[i][2] < 0.0f)
+    if (m_linear_nodes.empty())
+        return;
+
+    // The tree is walked one level at a time, so that the nodes of a level can be transposed and
+    // tested in groups by the batched kernel. The group size is a multiple of 32, so the bitsets
+    // of a group are whole words.
+    alignas(64) float min[3 * CULL_GROUP_SIZE];
+    alignas(64) float max[3 * CULL_GROUP_SIZE];
+    std::uint32_t intersect[CULL_GROUP_SIZE / 32];
+    std::uint32_t inside[CULL_GROUP_SIZE / 32];
+
+    std::vector<std::uint32_t>& level = scratch.level;
+    std::vector<std::uint32_t>& next_level = scratch.next_level;
+    level.assign(1, 0);
+    while (!level.empty())
+    {
+        next_level.clear();
+
+        for (std::size_t begin = 0; begin < level.size(); begin += CULL_GROUP_SIZE)
+        {
+            std::size_t size = std::min(CULL_GROUP_SIZE, level.size() - begin);
+            for (std::size_t i = 0; i < size; ++i)
             {
-                max_vertex[2] = m_nodes[index].aabb.min[2];
-                min_vertex[2] = m_nodes[index].aabb.max[2];
+                const bounding_volume_aabb& box = m_linear_nodes[level[begin + i]].aabb;
+                for (std::size_t c = 0; c < 3; ++c)
+                {
+                    min[c * size + i] = box.min[c];
+                    max[c * size + i] = box.max[c];
+                }
             }
-            else
+
+            math::bounding_box_batch::frustum_culling(
+                min,
+                max,
+                frustum.data(),
+                intersect,
+                inside,
+                size);
+
+            for (std::size_t i = 0; i < size; ++i)
             {
-                max_vertex[2] = m_nodes[index].aabb.max[2];
-                min_vertex[2] = m_nodes[index].aabb.min[2];
+                std::uint32_t bit = 1u << (i % 32);
+                if ((intersect[i / 32] & bit) == 0)
+                    continue;
+
+                std::uint32_t index = level[begin + i];
+                const linear_node& node = m_linear_nodes[index];
+                if ((inside[i / 32] & bit) != 0)
+                {
+                    // Completely inside, every leaf of the subtree is visible.
+                    for (std::uint32_t j = index; j < node.skip; ++j)
+                    {
+                        if (m_linear_nodes[j].proxy_id != INVALID_NODE_INDEX)
+                            visible.push_back(m_linear_nodes[j].proxy_id);
+                    }
+                }
+                else if (node.proxy_id != INVALID_NODE_INDEX)
+                {
+                    visible.push_back(node.proxy_id);
+                }
+                else
+                {
+                    // The left child is the next node, the right child follows its subtree.
+                    next_level.push_back(index + 1);
+                    next_level.push_back(m_linear_nodes[index + 1].skip);
+                }
             }
+        }
 
-            math::float4_simd max = math::simd::load(max_vertex);
-            math::float4_simd normal = math::simd::load(frustum[i]);
-            if (math::vector_simd::dot(max, normal) + frustum[i][3] < 0.0f)
+        level.swap(next_level);
+    }
+}
+
+std::size_t bvh_tree::k_nearest(
+    const math::float3& point,
+    std::span<std::size_t> result,
+    std::span<float> distance) const
+{
+    ASH_ASSERT(distance.size() >= result.size());
+
+    std::size_t count = 0;
+    merge_nearest(point, result, distance, count, [](std::size_t proxy_id) { return proxy_id; });
+
+    for (std::size_t i = 0; i < count; ++i)
+        distance[i] = std::sqrt(distance[i]);
+
+    return count;
+}
+
+std::uint32_t bvh_tree::build_node(
+    build_context& context,
+    std::uint32_t begin,
+    std::uint32_t end,
+    std::uint32_t node_index,
+    std::uint32_t parent,
+    const build_bin& bounds)
+{
+    if (end - begin == 1)
+    {
+        std::uint32_t leaf_index = context.references[begin].index;
+        m_nodes[leaf_index].parent = parent;
+        return leaf_index;
+    }
+
+    std::size_t count = end - begin;
+    bool parallel = context.task != nullptr && count >= BUILD_PARALLEL_THRESHOLD;
+
+    // Split along the axis with the largest centroid extent.
+    math::float4 centroid_min;
+    math::float4 centroid_extent;
+    math::simd::store(bounds.centroid_min, centroid_min);
+    math::simd::store(
+        math::vector_simd::sub(bounds.centroid_max, bounds.centroid_min),
+        centroid_extent);
+
+    std::size_t axis = 0;
+    if (centroid_extent[1] > centroid_extent[axis])
+        axis = 1;
+    if (centroid_extent[2] > centroid_extent[axis])
+        axis = 2;
+
+    std::uint32_t middle = begin + static_cast<std::uint32_t>(count / 2);
+    build_bin left_bounds;
+    build_bin right_bounds;
+    left_bounds.reset();
+    right_bounds.reset();
+
+    if (count > 2 && centroid_extent[axis] > 0.0f)
+    {
+        float scale = static_cast<float>(BUILD_BIN_COUNT) * 0.9999f / centroid_extent[axis];
+        auto bin_index = [&](const build_context::reference& reference) {
+            float offset = reference.centroid[axis] - centroid_min[axis];
+            return static_cast<std::size_t>(offset * scale);
+        };
+
+        using bin_array = std::array<build_bin, BUILD_BIN_COUNT>;
+        auto bin_range = [&](std::size_t range_begin, std::size_t range_end, bin_array& bins) {
+            for (build_bin& bin : bins)
+                bin.reset();
+            for (std::size_t i = range_begin; i < range_end; ++i)
             {
-                cull = true;
-                break;
+                const build_context::reference& reference = context.references[i];
+                context.add(bins[bin_index(reference)], reference);
             }
-            else if (inside)
+        };
+
+        bin_array bins;
+        if (parallel)
+        {
+            std::vector<bin_array> chunk_bins((count + BUILD_BIN_GRAIN - 1) / BUILD_BIN_GRAIN);
+            context.task->parallel_for(
+                count,
+                BUILD_BIN_GRAIN,
+                [&](std::size_t chunk_begin, std::size_t chunk_end) {
+                    bin_range(
+                        begin + chunk_begin,
+                        begin + chunk_end,
+                        chunk_bins[chunk_begin / BUILD_BIN_GRAIN]);
+                });
+
+            bins = chunk_bins[0];
+            for (std::size_t i = 1; i < chunk_bins.size(); ++i)
             {
-                math::float4_simd min = math::simd::load(min_vertex);
-                if (math::vector_simd::dot(min, normal) + frustum[i][3] < 0.0f)
-                    inside = false;
+                for (std::size_t j = 0; j < BUILD_BIN_COUNT; ++j)
+                    bins[j].merge(chunk_bins[i][j]);
             }
         }
+        else
+        {
+            bin_range(begin, end, bins);
+        }
 
-        if (!cull)
+        // Sweep from both sides, the split k puts bins [0, k) on the left.
+        std::array<build_bin, BUILD_BIN_COUNT> right_sweep;
+        right_sweep[BUILD_BIN_COUNT - 1] = bins[BUILD_BIN_COUNT - 1];
+        for (std::size_t k = BUILD_BIN_COUNT - 1; k-- > 0;)
         {
-            m_nodes[index].visible = true;
-            if (inside)
-            {
-                inside_nodes.push(index);
-            }
-            else if (m_nodes[index].depth > 0)
+            right_sweep[k] = right_sweep[k + 1];
+            right_sweep[k].merge(bins[k]);
+        }
+
+        build_bin left_sweep;
+        left_sweep.reset();
+
+        float best_cost = std::numeric_limits<float>::infinity();
+        std::size_t best_split = 0;
+        for (std::size_t k = 1; k < BUILD_BIN_COUNT; ++k)
+        {
+            left_sweep.merge(bins[k - 1]);
+            if (left_sweep.count == 0 || right_sweep[k].count == 0)
+                continue;
+
+            float cost = left_sweep.cost() + right_sweep[k].cost();
+            if (cost < best_cost)
             {
-                dfs.push(m_nodes[index].left_child);
-                dfs.push(m_nodes[index].right_child);
+                best_cost = cost;
+                best_split = k;
+                left_bounds = left_sweep;
+                right_bounds = right_sweep[k];
             }
         }
+
+        if (best_split != 0)
+        {
+            auto split = std::partition(
+                context.references.begin() + begin,
+                context.references.begin() + end,
+                [&](const build_context::reference& reference) {
+                    return bin_index(reference) < best_split;
+                });
+            middle = static_cast<std::uint32_t>(split - context.references.begin());
+        }
     }
 
-    while (!inside_nodes.empty())
+    if (left_bounds.count == 0)
     {
-        std::size_t index = inside_nodes.top();
-        inside_nodes.pop();
+        // Every centroid is at the same place, split by count.
+        for (std::uint32_t i = begin; i < middle; ++i)
+            context.add(left_bounds, context.references[i]);
+        for (std::uint32_t i = middle; i < end; ++i)
+            context.add(right_bounds, context.references[i]);
+    }
+
+    bvh_node& node = m_nodes[node_index];
+    node.parent = parent;
+    math::simd::store(bounds.min, node.aabb.min);
+    math::simd::store(bounds.max, node.aabb.max);
 
-        m_nodes[index].visible = true;
-        if (m_nodes[index].depth > 0)
+    // A subtree of n leaves uses n - 1 internal nodes, the left subtree takes the ones right
+    // after this node.
+    std::uint32_t child_index[2] = {node_index + 1, node_index + (middle - begin)};
+    auto build_child = [&](std::size_t i) {
+        if (i == 0)
+        {
+            child_index[0] =
+                build_node(context, begin, middle, child_index[0], node_index, left_bounds);
+        }
+        else
         {
-            inside_nodes.push(m_nodes[index].left_child);
-            inside_nodes.push(m_nodes[index].right_child);
+            child_index[1] =
+                build_node(context, middle, end, child_index[1], node_index, right_bounds);
         }
+    };
+
+    if (parallel)
+    {
+        context.task->parallel_for(2, 1, [&](std::size_t child_begin, std::size_t child_end) {
+            for (std::size_t i = child_begin; i < child_end; ++i)
+                build_child(i);
+        });
+    }
+    else
+    {
+        build_child(0);
+        build_child(1);
     }
+
+    node.left_child = child_index[0];
+    node.right_child = child_index[1];
+    node.depth = std::max(m_nodes[child_index[0]].depth, m_nodes[child_index[1]].depth) + 1;
+
+    return node_index;
 }
 
-void bvh_tree::balance(std::size_t index)
+void bvh_tree::balance(std::uint32_t index)
 {
     while (index != INVALID_NODE_INDEX)
     {
         index = rotate(index);
 
-        std::size_t child1_index = m_nodes[index].left_child;
-        std::size_t child2_index = m_nodes[index].right_child;
+        std::uint32_t child1_index = m_nodes[index].left_child;
+        std::uint32_t child2_index = m_nodes[index].right_child;
         m_nodes[index].aabb = union_box(m_nodes[child1_index].aabb, m_nodes[child2_index].aabb);
         m_nodes[index].depth =
             std::max(m_nodes[child1_index].depth, m_nodes[child2_index].depth) + 1;
@@ -242,11 +686,85 @@ void bvh_tree::balance(std::size_t index)
     }
 }
 
-std::size_t bvh_tree::rotate(std::size_t index)
+bool bvh_tree::refit_node(std::uint32_t index)
 {
-    std::size_t parent_index = m_nodes[index].parent;
-    std::size_t left_index = m_nodes[index].left_child;
-    std::size_t right_index = m_nodes[index].right_child;
+    bvh_node& node = m_nodes[index];
+    bounding_volume_aabb aabb =
+        union_box(m_nodes[node.left_child].aabb, m_nodes[node.right_child].aabb);
+    node.depth = std::max(m_nodes[node.left_child].depth, m_nodes[node.right_child].depth) + 1;
+
+    if (equal_box(node.aabb, aabb))
+        return false;
+
+    node.aabb = aabb;
+    return true;
+}
+
+void bvh_tree::optimize_node(std::uint32_t index)
+{
+    // Try to swap each child with a grandchild on the other side. The box of this node stays the
+    // same, the box of the child whose subtree changes is the only cost that moves.
+    std::uint32_t best_child = INVALID_NODE_INDEX;
+    std::uint32_t best_grandchild = INVALID_NODE_INDEX;
+    float best_gain = 0.0f;
+
+    auto evaluate = [&](std::uint32_t child_index, std::uint32_t other_index) {
+        const bvh_node& other = m_nodes[other_index];
+        if (other.depth == 0)
+            return;
+
+        float other_cost = calculate_cost(other.aabb);
+        const bounding_volume_aabb& child_aabb = m_nodes[child_index].aabb;
+
+        float gain = other_cost -
+                     calculate_cost(union_box(child_aabb, m_nodes[other.right_child].aabb));
+        if (gain > best_gain)
+        {
+            best_gain = gain;
+            best_child = child_index;
+            best_grandchild = other.left_child;
+        }
+
+        gain = other_cost - calculate_cost(union_box(child_aabb, m_nodes[other.left_child].aabb));
+        if (gain > best_gain)
+        {
+            best_gain = gain;
+            best_child = child_index;
+            best_grandchild = other.right_child;
+        }
+    };
+
+    evaluate(m_nodes[index].left_child, m_nodes[index].right_child);
+    evaluate(m_nodes[index].right_child, m_nodes[index].left_child);
+
+    if (best_child == INVALID_NODE_INDEX)
+        return;
+
+    bvh_node& node = m_nodes[index];
+    std::uint32_t other_index = node.left_child == best_child ? node.right_child : node.left_child;
+    bvh_node& other = m_nodes[other_index];
+
+    if (node.left_child == best_child)
+        node.left_child = best_grandchild;
+    else
+        node.right_child = best_grandchild;
+
+    if (other.left_child == best_grandchild)
+        other.left_child = best_child;
+    else
+        other.right_child = best_child;
+
+    m_nodes[best_child].parent = other_index;
+    m_nodes[best_grandchild].parent = index;
+
+    refit_node(other_index);
+}
+
+std::uint32_t bvh_tree::rotate(std::uint32_t index)
+{
+    std::uint32_t parent_index = m_nodes[index].parent;
+    std::uint32_t left_index = m_nodes[index].left_child;
+    std::uint32_t right_index = m_nodes[index].right_child;
 
     int balance = m_nodes[left_index].depth - m_nodes[right_index].depth;
     if (balance < -1)
@@ -264,8 +782,8 @@ std::size_t bvh_tree::rotate(std::size_t index)
             m_root_index = right_index;
         }
 
-        std::size_t rl_index = m_nodes[right_index].left_child;
-        std::size_t rr_index = m_nodes[right_index].right_child;
+        std::uint32_t rl_index = m_nodes[right_index].left_child;
+        std::uint32_t rr_index = m_nodes[right_index].right_child;
         if (m_nodes[rl_index].depth < m_nodes[rr_index].depth)
         {
             m_nodes[rl_index].parent = index;
@@ -305,8 +823,8 @@ std::size_t bvh_tree::rotate(std::size_t index)
             m_root_index = left_index;
         }
 
-        std::size_t ll_index = m_nodes[left_index].left_child;
-        std::size_t lr_index = m_nodes[left_index].right_child;
+        std::uint32_t ll_index = m_nodes[left_index].left_child;
+        std::uint32_t lr_index = m_nodes[left_index].right_child;
         if (m_nodes[ll_index].depth < m_nodes[lr_index].depth)
         {
             m_nodes[ll_index].parent = index;
@@ -335,7 +853,7 @@ std::size_t bvh_tree::rotate(std::size_t index)
     return index;
 }
 
-float bvh_tree::calculate_cost(const bounding_volume_aabb& aabb)
+float bvh_tree::calculate_cost(const bounding_volume_aabb& aabb) const
 {
     // SAH.
     math::float3 d = math::vector::sub(aabb.max, aabb.min);
@@ -344,7 +862,7 @@ float bvh_tree::calculate_cost(const bounding_volume_aabb& aabb)
 
 bounding_volume_aabb bvh_tree::union_box(
     const bounding_volume_aabb& a,
-    const bounding_volume_aabb& b)
+    const bounding_volume_aabb& b) const
 {
     math::float4_simd min = math::simd::min(math::simd::load(a.min), math::simd::load(b.min));
     math::float4_simd max = math::simd::max(math::simd::load(a.max), math::simd::load(b.max));
@@ -355,34 +873,30 @@ bounding_volume_aabb bvh_tree::union_box(
     return result;
 }
 
-std::size_t bvh_tree::allocate_node()
+std::uint32_t bvh_tree::allocate_node()
 {
-    std::size_t result;
+    std::uint32_t result;
     if (!m_free_nodes.empty())
     {
-        result = m_free_nodes.front();
-        m_free_nodes.pop();
-
-        m_nodes[result].parent = INVALID_NODE_INDEX;
-        m_nodes[result].left_child = INVALID_NODE_INDEX;
-        m_nodes[result].right_child = INVALID_NODE_INDEX;
-        m_nodes[result].depth = 0;
+        result = m_free_nodes.back();
+        m_free_nodes.pop_back();
     }
     else
     {
-        result = m_nodes.size();
-        m_nodes.push_back(
-            {.parent = INVALID_NODE_INDEX,
-             .left_child = INVALID_NODE_INDEX,
-             .right_child = INVALID_NODE_INDEX,
-             .depth = 0});
+        result = static_cast<std::uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
     }
 
+    m_nodes[result].parent = INVALID_NODE_INDEX;
+    m_nodes[result].left_child = INVALID_NODE_INDEX;
+    m_nodes[result].right_child = INVALID_NODE_INDEX;
+    m_nodes[result].depth = 0;
+
     return result;
 }
 
-void bvh_tree::deallocate_node(std::size_t index)
+void bvh_tree::deallocate_node(std::uint32_t index)
 {
-    m_free_nodes.push(index);
+    m_free_nodes.push_back(index);
 }
 } // namespace ash::scene
\ No newline at end of file
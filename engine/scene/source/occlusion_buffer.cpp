@@ -0,0 +1,296 @@
+#include "scene/occlusion_buffer.hpp"
+#include "task/task_manager.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ash::scene
+{
+namespace
+{
+// Rows rasterized by one job, a multiple of the tile size so that each job also owns its tiles.
+constexpr std::uint32_t BAND_HEIGHT = occlusion_buffer::TILE_SIZE * 2;
+
+constexpr float CLEAR_DEPTH = 1.0f;
+} // namespace
+
+occlusion_buffer::occlusion_buffer(std::uint32_t width, std::uint32_t height)
+    : m_width(0),
+      m_height(0),
+      m_view_projection(math::matrix::identity())
+{
+    resize(width, height);
+}
+
+void occlusion_buffer::resize(std::uint32_t width, std::uint32_t height)
+{
+    m_width = (width + TILE_SIZE - 1) / TILE_SIZE * TILE_SIZE;
+    m_height = (height + TILE_SIZE - 1) / TILE_SIZE * TILE_SIZE;
+
+    m_depth.assign(m_width * m_height, CLEAR_DEPTH);
+    m_tile_depth.assign((m_width / TILE_SIZE) * (m_height / TILE_SIZE), CLEAR_DEPTH);
+}
+
+void occlusion_buffer::begin(const math::float4x4& view_projection)
+{
+    m_view_projection = view_projection;
+    m_triangles.clear();
+
+    std::fill(m_depth.begin(), m_depth.end(), CLEAR_DEPTH);
+    std::fill(m_tile_depth.begin(), m_tile_depth.end(), CLEAR_DEPTH);
+}
+
+void occlusion_buffer::add_occluder(
+    std::span<const math::float3> vertices,
+    std::span<const std::uint32_t> indices,
+    const math::float4x4& to_world)
+{
+    math::float4x4_simd to_clip = math::matrix_simd::mul(
+        math::simd::load(to_world),
+        math::simd::load(m_view_projection));
+
+    std::vector<math::float4> clip(vertices.size());
+    for (std::size_t i = 0; i < vertices.size(); ++i)
+    {
+        math::float4_simd v = math::simd::load(vertices[i], 1.0f);
+        math::simd::store(math::matrix_simd::mul(v, to_clip), clip[i]);
+    }
+
+    auto width = static_cast<float>(m_width);
+    auto height = static_cast<float>(m_height);
+    for (std::size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        triangle t;
+        bool valid = true;
+        for (std::size_t j = 0; j < 3; ++j)
+        {
+            const math::float4& v = clip[indices[i + j]];
+            if (v[2] < 0.0f || v[3] <= 0.0f)
+            {
+                valid = false;
+                break;
+            }
+
+            float inverse_w = 1.0f / v[3];
+            t.x[j] = (v[0] * inverse_w * 0.5f + 0.5f) * width;
+            t.y[j] = (0.5f - v[1] * inverse_w * 0.5f) * height;
+            t.z[j] = v[2] * inverse_w;
+        }
+
+        if (!valid)
+            continue;
+
+        float min_x = std::min({t.x[0], t.x[1], t.x[2]});
+        float max_x = std::max({t.x[0], t.x[1], t.x[2]});
+        float min_y = std::min({t.y[0], t.y[1], t.y[2]});
+        float max_y = std::max({t.y[0], t.y[1], t.y[2]});
+        if (max_x < 0.0f || min_x > width || max_y < 0.0f || min_y > height)
+            continue;
+
+        t.min_y = static_cast<std::uint32_t>(std::max(min_y, 0.0f));
+        t.max_y = static_cast<std::uint32_t>(std::min(std::ceil(max_y), height));
+        m_triangles.push_back(t);
+    }
+}
+
+void occlusion_buffer::rasterize(task::task_manager* task)
+{
+    if (m_triangles.empty())
+        return;
+
+    auto rasterize_band = [this](std::uint32_t band) {
+        std::uint32_t begin_y = band * BAND_HEIGHT;
+        std::uint32_t end_y = std::min(begin_y + BAND_HEIGHT, m_height);
+
+        for (const triangle& triangle : m_triangles)
+        {
+            if (triangle.max_y > begin_y && triangle.min_y < end_y)
+                rasterize(triangle, begin_y, end_y);
+        }
+        update_tiles(begin_y, end_y);
+    };
+
+    std::uint32_t band_count = (m_height + BAND_HEIGHT - 1) / BAND_HEIGHT;
+    if (task == nullptr)
+    {
+        for (std::uint32_t band = 0; band < band_count; ++band)
+            rasterize_band(band);
+    }
+    else
+    {
+        task->parallel_for(band_count, 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t band = begin; band < end; ++band)
+                rasterize_band(static_cast<std::uint32_t>(band));
+        });
+    }
+}
+
+bool occlusion_buffer::test(const bounding_volume_aabb& aabb) const
+{
+    math::float4x4_simd view_projection = math::simd::load(m_view_projection);
+
+    auto width = static_cast<float>(m_width);
+    auto height = static_cast<float>(m_height);
+
+    float inf = std::numeric_limits<float>::infinity();
+    float min_x = inf, min_y = inf, min_z = inf;
+    float max_x = -inf, max_y = -inf;
+    for (std::size_t i = 0; i < 8; ++i)
+    {
+        math::float4_simd corner = math::simd::set(
+            (i & 1) ? aabb.max[0] : aabb.min[0],
+            (i & 2) ? aabb.max[1] : aabb.min[1],
+            (i & 4) ? aabb.max[2] : aabb.min[2],
+            1.0f);
+
+        math::float4 v;
+        math::simd::store(math::matrix_simd::mul(corner, view_projection), v);
+
+        // The box crosses the near plane, the camera may be inside.
+        if (v[2] < 0.0f || v[3] <= 0.0f)
+            return true;
+
+        float inverse_w = 1.0f / v[3];
+        float x = (v[0] * inverse_w * 0.5f + 0.5f) * width;
+        float y = (0.5f - v[1] * inverse_w * 0.5f) * height;
+        min_x = std::min(min_x, x);
+        max_x = std::max(max_x, x);
+        min_y = std::min(min_y, y);
+        max_y = std::max(max_y, y);
+        min_z = std::min(min_z, v[2] * inverse_w);
+    }
+
+    auto begin_x = static_cast<std::uint32_t>(std::max(min_x, 0.0f));
+    auto begin_y = static_cast<std::uint32_t>(std::max(min_y, 0.0f));
+    auto end_x = static_cast<std::uint32_t>(std::clamp(std::ceil(max_x), 0.0f, width));
+    auto end_y = static_cast<std::uint32_t>(std::clamp(std::ceil(max_y), 0.0f, height));
+    if (begin_x >= end_x || begin_y >= end_y)
+        return true;
+
+    std::uint32_t tile_row = m_width / TILE_SIZE;
+    for (std::uint32_t tile_y = begin_y / TILE_SIZE; tile_y * TILE_SIZE < end_y; ++tile_y)
+    {
+        for (std::uint32_t tile_x = begin_x / TILE_SIZE; tile_x * TILE_SIZE < end_x; ++tile_x)
+        {
+            // Every pixel of the tile is nearer than the box.
+            if (min_z > m_tile_depth[tile_y * tile_row + tile_x])
+                continue;
+
+            std::uint32_t x0 = std::max(begin_x, tile_x * TILE_SIZE);
+            std::uint32_t x1 = std::min(end_x, (tile_x + 1) * TILE_SIZE);
+            std::uint32_t y0 = std::max(begin_y, tile_y * TILE_SIZE);
+            std::uint32_t y1 = std::min(end_y, (tile_y + 1) * TILE_SIZE);
+            for (std::uint32_t y = y0; y < y1; ++y)
+            {
+                const float* row = m_depth.data() + y * m_width;
+                for (std::uint32_t x = x0; x < x1; ++x)
+                {
+                    if (min_z <= row[x])
+                        return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+void occlusion_buffer::rasterize(const triangle& t, std::uint32_t begin_y, std::uint32_t end_y)
+{
+    float area = (t.x[1] - t.x[0]) * (t.y[2] - t.y[0]) - (t.x[2] - t.x[0]) * (t.y[1] - t.y[0]);
+    if (area == 0.0f)
+        return;
+
+    // Edge functions e = a * x + b * y + c, positive inside whatever the winding.
+    float sign = area > 0.0f ? 1.0f : -1.0f;
+    float a[3], b[3], c[3];
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        std::size_t j = (i + 1) % 3;
+        a[i] = (t.y[i] - t.y[j]) * sign;
+        b[i] = (t.x[j] - t.x[i]) * sign;
+        c[i] = -a[i] * t.x[i] - b[i] * t.y[i];
+    }
+
+    // Depth is linear in screen space.
+    float inverse_area = 1.0f / area;
+    float z10 = t.z[1] - t.z[0];
+    float z20 = t.z[2] - t.z[0];
+    float dzdx = (z10 * (t.y[2] - t.y[0]) - z20 * (t.y[1] - t.y[0])) * inverse_area;
+    float dzdy = (z20 * (t.x[1] - t.x[0]) - z10 * (t.x[2] - t.x[0])) * inverse_area;
+    float dz = t.z[0] - dzdx * t.x[0] - dzdy * t.y[0];
+
+    float min_x = std::min({t.x[0], t.x[1], t.x[2]});
+    float max_x = std::max({t.x[0], t.x[1], t.x[2]});
+    auto begin_x = static_cast<std::uint32_t>(std::max(min_x, 0.0f)) & ~3u;
+    auto end_x = static_cast<std::uint32_t>(
+        std::clamp(std::ceil(max_x), 0.0f, static_cast<float>(m_width)));
+
+    begin_y = std::max(begin_y, t.min_y);
+    end_y = std::min(end_y, t.max_y);
+
+    // Four pixels at a time, sampled at their centers.
+    const __m128 x_offset = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    __m128 a0 = _mm_set1_ps(a[0]), a1 = _mm_set1_ps(a[1]), a2 = _mm_set1_ps(a[2]);
+    __m128 step0 = _mm_set1_ps(a[0] * 4.0f);
+    __m128 step1 = _mm_set1_ps(a[1] * 4.0f);
+    __m128 step2 = _mm_set1_ps(a[2] * 4.0f);
+    __m128 step_z = _mm_set1_ps(dzdx * 4.0f);
+    __m128 zero = _mm_setzero_ps();
+
+    for (std::uint32_t y = begin_y; y < end_y; ++y)
+    {
+        float center_y = static_cast<float>(y) + 0.5f;
+        __m128 x = _mm_add_ps(_mm_set1_ps(static_cast<float>(begin_x)), x_offset);
+
+        __m128 e0 = _mm_add_ps(_mm_mul_ps(a0, x), _mm_set1_ps(b[0] * center_y + c[0]));
+        __m128 e1 = _mm_add_ps(_mm_mul_ps(a1, x), _mm_set1_ps(b[1] * center_y + c[1]));
+        __m128 e2 = _mm_add_ps(_mm_mul_ps(a2, x), _mm_set1_ps(b[2] * center_y + c[2]));
+        __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(dzdx), x), _mm_set1_ps(dzdy * center_y + dz));
+
+        float* row = m_depth.data() + y * m_width;
+        for (std::uint32_t i = begin_x; i < end_x; i += 4)
+        {
+            __m128 inside = _mm_and_ps(
+                _mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)),
+                _mm_cmpge_ps(e2, zero));
+
+            if (_mm_movemask_ps(inside) != 0)
+            {
+                __m128 depth = _mm_load_ps(row + i);
+                __m128 nearest = _mm_min_ps(depth, z);
+                depth = _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, depth));
+                _mm_store_ps(row + i, depth);
+            }
+
+            e0 = _mm_add_ps(e0, step0);
+            e1 = _mm_add_ps(e1, step1);
+            e2 = _mm_add_ps(e2, step2);
+            z = _mm_add_ps(z, step_z);
+        }
+    }
+}
+
+void occlusion_buffer::update_tiles(std::uint32_t begin_y, std::uint32_t end_y)
+{
+    std::uint32_t tile_row = m_width / TILE_SIZE;
+    for (std::uint32_t tile_y = begin_y / TILE_SIZE; tile_y * TILE_SIZE < end_y; ++tile_y)
+    {
+        for (std::uint32_t tile_x = 0; tile_x < tile_row; ++tile_x)
+        {
+            __m128 farthest = _mm_setzero_ps();
+            for (std::uint32_t y = tile_y * TILE_SIZE; y < (tile_y + 1) * TILE_SIZE; ++y)
+            {
+                const float* row = m_depth.data() + y * m_width + tile_x * TILE_SIZE;
+                farthest = _mm_max_ps(farthest, _mm_load_ps(row));
+                farthest = _mm_max_ps(farthest, _mm_load_ps(row + 4));
+            }
+
+            math::float4 result;
+            math::simd::store(farthest, result);
+            m_tile_depth[tile_y * tile_row + tile_x] =
+                std::max(std::max(result[0], result[1]), std::max(result[2], result[3]));
+        }
+    }
+}
+} // namespace ash::scene
@@ -1,12 +1,47 @@
 #include "scene/scene.hpp"
 #include "core/relation.hpp"
 #include "core/relation_event.hpp"
+#include "math/batch.hpp"
 #include "scene/bounding_box.hpp"
 #include "scene/scene_event.hpp"
+#include "scene/scene_task.hpp"
+#include "scene/transform_batch.hpp"
+#include "task/task_manager.hpp"
+#include <array>
+#include <cmath>
 
 namespace ash::scene
 {
-scene::scene() : system_base("scene")
+namespace
+{
+// Hierarchy propagation states used by sync_local and sync_world.
+constexpr std::uint8_t SYNC_SKIP = 0;
+constexpr std::uint8_t SYNC_CLEAN = 1;
+constexpr std::uint8_t SYNC_UPDATED = 2;
+
+// Levels smaller than this are not worth splitting across the workers.
+constexpr std::size_t SYNC_PARALLEL_THRESHOLD = 1024;
+constexpr std::size_t SYNC_BATCHES_PER_JOB = 64;
+
+constexpr std::size_t OCCLUSION_TEST_GRAIN = 256;
+
+// Dynamic trees with at most this many proxy ids, internal nodes included, are culled as a flat
+// array. The level walk would test the internal nodes as well, about twice as many boxes.
+constexpr std::size_t FLAT_CULLING_LIMIT = 512;
+constexpr std::size_t FLAT_CULLING_GROUP_SIZE = 256;
+
+// Proxy id of a bounding box that is in neither tree.
+constexpr std::size_t INVALID_PROXY_ID = static_cast<std::size_t>(-1);
+
+void bind_proxy(std::vector<ecs::entity>& proxies, std::size_t proxy_id, ecs::entity entity)
+{
+    if (proxies.size() <= proxy_id)
+        proxies.resize(proxy_id + 1);
+    proxies[proxy_id] = entity;
+}
+} // namespace
+
+scene::scene() : system_base("scene"), m_static_dirty(false), m_static_build_count(0)
 {
 }
 
@@ -15,6 +50,7 @@ bool scene::initialize(const dictionary& config)
     auto& world = system<ecs::world>();
     world.register_component<transform>();
     world.register_component<bounding_box>();
+    world.register_component<occluder>();
 
     m_root = world.create("scene");
     world.add<core::link, transform>(m_root);
@@ -26,14 +62,21 @@ bool scene::initialize(const dictionary& config)
     event.register_event<event_enter_scene>();
     event.register_event<event_exit_scene>();
 
-    event.subscribe<core::event_link>("scene", [this](ecs::entity entity, core::link& link) {
+    event.subscribe<core::event_link>([this](ecs::entity entity, core::link& link) {
         on_entity_link(entity, link);
     });
 
-    event.subscribe<core::event_unlink>("scene", [this](ecs::entity entity, core::link& link) {
+    event.subscribe<core::event_unlink>([this](ecs::entity entity, core::link& link) {
         on_entity_unlink(entity, link);
     });
 
+    auto& task = system<task::task_manager>();
+    auto save_previous_task = task.schedule(TASK_SCENE_SAVE_PREVIOUS, [this]() {
+        save_previous();
+    });
+    save_previous_task->add_dependency(*task.find(task::TASK_FIXED_ROOT));
+    task.find(task::TASK_FIXED_LOGIC_START)->add_dependency(*save_previous_task);
+
     return true;
 }
 
@@ -51,29 +94,25 @@ void scene::sync_local()
 void scene::sync_local(ecs::entity root)
 {
     auto& world = system<ecs::world>();
+    auto& relation = system<core::relation>();
+    auto& task = system<task::task_manager>();
 
-    std::queue<ecs::entity> dirty_entities;
-    auto find_dirty = [&](ecs::entity entity) {
-        if (!world.has_component<transform>(entity))
-            return false;
+    std::uint32_t root_index = relation.hierarchy_index(root);
+    const auto& hierarchy = relation.hierarchy();
+    m_sync_state.resize(hierarchy.size());
+
+    auto need_update = [&](ecs::entity entity, std::uint8_t parent_state) -> std::uint8_t {
+        if (parent_state == SYNC_SKIP || !world.has_component<transform>(entity))
+            return SYNC_SKIP;
 
         auto& node_transform = world.component<transform>(entity);
-        if (node_transform.dirty())
-        {
-            dirty_entities.push(entity);
-            return false;
-        }
+        if (parent_state != SYNC_UPDATED && !node_transform.dirty())
+            return SYNC_CLEAN;
         else
-        {
-            return true;
-        }
+            return SYNC_UPDATED;
     };
-    system<core::relation>().each_bfs(root, find_dirty);
 
     auto update_local = [&](ecs::entity entity) {
-        if (!world.has_component<transform>(entity))
-            return false;
-
         auto& node_transform = world.component<transform>(entity);
         auto& node_link = world.component<core::link>(entity);
 
@@ -92,15 +131,69 @@ void scene::sync_local(ecs::entity root)
         math::float4x4_simd to_world = math::matrix_simd::mul(to_parent, parent_to_world);
 
         node_transform.sync(to_parent, to_world);
+    };
+
+    m_sync_state[root_index] = need_update(root, SYNC_CLEAN);
+    if (m_sync_state[root_index] == SYNC_UPDATED)
+        update_local(root);
+    else if (m_sync_state[root_index] == SYNC_SKIP)
+        return;
+
+    // Nodes of a level only depend on the previous level, which is complete when the level starts.
+    auto update_level = [&](std::size_t begin, std::size_t end) {
+        transform_batch batch;
+        std::array<std::size_t, transform_batch::SIZE> batch_index;
+        math::float4x4_simd batch_to_parent[transform_batch::SIZE];
+
+        auto flush = [&]() {
+            batch.affine_transform(batch_to_parent);
+            for (std::size_t i = 0; i < batch.size(); ++i)
+            {
+                const core::hierarchy_node& node = hierarchy[batch_index[i]];
+                auto& node_transform = world.component<transform>(node.entity);
+                auto& parent = world.component<transform>(hierarchy[node.parent].entity);
 
-        return true;
+                math::float4x4_simd parent_to_world = math::simd::load(parent.to_world());
+                math::float4x4_simd to_world =
+                    math::matrix_simd::mul(batch_to_parent[i], parent_to_world);
+
+                node_transform.sync(batch_to_parent[i], to_world);
+            }
+            batch.clear();
+        };
+
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            const core::hierarchy_node& node = hierarchy[i];
+            m_sync_state[i] = need_update(node.entity, m_sync_state[node.parent]);
+            if (m_sync_state[i] != SYNC_UPDATED)
+                continue;
+
+            batch_index[batch.size()] = i;
+            batch.push(world.component<transform>(node.entity));
+            if (batch.full())
+                flush();
+        }
+
+        if (batch.size() != 0)
+            flush();
     };
 
-    while (!dirty_entities.empty())
-    {
-        system<core::relation>().each_bfs(dirty_entities.front(), update_local);
-        dirty_entities.pop();
-    }
+    relation.each_level(root, [&](std::uint32_t begin, std::uint32_t end) {
+        if (end - begin < SYNC_PARALLEL_THRESHOLD)
+        {
+            update_level(begin, end);
+        }
+        else
+        {
+            task.parallel_for(
+                end - begin,
+                transform_batch::SIZE * SYNC_BATCHES_PER_JOB,
+                [&](std::size_t job_begin, std::size_t job_end) {
+                    update_level(begin + job_begin, begin + job_end);
+                });
+        }
+    });
 }
 
 void scene::sync_world()
@@ -112,46 +205,35 @@ void scene::sync_world(ecs::entity root)
 {
     auto& world = system<ecs::world>();
 
-    std::queue<ecs::entity> dirty_entities;
-    auto find_dirty = [&](ecs::entity entity) {
+    auto update_world = [&](ecs::entity entity, std::uint8_t parent_state) -> std::uint8_t {
         if (!world.has_component<transform>(entity))
-            return false;
+            return SYNC_SKIP;
 
         auto& node_transform = world.component<transform>(entity);
-        if (node_transform.dirty())
-        {
-            dirty_entities.push(entity);
-            return false;
-        }
-        else
-        {
-            return true;
-        }
-    };
-    system<core::relation>().each_bfs(root, find_dirty);
+        if (parent_state != SYNC_UPDATED && !node_transform.dirty())
+            return SYNC_CLEAN;
 
-    auto update_world = [&](ecs::entity entity) {
-        if (!world.has_component<transform>(entity))
-            return false;
-
-        auto& node_transform = world.component<transform>(entity);
         auto& node_link = world.component<core::link>(entity);
         auto& parent = world.component<transform>(node_link.parent);
 
         math::float4x4_simd parent_to_world = math::simd::load(parent.to_world());
         math::float4x4_simd to_world = math::simd::load(node_transform.to_world());
         math::float4x4_simd to_parent =
-            math::matrix_simd::mul(to_world, math::matrix_simd::inverse(parent_to_world));
+            math::matrix_simd::mul(to_world, math::matrix_simd::inverse_affine(parent_to_world));
         node_transform.sync(to_parent);
 
-        return true;
+        return SYNC_UPDATED;
     };
+    system<core::relation>().propagate(root, update_world, SYNC_CLEAN);
+}
 
-    while (!dirty_entities.empty())
-    {
-        system<core::relation>().each_bfs(dirty_entities.front(), update_world);
-        dirty_entities.pop();
-    }
+void scene::save_previous()
+{
+    auto& world = system<ecs::world>();
+    world.view<transform>().each([](transform& transform) {
+        if (transform.interpolation())
+            transform.save_previous();
+    });
 }
 
 void scene::frustum_culling(const std::vector<math::float4>& frustum)
@@ -159,28 +241,211 @@ void scene::frustum_culling(const std::vector<math::float4>& frustum)
     auto& world = system<ecs::world>();
 
     world.view<transform, bounding_box>().each(
-        [this](transform& transform, bounding_box& bounding_box) {
+        [this](ecs::entity entity, transform& transform, bounding_box& bounding_box) {
+            bounding_box.visible(false);
+
+            if (bounding_box.proxy_id() == INVALID_PROXY_ID)
+                return;
+
             if (bounding_box.dynamic() && transform.sync_count() != 0)
             {
-                if (bounding_box.transform(transform.to_world()))
+                if (!bounding_box.transform(transform.to_world()))
+                    return;
+
+                // Small moves are refitted together below, so that every ancestor is resized once
+                // per frame instead of once per moved leaf.
+                if (m_dynamic_bvh.refittable(bounding_box.proxy_id(), bounding_box.aabb()))
+                {
+                    m_refit_proxies.push_back(bounding_box.proxy_id());
+                    m_refit_boxes.push_back(bounding_box.aabb());
+                }
+                else
                 {
                     std::size_t new_proxy_id =
                         m_dynamic_bvh.update(bounding_box.proxy_id(), bounding_box.aabb());
                     bounding_box.proxy_id(new_proxy_id);
+                    bind_proxy(m_dynamic_proxies, new_proxy_id, entity);
                 }
             }
         });
 
-    //m_static_bvh.frustum_culling(frustum);
-    m_dynamic_bvh.frustum_culling(frustum);
+    m_dynamic_bvh.refit(m_refit_proxies, m_refit_boxes, true);
+    m_refit_proxies.clear();
+    m_refit_boxes.clear();
 
-    world.view<transform, bounding_box>().each(
-        [this](transform& transform, bounding_box& bounding_box) {
-            if (bounding_box.dynamic())
-                bounding_box.visible(m_dynamic_bvh.visible(bounding_box.proxy_id()));
-            else
-                bounding_box.visible(m_static_bvh.visible(bounding_box.proxy_id()));
+    // Static boxes never move, so the tree is rebuilt in one pass when some were linked instead of
+    // inserting them one by one.
+    if (m_static_dirty)
+    {
+        std::vector<bounding_volume_aabb> boxes;
+        boxes.reserve(m_static_proxies.size());
+
+        std::size_t count = 0;
+        for (ecs::entity entity : m_static_proxies)
+        {
+            if (entity == ecs::INVALID_ENTITY)
+                continue;
+
+            auto& bounding = world.component<bounding_box>(entity);
+            bounding.proxy_id(count);
+            boxes.push_back(bounding.aabb());
+            m_static_proxies[count++] = entity;
+        }
+        m_static_proxies.resize(count);
+
+        m_static_bvh.build(boxes, &system<task::task_manager>());
+        m_static_build_count = count;
+        m_static_dirty = false;
+    }
+
+    // The queries resolve proxy ids through a copy taken with the flattened trees, unlinking
+    // invalidates or reuses proxy ids of the live arrays before the next flatten.
+    if (m_static_bvh.flatten())
+        m_static_query_proxies = m_static_proxies;
+    if (m_dynamic_bvh.flatten())
+        m_dynamic_query_proxies = m_dynamic_proxies;
+
+    m_visible_entities.clear();
+    auto cull = [&](const bvh_tree& tree, const std::vector<ecs::entity>& proxies) {
+        m_visible_proxies.clear();
+        tree.frustum_culling(frustum, m_visible_proxies, m_culling_scratch);
+
+        for (std::size_t proxy_id : m_visible_proxies)
+        {
+            ecs::entity entity = proxies[proxy_id];
+            world.component<bounding_box>(entity).visible(true);
+            m_visible_entities.push_back(entity);
+        }
+    };
+    cull(m_static_bvh, m_static_query_proxies);
+
+    if (m_dynamic_proxies.size() <= FLAT_CULLING_LIMIT)
+        flat_culling(frustum, m_dynamic_proxies);
+    else
+        cull(m_dynamic_bvh, m_dynamic_query_proxies);
+}
+
+void scene::flat_culling(
+    const std::vector<math::float4>& frustum,
+    const std::vector<ecs::entity>& proxies)
+{
+    auto& world = system<ecs::world>();
+
+    alignas(64) float min[3 * FLAT_CULLING_GROUP_SIZE];
+    alignas(64) float max[3 * FLAT_CULLING_GROUP_SIZE];
+    std::uint32_t visible[FLAT_CULLING_GROUP_SIZE / 32];
+    ecs::entity entities[FLAT_CULLING_GROUP_SIZE];
+
+    std::size_t proxy_id = 0;
+    while (proxy_id < proxies.size())
+    {
+        // Proxy ids of internal nodes and removed boxes are INVALID_ENTITY.
+        std::size_t size = 0;
+        for (; proxy_id < proxies.size() && size < FLAT_CULLING_GROUP_SIZE; ++proxy_id)
+        {
+            if (proxies[proxy_id] != ecs::INVALID_ENTITY)
+                entities[size++] = proxies[proxy_id];
+        }
+
+        if (size == 0)
+            break;
+
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            const bounding_volume_aabb& box = world.component<bounding_box>(entities[i]).aabb();
+            for (std::size_t c = 0; c < 3; ++c)
+            {
+                min[c * size + i] = box.min[c];
+                max[c * size + i] = box.max[c];
+            }
+        }
+
+        math::bounding_box_batch::frustum_culling(
+            min,
+            max,
+            frustum.data(),
+            visible,
+            nullptr,
+            size);
+
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            if ((visible[i / 32] & (1u << (i % 32))) == 0)
+                continue;
+
+            world.component<bounding_box>(entities[i]).visible(true);
+            m_visible_entities.push_back(entities[i]);
+        }
+    }
+}
+
+void scene::frustum_culling(
+    const std::vector<math::float4>& frustum,
+    const math::float4x4& view_projection)
+{
+    frustum_culling(frustum);
+    occlusion_culling(view_projection);
+}
+
+void scene::occlusion_culling(const math::float4x4& view_projection)
+{
+    auto& world = system<ecs::world>();
+    auto& task = system<task::task_manager>();
+
+    m_occlusion_buffer.begin(view_projection);
+    world.view<transform, occluder>().each([this](transform& transform, occluder& occluder) {
+        m_occlusion_buffer.add_occluder(occluder.vertices, occluder.indices, transform.to_world());
+    });
+
+    if (m_occlusion_buffer.empty())
+        return;
+
+    m_occlusion_buffer.rasterize(&task);
+
+    m_occlusion_visible.resize(m_visible_entities.size());
+    task.parallel_for(
+        m_visible_entities.size(),
+        OCCLUSION_TEST_GRAIN,
+        [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                auto& bounding = world.component<bounding_box>(m_visible_entities[i]);
+                m_occlusion_visible[i] = m_occlusion_buffer.test(bounding.aabb());
+            }
         });
+
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < m_visible_entities.size(); ++i)
+    {
+        ecs::entity entity = m_visible_entities[i];
+        if (m_occlusion_visible[i])
+            m_visible_entities[count++] = entity;
+        else
+            world.component<bounding_box>(entity).visible(false);
+    }
+    m_visible_entities.resize(count);
+}
+
+std::size_t scene::k_nearest(
+    const math::float3& point,
+    std::span<ecs::entity> result,
+    std::span<float> distance) const
+{
+    ASH_ASSERT(distance.size() >= result.size());
+
+    // The spans hold squared distances until both trees are merged.
+    std::size_t count = 0;
+    m_static_bvh.merge_nearest(point, result, distance, count, [this](std::size_t proxy_id) {
+        return m_static_query_proxies[proxy_id];
+    });
+    m_dynamic_bvh.merge_nearest(point, result, distance, count, [this](std::size_t proxy_id) {
+        return m_dynamic_query_proxies[proxy_id];
+    });
+
+    for (std::size_t i = 0; i < count; ++i)
+        distance[i] = std::sqrt(distance[i]);
+
+    return count;
 }
 
 void scene::on_entity_link(ecs::entity entity, core::link& link)
@@ -211,15 +476,21 @@ void scene::on_entity_link(ecs::entity entity, core::link& link)
         if (world.has_component<bounding_box>(entity))
         {
             auto& bounding = world.component<bounding_box>(entity);
+            if (bounding.proxy_id() != INVALID_PROXY_ID)
+                remove_proxy(bounding);
+
             if (bounding.dynamic())
             {
                 std::size_t proxy_id = m_dynamic_bvh.add(bounding.aabb());
                 bounding.proxy_id(proxy_id);
+                bind_proxy(m_dynamic_proxies, proxy_id, entity);
             }
             else
             {
-                std::size_t proxy_id = m_static_bvh.add(bounding.aabb());
-                bounding.proxy_id(proxy_id);
+                // The proxy id matches the box index of the next build.
+                bounding.proxy_id(m_static_proxies.size());
+                m_static_proxies.push_back(entity);
+                m_static_dirty = true;
             }
         }
     }
@@ -239,5 +510,33 @@ void scene::on_entity_unlink(ecs::entity entity, core::link& link)
             event.publish<event_exit_scene>(entity);
         }
     }
+
+    // The entity may be released right after, so no tree may refer to it anymore.
+    if (world.has_component<bounding_box>(entity))
+    {
+        auto& bounding = world.component<bounding_box>(entity);
+        if (bounding.proxy_id() != INVALID_PROXY_ID)
+            remove_proxy(bounding);
+    }
+}
+
+void scene::remove_proxy(bounding_box& bounding)
+{
+    std::size_t proxy_id = bounding.proxy_id();
+    if (bounding.dynamic())
+    {
+        m_dynamic_bvh.remove(proxy_id);
+        m_dynamic_proxies[proxy_id] = ecs::INVALID_ENTITY;
+    }
+    else
+    {
+        // Boxes linked after the last build are not in the tree yet.
+        if (proxy_id < m_static_build_count)
+            m_static_bvh.remove(proxy_id);
+        m_static_proxies[proxy_id] = ecs::INVALID_ENTITY;
+        m_static_dirty = true;
+    }
+
+    bounding.proxy_id(INVALID_PROXY_ID);
 }
 } // namespace ash::scene
\ No newline at end of file
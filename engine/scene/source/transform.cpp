@@ -4,12 +4,14 @@
 namespace ash::scene
 {
 transform::transform() noexcept
-    : m_position{0.0f, 0.0f, 0.0f},
+    : m_to_parent(math::matrix::identity()),
+      m_to_world(math::matrix::identity()),
+      m_previous_to_world(math::matrix::identity()),
+      m_position{0.0f, 0.0f, 0.0f},
       m_rotation{0.0f, 0.0f, 0.0f, 1.0f},
       m_scale{1.0f, 1.0f, 1.0f},
-      m_to_parent(math::matrix::identity()),
-      m_to_world(math::matrix::identity()),
       m_in_scene(false),
+      m_interpolation(false),
       m_dirty(false),
       m_sync_count(0)
 {
@@ -51,4 +53,28 @@ void transform::sync(
     m_dirty = false;
     ++m_sync_count;
 }
+
+math::float4x4 transform::to_world_interpolated(float alpha) const
+{
+    if (!m_interpolation || alpha >= 1.0f)
+        return m_to_world;
+
+    math::float4_simd previous_scale, previous_rotation, previous_position;
+    math::matrix_simd::decompose(
+        math::simd::load(m_previous_to_world),
+        previous_scale,
+        previous_rotation,
+        previous_position);
+
+    math::float4_simd scale, rotation, position;
+    math::matrix_simd::decompose(math::simd::load(m_to_world), scale, rotation, position);
+
+    scale = math::vector_simd::lerp(previous_scale, scale, alpha);
+    rotation = math::quaternion_simd::slerp(previous_rotation, rotation, alpha);
+    position = math::vector_simd::lerp(previous_position, position, alpha);
+
+    math::float4x4 result;
+    math::simd::store(math::matrix_simd::affine_transform(scale, rotation, position), result);
+    return result;
+}
 } // namespace ash::scene
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include "scene/transform_batch.hpp"
+#include "assert.hpp"
+
+namespace ash::scene
+{
+transform_batch::transform_batch() noexcept : m_position{}, m_rotation{}, m_scale{}, m_size(0)
+{
+    for (std::size_t i = 0; i < SIZE; ++i)
+    {
+        m_rotation[3][i] = 1.0f;
+        m_scale[0][i] = m_scale[1][i] = m_scale[2][i] = 1.0f;
+    }
+}
+
+void transform_batch::push(const transform& transform) noexcept
+{
+    ASH_ASSERT(m_size < SIZE);
+
+    const math::float3& position = transform.position();
+    const math::float4& rotation = transform.rotation();
+    const math::float3& scale = transform.scale();
+
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        m_position[i][m_size] = position[i];
+        m_scale[i][m_size] = scale[i];
+    }
+
+    for (std::size_t i = 0; i < 4; ++i)
+        m_rotation[i][m_size] = rotation[i];
+
+    ++m_size;
+}
+
+void transform_batch::affine_transform(math::float4x4_simd* result) const noexcept
+{
+    // The components are already laid out as structure of arrays of SIZE elements.
+    alignas(32) float soa[16][SIZE];
+    math::matrix_batch::affine_transform(
+        &m_scale[0][0],
+        &m_rotation[0][0],
+        &m_position[0][0],
+        &soa[0][0],
+        SIZE);
+
+    // Transpose the lanes back into one matrix per transform, 4 transforms at a time.
+    for (std::size_t lane = 0; lane < m_size; lane += 4)
+    {
+        for (std::size_t row = 0; row < 4; ++row)
+        {
+            __m128 r0 = _mm_load_ps(&soa[row * 4 + 0][lane]);
+            __m128 r1 = _mm_load_ps(&soa[row * 4 + 1][lane]);
+            __m128 r2 = _mm_load_ps(&soa[row * 4 + 2][lane]);
+            __m128 r3 = _mm_load_ps(&soa[row * 4 + 3][lane]);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+            result[lane + 0][row] = r0;
+            result[lane + 1][row] = r1;
+            result[lane + 2][row] = r2;
+            result[lane + 3][row] = r3;
+        }
+    }
+}
+} // namespace ash::scene
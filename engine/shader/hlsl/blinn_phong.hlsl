@@ -1,16 +1,24 @@
-cbuffer ash_object : register(b0, space0)
+struct ash_object_data
 {
-    float4x4 transform_m;
+    row_major float4x4 transform_m;
 };
 
-cbuffer ash_blinn_phong_material : register(b0, space1)
+StructuredBuffer<ash_object_data> ash_objects : register(t0, space0);
+StructuredBuffer<uint> ash_instances : register(t1, space0);
+
+cbuffer ash_draw : register(b0, space1)
+{
+    uint instance_index;
+};
+
+cbuffer ash_blinn_phong_material : register(b0, space2)
 {
     float3 diffuse;
     float3 fresnel;
     float roughness;
 };
 
-cbuffer ash_camera : register(b0, space2)
+cbuffer ash_camera : register(b0, space3)
 {
     float3 camera_position;
     float3 camera_direction;
@@ -28,7 +36,7 @@ struct ash_directional_light_data
     float _padding_1;
 };
 
-cbuffer ash_light : register(b0, space3)
+cbuffer ash_light : register(b0, space4)
 {
     ash_directional_light_data directional_light[4];
     uint directional_light_count;
@@ -47,10 +55,12 @@ struct vs_out
     float3 normal : NORMAL;
 };
 
-vs_out vs_main(vs_in vin)
+vs_out vs_main(vs_in vin, uint instance_id : SV_InstanceID)
 {
     vs_out result;
 
+    float4x4 transform_m = ash_objects[ash_instances[instance_index + instance_id]].transform_m;
+
     float4 world_position = mul(mul(float4(vin.position, 1.0f), transform_m), transform_v);
     result.world_position = world_position.xyz;
     result.position = mul(world_position, transform_p);
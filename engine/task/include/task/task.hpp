@@ -42,6 +42,12 @@ public:
     std::string_view name() const noexcept { return m_name; }
     task_type type() const noexcept { return m_type; }
 
+    /**
+     * @brief Detached tasks are not part of the task graph, such as the jobs of parallel_for.
+     * They have no dependencies and do not count towards the completion of the graph.
+     */
+    virtual bool detached() const noexcept { return false; }
+
 private:
     void mark_dependency_dirty();
 
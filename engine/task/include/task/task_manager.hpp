@@ -4,7 +4,9 @@
 #include "task/task.hpp"
 #include "task/task_queue.hpp"
 #include "task/thread_pool.hpp"
+#include <algorithm>
 #include <memory>
+#include <thread>
 
 namespace ash::task
 {
@@ -12,6 +14,10 @@ static constexpr char TASK_ROOT[] = "root";
 static constexpr char TASK_GAME_LOGIC_START[] = "game logic start";
 static constexpr char TASK_GAME_LOGIC_END[] = "game logic end";
 
+static constexpr char TASK_FIXED_ROOT[] = "fixed root";
+static constexpr char TASK_FIXED_LOGIC_START[] = "fixed logic start";
+static constexpr char TASK_FIXED_LOGIC_END[] = "fixed logic end";
+
 class task_manager;
 class task_handle
 {
@@ -32,6 +38,54 @@ private:
 template <typename T>
 concept derived_from_task = std::is_base_of<task, T>::value;
 
+template <typename Functor>
+class parallel_job : public task
+{
+public:
+    parallel_job(Functor& functor, std::size_t count, std::size_t grain, std::size_t helpers)
+        : task("parallel job", task_type::NONE),
+          m_functor(functor),
+          m_count(count),
+          m_grain(grain),
+          m_next(0),
+          m_helpers(helpers)
+    {
+    }
+
+    virtual void execute() override
+    {
+        run();
+        m_helpers.fetch_sub(1, std::memory_order_release);
+    }
+
+    virtual bool detached() const noexcept override { return true; }
+
+    /**
+     * @brief Process chunks until there is nothing left.
+     */
+    void run()
+    {
+        while (true)
+        {
+            std::size_t begin = m_next.fetch_add(m_grain, std::memory_order_relaxed);
+            if (begin >= m_count)
+                break;
+            m_functor(begin, std::min(begin + m_grain, m_count));
+        }
+    }
+
+    bool done() const noexcept { return m_helpers.load(std::memory_order_acquire) == 0; }
+
+private:
+    Functor& m_functor;
+
+    std::size_t m_count;
+    std::size_t m_grain;
+
+    std::atomic<std::size_t> m_next;
+    std::atomic<std::size_t> m_helpers;
+};
+
 class task_manager : public core::system_base
 {
 public:
@@ -50,6 +104,46 @@ public:
 
     void execute(handle task);
 
+    /**
+     * @brief Split [0, count) into chunks of grain elements and call functor(begin, end) for each
+     * chunk on the worker threads. Blocks until all chunks are processed, the calling thread takes
+     * part in the work. Can be called from inside a task.
+     */
+    template <typename Functor>
+    void parallel_for(std::size_t count, std::size_t grain, Functor&& functor)
+    {
+        if (grain == 0)
+            grain = 1;
+
+        std::size_t chunk_count = (count + grain - 1) / grain;
+        if (chunk_count <= 1 || m_num_thread == 0)
+        {
+            if (count != 0)
+                functor(std::size_t(0), count);
+            return;
+        }
+
+        std::size_t helpers = std::min(chunk_count - 1, m_num_thread);
+        parallel_job<std::remove_reference_t<Functor>> job(functor, count, grain, helpers);
+
+        task_queue& queue = m_queues->queue(task_type::NONE);
+        for (std::size_t i = 0; i < helpers; ++i)
+            queue.push(&job);
+
+        job.run();
+
+        // Helpers that have not started yet still reference the job, keep the thread busy with
+        // other work until they are all finished.
+        std::vector<task*> next_tasks;
+        while (!job.done())
+        {
+            if (!m_queues->execute_one(task_type::NONE, next_tasks))
+                std::this_thread::yield();
+        }
+    }
+
+    std::size_t num_thread() const noexcept { return m_num_thread; }
+
     void run();
     void stop();
 
@@ -73,5 +167,6 @@ private:
 
     std::unique_ptr<task_queue_group> m_queues;
     std::unique_ptr<thread_pool> m_thread_pool;
+    std::size_t m_num_thread;
 };
 } // namespace ash::task
\ No newline at end of file
@@ -64,6 +64,15 @@ public:
     std::future<void> execute(task* t, std::size_t task_count);
     void notify_task_completion(bool force = false);
 
+    /**
+     * @brief Pop a task of the given type and execute it on the calling thread.
+     *
+     * @param type Task type
+     * @param next_tasks Scratch buffer for the tasks that become ready
+     * @return Returns false if the queue is empty.
+     */
+    bool execute_one(task_type type, std::vector<task*>& next_tasks);
+
     task_queue& queue(task_type type) { return m_queues[static_cast<std::size_t>(type)]; }
     task_queue& operator[](task_type type) { return queue(type); }
 
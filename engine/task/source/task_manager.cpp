@@ -4,7 +4,7 @@
 
 namespace ash::task
 {
-task_manager::task_manager() : core::system_base("task")
+task_manager::task_manager() : core::system_base("task"), m_num_thread(0)
 {
 }
 
@@ -16,6 +16,7 @@ bool task_manager::initialize(const dictionary& config)
 
     m_queues = std::make_unique<task_queue_group>();
     m_thread_pool = std::make_unique<thread_pool>(num_thread);
+    m_num_thread = num_thread;
 
     auto root_task = schedule(TASK_ROOT, []() {});
 
@@ -25,6 +26,15 @@ bool task_manager::initialize(const dictionary& config)
     auto logic_end_task = schedule(TASK_GAME_LOGIC_END, []() {});
     logic_end_task->add_dependency(*logic_start_task);
 
+    // The fixed step graph is executed separately, zero or more times per frame.
+    auto fixed_root_task = schedule(TASK_FIXED_ROOT, []() {});
+
+    auto fixed_logic_start_task = schedule(TASK_FIXED_LOGIC_START, []() {});
+    fixed_logic_start_task->add_dependency(*fixed_root_task);
+
+    auto fixed_logic_end_task = schedule(TASK_FIXED_LOGIC_END, []() {});
+    fixed_logic_end_task->add_dependency(*fixed_logic_start_task);
+
     return true;
 }
 
@@ -85,4 +85,26 @@ void task_queue_group::notify_task_completion(bool force)
         }
     }
 }
+
+bool task_queue_group::execute_one(task_type type, std::vector<task*>& next_tasks)
+{
+    task* current_task = queue(type).pop();
+    if (current_task == nullptr)
+        return false;
+
+    if (current_task->detached())
+    {
+        current_task->execute();
+        return true;
+    }
+
+    current_task->execute_and_get_next_tasks(next_tasks);
+    for (task* next_task : next_tasks)
+        queue(next_task->type()).push(next_task);
+    next_tasks.clear();
+
+    notify_task_completion();
+
+    return true;
+}
 } // namespace ash::task
\ No newline at end of file
@@ -22,6 +22,10 @@ void thread_pool::run(task_queue_group& queues)
 
 void thread_pool::stop()
 {
+    // Never run.
+    if (m_queues == nullptr)
+        return;
+
     for (work_thread& thread : m_threads)
         thread.stop();
 
@@ -66,21 +66,8 @@ void work_thread::loop(task_queue_group& queues)
 
     while (!m_stop)
     {
-        task* current_task = m_queue->pop();
-        if (current_task)
-        {
-            // log::debug("{}", current_task->name());
-            current_task->execute_and_get_next_tasks(next_tasks);
-            for (task* next_task : next_tasks)
-                queues[next_task->type()].push(next_task);
-            next_tasks.clear();
-
-            queues.notify_task_completion();
-        }
-        else
-        {
+        if (!queues.execute_one(m_type, next_tasks))
             m_queue->wait_task([this]() { return m_stop.load(); });
-        }
     }
     m_queue = nullptr;
 }
@@ -11,6 +11,7 @@
 #include "ui/ui_task.hpp"
 #include "window/window.hpp"
 #include "window/window_event.hpp"
+#include <algorithm>
 
 namespace ash::ui
 {
@@ -85,9 +86,8 @@ bool ui::initialize(const dictionary& config)
     mesh_render.index_buffer = m_index_buffer.get();
 
     event.subscribe<window::event_window_resize>(
-        "ui",
         [this](std::uint32_t width, std::uint32_t height) { resize(width, height); });
-    event.subscribe<window::event_keyboard_char>("ui", [this](char c) { m_tree->input(c); });
+    event.subscribe<window::event_keyboard_char>([this](char c) { m_tree->input(c); });
 
     auto window_extent = system<window::window>().extent();
     resize(window_extent.width, window_extent.height);
@@ -108,77 +108,92 @@ void ui::tick()
 {
     auto& world = system<ecs::world>();
 
-    m_renderer.reset();
-
     auto extent = system<window::window>().extent();
     m_tree->tick(static_cast<float>(extent.width), static_cast<float>(extent.height));
 
-    if (!m_tree->tree_dirty())
-        return;
+    if (m_tree->tree_dirty())
+    {
+        m_renderer.reset();
+        m_renderer.draw(m_tree.get());
+        m_offset_parameter->offset(m_renderer.offset());
+
+        auto& mesh_render = world.component<graphics::mesh_render>(m_entity);
+        mesh_render.submeshes.clear();
+        mesh_render.materials.clear();
+
+        std::size_t vertex_offset = 0;
+        std::size_t index_offset = 0;
+
+        for (auto& batch : m_renderer)
+        {
+            graphics::submesh submesh = {
+                .index_start = index_offset,
+                .index_end = index_offset + batch->indices.size(),
+                .vertex_base = vertex_offset};
+            mesh_render.submeshes.push_back(submesh);
+
+            auto material_parameter = allocate_material_parameter();
+            material_parameter->mesh_type(batch->type);
+            if (batch->type != ELEMENT_MESH_TYPE_BLOCK)
+                material_parameter->texture(batch->texture);
+
+            graphics::material material = {};
+            material.pipeline = m_pipeline.get();
+            material.parameters = {
+                material_parameter->interface(),
+                m_offset_parameter->interface(),
+                m_mvp_parameter->interface()};
+            material.scissor = graphics::scissor_extent{
+                .min_x = static_cast<std::uint32_t>(batch->scissor.x),
+                .min_y = static_cast<std::uint32_t>(batch->scissor.y),
+                .max_x = static_cast<std::uint32_t>(batch->scissor.x + batch->scissor.width),
+                .max_y = static_cast<std::uint32_t>(batch->scissor.y + batch->scissor.height)};
+
+            mesh_render.materials.push_back(material);
+
+            vertex_offset += batch->vertex_position.size();
+            index_offset += batch->indices.size();
+        }
+
+        m_material_parameter_counter = 0;
+    }
 
-    m_renderer.draw(m_tree.get());
-    m_offset_parameter->offset(m_renderer.offset());
+    // The buffers are frame resources, which only hold what is written in the current frame, so
+    // the batches are written every frame straight into the mapped memory.
+    std::size_t vertex_count = 0;
+    std::size_t index_count = 0;
+    for (auto& batch : m_renderer)
+    {
+        vertex_count += batch->vertex_position.size();
+        index_count += batch->indices.size();
+    }
 
-    auto& mesh_render = world.component<graphics::mesh_render>(m_entity);
-    mesh_render.submeshes.clear();
-    mesh_render.materials.clear();
+    if (index_count == 0)
+        return;
 
-    std::size_t vertex_offset = 0;
-    std::size_t index_offset = 0;
+    auto position = static_cast<math::float2*>(
+        m_vertex_buffers[0]->map(vertex_count * sizeof(math::float2)));
+    auto uv = static_cast<math::float2*>(
+        m_vertex_buffers[1]->map(vertex_count * sizeof(math::float2)));
+    auto color = static_cast<std::uint32_t*>(
+        m_vertex_buffers[2]->map(vertex_count * sizeof(std::uint32_t)));
+    auto offset_index = static_cast<std::uint32_t*>(
+        m_vertex_buffers[3]->map(vertex_count * sizeof(std::uint32_t)));
+    auto indices = static_cast<std::uint32_t*>(
+        m_index_buffer->map(index_count * sizeof(std::uint32_t)));
 
     for (auto& batch : m_renderer)
     {
-        m_vertex_buffers[0]->upload(
-            batch->vertex_position.data(),
-            batch->vertex_position.size() * sizeof(math::float2),
-            vertex_offset * sizeof(math::float2));
-        m_vertex_buffers[1]->upload(
-            batch->vertex_uv.data(),
-            batch->vertex_uv.size() * sizeof(math::float2),
-            vertex_offset * sizeof(math::float2));
-        m_vertex_buffers[2]->upload(
-            batch->vertex_color.data(),
-            batch->vertex_color.size() * sizeof(std::uint32_t),
-            vertex_offset * sizeof(std::uint32_t));
-        m_vertex_buffers[3]->upload(
-            batch->vertex_offset_index.data(),
-            batch->vertex_offset_index.size() * sizeof(std::uint32_t),
-            vertex_offset * sizeof(std::uint32_t));
-        m_index_buffer->upload(
-            batch->indices.data(),
-            batch->indices.size() * sizeof(std::uint32_t),
-            index_offset * sizeof(std::uint32_t));
-
-        graphics::submesh submesh = {
-            .index_start = index_offset,
-            .index_end = index_offset + batch->indices.size(),
-            .vertex_base = vertex_offset};
-        mesh_render.submeshes.push_back(submesh);
-
-        auto material_parameter = allocate_material_parameter();
-        material_parameter->mesh_type(batch->type);
-        if (batch->type != ELEMENT_MESH_TYPE_BLOCK)
-            material_parameter->texture(batch->texture);
-
-        graphics::material material = {};
-        material.pipeline = m_pipeline.get();
-        material.parameters = {
-            material_parameter->interface(),
-            m_offset_parameter->interface(),
-            m_mvp_parameter->interface()};
-        material.scissor = graphics::scissor_extent{
-            .min_x = static_cast<std::uint32_t>(batch->scissor.x),
-            .min_y = static_cast<std::uint32_t>(batch->scissor.y),
-            .max_x = static_cast<std::uint32_t>(batch->scissor.x + batch->scissor.width),
-            .max_y = static_cast<std::uint32_t>(batch->scissor.y + batch->scissor.height)};
-
-        mesh_render.materials.push_back(material);
-
-        vertex_offset += batch->vertex_position.size();
-        index_offset += batch->indices.size();
+        position =
+            std::copy(batch->vertex_position.begin(), batch->vertex_position.end(), position);
+        uv = std::copy(batch->vertex_uv.begin(), batch->vertex_uv.end(), uv);
+        color = std::copy(batch->vertex_color.begin(), batch->vertex_color.end(), color);
+        offset_index = std::copy(
+            batch->vertex_offset_index.begin(),
+            batch->vertex_offset_index.end(),
+            offset_index);
+        indices = std::copy(batch->indices.begin(), batch->indices.end(), indices);
     }
-
-    m_material_parameter_counter = 0;
 }
 
 void ui::load_font(std::string_view name, std::string_view ttf_file, std::size_t size)
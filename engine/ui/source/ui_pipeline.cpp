@@ -59,7 +59,7 @@ std::vector<graphics::pipeline_parameter_pair> material_pipeline_parameter::layo
     };
 }
 
-ui_pipeline::ui_pipeline()
+ui_pipeline::ui_pipeline() : graphics::render_pipeline(graphics::RENDER_ORDER_SUBMISSION)
 {
     // UI pass.
     graphics::render_pass_info ui_pass_info = {};
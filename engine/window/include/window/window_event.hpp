@@ -7,26 +7,26 @@ namespace ash::window
 {
 struct event_mouse_move
 {
-    using dispatcher = core::sequence_dispatcher<std::function<void(mouse_mode, int, int)>>;
+    using dispatcher = core::sequence_dispatcher<void(mouse_mode, int, int)>;
 };
 
 struct event_mouse_key
 {
-    using dispatcher = core::sequence_dispatcher<std::function<void(mouse_key, key_state)>>;
+    using dispatcher = core::sequence_dispatcher<void(mouse_key, key_state)>;
 };
 
 struct event_keyboard_key
 {
-    using dispatcher = core::sequence_dispatcher<std::function<void(keyboard_key, key_state)>>;
+    using dispatcher = core::sequence_dispatcher<void(keyboard_key, key_state)>;
 };
 
 struct event_keyboard_char
 {
-    using dispatcher = core::sequence_dispatcher<std::function<void(char)>>;
+    using dispatcher = core::sequence_dispatcher<void(char)>;
 };
 
 struct event_window_resize
 {
-    using dispatcher = core::sequence_dispatcher<std::function<void(std::uint32_t, std::uint32_t)>>;
+    using dispatcher = core::sequence_dispatcher<void(std::uint32_t, std::uint32_t)>;
 };
 } // namespace ash::window
\ No newline at end of file
@@ -28,7 +28,6 @@ bool bvh_viewer::initialize(const dictionary& config)
     initialize_task();
 
     system<core::event>().subscribe<graphics::event_render_extent_change>(
-        "sample_module",
         [this](std::uint32_t width, std::uint32_t height) { resize_camera(width, height); });
 
     auto& world = system<ecs::world>();
@@ -296,11 +295,10 @@ void bvh_viewer::add_cube(bool random)
     auto& mesh = world.component<graphics::mesh_render>(cube);
     mesh.vertex_buffers = {m_cube_positon_buffer.get(), m_cube_normal_buffer.get()};
     mesh.index_buffer = m_cube_index_buffer.get();
-    mesh.object_parameter = std::make_unique<graphics::object_pipeline_parameter>();
 
     graphics::material material = {};
     material.pipeline = m_pipeline.get();
-    material.parameters = {mesh.object_parameter->interface(), m_cube_material->interface()};
+    material.parameters = {m_cube_material->interface()};
     mesh.materials.push_back(material);
     mesh.submeshes.push_back(graphics::submesh{0, 36, 0});
 
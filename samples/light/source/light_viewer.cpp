@@ -111,11 +111,10 @@ void light_viewer::initialize_scene()
         auto& mesh = world.component<graphics::mesh_render>(m_cube);
         mesh.vertex_buffers = {m_cube_positon_buffer.get(), m_cube_normal_buffer.get()};
         mesh.index_buffer = m_cube_index_buffer.get();
-        mesh.object_parameter = std::make_unique<graphics::object_pipeline_parameter>();
 
         graphics::material material = {};
         material.pipeline = m_pipeline.get();
-        material.parameters = {mesh.object_parameter->interface(), m_material->interface()};
+        material.parameters = {m_material->interface()};
         mesh.materials.push_back(material);
         mesh.submeshes.push_back(graphics::submesh{0, m_cube_mesh_data.indices.size(), 0});
 
@@ -135,11 +134,10 @@ void light_viewer::initialize_scene()
         auto& mesh = world.component<graphics::mesh_render>(m_sphere);
         mesh.vertex_buffers = {m_sphere_positon_buffer.get(), m_sphere_normal_buffer.get()};
         mesh.index_buffer = m_sphere_index_buffer.get();
-        mesh.object_parameter = std::make_unique<graphics::object_pipeline_parameter>();
 
         graphics::material material = {};
         material.pipeline = m_pipeline.get();
-        material.parameters = {mesh.object_parameter->interface(), m_material->interface()};
+        material.parameters = {m_material->interface()};
         mesh.materials.push_back(material);
         mesh.submeshes.push_back(graphics::submesh{0, m_sphere_mesh_data.indices.size(), 0});
 
@@ -39,7 +39,7 @@ struct mmd_node_animation
     {
         std::int32_t frame;
         math::float3 translate;
-        math::float4 rotate;
+        math::quaternion48 rotate;
 
         mmd_bezier tx_bezier;
         mmd_bezier ty_bezier;
@@ -217,6 +217,11 @@ struct mmd_morph_controler
 
     std::vector<std::unique_ptr<morph>> morphs;
 
+    // Morphs accumulate in system memory, the results are then copied to the GPU buffers in one
+    // pass. The buffers only exist for meshes skinned on the GPU.
+    std::vector<math::float3> vertex_morph_offset;
+    std::vector<math::float2> uv_morph_offset;
+
     std::unique_ptr<graphics::resource_interface> vertex_morph_result;
     std::unique_ptr<graphics::resource_interface> uv_morph_result;
 };
@@ -20,7 +20,8 @@ public:
         std::string_view pmx,
         std::string_view vmd,
         graphics::render_pipeline* render_pipeline,
-        graphics::skin_pipeline* skin_pipeline);
+        graphics::skin_pipeline* skin_pipeline,
+        graphics::skin_policy skin_policy);
 
     bool load_pmx(std::string_view pmx);
     bool load_vmd(std::string_view vmd);
@@ -30,7 +31,8 @@ private:
     void load_mesh(
         ecs::entity entity,
         const pmx_loader& loader,
-        graphics::skin_pipeline* skin_pipeline);
+        graphics::skin_pipeline* skin_pipeline,
+        graphics::skin_policy skin_policy);
     void load_material(
         ecs::entity entity,
         const pmx_loader& loader,
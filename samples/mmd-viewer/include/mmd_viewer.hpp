@@ -31,5 +31,8 @@ private:
 
     std::unique_ptr<mmd_render_pipeline> m_render_pipeline;
     std::unique_ptr<mmd_skin_pipeline> m_skin_pipeline;
+
+    // Policy of the models loaded from now on.
+    graphics::skin_policy m_skin_policy;
 };
 } // namespace ash::sample::mmd
\ No newline at end of file
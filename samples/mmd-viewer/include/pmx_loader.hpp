@@ -1,5 +1,6 @@
 #pragma once
 
+#include "graphics/cpu_skin.hpp"
 #include "math/math.hpp"
 #include "mmd_pipeline.hpp"
 #include "physics_interface.hpp"
@@ -350,6 +351,19 @@ public:
     }
     graphics::resource_interface* index_buffer() const { return m_index_buffer.get(); }
 
+    graphics::cpu_skin_info cpu_skin_info() const noexcept
+    {
+        graphics::cpu_skin_info info = {};
+        info.position = m_positions;
+        info.normal = m_normals;
+        info.uv = m_uvs;
+        info.skin = m_skin_vertices;
+        info.position_slot = PMX_VERTEX_ATTRIBUTE_POSITION;
+        info.normal_slot = PMX_VERTEX_ATTRIBUTE_NORMAL;
+        info.uv_slot = PMX_VERTEX_ATTRIBUTE_UV;
+        return info;
+    }
+
     const std::vector<std::pair<std::size_t, std::size_t>>& submesh() const noexcept
     {
         return m_submesh;
@@ -402,6 +416,12 @@ private:
     std::vector<std::unique_ptr<graphics::resource_interface>> m_vertex_buffers;
     std::size_t m_vertex_count;
 
+    // Bind pose kept in memory for meshes skinned on the CPU.
+    std::vector<math::float3> m_positions;
+    std::vector<math::float3> m_normals;
+    std::vector<math::float2> m_uvs;
+    std::vector<graphics::skin_vertex> m_skin_vertices;
+
     std::unique_ptr<graphics::resource_interface> m_index_buffer;
     std::vector<std::pair<std::size_t, std::size_t>> m_submesh;
 
@@ -1,9 +1,4 @@
-cbuffer ash_object : register(b0, space0)
-{
-    float4x4 transform_m;
-};
-
-cbuffer mmd_material : register(b0, space1)
+cbuffer mmd_material : register(b0, space0)
 {
     float4 diffuse;
     float3 specular;
@@ -15,12 +10,12 @@ cbuffer mmd_material : register(b0, space1)
     uint spa_mode;
 };
 
-Texture2D tex : register(t0, space1);
-Texture2D toon : register(t1, space1);
-Texture2D spa : register(t2, space1);
+Texture2D tex : register(t0, space0);
+Texture2D toon : register(t1, space0);
+Texture2D spa : register(t2, space0);
 SamplerState sampler_clamp : register(s1);
 
-cbuffer ash_camera : register(b0, space2)
+cbuffer ash_camera : register(b0, space1)
 {
     float3 camera_position;
     float3 camera_direction;
@@ -38,7 +33,7 @@ struct ash_directional_light_data
     float _padding_1;
 };
 
-cbuffer ash_light : register(b0, space3)
+cbuffer ash_light : register(b0, space2)
 {
     ash_directional_light_data directional_light[4];
     uint directional_light_count;
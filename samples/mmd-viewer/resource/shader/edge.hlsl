@@ -1,9 +1,4 @@
-cbuffer ash_object : register(b0, space0)
-{
-    float4x4 transform_m;
-};
-
-cbuffer mmd_material : register(b0, space1)
+cbuffer mmd_material : register(b0, space0)
 {
     float4 diffuse;
     float3 specular;
@@ -15,7 +10,7 @@ cbuffer mmd_material : register(b0, space1)
     uint spa_mode;
 };
 
-cbuffer ash_camera : register(b0, space2)
+cbuffer ash_camera : register(b0, space1)
 {
     float3 camera_position;
     float3 camera_direction;
@@ -37,7 +37,6 @@ public:
         initialize_task();
 
         system<core::event>().subscribe<graphics::event_render_extent_change>(
-            "sample_module",
             [this](std::uint32_t width, std::uint32_t height) { resize_camera(width, height); });
 
         return true;
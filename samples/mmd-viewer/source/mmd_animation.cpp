@@ -1,5 +1,7 @@
 #include "mmd_animation.hpp"
 #include "scene/scene.hpp"
+#include <algorithm>
+#include <cstring>
 
 namespace ash::sample::mmd
 {
@@ -93,12 +95,12 @@ void mmd_animation::evaluate_node(
     if (bound == node_animation.keys.end())
     {
         translate = math::simd::load(node_animation.keys.back().translate);
-        rotate = math::simd::load(node_animation.keys.back().rotate);
+        rotate = math::compress_simd::load(node_animation.keys.back().rotate);
     }
     else if (bound == node_animation.keys.begin())
     {
         translate = math::simd::load(bound->translate);
-        rotate = math::simd::load(bound->rotate);
+        rotate = math::compress_simd::load(bound->rotate);
     }
     else
     {
@@ -117,8 +119,8 @@ void mmd_animation::evaluate_node(
                 0.0f));
 
         rotate = math::quaternion_simd::slerp(
-            math::simd::load(key0.rotate),
-            math::simd::load(key1.rotate),
+            math::compress_simd::load(key0.rotate),
+            math::compress_simd::load(key1.rotate),
             key1.r_bezier.evaluate(time));
 
         node_animation.offset = std::distance(node_animation.keys.cbegin(), bound);
@@ -184,10 +186,14 @@ void mmd_animation::evaluate_morph(
     mmd_morph_controler& morph_controler,
     float t)
 {
-    std::memset(
-        morph_controler.vertex_morph_result->pointer(),
-        0,
-        morph_controler.vertex_morph_result->size());
+    std::fill(
+        morph_controler.vertex_morph_offset.begin(),
+        morph_controler.vertex_morph_offset.end(),
+        math::float3{});
+    std::fill(
+        morph_controler.uv_morph_offset.begin(),
+        morph_controler.uv_morph_offset.end(),
+        math::float2{});
 
     for (auto& morph : morph_controler.morphs)
     {
@@ -219,6 +225,19 @@ void mmd_animation::evaluate_morph(
         if (weight != 0.0f)
             morph->evaluate(weight, entity);
     }
+
+    // The results are write combined upload memory, they are only written, front to back.
+    if (morph_controler.vertex_morph_result != nullptr)
+    {
+        std::memcpy(
+            morph_controler.vertex_morph_result->pointer(),
+            morph_controler.vertex_morph_offset.data(),
+            morph_controler.vertex_morph_offset.size() * sizeof(math::float3));
+        std::memcpy(
+            morph_controler.uv_morph_result->pointer(),
+            morph_controler.uv_morph_offset.data(),
+            morph_controler.uv_morph_offset.size() * sizeof(math::float2));
+    }
 }
 
 void mmd_animation::update_local(mmd_skeleton& skeleton, bool after_physics)
@@ -21,8 +21,7 @@ void mmd_morph_controler::vertex_morph::evaluate(float weight, ecs::entity entit
 
     for (auto& [index, translate] : data)
     {
-        math::float3& target =
-            *(static_cast<math::float3*>(controler.vertex_morph_result->pointer()) + index);
+        math::float3& target = controler.vertex_morph_offset[index];
 
         math::float4_simd t1 = math::simd::load(translate);
         t1 = math::vector_simd::mul(t1, weight);
@@ -60,8 +59,7 @@ void mmd_morph_controler::uv_morph::evaluate(float weight, ecs::entity entity)
 
     for (auto& [index, uv] : data)
     {
-        math::float2& target =
-            *(static_cast<math::float2*>(controler.uv_morph_result->pointer()) + index);
+        math::float2& target = controler.uv_morph_offset[index];
 
         target[0] += weight * uv[0];
         target[1] += weight * uv[1];
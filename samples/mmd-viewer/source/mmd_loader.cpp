@@ -51,7 +51,8 @@ bool mmd_loader::load(
     std::string_view pmx,
     std::string_view vmd,
     graphics::render_pipeline* render_pipeline,
-    graphics::skin_pipeline* skin_pipeline)
+    graphics::skin_pipeline* skin_pipeline,
+    graphics::skin_policy skin_policy)
 {
     auto& world = system<ecs::world>();
     bool static_model = vmd.empty();
@@ -66,12 +67,9 @@ bool mmd_loader::load(
             graphics::skinned_mesh,
             mmd_skeleton>(entity);
 
-    auto& mesh_render = world.component<graphics::mesh_render>(entity);
-    mesh_render.object_parameter = std::make_unique<graphics::object_pipeline_parameter>();
-
     pmx_loader& pmx_loader = m_pmx[pmx.data()];
     load_hierarchy(entity, pmx_loader);
-    load_mesh(entity, pmx_loader, static_model ? nullptr : skin_pipeline);
+    load_mesh(entity, pmx_loader, static_model ? nullptr : skin_pipeline, skin_policy);
     load_material(entity, pmx_loader, render_pipeline);
     load_physics(entity, pmx_loader);
     load_ik(entity, pmx_loader);
@@ -189,7 +187,8 @@ void mmd_loader::load_hierarchy(ecs::entity entity, const pmx_loader& loader)
 void mmd_loader::load_mesh(
     ecs::entity entity,
     const pmx_loader& loader,
-    graphics::skin_pipeline* skin_pipeline)
+    graphics::skin_pipeline* skin_pipeline,
+    graphics::skin_policy skin_policy)
 {
     auto& world = system<ecs::world>();
 
@@ -201,7 +200,38 @@ void mmd_loader::load_mesh(
         loader.vertex_buffers(PMX_VERTEX_ATTRIBUTE_EDGE)};
     mesh_render.index_buffer = loader.index_buffer();
 
-    if (skin_pipeline != nullptr)
+    if (skin_pipeline != nullptr && skin_policy == graphics::SKIN_POLICY_CPU)
+    {
+        auto& skinned_mesh = world.component<graphics::skinned_mesh>(entity);
+        skinned_mesh.policy = graphics::SKIN_POLICY_CPU;
+        skinned_mesh.skinned_vertex_buffers.resize(mesh_render.vertex_buffers.size());
+
+        // Written by the CPU every frame.
+        skinned_mesh.skinned_vertex_buffers[PMX_VERTEX_ATTRIBUTE_POSITION] =
+            graphics::rhi::make_vertex_buffer<math::float3>(
+                nullptr,
+                loader.vertex_count(),
+                graphics::VERTEX_BUFFER_FLAG_NONE,
+                true,
+                true);
+        skinned_mesh.skinned_vertex_buffers[PMX_VERTEX_ATTRIBUTE_NORMAL] =
+            graphics::rhi::make_vertex_buffer<math::float3>(
+                nullptr,
+                loader.vertex_count(),
+                graphics::VERTEX_BUFFER_FLAG_NONE,
+                true,
+                true);
+        skinned_mesh.skinned_vertex_buffers[PMX_VERTEX_ATTRIBUTE_UV] =
+            graphics::rhi::make_vertex_buffer<math::float2>(
+                nullptr,
+                loader.vertex_count(),
+                graphics::VERTEX_BUFFER_FLAG_NONE,
+                true,
+                true);
+        skinned_mesh.vertex_count = loader.vertex_count();
+        skinned_mesh.cpu = std::make_unique<graphics::cpu_skin>(loader.cpu_skin_info());
+    }
+    else if (skin_pipeline != nullptr)
     {
         auto& skinned_mesh = world.component<graphics::skinned_mesh>(entity);
         skinned_mesh.pipeline = skin_pipeline;
@@ -260,9 +290,7 @@ void mmd_loader::load_material(
 
         graphics::material material = {};
         material.pipeline = render_pipeline;
-        material.parameters = {
-            mesh_render.object_parameter->interface(),
-            loader.materials(i)->interface()};
+        material.parameters = {loader.materials(i)->interface()};
         mesh_render.materials.push_back(material);
     }
 }
@@ -553,23 +581,30 @@ void mmd_loader::load_morph(
         });
     }
 
-    morph_controler.vertex_morph_result = graphics::rhi::make_vertex_buffer<math::float3>(
-        nullptr,
-        pmx_loader.vertex_count(),
-        graphics::VERTEX_BUFFER_FLAG_COMPUTE_IN,
-        true,
-        true);
-    morph_controler.uv_morph_result = graphics::rhi::make_vertex_buffer<math::float2>(
-        nullptr,
-        pmx_loader.vertex_count(),
-        graphics::VERTEX_BUFFER_FLAG_COMPUTE_IN,
-        true,
-        true);
+    morph_controler.vertex_morph_offset.resize(pmx_loader.vertex_count());
+    morph_controler.uv_morph_offset.resize(pmx_loader.vertex_count());
 
+    // Meshes skinned on the CPU read the offsets directly, see mmd_viewer::update.
     auto& skinned_mesh = world.component<graphics::skinned_mesh>(entity);
-    auto skin_parameter = static_cast<skin_pipeline_parameter*>(skinned_mesh.parameter.get());
-    skin_parameter->vertex_morph(morph_controler.vertex_morph_result.get());
-    skin_parameter->uv_morph(morph_controler.uv_morph_result.get());
+    if (skinned_mesh.policy == graphics::SKIN_POLICY_GPU)
+    {
+        morph_controler.vertex_morph_result = graphics::rhi::make_vertex_buffer<math::float3>(
+            nullptr,
+            pmx_loader.vertex_count(),
+            graphics::VERTEX_BUFFER_FLAG_COMPUTE_IN,
+            true,
+            true);
+        morph_controler.uv_morph_result = graphics::rhi::make_vertex_buffer<math::float2>(
+            nullptr,
+            pmx_loader.vertex_count(),
+            graphics::VERTEX_BUFFER_FLAG_COMPUTE_IN,
+            true,
+            true);
+
+        auto skin_parameter = static_cast<skin_pipeline_parameter*>(skinned_mesh.parameter.get());
+        skin_parameter->vertex_morph(morph_controler.vertex_morph_result.get());
+        skin_parameter->uv_morph(morph_controler.uv_morph_result.get());
+    }
 }
 
 void mmd_loader::load_animation(
@@ -609,7 +644,7 @@ void mmd_loader::load_animation(
             mmd_node_animation::key key;
             key.frame = pmx_motion.frame_index;
             key.translate = pmx_motion.translate;
-            key.rotate = pmx_motion.rotate;
+            key.rotate = math::compress::to_quaternion48(pmx_motion.rotate);
 
             set_bezier(key.tx_bezier, &pmx_motion.interpolation[0]);
             set_bezier(key.ty_bezier, &pmx_motion.interpolation[1]);
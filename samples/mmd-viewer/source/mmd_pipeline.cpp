@@ -94,7 +94,7 @@ mmd_render_pipeline::mmd_render_pipeline()
         {graphics::ATTACHMENT_REFERENCE_TYPE_UNUSE, 0}
     };
     color_pass_info.primitive_topology = graphics::PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
-    color_pass_info.parameters = {"ash_object", "mmd_material", "ash_camera", "ash_light"};
+    color_pass_info.parameters = {"mmd_material", "ash_camera", "ash_light"};
     color_pass_info.samples = 4;
 
     // Edge pass.
@@ -112,7 +112,7 @@ mmd_render_pipeline::mmd_render_pipeline()
         {graphics::ATTACHMENT_REFERENCE_TYPE_RESOLVE, 0}
     };
     edge_pass_info.primitive_topology = graphics::PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
-    edge_pass_info.parameters = {"ash_object", "mmd_material", "ash_camera"};
+    edge_pass_info.parameters = {"mmd_material", "ash_camera"};
     edge_pass_info.samples = 4;
     edge_pass_info.rasterizer.cull_mode = graphics::CULL_MODE_FRONT;
     edge_pass_info.depth_stencil.depth_functor = graphics::DEPTH_FUNCTOR_LESS;
@@ -178,12 +178,11 @@ void mmd_render_pipeline::render(
     command->scissor(&rect, 1);
 
     // Color pass.
-    command->parameter(2, scene.camera_parameter);
-    command->parameter(3, scene.light_parameter);
+    command->parameter(1, scene.camera_parameter);
+    command->parameter(2, scene.light_parameter);
     for (auto& unit : scene.units)
     {
         command->parameter(0, unit.parameters[0]);
-        command->parameter(1, unit.parameters[1]);
 
         graphics::resource_interface* vertex_buffers[] = {
             unit.vertex_buffers[0],
@@ -196,11 +195,10 @@ void mmd_render_pipeline::render(
     command->next_pass(m_interface.get());
 
     // Edge pass.
-    command->parameter(2, scene.camera_parameter);
+    command->parameter(1, scene.camera_parameter);
     for (auto& unit : scene.units)
     {
         command->parameter(0, unit.parameters[0]);
-        command->parameter(1, unit.parameters[1]);
 
         graphics::resource_interface* vertex_buffers[] = {
             unit.vertex_buffers[0],
@@ -10,7 +10,7 @@
 
 namespace ash::sample::mmd
 {
-mmd_viewer::mmd_viewer() : system_base("mmd_viewer")
+mmd_viewer::mmd_viewer() : system_base("mmd_viewer"), m_skin_policy(graphics::SKIN_POLICY_GPU)
 {
 }
 
@@ -38,6 +38,10 @@ bool mmd_viewer::initialize(const dictionary& config)
     m_render_pipeline = std::make_unique<mmd_render_pipeline>();
     m_skin_pipeline = std::make_unique<mmd_skin_pipeline>();
 
+    // "cpu" skins on the task workers, for machines without a fast GPU.
+    if (config["skin"] == "cpu")
+        m_skin_policy = graphics::SKIN_POLICY_CPU;
+
     return true;
 }
 
@@ -47,7 +51,13 @@ ash::ecs::entity mmd_viewer::load_mmd(
     std::string_view vmd)
 {
     ecs::entity entity = system<ecs::world>().create(name);
-    if (m_loader->load(entity, pmx, vmd, m_render_pipeline.get(), m_skin_pipeline.get()))
+    if (m_loader->load(
+            entity,
+            pmx,
+            vmd,
+            m_render_pipeline.get(),
+            m_skin_pipeline.get(),
+            m_skin_policy))
     {
         return entity;
     }
@@ -107,7 +117,7 @@ void mmd_viewer::update()
     animation.update(true);
 
     world.view<mmd_skeleton, graphics::skinned_mesh>().each(
-        [&](mmd_skeleton& skeleton, graphics::skinned_mesh& skinned_mesh) {
+        [&](ecs::entity entity, mmd_skeleton& skeleton, graphics::skinned_mesh& skinned_mesh) {
             math::float4x4_simd to_world;
             math::float4x4_simd initial_inverse;
             math::float4x4_simd final_transform;
@@ -122,9 +132,24 @@ void mmd_viewer::update()
                 math::simd::store(final_transform, skeleton.world[i]);
             }
 
-            auto parameter = dynamic_cast<skin_pipeline_parameter*>(skinned_mesh.parameter.get());
-            ASH_ASSERT(parameter);
-            parameter->bone_transform(skeleton.world);
+            if (skinned_mesh.policy == graphics::SKIN_POLICY_GPU)
+            {
+                auto parameter =
+                    dynamic_cast<skin_pipeline_parameter*>(skinned_mesh.parameter.get());
+                ASH_ASSERT(parameter);
+                parameter->bone_transform(skeleton.world);
+                return;
+            }
+
+            skinned_mesh.cpu->bones(skeleton.world);
+
+            // Components can move in memory, the offsets are set again every frame.
+            if (world.has_component<mmd_morph_controler>(entity))
+            {
+                auto& morph_controler = world.component<mmd_morph_controler>(entity);
+                skinned_mesh.cpu->position_offset(morph_controler.vertex_morph_offset.data());
+                skinned_mesh.cpu->uv_offset(morph_controler.uv_morph_offset.data());
+            }
         });
 }
 
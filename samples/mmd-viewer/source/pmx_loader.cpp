@@ -99,6 +99,9 @@ bool pmx_loader::load_vertex(std::ifstream& fin)
     std::vector<math::float3> normal(m_vertex_count);
     std::vector<math::float2> uv(m_vertex_count);
 
+    // The same weights for skinning on the CPU, QDEF falls back to the first bone.
+    m_skin_vertices.resize(m_vertex_count);
+
     // first: skin type(0: BDEF, 1: SDEF), second: skin data index
     std::vector<math::uint2> skin(m_vertex_count);
     std::vector<float> edge(m_vertex_count);
@@ -151,6 +154,7 @@ bool pmx_loader::load_vertex(std::ifstream& fin)
             skin[i][0] = 0;
             skin[i][1] = bdef_bone.size();
             bdef_bone.push_back(data);
+            m_skin_vertices[i] = {graphics::SKIN_TYPE_BDEF1, data.index, data.weight};
             break;
         }
         case pmx_vertex_weight::BDEF2: {
@@ -164,6 +168,7 @@ bool pmx_loader::load_vertex(std::ifstream& fin)
             skin[i][0] = 0;
             skin[i][1] = bdef_bone.size();
             bdef_bone.push_back(data);
+            m_skin_vertices[i] = {graphics::SKIN_TYPE_BDEF2, data.index, data.weight};
             break;
         }
         case pmx_vertex_weight::BDEF4: {
@@ -180,6 +185,7 @@ bool pmx_loader::load_vertex(std::ifstream& fin)
             skin[i][0] = 0;
             skin[i][1] = bdef_bone.size();
             bdef_bone.push_back(data);
+            m_skin_vertices[i] = {graphics::SKIN_TYPE_BDEF4, data.index, data.weight};
             break;
         }
         case pmx_vertex_weight::SDEF: {
@@ -213,6 +219,14 @@ bool pmx_loader::load_vertex(std::ifstream& fin)
             skin[i][0] = 1;
             skin[i][1] = sdef_bone.size();
             sdef_bone.push_back(data);
+
+            auto& skin_vertex = m_skin_vertices[i];
+            skin_vertex.type = graphics::SKIN_TYPE_SDEF;
+            skin_vertex.index = {data.index[0], data.index[1], 0, 0};
+            skin_vertex.weight = {data.weight[0], data.weight[1], 0.0f, 0.0f};
+            skin_vertex.center = data.center;
+            skin_vertex.r0 = data.r0;
+            skin_vertex.r1 = data.r1;
             break;
         }
         case pmx_vertex_weight::QDEF: {
@@ -272,6 +286,10 @@ bool pmx_loader::load_vertex(std::ifstream& fin)
             graphics::VERTEX_BUFFER_FLAG_COMPUTE_IN);
     }
 
+    m_positions = std::move(position);
+    m_normals = std::move(normal);
+    m_uvs = std::move(uv);
+
     return true;
 }
 
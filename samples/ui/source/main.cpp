@@ -25,7 +25,6 @@ public:
         initialize_camera();
 
         system<core::event>().subscribe<graphics::event_render_extent_change>(
-            "sample_module",
             [this](std::uint32_t width, std::uint32_t height) { resize_camera(width, height); });
 
         return true;
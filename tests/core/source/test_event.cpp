@@ -0,0 +1,288 @@
+#include "core/event.hpp"
+#include <catch2/catch.hpp>
+#include <memory>
+#include <thread>
+
+using namespace ash::core;
+
+namespace ash::test
+{
+namespace
+{
+struct test_sequence_event
+{
+    using dispatcher = sequence_dispatcher<void(int)>;
+};
+
+struct test_queued_event
+{
+    using dispatcher = queued_dispatcher<void(int)>;
+};
+} // namespace
+
+TEST_CASE("delegate", "[event]")
+{
+    SECTION("invoke")
+    {
+        int base = 10;
+        delegate<int(int)> add([&base](int value) { return base + value; });
+        CHECK(add);
+        CHECK(add(5) == 15);
+
+        base = 20;
+        CHECK(add(5) == 25);
+    }
+
+    SECTION("reference arguments")
+    {
+        delegate<void(int&)> increase([](int& value) { ++value; });
+
+        int value = 1;
+        increase(value);
+        CHECK(value == 2);
+    }
+
+    SECTION("empty")
+    {
+        delegate<void()> empty;
+        CHECK(!empty);
+    }
+
+    SECTION("move")
+    {
+        auto counter = std::make_shared<int>(0);
+
+        delegate<void()> a([counter]() { ++*counter; });
+        CHECK(counter.use_count() == 2);
+
+        delegate<void()> b(std::move(a));
+        CHECK(!a);
+        CHECK(b);
+        CHECK(counter.use_count() == 2);
+
+        b();
+        CHECK(*counter == 1);
+
+        delegate<void()> c;
+        c = std::move(b);
+        CHECK(!b);
+        c();
+        CHECK(*counter == 2);
+        CHECK(counter.use_count() == 2);
+
+        // Assigning over a delegate destroys the functor it held.
+        c = delegate<void()>([]() {});
+        CHECK(counter.use_count() == 1);
+    }
+
+    SECTION("destroy")
+    {
+        auto counter = std::make_shared<int>(0);
+        {
+            delegate<void()> a([counter]() {});
+            CHECK(counter.use_count() == 2);
+        }
+        CHECK(counter.use_count() == 1);
+    }
+}
+
+TEST_CASE("sequence dispatcher", "[event]")
+{
+    sequence_dispatcher<void(int)> dispatcher;
+
+    std::vector<std::pair<int, int>> calls;
+    event_handle a = dispatcher.subscribe([&](int value) { calls.emplace_back(0, value); });
+    event_handle b = dispatcher.subscribe([&](int value) { calls.emplace_back(1, value); });
+    event_handle c = dispatcher.subscribe([&](int value) { calls.emplace_back(2, value); });
+    CHECK(a != b);
+    CHECK(b != c);
+    CHECK(a != c);
+
+    // In subscription order.
+    dispatcher.publish(7);
+    CHECK(calls == std::vector<std::pair<int, int>>{{0, 7}, {1, 7}, {2, 7}});
+
+    calls.clear();
+    dispatcher.unsubscribe(b);
+    dispatcher.publish(8);
+    CHECK(calls == std::vector<std::pair<int, int>>{{0, 8}, {2, 8}});
+
+    // Unknown and already removed handles are ignored.
+    calls.clear();
+    dispatcher.unsubscribe(b);
+    dispatcher.unsubscribe(1000);
+    dispatcher.publish(9);
+    CHECK(calls == std::vector<std::pair<int, int>>{{0, 9}, {2, 9}});
+
+    // Handles are not reused.
+    event_handle d = dispatcher.subscribe([&](int value) { calls.emplace_back(3, value); });
+    CHECK(d != a);
+    CHECK(d != b);
+    CHECK(d != c);
+
+    calls.clear();
+    dispatcher.unsubscribe(a);
+    dispatcher.unsubscribe(c);
+    dispatcher.publish(10);
+    CHECK(calls == std::vector<std::pair<int, int>>{{3, 10}});
+}
+
+TEST_CASE("queued dispatcher", "[event]")
+{
+    SECTION("flush")
+    {
+        queued_dispatcher<void(int)> dispatcher;
+
+        std::vector<int> values;
+        dispatcher.subscribe([&](int value) { values.push_back(value); });
+
+        CHECK(dispatcher.publish(1));
+        CHECK(dispatcher.publish(2));
+        CHECK(dispatcher.publish(3));
+        CHECK(values.empty());
+
+        dispatcher.flush();
+        CHECK(values == std::vector<int>{1, 2, 3});
+
+        dispatcher.flush();
+        CHECK(values == std::vector<int>{1, 2, 3});
+    }
+
+    SECTION("full")
+    {
+        // The capacity is rounded up to a power of two.
+        queued_dispatcher<void(int)> dispatcher(3);
+
+        std::vector<int> values;
+        dispatcher.subscribe([&](int value) { values.push_back(value); });
+
+        for (int i = 0; i < 4; ++i)
+            CHECK(dispatcher.publish(i));
+        CHECK(!dispatcher.publish(4));
+
+        dispatcher.flush();
+        CHECK(values == std::vector<int>{0, 1, 2, 3});
+
+        // The slots are free again after the flush.
+        values.clear();
+        for (int i = 0; i < 4; ++i)
+            CHECK(dispatcher.publish(i + 10));
+        dispatcher.flush();
+        CHECK(values == std::vector<int>{10, 11, 12, 13});
+    }
+
+    SECTION("publish while flushing")
+    {
+        queued_dispatcher<void(int)> dispatcher;
+
+        std::vector<int> values;
+        dispatcher.subscribe([&](int value) {
+            values.push_back(value);
+            if (value < 3)
+                dispatcher.publish(value + 1);
+        });
+
+        dispatcher.publish(0);
+        dispatcher.flush();
+        CHECK(values == std::vector<int>{0});
+
+        dispatcher.flush();
+        dispatcher.flush();
+        dispatcher.flush();
+        CHECK(values == std::vector<int>{0, 1, 2, 3});
+    }
+
+    SECTION("destroy pending")
+    {
+        auto counter = std::make_shared<int>(0);
+        {
+            queued_dispatcher<void(std::shared_ptr<int>)> dispatcher;
+            dispatcher.publish(counter);
+            dispatcher.publish(counter);
+            CHECK(counter.use_count() == 3);
+        }
+        CHECK(counter.use_count() == 1);
+    }
+
+    SECTION("threads")
+    {
+        constexpr int THREAD_COUNT = 4;
+        constexpr int EVENT_COUNT = 20000;
+
+        // Smaller than the number of events, so that the ring wraps while it is flushed.
+        queued_dispatcher<void(int)> dispatcher(64);
+
+        std::vector<std::vector<int>> received(THREAD_COUNT);
+        dispatcher.subscribe([&](int value) {
+            received[value / EVENT_COUNT].push_back(value % EVENT_COUNT);
+        });
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREAD_COUNT; ++t)
+        {
+            threads.emplace_back([&dispatcher, t]() {
+                for (int i = 0; i < EVENT_COUNT; ++i)
+                {
+                    while (!dispatcher.publish(t * EVENT_COUNT + i))
+                        std::this_thread::yield();
+                }
+            });
+        }
+
+        std::size_t total = 0;
+        while (total != THREAD_COUNT * EVENT_COUNT)
+        {
+            dispatcher.flush();
+
+            total = 0;
+            for (auto& r : received)
+                total += r.size();
+        }
+
+        for (auto& thread : threads)
+            thread.join();
+
+        // Every event arrives once, in the order its thread published it.
+        for (auto& r : received)
+        {
+            REQUIRE(r.size() == EVENT_COUNT);
+            for (int i = 0; i < EVENT_COUNT; ++i)
+                REQUIRE(r[i] == i);
+        }
+    }
+}
+
+TEST_CASE("event", "[event]")
+{
+    event e;
+    e.register_event<test_sequence_event>();
+    e.register_event<test_queued_event>(16);
+
+    std::vector<int> sequence_values;
+    std::vector<int> queued_values;
+    event_handle sequence_handle = e.subscribe<test_sequence_event>(
+        [&](int value) { sequence_values.push_back(value); });
+    event_handle queued_handle =
+        e.subscribe<test_queued_event>([&](int value) { queued_values.push_back(value); });
+
+    e.publish<test_sequence_event>(1);
+    CHECK(e.publish<test_queued_event>(2));
+    CHECK(sequence_values == std::vector<int>{1});
+    CHECK(queued_values.empty());
+
+    // Queued events are dispatched at the beginning of the next frame.
+    e.on_begin_frame();
+    CHECK(queued_values == std::vector<int>{2});
+
+    e.unsubscribe<test_sequence_event>(sequence_handle);
+    e.unsubscribe<test_queued_event>(queued_handle);
+    e.publish<test_sequence_event>(3);
+    e.publish<test_queued_event>(4);
+    e.on_begin_frame();
+    CHECK(sequence_values == std::vector<int>{1});
+    CHECK(queued_values == std::vector<int>{2});
+
+    e.unregister_event<test_sequence_event>();
+    e.unregister_event<test_queued_event>();
+}
+} // namespace ash::test
\ No newline at end of file
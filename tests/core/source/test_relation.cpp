@@ -0,0 +1,374 @@
+#include "core/event.hpp"
+#include "core/relation.hpp"
+#include <catch2/catch.hpp>
+#include <functional>
+#include <random>
+
+using namespace ash::core;
+
+namespace ash::test
+{
+namespace
+{
+relation& install_relation()
+{
+    // The systems stay installed for the whole run, every test creates its own entities.
+    context::install<ecs::world>();
+    context::install<event>();
+    context::install<relation>();
+    return system<relation>();
+}
+
+ecs::entity create_node()
+{
+    auto& world = system<ecs::world>();
+    ecs::entity entity = world.create();
+    world.add<core::link>(entity);
+    return entity;
+}
+
+std::vector<ecs::entity> link_bfs(ecs::entity root)
+{
+    auto& world = system<ecs::world>();
+
+    std::vector<ecs::entity> result = {root};
+    for (std::size_t i = 0; i < result.size(); ++i)
+    {
+        for (ecs::entity child : world.component<core::link>(result[i]).children)
+            result.push_back(child);
+    }
+    return result;
+}
+
+std::vector<ecs::entity> link_dfs(ecs::entity root)
+{
+    auto& world = system<ecs::world>();
+
+    std::vector<ecs::entity> result;
+    std::function<void(ecs::entity)> visit = [&](ecs::entity entity) {
+        result.push_back(entity);
+        for (ecs::entity child : world.component<core::link>(entity).children)
+            visit(child);
+    };
+    visit(root);
+    return result;
+}
+
+// Compares the traversals with the link components and checks the flattened layout.
+void check_tree(relation& relation, ecs::entity root)
+{
+    std::vector<ecs::entity> bfs;
+    relation.each_bfs(root, [&](ecs::entity entity) { bfs.push_back(entity); });
+    CHECK(bfs == link_bfs(root));
+
+    std::vector<ecs::entity> dfs;
+    relation.each_dfs(root, [&](ecs::entity entity) { dfs.push_back(entity); });
+    CHECK(dfs == link_dfs(root));
+
+    std::size_t level_count = 1;
+    relation.each_level(root, [&](std::uint32_t begin, std::uint32_t end) {
+        level_count += end - begin;
+    });
+    CHECK(level_count == bfs.size());
+
+    auto& world = system<ecs::world>();
+    const std::vector<hierarchy_node>& hierarchy = relation.hierarchy();
+    for (std::uint32_t i = 0; i < hierarchy.size(); ++i)
+    {
+        const hierarchy_node& node = hierarchy[i];
+        REQUIRE(relation.hierarchy_index(node.entity) == i);
+        if (i != 0)
+            REQUIRE(hierarchy[i - 1].depth <= node.depth);
+
+        if (node.parent != relation::INVALID_INDEX)
+        {
+            const hierarchy_node& parent = hierarchy[node.parent];
+            REQUIRE(parent.first_child <= i);
+            REQUIRE(i < parent.first_child + parent.child_count);
+        }
+        else
+        {
+            REQUIRE(world.component<core::link>(node.entity).parent == ecs::INVALID_ENTITY);
+        }
+
+        for (std::uint32_t j = node.first_child; j < node.first_child + node.child_count; ++j)
+        {
+            REQUIRE(hierarchy[j].parent == i);
+            REQUIRE(hierarchy[j].depth == node.depth + 1);
+            REQUIRE(world.component<core::link>(hierarchy[j].entity).parent == node.entity);
+        }
+    }
+}
+} // namespace
+
+TEST_CASE("relation traversal", "[relation]")
+{
+    relation& relation = install_relation();
+
+    // root -> a, b
+    // a    -> c, d
+    // b    -> e
+    // c    -> f
+    ecs::entity root = create_node();
+    ecs::entity a = create_node();
+    ecs::entity b = create_node();
+    ecs::entity c = create_node();
+    ecs::entity d = create_node();
+    ecs::entity e = create_node();
+    ecs::entity f = create_node();
+
+    relation.link(a, root);
+    relation.link(b, root);
+    relation.link(c, a);
+    relation.link(d, a);
+    relation.link(e, b);
+    relation.link(f, c);
+
+    SECTION("bfs")
+    {
+        std::vector<ecs::entity> nodes;
+        relation.each_bfs(root, [&](ecs::entity entity) { nodes.push_back(entity); });
+        CHECK(nodes == std::vector<ecs::entity>{root, a, b, c, d, e, f});
+
+        nodes.clear();
+        relation.each_bfs(root, [&](ecs::entity entity) { nodes.push_back(entity); }, true);
+        CHECK(nodes == std::vector<ecs::entity>{a, b, c, d, e, f});
+
+        nodes.clear();
+        relation.each_bfs(root, [&](ecs::entity entity) {
+            nodes.push_back(entity);
+            return entity != a;
+        });
+        CHECK(nodes == std::vector<ecs::entity>{root, a, b, e});
+    }
+
+    SECTION("dfs")
+    {
+        std::vector<ecs::entity> nodes;
+        relation.each_dfs(root, [&](ecs::entity entity) { nodes.push_back(entity); });
+        CHECK(nodes == std::vector<ecs::entity>{root, a, c, f, d, b, e});
+
+        nodes.clear();
+        relation.each_dfs(root, [&](ecs::entity entity) { nodes.push_back(entity); }, true);
+        CHECK(nodes == std::vector<ecs::entity>{a, c, f, d, b, e});
+
+        nodes.clear();
+        relation.each_dfs(root, [&](ecs::entity entity) {
+            nodes.push_back(entity);
+            return entity != c;
+        });
+        CHECK(nodes == std::vector<ecs::entity>{root, a, c, d, b, e});
+
+        // A subtree stops at its own root.
+        nodes.clear();
+        relation.each_dfs(a, [&](ecs::entity entity) { nodes.push_back(entity); });
+        CHECK(nodes == std::vector<ecs::entity>{a, c, f, d});
+
+        nodes.clear();
+        relation.each_dfs(f, [&](ecs::entity entity) { nodes.push_back(entity); }, true);
+        CHECK(nodes.empty());
+    }
+
+    SECTION("propagate")
+    {
+        std::vector<std::pair<ecs::entity, std::uint8_t>> nodes;
+        relation.propagate(
+            root,
+            [&](ecs::entity entity, std::uint8_t state) -> std::uint8_t {
+                nodes.emplace_back(entity, state);
+                return entity == b ? 0 : state + 1;
+            },
+            1);
+        CHECK(nodes == decltype(nodes){{root, 1}, {a, 2}, {b, 2}, {c, 3}, {d, 3}, {f, 4}});
+    }
+
+    SECTION("each level")
+    {
+        std::vector<std::vector<ecs::entity>> levels;
+        relation.each_level(root, [&](std::uint32_t begin, std::uint32_t end) {
+            auto& level = levels.emplace_back();
+            for (std::uint32_t i = begin; i < end; ++i)
+                level.push_back(relation.hierarchy()[i].entity);
+        });
+        CHECK(levels == decltype(levels){{a, b}, {c, d, e}, {f}});
+
+        levels.clear();
+        relation.each_level(a, [&](std::uint32_t begin, std::uint32_t end) {
+            auto& level = levels.emplace_back();
+            for (std::uint32_t i = begin; i < end; ++i)
+                level.push_back(relation.hierarchy()[i].entity);
+        });
+        CHECK(levels == decltype(levels){{c, d}, {f}});
+    }
+
+    check_tree(relation, root);
+}
+
+TEST_CASE("relation link", "[relation]")
+{
+    relation& relation = install_relation();
+
+    ecs::entity root = create_node();
+    relation.hierarchy_index(root);
+
+    ecs::entity a = create_node();
+    ecs::entity b = create_node();
+    relation.link(a, root);
+    relation.link(b, a);
+    check_tree(relation, root);
+
+    SECTION("untracked tree")
+    {
+        // Built while untracked, then added in one piece.
+        ecs::entity model = create_node();
+        ecs::entity bone = create_node();
+        relation.link(bone, model);
+        relation.link(create_node(), bone);
+        relation.link(create_node(), bone);
+
+        relation.link(model, b);
+        check_tree(relation, root);
+        CHECK(relation.hierarchy()[relation.hierarchy_index(bone)].depth == 4);
+    }
+
+    SECTION("move subtree")
+    {
+        ecs::entity c = create_node();
+        relation.link(c, root);
+
+        relation.unlink(a);
+        relation.link(a, c);
+        check_tree(relation, root);
+
+        std::vector<ecs::entity> nodes;
+        relation.each_dfs(root, [&](ecs::entity entity) { nodes.push_back(entity); });
+        CHECK(nodes == std::vector<ecs::entity>{root, c, a, b});
+    }
+
+    SECTION("unlink")
+    {
+        relation.unlink(b);
+        check_tree(relation, root);
+        check_tree(relation, b);
+
+        // The detached tree is tracked on its own after the lookup.
+        CHECK(relation.hierarchy()[relation.hierarchy_index(b)].depth == 0);
+        CHECK(relation.hierarchy()[relation.hierarchy_index(a)].depth == 1);
+    }
+
+    SECTION("tracked root")
+    {
+        ecs::entity other = create_node();
+        ecs::entity child = create_node();
+        relation.link(child, other);
+        relation.hierarchy_index(other);
+
+        // Linked under the tracked tree, the root is no longer a root.
+        relation.link(other, b);
+        check_tree(relation, root);
+        CHECK(relation.hierarchy()[relation.hierarchy_index(child)].depth == 4);
+
+        // Linked under an untracked tree, it is dropped until that tree is looked up.
+        ecs::entity untracked = create_node();
+        relation.unlink(other);
+        relation.link(other, untracked);
+        check_tree(relation, root);
+        check_tree(relation, untracked);
+    }
+}
+
+TEST_CASE("relation trees", "[relation]")
+{
+    relation& relation = install_relation();
+    auto& world = system<ecs::world>();
+
+    // Several separate trees, each added on its own lookup.
+    std::vector<ecs::entity> roots;
+    for (int i = 0; i < 5; ++i)
+    {
+        ecs::entity root = create_node();
+        ecs::entity a = create_node();
+        relation.link(a, root);
+        relation.link(create_node(), a);
+        relation.link(create_node(), root);
+
+        relation.hierarchy_index(root);
+        roots.push_back(root);
+    }
+
+    for (ecs::entity root : roots)
+        check_tree(relation, root);
+
+    // Move a subtree from the first tree to the last one.
+    ecs::entity a = world.component<core::link>(roots.front()).children.front();
+    relation.unlink(a);
+    relation.link(a, roots.back());
+    for (ecs::entity root : roots)
+        check_tree(relation, root);
+
+    // A tracked tree linked under another one.
+    relation.link(roots[2], a);
+    CHECK(relation.hierarchy()[relation.hierarchy_index(roots[2])].depth == 2);
+    check_tree(relation, roots.back());
+
+    relation.unlink(roots[2]);
+    check_tree(relation, roots[2]);
+    check_tree(relation, roots.back());
+}
+
+TEST_CASE("relation random", "[relation]")
+{
+    relation& relation = install_relation();
+    auto& world = system<ecs::world>();
+
+    std::mt19937 engine(3);
+
+    ecs::entity root = create_node();
+    std::vector<ecs::entity> nodes = {root};
+
+    auto random_node = [&]() {
+        return nodes[std::uniform_int_distribution<std::size_t>(0, nodes.size() - 1)(engine)];
+    };
+
+    auto in_subtree = [&](ecs::entity entity, ecs::entity subtree) {
+        for (; entity != ecs::INVALID_ENTITY; entity = world.component<core::link>(entity).parent)
+        {
+            if (entity == subtree)
+                return true;
+        }
+        return false;
+    };
+
+    relation.hierarchy_index(root);
+    for (int i = 0; i < 2000; ++i)
+    {
+        // Several changes between checks, each spliced on its own.
+        int change_count = std::uniform_int_distribution<int>(1, 4)(engine);
+        for (int j = 0; j < change_count; ++j)
+        {
+            if (nodes.size() < 10 || engine() % 3 == 0)
+            {
+                ecs::entity entity = create_node();
+                relation.link(entity, random_node());
+                nodes.push_back(entity);
+                continue;
+            }
+
+            ecs::entity entity = random_node();
+            if (entity == root)
+                continue;
+
+            if (world.component<core::link>(entity).parent != ecs::INVALID_ENTITY)
+                relation.unlink(entity);
+
+            ecs::entity parent = random_node();
+            if (!in_subtree(parent, entity))
+                relation.link(entity, parent);
+            else if (engine() % 2 == 0)
+                relation.hierarchy_index(entity);
+        }
+
+        check_tree(relation, root);
+    }
+}
+} // namespace ash::test
@@ -0,0 +1,239 @@
+#include "core/timer.hpp"
+#include <catch2/catch.hpp>
+#include <cmath>
+
+using namespace ash::core;
+using namespace std::chrono_literals;
+
+namespace ash::test
+{
+class timer_accessor
+{
+public:
+    static void update_fixed_step(timer& t, std::chrono::nanoseconds frame_delta)
+    {
+        t.update_fixed_step(frame_delta);
+    }
+
+    static void update_statistics(timer& t, float frame_delta) { t.update_statistics(frame_delta); }
+};
+
+namespace
+{
+dictionary make_timer_config(
+    std::uint32_t fixed_frequency,
+    std::size_t max_fixed_steps,
+    std::uint32_t frame_rate = 0,
+    std::string_view pacer = "sleep")
+{
+    dictionary config;
+    config["fixed_frequency"] = fixed_frequency;
+    config["max_fixed_steps"] = max_fixed_steps;
+    config["frame_rate"] = frame_rate;
+    config["pacer"] = pacer;
+    config["spin_time"] = 1000;
+    config["statistics_interval"] = 0;
+    return config;
+}
+} // namespace
+
+TEST_CASE("timer fixed step", "[timer]")
+{
+    timer t;
+
+    SECTION("disabled")
+    {
+        t.initialize(make_timer_config(0, 5));
+
+        timer_accessor::update_fixed_step(t, 25ms);
+        CHECK(t.fixed_steps() == 1);
+        CHECK(t.fixed_alpha() == 1.0f);
+        CHECK(t.fixed_delta() == t.frame_delta());
+    }
+
+    SECTION("accumulate")
+    {
+        // 10 ms steps.
+        t.initialize(make_timer_config(100, 5));
+        CHECK(t.fixed_delta() == Approx(0.01f));
+
+        timer_accessor::update_fixed_step(t, 25ms);
+        CHECK(t.fixed_steps() == 2);
+        CHECK(t.fixed_alpha() == Approx(0.5f));
+
+        // The 5 ms left from the last frame complete a step.
+        timer_accessor::update_fixed_step(t, 5ms);
+        CHECK(t.fixed_steps() == 1);
+        CHECK(t.fixed_alpha() == Approx(0.0f));
+
+        timer_accessor::update_fixed_step(t, 4ms);
+        CHECK(t.fixed_steps() == 0);
+        CHECK(t.fixed_alpha() == Approx(0.4f));
+
+        timer_accessor::update_fixed_step(t, 8ms);
+        CHECK(t.fixed_steps() == 1);
+        CHECK(t.fixed_alpha() == Approx(0.2f));
+    }
+
+    SECTION("drop catch-up time")
+    {
+        t.initialize(make_timer_config(100, 3));
+
+        // 10 steps are due, only 3 are simulated and the remaining whole steps are dropped.
+        timer_accessor::update_fixed_step(t, 105ms);
+        CHECK(t.fixed_steps() == 3);
+        CHECK(t.fixed_alpha() == Approx(0.5f));
+
+        // The dropped time is not simulated in the following frames.
+        timer_accessor::update_fixed_step(t, 5ms);
+        CHECK(t.fixed_steps() == 1);
+        CHECK(t.fixed_alpha() == Approx(0.0f));
+
+        timer_accessor::update_fixed_step(t, 30ms);
+        CHECK(t.fixed_steps() == 3);
+        CHECK(t.fixed_alpha() == Approx(0.0f));
+    }
+}
+
+TEST_CASE("timer statistics", "[timer]")
+{
+    timer t;
+    t.initialize(make_timer_config(0, 1));
+
+    SECTION("empty")
+    {
+        timer::frame_statistics statistics = t.statistics();
+        CHECK(statistics.p50 == 0.0f);
+        CHECK(statistics.p99 == 0.0f);
+        CHECK(statistics.jitter == 0.0f);
+    }
+
+    SECTION("percentile")
+    {
+        // 1 ms to 100 ms in shuffled order.
+        for (std::size_t i = 0; i < 100; ++i)
+            timer_accessor::update_statistics(t, static_cast<float>((i * 37) % 100 + 1) * 0.001f);
+
+        timer::frame_statistics statistics = t.statistics();
+        CHECK(statistics.p50 == Approx(0.050f));
+        CHECK(statistics.p95 == Approx(0.095f));
+        CHECK(statistics.p99 == Approx(0.099f));
+        CHECK(statistics.average == Approx(0.0505f));
+
+        // Standard deviation of 1..n is sqrt((n * n - 1) / 12).
+        CHECK(statistics.jitter == Approx(std::sqrt((100.0f * 100.0f - 1.0f) / 12.0f) * 0.001f));
+    }
+
+    SECTION("jitter")
+    {
+        // Alternating 10 ms and 20 ms frames.
+        for (std::size_t i = 0; i < 10; ++i)
+            timer_accessor::update_statistics(t, i % 2 == 0 ? 0.010f : 0.020f);
+
+        timer::frame_statistics statistics = t.statistics();
+        CHECK(statistics.p50 == Approx(0.010f));
+        CHECK(statistics.p95 == Approx(0.020f));
+        CHECK(statistics.average == Approx(0.015f));
+        CHECK(statistics.jitter == Approx(0.005f));
+    }
+
+    SECTION("rolling window")
+    {
+        // Frames older than the window don't contribute.
+        for (std::size_t i = 0; i < 100; ++i)
+            timer_accessor::update_statistics(t, 1.0f);
+        for (std::size_t i = 0; i < timer::FRAME_STATISTICS_SIZE; ++i)
+            timer_accessor::update_statistics(t, 0.016f);
+
+        timer::frame_statistics statistics = t.statistics();
+        CHECK(statistics.p50 == Approx(0.016f));
+        CHECK(statistics.p99 == Approx(0.016f));
+        CHECK(statistics.average == Approx(0.016f));
+        CHECK(statistics.jitter == Approx(0.0f).margin(0.000001f));
+    }
+}
+
+TEST_CASE("timer sleep", "[timer]")
+{
+    SECTION("sleep until")
+    {
+        timer::steady_time_point end_time = timer::now() + 3ms;
+        timer::sleep_until(end_time);
+        CHECK(timer::now() >= end_time);
+    }
+
+    SECTION("spin only")
+    {
+        timer::steady_time_point end_time = timer::now() + 1ms;
+        timer::sleep_until(end_time, 2ms);
+        CHECK(timer::now() >= end_time);
+    }
+
+    SECTION("past")
+    {
+        timer::steady_time_point end_time = timer::now() - 1ms;
+        timer::sleep_until(end_time);
+        CHECK(timer::now() >= end_time);
+    }
+
+    SECTION("sleep")
+    {
+        timer::steady_time_point start = timer::now();
+        timer::sleep(2ms, 0ms);
+        CHECK(timer::now() - start >= 2ms);
+    }
+}
+
+TEST_CASE("timer pace", "[timer]")
+{
+    SECTION("unlimited")
+    {
+        timer t;
+        t.initialize(make_timer_config(0, 1, 0));
+
+        timer::steady_time_point start = timer::now();
+        for (std::size_t i = 0; i < 10; ++i)
+            t.pace();
+        CHECK(timer::now() - start < 5ms);
+    }
+
+    SECTION("sleep pacer")
+    {
+        // The deadlines start at initialize, 10 frames at 200 fps end at least 50 ms later.
+        timer::steady_time_point start = timer::now();
+        timer t;
+        t.initialize(make_timer_config(0, 1, 200, "sleep"));
+
+        for (std::size_t i = 0; i < 10; ++i)
+            t.pace();
+        CHECK(timer::now() - start >= 50ms);
+    }
+
+    SECTION("late frame")
+    {
+        timer t;
+        t.initialize(make_timer_config(0, 1, 200, "sleep"));
+
+        // A frame that misses its deadline restarts pacing instead of skipping the next sleeps.
+        timer::sleep(20ms);
+        t.pace();
+
+        timer::steady_time_point start = timer::now();
+        t.pace();
+        CHECK(timer::now() - start >= 4ms);
+    }
+
+#if defined(__linux__)
+    SECTION("timerfd pacer")
+    {
+        timer::steady_time_point start = timer::now();
+        timer t;
+        t.initialize(make_timer_config(0, 1, 200, "timerfd"));
+
+        for (std::size_t i = 0; i < 10; ++i)
+            t.pace();
+        CHECK(timer::now() - start >= 50ms);
+    }
+#endif
+}
+} // namespace ash::test
@@ -0,0 +1,238 @@
+#include "core/context.hpp"
+#include "core/event.hpp"
+#include "core/relation.hpp"
+#include "core/timer.hpp"
+#include "graphics/blinn_phong_pipeline.hpp"
+#include "graphics/camera.hpp"
+#include "graphics/geometry.hpp"
+#include "graphics/graphics.hpp"
+#include "graphics/light.hpp"
+#include "graphics/rhi.hpp"
+#include "scene/scene.hpp"
+#include "task/task_manager.hpp"
+#include <catch2/catch.hpp>
+
+using namespace ash::graphics;
+
+namespace ash::test
+{
+namespace
+{
+// Renders through ash-graphics-null, which needs no window and only validates and counts the
+// commands, see test-graphics/config.
+class headless_scene
+{
+public:
+    headless_scene()
+    {
+        core::context::initialize("test-graphics/config");
+        core::context::install<task::task_manager>();
+        core::context::install<ecs::world>();
+        core::context::install<core::event>();
+        core::context::install<core::timer>();
+        core::context::install<core::relation>();
+        core::context::install<scene::scene>();
+        core::context::install<graphics::graphics>();
+
+        m_box = geometry::box(1.0f, 1.0f, 1.0f);
+        m_position_buffer = rhi::make_vertex_buffer(m_box.position.data(), m_box.position.size());
+        m_normal_buffer = rhi::make_vertex_buffer(m_box.normal.data(), m_box.normal.size());
+        m_index_buffer = rhi::make_index_buffer(m_box.indices.data(), m_box.indices.size());
+        m_pipeline = std::make_unique<blinn_phong_pipeline>();
+
+        auto& world = system<ecs::world>();
+        auto& scene = system<scene::scene>();
+        auto& relation = system<core::relation>();
+
+        m_light = world.create();
+        world.add<scene::transform, core::link, directional_light>(m_light);
+        relation.link(m_light, scene.root());
+
+        render_target_info render_target_info = {};
+        render_target_info.width = 800;
+        render_target_info.height = 600;
+        render_target_info.format = rhi::back_buffer_format();
+        render_target_info.samples = 4;
+        m_render_target = rhi::make_render_target(render_target_info);
+
+        depth_stencil_buffer_info depth_stencil_buffer_info = {};
+        depth_stencil_buffer_info.width = 800;
+        depth_stencil_buffer_info.height = 600;
+        depth_stencil_buffer_info.format = RESOURCE_FORMAT_D24_UNORM_S8_UINT;
+        depth_stencil_buffer_info.samples = 4;
+        m_depth_stencil_buffer = rhi::make_depth_stencil_buffer(depth_stencil_buffer_info);
+
+        m_camera = world.create();
+        world.add<core::link, camera, scene::transform>(m_camera);
+        auto& camera = world.component<graphics::camera>(m_camera);
+        camera.field_of_view(math::to_radians(30.0f));
+        camera.clipping_planes(0.01f, 1000.0f);
+        camera.render_target(m_render_target.get());
+        camera.depth_stencil_buffer(m_depth_stencil_buffer.get());
+        world.component<scene::transform>(m_camera).position(math::float3{0.0f, 0.0f, -40.0f});
+        relation.link(m_camera, scene.root());
+
+        system<graphics::graphics>().game_camera(m_camera);
+        system<task::task_manager>().run();
+    }
+
+    ~headless_scene()
+    {
+        system<task::task_manager>().stop();
+
+        auto& world = system<ecs::world>();
+        for (ecs::entity cube : m_cubes)
+            world.release(cube);
+        world.release(m_camera);
+        world.release(m_light);
+
+        m_materials.clear();
+        m_pipeline = nullptr;
+        m_render_target = nullptr;
+        m_depth_stencil_buffer = nullptr;
+        m_position_buffer = nullptr;
+        m_normal_buffer = nullptr;
+        m_index_buffer = nullptr;
+
+        core::context::shutdown();
+    }
+
+    blinn_phong_material_pipeline_parameter* add_material()
+    {
+        return m_materials.emplace_back(std::make_unique<blinn_phong_material_pipeline_parameter>())
+            .get();
+    }
+
+    ecs::entity add_cube(
+        const math::float3& position,
+        blinn_phong_material_pipeline_parameter* material_parameter)
+    {
+        auto& world = system<ecs::world>();
+
+        ecs::entity cube = world.create();
+        world.add<scene::transform, scene::bounding_box, mesh_render, core::link>(cube);
+
+        auto& mesh = world.component<mesh_render>(cube);
+        mesh.vertex_buffers = {m_position_buffer.get(), m_normal_buffer.get()};
+        mesh.index_buffer = m_index_buffer.get();
+
+        material material = {};
+        material.pipeline = m_pipeline.get();
+        material.parameters = {material_parameter->interface()};
+        mesh.materials.push_back(material);
+        mesh.submeshes.push_back(submesh{0, m_box.indices.size(), 0});
+
+        auto& transform = world.component<scene::transform>(cube);
+        transform.position(position);
+        world.component<scene::bounding_box>(cube).aabb(
+            m_box.position,
+            transform.to_world(),
+            true);
+
+        system<core::relation>().link(cube, system<scene::scene>().root());
+        system<scene::scene>().sync_local();
+
+        m_cubes.push_back(cube);
+        return cube;
+    }
+
+    void look_at_cubes(bool look)
+    {
+        auto& transform = system<ecs::world>().component<scene::transform>(m_camera);
+        transform.rotation_euler(math::float3{0.0f, look ? 0.0f : math::PI, 0.0f});
+        system<scene::scene>().sync_local();
+    }
+
+    // Runs the frame graph once and returns what the backend counted for it.
+    render_statistics render_frame()
+    {
+        auto& task = system<task::task_manager>();
+
+        core::context::begin_frame();
+        task.execute(task.find(task::TASK_ROOT));
+        core::context::end_frame();
+
+        return rhi::renderer().statistics();
+    }
+
+private:
+    geometry_data m_box;
+    std::unique_ptr<resource_interface> m_position_buffer;
+    std::unique_ptr<resource_interface> m_normal_buffer;
+    std::unique_ptr<resource_interface> m_index_buffer;
+
+    std::unique_ptr<blinn_phong_pipeline> m_pipeline;
+    std::vector<std::unique_ptr<blinn_phong_material_pipeline_parameter>> m_materials;
+
+    std::unique_ptr<resource_interface> m_render_target;
+    std::unique_ptr<resource_interface> m_depth_stencil_buffer;
+
+    ecs::entity m_camera;
+    ecs::entity m_light;
+    std::vector<ecs::entity> m_cubes;
+};
+} // namespace
+
+TEST_CASE("graphics headless", "[graphics]")
+{
+    // The context is shut down at the end, every check runs on the same scene.
+    headless_scene scene;
+
+    // 10 x 10 cubes in front of the camera, in two materials.
+    blinn_phong_material_pipeline_parameter* materials[] = {
+        scene.add_material(),
+        scene.add_material()};
+    for (int i = 0; i < 100; ++i)
+    {
+        float x = static_cast<float>(i % 10) * 2.0f - 9.0f;
+        float y = static_cast<float>(i / 10) * 2.0f - 9.0f;
+        scene.add_cube(math::float3{x, y, 0.0f}, materials[i % 2]);
+    }
+
+    // One instanced draw per material and the sky.
+    render_statistics statistics = scene.render_frame();
+    CHECK(statistics.error_count == 0);
+    CHECK(statistics.draw_count == 3);
+    CHECK(statistics.instance_count == 101);
+    CHECK(statistics.parameter_bind_count == 9);
+    CHECK(statistics.upload_size > 100 * sizeof(math::float4x4));
+
+    // Nothing moved, only the per frame data is uploaded again.
+    statistics = scene.render_frame();
+    CHECK(statistics.error_count == 0);
+    CHECK(statistics.draw_count == 3);
+    CHECK(statistics.instance_count == 101);
+    CHECK(statistics.upload_size < 100 * sizeof(math::float4x4));
+    std::size_t static_upload_size = statistics.upload_size;
+
+    // Every cube is culled, only the sky is left.
+    scene.look_at_cubes(false);
+    statistics = scene.render_frame();
+    CHECK(statistics.error_count == 0);
+    CHECK(statistics.draw_count == 1);
+    CHECK(statistics.instance_count == 1);
+
+    scene.look_at_cubes(true);
+    statistics = scene.render_frame();
+    CHECK(statistics.error_count == 0);
+    CHECK(statistics.draw_count == 3);
+    CHECK(statistics.instance_count == 101);
+    CHECK(statistics.upload_size == static_upload_size);
+
+    // A material per cube, the queue is recorded in slices on the workers. The null backend
+    // reports an error when a frame allocates more commands than the render concurrency of 3.
+    for (int i = 0; i < 1100; ++i)
+    {
+        float x = static_cast<float>(i % 10) * 2.0f - 9.0f;
+        float y = static_cast<float>(i / 10 % 10) * 2.0f - 9.0f;
+        float z = static_cast<float>(i / 100) * 2.0f + 2.0f;
+        scene.add_cube(math::float3{x, y, z}, scene.add_material());
+    }
+
+    statistics = scene.render_frame();
+    CHECK(statistics.error_count == 0);
+    CHECK(statistics.command_count == 3);
+    CHECK(statistics.draw_count == 1103);
+    CHECK(statistics.instance_count == 1201);
+}
+} // namespace ash::test
\ No newline at end of file
@@ -0,0 +1,355 @@
+#include "graphics/render_queue.hpp"
+#include <algorithm>
+#include <bit>
+#include <catch2/catch.hpp>
+#include <numeric>
+#include <random>
+
+using namespace ash::graphics;
+
+namespace ash::test
+{
+namespace
+{
+class test_pipeline : public render_pipeline
+{
+public:
+    using render_pipeline::render_pipeline;
+
+    virtual void render(const render_scene&, render_command_interface*) override {}
+};
+
+// The queue only compares the handles, they are never dereferenced.
+template <typename T>
+T* handle(std::uintptr_t value)
+{
+    return reinterpret_cast<T*>(value * 16);
+}
+
+struct test_state
+{
+    test_state()
+    {
+        vertex_buffers[0][0] = handle<resource_interface>(1);
+        vertex_buffers[1][0] = handle<resource_interface>(2);
+
+        // The first parameter is the object, the last one the material.
+        for (std::size_t i = 0; i < 2; ++i)
+        {
+            materials[i][0] = handle<pipeline_parameter_interface>(100);
+            materials[i][1] = handle<pipeline_parameter_interface>(200 + i);
+        }
+    }
+
+    render_unit unit(
+        std::size_t material,
+        std::size_t vertex_buffer,
+        std::size_t index_start,
+        std::size_t index_end)
+    {
+        render_unit result = {};
+        result.vertex_buffers = vertex_buffers[vertex_buffer];
+        result.index_buffer = handle<resource_interface>(3);
+        result.index_start = index_start;
+        result.index_end = index_end;
+        result.parameters = materials[material];
+        return result;
+    }
+
+    resource_interface* vertex_buffers[2][1];
+    pipeline_parameter_interface* materials[2][2];
+};
+
+std::vector<std::size_t> index_starts(const render_queue& queue)
+{
+    std::vector<std::size_t> result;
+    queue.each([&](render_pipeline*, std::span<const render_unit> units) {
+        for (const render_unit& unit : units)
+            result.push_back(unit.index_start);
+    });
+    return result;
+}
+
+std::vector<std::size_t> expected(std::initializer_list<std::size_t> list)
+{
+    return std::vector<std::size_t>(list);
+}
+} // namespace
+
+TEST_CASE("render queue key layout", "[render queue]")
+{
+    test_state state;
+    render_queue queue;
+
+    // Material 1 is used first, so it gets the smaller id.
+    auto add_units = [&](render_pipeline& pipeline) {
+        queue.clear();
+        queue.add(&pipeline, state.unit(1, 0, 0, 3), 2, 1.0f, 0);
+        queue.add(&pipeline, state.unit(0, 1, 10, 13), 2, 5.0f, 1);
+        queue.add(&pipeline, state.unit(0, 0, 20, 23), 2, 2.0f, 2);
+        queue.sort();
+    };
+
+    SECTION("front to back")
+    {
+        test_pipeline pipeline(RENDER_ORDER_FRONT_TO_BACK);
+        add_units(pipeline);
+        CHECK(index_starts(queue) == expected({0, 20, 10}));
+    }
+
+    SECTION("back to front")
+    {
+        test_pipeline pipeline(RENDER_ORDER_BACK_TO_FRONT);
+        add_units(pipeline);
+        CHECK(index_starts(queue) == expected({10, 20, 0}));
+    }
+
+    SECTION("submission")
+    {
+        test_pipeline pipeline(RENDER_ORDER_SUBMISSION);
+        add_units(pipeline);
+        CHECK(index_starts(queue) == expected({0, 10, 20}));
+    }
+
+    SECTION("front to back instancing")
+    {
+        // Vertex buffer before depth.
+        test_pipeline pipeline(RENDER_ORDER_FRONT_TO_BACK, true);
+        queue.add(&pipeline, state.unit(0, 0, 0, 3), 2, 1.0f, 0);
+        queue.add(&pipeline, state.unit(0, 1, 10, 13), 2, 2.0f, 1);
+        queue.add(&pipeline, state.unit(0, 0, 20, 23), 2, 3.0f, 2);
+        queue.sort();
+        CHECK(index_starts(queue) == expected({0, 20, 10}));
+    }
+}
+
+TEST_CASE("render queue pipelines", "[render queue]")
+{
+    test_state state;
+    test_pipeline pipeline_a;
+    test_pipeline pipeline_b;
+
+    render_queue queue;
+    queue.add(&pipeline_b, state.unit(0, 0, 0, 3), 2, 1.0f, 0);
+    queue.add(&pipeline_a, state.unit(0, 0, 10, 13), 2, 1.0f, 1);
+    queue.add(&pipeline_b, state.unit(0, 0, 20, 23), 2, 1.0f, 2);
+    queue.sort();
+
+    CHECK(queue.size() == 3);
+    CHECK(queue.sorted_size() == 3);
+
+    std::vector<std::pair<render_pipeline*, std::size_t>> batches;
+    queue.each([&](render_pipeline* pipeline, std::span<const render_unit> units) {
+        batches.emplace_back(pipeline, units.size());
+    });
+    CHECK(batches == decltype(batches){{&pipeline_b, 2}, {&pipeline_a, 1}});
+
+    batches.clear();
+    queue.each(1, 3, [&](render_pipeline* pipeline, std::span<const render_unit> units) {
+        batches.emplace_back(pipeline, units.size());
+        CHECK(units[0].index_start == (pipeline == &pipeline_b ? 20 : 10));
+    });
+    CHECK(batches == decltype(batches){{&pipeline_b, 1}, {&pipeline_a, 1}});
+
+    queue.clear();
+    queue.sort();
+    CHECK(queue.size() == 0);
+    CHECK(queue.sorted_size() == 0);
+    CHECK(index_starts(queue).empty());
+}
+
+TEST_CASE("render queue radix sort", "[render queue]")
+{
+    test_state state;
+    test_pipeline pipeline;
+    render_queue queue;
+
+    SECTION("equal keys")
+    {
+        // Every pass is skipped, the units stay in submission order.
+        for (std::size_t i = 0; i < 100; ++i)
+            queue.add(&pipeline, state.unit(0, 0, i * 10, i * 10 + 1), 2, 1.0f, 0);
+        queue.sort();
+
+        std::vector<std::size_t> starts = index_starts(queue);
+        REQUIRE(starts.size() == 100);
+        CHECK(std::is_sorted(starts.begin(), starts.end()));
+    }
+
+    SECTION("random depth")
+    {
+        // Only the depth digits differ, the pipeline, material and vertex buffer passes are
+        // skipped.
+        std::mt19937 engine(7);
+        std::uniform_real_distribution<float> distribution(0.0f, 1000.0f);
+
+        std::vector<float> depths(4000);
+        for (float& depth : depths)
+            depth = distribution(engine);
+
+        // Repeated depths keep their submission order.
+        for (std::size_t i = 0; i < depths.size(); i += 5)
+            depths[i] = 100.0f;
+
+        for (std::size_t i = 0; i < depths.size(); ++i)
+        {
+            queue.add(
+                &pipeline,
+                state.unit(0, 0, i * 10, i * 10 + 1),
+                2,
+                depths[i],
+                static_cast<std::uint32_t>(i));
+        }
+        queue.sort();
+
+        // The key keeps the top 24 bits of the depth.
+        std::vector<std::size_t> order(depths.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+            return (std::bit_cast<std::uint32_t>(depths[a]) >> 7) <
+                   (std::bit_cast<std::uint32_t>(depths[b]) >> 7);
+        });
+
+        std::vector<std::size_t> starts = index_starts(queue);
+        REQUIRE(starts.size() == order.size());
+        for (std::size_t i = 0; i < order.size(); ++i)
+            REQUIRE(starts[i] == order[i] * 10);
+    }
+}
+
+TEST_CASE("render queue merge", "[render queue]")
+{
+    test_state state;
+    test_pipeline pipeline;
+    render_queue queue;
+
+    SECTION("adjacent ranges")
+    {
+        queue.add(&pipeline, state.unit(0, 0, 0, 3), 2, 1.0f, 7);
+        queue.add(&pipeline, state.unit(0, 0, 3, 6), 2, 1.0f, 7);
+        queue.add(&pipeline, state.unit(0, 0, 6, 9), 2, 1.0f, 7);
+        queue.sort();
+
+        REQUIRE(queue.sorted_size() == 1);
+        queue.each([](render_pipeline*, std::span<const render_unit> units) {
+            CHECK(units[0].index_start == 0);
+            CHECK(units[0].index_end == 9);
+            CHECK(units[0].instance_count == 1);
+        });
+        CHECK(queue.instances().size() == 1);
+    }
+
+    SECTION("different object")
+    {
+        queue.add(&pipeline, state.unit(0, 0, 0, 3), 2, 1.0f, 7);
+        queue.add(&pipeline, state.unit(0, 0, 3, 6), 2, 1.0f, 8);
+        queue.sort();
+        CHECK(queue.sorted_size() == 2);
+    }
+
+    SECTION("different scissor")
+    {
+        render_unit unit = state.unit(0, 0, 3, 6);
+        unit.scissor.max_x = 10;
+
+        queue.add(&pipeline, state.unit(0, 0, 0, 3), 2, 1.0f, 7);
+        queue.add(&pipeline, unit, 2, 1.0f, 7);
+        queue.sort();
+        CHECK(queue.sorted_size() == 2);
+    }
+
+    SECTION("not in key order")
+    {
+        queue.add(&pipeline, state.unit(0, 0, 3, 6), 2, 1.0f, 7);
+        queue.add(&pipeline, state.unit(0, 0, 0, 3), 2, 1.0f, 7);
+        queue.sort();
+        CHECK(queue.sorted_size() == 2);
+    }
+}
+
+TEST_CASE("render queue instancing", "[render queue]")
+{
+    test_state state;
+    render_queue queue;
+
+    auto add_units = [&](render_pipeline& pipeline) {
+        queue.add(&pipeline, state.unit(0, 0, 0, 6), 2, 3.0f, 4);
+        queue.add(&pipeline, state.unit(0, 0, 0, 6), 2, 1.0f, 5);
+        queue.add(&pipeline, state.unit(0, 0, 0, 6), 2, 2.0f, 6);
+        queue.add(&pipeline, state.unit(0, 1, 6, 12), 2, 1.5f, 7);
+        queue.sort();
+    };
+
+    auto instances = [&]() {
+        return std::vector<std::uint32_t>(queue.instances().begin(), queue.instances().end());
+    };
+
+    SECTION("instancing")
+    {
+        test_pipeline pipeline(RENDER_ORDER_FRONT_TO_BACK, true);
+        add_units(pipeline);
+
+        REQUIRE(queue.sorted_size() == 2);
+        CHECK(instances() == std::vector<std::uint32_t>{5, 6, 4, 7});
+
+        queue.each([](render_pipeline*, std::span<const render_unit> units) {
+            CHECK(units[0].index_start == 0);
+            CHECK(units[0].instance_start == 0);
+            CHECK(units[0].instance_count == 3);
+            CHECK(units[1].index_start == 6);
+            CHECK(units[1].instance_start == 3);
+            CHECK(units[1].instance_count == 1);
+        });
+    }
+
+    SECTION("submeshes")
+    {
+        // Two submeshes of one mesh with the same material, the ranges are not adjacent so the
+        // units of an object are not merged. Their depths interleave.
+        test_pipeline pipeline(RENDER_ORDER_FRONT_TO_BACK, true);
+        constexpr std::uint32_t count = 10;
+        for (std::uint32_t i = 0; i < count; ++i)
+        {
+            queue.add(&pipeline, state.unit(0, 0, 0, 6), 2, static_cast<float>(i), i);
+            queue.add(&pipeline, state.unit(0, 0, 12, 18), 2, static_cast<float>(i), i);
+        }
+        queue.sort();
+
+        REQUIRE(queue.sorted_size() == 2);
+        queue.each([&](render_pipeline*, std::span<const render_unit> units) {
+            CHECK(units[0].index_start == 0);
+            CHECK(units[0].instance_start == 0);
+            CHECK(units[0].instance_count == count);
+            CHECK(units[1].index_start == 12);
+            CHECK(units[1].instance_start == count);
+            CHECK(units[1].instance_count == count);
+        });
+
+        // Each submesh keeps its instances front to back.
+        std::vector<std::uint32_t> expected_instances;
+        for (std::size_t i = 0; i < 2; ++i)
+        {
+            for (std::uint32_t j = 0; j < count; ++j)
+                expected_instances.push_back(j);
+        }
+        CHECK(instances() == expected_instances);
+    }
+
+    SECTION("no instancing")
+    {
+        test_pipeline pipeline(RENDER_ORDER_FRONT_TO_BACK);
+        add_units(pipeline);
+
+        REQUIRE(queue.sorted_size() == 4);
+        CHECK(instances() == std::vector<std::uint32_t>{5, 7, 6, 4});
+
+        queue.each([](render_pipeline*, std::span<const render_unit> units) {
+            for (std::size_t i = 0; i < units.size(); ++i)
+            {
+                CHECK(units[i].instance_start == i);
+                CHECK(units[i].instance_count == 1);
+            }
+        });
+    }
+}
+} // namespace ash::test
\ No newline at end of file
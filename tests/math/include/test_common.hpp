@@ -1,5 +1,7 @@
 #pragma once
 
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
 #include "math/math.hpp"
 #include <catch2/catch.hpp>
 
@@ -0,0 +1,534 @@
+#include "test_common.hpp"
+#include <cfloat>
+#include <vector>
+
+using namespace ash::math;
+
+namespace ash::test
+{
+namespace
+{
+// Odd count, so that every level runs both full groups and the padded remainder.
+constexpr std::size_t BATCH_COUNT = 37;
+
+float value(std::size_t i, std::size_t c)
+{
+    return static_cast<float>((i * 7 + c * 13) % 17) * 0.25f - 2.0f;
+}
+
+float4 quaternion_value(std::size_t i, float angle)
+{
+    float4 axis = vector::normalize(float4{value(i, 0), value(i, 1) + 0.5f, value(i, 2), 0.0f});
+    return quaternion::rotation_axis(axis, angle);
+}
+
+template <std::size_t C>
+std::vector<float> to_soa(const std::vector<packed<float, C>>& v)
+{
+    std::vector<float> result(v.size() * C);
+    for (std::size_t i = 0; i < v.size(); ++i)
+    {
+        for (std::size_t c = 0; c < C; ++c)
+            result[c * v.size() + i] = v[i][c];
+    }
+    return result;
+}
+
+std::vector<float> to_soa(const std::vector<float4x4>& v)
+{
+    std::vector<float> result(v.size() * 16);
+    for (std::size_t i = 0; i < v.size(); ++i)
+    {
+        for (std::size_t c = 0; c < 16; ++c)
+            result[c * v.size() + i] = v[i][c / 4][c % 4];
+    }
+    return result;
+}
+
+bool equal_batch(const std::vector<float>& a, const std::vector<float>& b, float margin)
+{
+    for (std::size_t i = 0; i < a.size(); ++i)
+    {
+        if (Approx(a[i]).margin(margin) != b[i])
+            return false;
+    }
+    return true;
+}
+
+// 0 outside, 1 intersecting, 2 inside.
+int frustum_test(const float4* frustum, const float3& min, const float3& max)
+{
+    int result = 2;
+    for (std::size_t i = 0; i < 6; ++i)
+    {
+        float far_distance = frustum[i][3];
+        float near_distance = frustum[i][3];
+        for (std::size_t c = 0; c < 3; ++c)
+        {
+            far_distance += frustum[i][c] * (frustum[i][c] < 0.0f ? min[c] : max[c]);
+            near_distance += frustum[i][c] * (frustum[i][c] < 0.0f ? max[c] : min[c]);
+        }
+
+        if (far_distance < 0.0f)
+            return 0;
+        else if (near_distance < 0.0f)
+            result = 1;
+    }
+    return result;
+}
+
+void frustum_planes(float4 (&frustum)[6])
+{
+    frustum[0] = {1.0f, 0.2f, 0.0f, 4.1f};
+    frustum[1] = {-1.0f, 0.1f, 0.0f, 4.3f};
+    frustum[2] = {0.1f, 1.0f, 0.0f, 3.1f};
+    frustum[3] = {0.0f, -1.0f, -0.3f, 3.3f};
+    frustum[4] = {0.0f, 0.0f, 1.0f, 2.1f};
+    frustum[5] = {0.2f, 0.0f, -1.0f, 5.9f};
+}
+
+bool bit(const std::vector<std::uint32_t>& bits, std::size_t i)
+{
+    return (bits[i / 32] >> (i % 32)) & 1;
+}
+
+template <typename Functor>
+void each_level(Functor&& functor)
+{
+    simd_level detected = simd_dispatch::detect();
+    for (simd_level level : {simd_level::SSE, simd_level::AVX2, simd_level::AVX512})
+    {
+        if (level > detected)
+            break;
+
+        simd_dispatch::level(level);
+        functor();
+    }
+    simd_dispatch::level(detected);
+}
+} // namespace
+
+TEST_CASE("matrix_batch::mul", "[batch]")
+{
+    std::vector<float4x4> a(BATCH_COUNT);
+    std::vector<float4x4> b(BATCH_COUNT);
+    std::vector<float4x4> expected(BATCH_COUNT);
+    for (std::size_t i = 0; i < BATCH_COUNT; ++i)
+    {
+        for (std::size_t c = 0; c < 16; ++c)
+        {
+            a[i][c / 4][c % 4] = value(i, c);
+            b[i][c / 4][c % 4] = value(i + 3, c);
+        }
+        expected[i] = matrix::mul(a[i], b[i]);
+    }
+
+    std::vector<float> soa_a = to_soa(a);
+    std::vector<float> soa_b = to_soa(b);
+    std::vector<float> soa_expected = to_soa(expected);
+
+    each_level([&]() {
+        std::vector<float> result(BATCH_COUNT * 16);
+        matrix_batch::mul(soa_a.data(), soa_b.data(), result.data(), BATCH_COUNT);
+        CHECK(equal_batch(result, soa_expected, 1e-5f));
+
+        // In place.
+        result = soa_a;
+        matrix_batch::mul(result.data(), soa_b.data(), result.data(), BATCH_COUNT);
+        CHECK(equal_batch(result, soa_expected, 1e-5f));
+    });
+}
+
+TEST_CASE("matrix_batch::inverse", "[batch]")
+{
+    std::vector<float4x4> m(BATCH_COUNT);
+    std::vector<float4x4> expected(BATCH_COUNT);
+    for (std::size_t i = 0; i < BATCH_COUNT; ++i)
+    {
+        for (std::size_t c = 0; c < 16; ++c)
+            m[i][c / 4][c % 4] = value(i, c) + (c % 5 == 0 ? 4.0f : 0.0f);
+        expected[i] = matrix::inverse(m[i]);
+    }
+
+    std::vector<float> soa_m = to_soa(m);
+    std::vector<float> soa_expected = to_soa(expected);
+
+    each_level([&]() {
+        std::vector<float> result = soa_m;
+        matrix_batch::inverse(result.data(), result.data(), BATCH_COUNT);
+        CHECK(equal_batch(result, soa_expected, 1e-5f));
+    });
+}
+
+TEST_CASE("matrix_batch::affine_transform", "[batch]")
+{
+    std::vector<float3> scale(BATCH_COUNT);
+    std::vector<float4> rotation(BATCH_COUNT);
+    std::vector<float3> translation(BATCH_COUNT);
+    std::vector<float4x4> expected(BATCH_COUNT);
+    for (std::size_t i = 0; i < BATCH_COUNT; ++i)
+    {
+        scale[i] = {value(i, 0) + 3.0f, value(i, 1) + 3.0f, value(i, 2) + 3.0f};
+        rotation[i] = quaternion_value(i, 0.1f * i);
+        translation[i] = {value(i, 3), value(i, 4), value(i, 5)};
+        expected[i] = matrix::affine_transform(scale[i], rotation[i], translation[i]);
+    }
+
+    std::vector<float> soa_scale = to_soa(scale);
+    std::vector<float> soa_rotation = to_soa(rotation);
+    std::vector<float> soa_translation = to_soa(translation);
+    std::vector<float> soa_expected = to_soa(expected);
+
+    each_level([&]() {
+        std::vector<float> result(BATCH_COUNT * 16);
+        matrix_batch::affine_transform(
+            soa_scale.data(),
+            soa_rotation.data(),
+            soa_translation.data(),
+            result.data(),
+            BATCH_COUNT);
+        CHECK(equal_batch(result, soa_expected, 1e-5f));
+    });
+}
+
+TEST_CASE("quaternion_batch::slerp", "[batch]")
+{
+    std::vector<float4> a(BATCH_COUNT);
+    std::vector<float4> b(BATCH_COUNT);
+    std::vector<float> t(BATCH_COUNT);
+    std::vector<float4> expected(BATCH_COUNT);
+    for (std::size_t i = 0; i < BATCH_COUNT; ++i)
+    {
+        a[i] = quaternion_value(i, 0.3f);
+        // Covers opposite hemispheres and nearly parallel quaternions.
+        b[i] = quaternion_value(i + 1, i % 5 == 0 ? 0.30001f : 0.17f * i);
+        if (i % 3 == 0)
+            b[i] = vector::mul(b[i], -1.0f);
+        t[i] = static_cast<float>(i) / (BATCH_COUNT - 1);
+        expected[i] = quaternion::slerp(a[i], b[i], t[i]);
+    }
+
+    std::vector<float> soa_a = to_soa(a);
+    std::vector<float> soa_b = to_soa(b);
+    std::vector<float> soa_expected = to_soa(expected);
+
+    each_level([&]() {
+        std::vector<float> result(BATCH_COUNT * 4);
+        quaternion_batch::slerp(soa_a.data(), soa_b.data(), t.data(), result.data(), BATCH_COUNT);
+        CHECK(equal_batch(result, soa_expected, 1e-5f));
+    });
+}
+
+TEST_CASE("bounding_box_batch::transform", "[batch]")
+{
+    std::vector<float3> min(BATCH_COUNT);
+    std::vector<float3> max(BATCH_COUNT);
+    std::vector<float4x4> m(BATCH_COUNT);
+    std::vector<float3> expected_min(BATCH_COUNT);
+    std::vector<float3> expected_max(BATCH_COUNT);
+    for (std::size_t i = 0; i < BATCH_COUNT; ++i)
+    {
+        min[i] = {value(i, 0) - 2.0f, value(i, 1) - 2.0f, value(i, 2) - 2.0f};
+        max[i] = {value(i, 3) + 2.0f, value(i, 4) + 2.0f, value(i, 5) + 2.0f};
+        m[i] = matrix::affine_transform(
+            float3{1.0f, 2.0f, 0.5f},
+            quaternion_value(i, 0.2f * i),
+            float3{value(i, 6), value(i, 7), value(i, 8)});
+
+        // Transform the 8 corners.
+        expected_min[i] = float3{FLT_MAX, FLT_MAX, FLT_MAX};
+        expected_max[i] = float3{-FLT_MAX, -FLT_MAX, -FLT_MAX};
+        for (std::size_t corner = 0; corner < 8; ++corner)
+        {
+            float4 p = {
+                (corner & 1) ? max[i][0] : min[i][0],
+                (corner & 2) ? max[i][1] : min[i][1],
+                (corner & 4) ? max[i][2] : min[i][2],
+                1.0f};
+            p = matrix::mul(p, m[i]);
+            for (std::size_t c = 0; c < 3; ++c)
+            {
+                expected_min[i][c] = std::min(expected_min[i][c], p[c]);
+                expected_max[i][c] = std::max(expected_max[i][c], p[c]);
+            }
+        }
+    }
+
+    std::vector<float> soa_min = to_soa(min);
+    std::vector<float> soa_max = to_soa(max);
+    std::vector<float> soa_m = to_soa(m);
+    std::vector<float> soa_expected_min = to_soa(expected_min);
+    std::vector<float> soa_expected_max = to_soa(expected_max);
+
+    each_level([&]() {
+        std::vector<float> result_min(BATCH_COUNT * 3);
+        std::vector<float> result_max(BATCH_COUNT * 3);
+        bounding_box_batch::transform(
+            soa_min.data(),
+            soa_max.data(),
+            soa_m.data(),
+            result_min.data(),
+            result_max.data(),
+            BATCH_COUNT);
+        CHECK(equal_batch(result_min, soa_expected_min, 1e-5f));
+        CHECK(equal_batch(result_max, soa_expected_max, 1e-5f));
+    });
+}
+
+TEST_CASE("bounding_box_batch::frustum_culling", "[batch]")
+{
+    // Cover more than one bitset word.
+    constexpr std::size_t COUNT = BATCH_COUNT * 2;
+
+    float4 frustum[6];
+    frustum_planes(frustum);
+
+    std::vector<float3> min(COUNT);
+    std::vector<float3> max(COUNT);
+    std::vector<int> expected(COUNT);
+    for (std::size_t i = 0; i < COUNT; ++i)
+    {
+        float3 center = {value(i, 0) * 2.0f, value(i, 1) * 2.0f, value(i, 2) * 2.0f};
+        float extent = 0.25f + static_cast<float>(i % 3) * 0.5f;
+        min[i] = {center[0] - extent, center[1] - extent, center[2] - extent};
+        max[i] = {center[0] + extent, center[1] + extent, center[2] + extent};
+        expected[i] = frustum_test(frustum, min[i], max[i]);
+    }
+
+    std::vector<float> soa_min = to_soa(min);
+    std::vector<float> soa_max = to_soa(max);
+
+    each_level([&]() {
+        std::vector<std::uint32_t> visible((COUNT + 31) / 32, 0xFFFFFFFF);
+        std::vector<std::uint32_t> inside((COUNT + 31) / 32, 0xFFFFFFFF);
+        bounding_box_batch::frustum_culling(
+            soa_min.data(),
+            soa_max.data(),
+            frustum,
+            visible.data(),
+            inside.data(),
+            COUNT);
+
+        std::size_t mismatch = 0;
+        for (std::size_t i = 0; i < visible.size() * 32; ++i)
+        {
+            int result = bit(visible, i) ? (bit(inside, i) ? 2 : 1) : 0;
+            if (result != (i < COUNT ? expected[i] : 0))
+                ++mismatch;
+        }
+        CHECK(mismatch == 0);
+    });
+}
+
+TEST_CASE("skin_batch::linear_blend", "[batch]")
+{
+    constexpr std::size_t BONE_COUNT = 5;
+
+    std::vector<float4x4> bones(BONE_COUNT);
+    for (std::size_t i = 0; i < BONE_COUNT; ++i)
+    {
+        bones[i] = matrix::affine_transform(
+            float3{1.0f, 1.5f, 0.5f},
+            quaternion_value(i, 0.4f * i),
+            float3{value(i, 0), value(i, 1), value(i, 2)});
+    }
+
+    std::vector<float3> position(BATCH_COUNT);
+    std::vector<float3> normal(BATCH_COUNT);
+    for (std::size_t i = 0; i < BATCH_COUNT; ++i)
+    {
+        position[i] = {value(i, 3), value(i, 4), value(i, 5)};
+        normal[i] = {value(i, 6), value(i, 7), value(i, 8)};
+    }
+    std::vector<float> soa_position = to_soa(position);
+    std::vector<float> soa_normal = to_soa(normal);
+
+    for (std::size_t influence_count : {1, 2, 4})
+    {
+        std::vector<float> index(BATCH_COUNT * influence_count);
+        std::vector<float> weight(BATCH_COUNT * influence_count);
+        std::vector<float3> expected_position(BATCH_COUNT);
+        std::vector<float3> expected_normal(BATCH_COUNT);
+        for (std::size_t i = 0; i < BATCH_COUNT; ++i)
+        {
+            float total = 0.0f;
+            for (std::size_t k = 0; k < influence_count; ++k)
+                total += 1.0f + static_cast<float>((i + k) % 3);
+
+            float4x4 m = {};
+            for (std::size_t k = 0; k < influence_count; ++k)
+            {
+                std::size_t bone = (i + k * 2) % BONE_COUNT;
+                float w = (1.0f + static_cast<float>((i + k) % 3)) / total;
+
+                index[k * BATCH_COUNT + i] = static_cast<float>(bone);
+                weight[k * BATCH_COUNT + i] = w;
+                for (std::size_t r = 0; r < 4; ++r)
+                    m[r] = vector::add(m[r], vector::mul(bones[bone][r], w));
+            }
+
+            float4 p = matrix::mul(float4{position[i][0], position[i][1], position[i][2], 1.0f}, m);
+            float4 n = matrix::mul(float4{normal[i][0], normal[i][1], normal[i][2], 0.0f}, m);
+            expected_position[i] = {p[0], p[1], p[2]};
+            expected_normal[i] = {n[0], n[1], n[2]};
+        }
+
+        std::vector<float> soa_expected_position = to_soa(expected_position);
+        std::vector<float> soa_expected_normal = to_soa(expected_normal);
+
+        each_level([&]() {
+            std::vector<float> result_position(BATCH_COUNT * 3);
+            std::vector<float> result_normal(BATCH_COUNT * 3);
+            skin_batch::linear_blend(
+                soa_position.data(),
+                soa_normal.data(),
+                index.data(),
+                weight.data(),
+                influence_count,
+                bones.data(),
+                result_position.data(),
+                result_normal.data(),
+                BATCH_COUNT);
+            CHECK(equal_batch(result_position, soa_expected_position, 1e-5f));
+            CHECK(equal_batch(result_normal, soa_expected_normal, 1e-5f));
+        });
+    }
+}
+
+TEST_CASE("skin_batch::spherical_deform", "[batch]")
+{
+    constexpr std::size_t BONE_COUNT = 5;
+
+    std::vector<float4x4> bones(BONE_COUNT);
+    std::vector<float4> rotations(BONE_COUNT);
+    for (std::size_t i = 0; i < BONE_COUNT; ++i)
+    {
+        rotations[i] = quaternion_value(i, 0.4f * i);
+        bones[i] = matrix::affine_transform(
+            float3{1.0f, 1.0f, 1.0f},
+            rotations[i],
+            float3{value(i, 0), value(i, 1), value(i, 2)});
+    }
+
+    std::vector<float3> position(BATCH_COUNT);
+    std::vector<float3> normal(BATCH_COUNT);
+    std::vector<float> index(BATCH_COUNT * 2);
+    std::vector<float> weight(BATCH_COUNT);
+    std::vector<float3> center(BATCH_COUNT);
+    std::vector<float3> r0(BATCH_COUNT);
+    std::vector<float3> r1(BATCH_COUNT);
+    std::vector<float3> expected_position(BATCH_COUNT);
+    std::vector<float3> expected_normal(BATCH_COUNT);
+    for (std::size_t i = 0; i < BATCH_COUNT; ++i)
+    {
+        position[i] = {value(i, 3), value(i, 4), value(i, 5)};
+        normal[i] = {value(i, 6), value(i, 7), value(i, 8)};
+        center[i] = {value(i, 9), value(i, 10), value(i, 11)};
+        r0[i] = {value(i, 12), value(i, 13), value(i, 14)};
+        r1[i] = {value(i, 15), value(i, 16), value(i, 17)};
+
+        std::size_t bone0 = i % BONE_COUNT;
+        std::size_t bone1 = (i + 2) % BONE_COUNT;
+        float w0 = static_cast<float>(i) / (BATCH_COUNT - 1);
+        index[i] = static_cast<float>(bone0);
+        index[BATCH_COUNT + i] = static_cast<float>(bone1);
+        weight[i] = w0;
+
+        float4 q = quaternion::slerp(rotations[bone0], rotations[bone1], 1.0f - w0);
+        float4x4 rotate = matrix::affine_transform(float3{1.0f, 1.0f, 1.0f}, q, float3{});
+
+        float4 d = vector::sub(
+            float4{position[i][0], position[i][1], position[i][2], 0.0f},
+            float4{center[i][0], center[i][1], center[i][2], 0.0f});
+        float4 p = matrix::mul(d, rotate);
+        float4 a = matrix::mul(float4{r0[i][0], r0[i][1], r0[i][2], 1.0f}, bones[bone0]);
+        float4 b = matrix::mul(float4{r1[i][0], r1[i][1], r1[i][2], 1.0f}, bones[bone1]);
+        p = vector::add(p, vector::add(vector::mul(a, w0), vector::mul(b, 1.0f - w0)));
+        float4 n = matrix::mul(float4{normal[i][0], normal[i][1], normal[i][2], 0.0f}, rotate);
+
+        expected_position[i] = {p[0], p[1], p[2]};
+        expected_normal[i] = {n[0], n[1], n[2]};
+    }
+
+    std::vector<float> soa_position = to_soa(position);
+    std::vector<float> soa_normal = to_soa(normal);
+    std::vector<float> soa_center = to_soa(center);
+    std::vector<float> soa_r0 = to_soa(r0);
+    std::vector<float> soa_r1 = to_soa(r1);
+    std::vector<float> soa_expected_position = to_soa(expected_position);
+    std::vector<float> soa_expected_normal = to_soa(expected_normal);
+
+    each_level([&]() {
+        std::vector<float> result_position(BATCH_COUNT * 3);
+        std::vector<float> result_normal(BATCH_COUNT * 3);
+        skin_batch::spherical_deform(
+            soa_position.data(),
+            soa_normal.data(),
+            index.data(),
+            weight.data(),
+            soa_center.data(),
+            soa_r0.data(),
+            soa_r1.data(),
+            bones.data(),
+            rotations.data(),
+            result_position.data(),
+            result_normal.data(),
+            BATCH_COUNT);
+        CHECK(equal_batch(result_position, soa_expected_position, 1e-4f));
+        CHECK(equal_batch(result_normal, soa_expected_normal, 1e-4f));
+    });
+}
+
+// Hidden by default, run with: test-math [benchmark]
+TEST_CASE("frustum culling benchmark", "[batch][.benchmark]")
+{
+    constexpr std::size_t COUNT = 1000000;
+
+    float4 frustum[6];
+    frustum_planes(frustum);
+
+    std::vector<float3> min(COUNT);
+    std::vector<float3> max(COUNT);
+    for (std::size_t i = 0; i < COUNT; ++i)
+    {
+        float3 center = {value(i, 0) * 3.0f, value(i, 1) * 3.0f, value(i, 2) * 3.0f};
+        min[i] = {center[0] - 0.5f, center[1] - 0.5f, center[2] - 0.5f};
+        max[i] = {center[0] + 0.5f, center[1] + 0.5f, center[2] + 0.5f};
+    }
+
+    std::vector<float> soa_min = to_soa(min);
+    std::vector<float> soa_max = to_soa(max);
+    std::vector<std::uint32_t> visible((COUNT + 31) / 32);
+
+    BENCHMARK("scalar")
+    {
+        std::size_t result = 0;
+        for (std::size_t i = 0; i < COUNT; ++i)
+            result += frustum_test(frustum, min[i], max[i]) != 0;
+        return result;
+    };
+
+    simd_level detected = simd_dispatch::detect();
+    for (simd_level level : {simd_level::SSE, simd_level::AVX2, simd_level::AVX512})
+    {
+        if (level > detected)
+            break;
+
+        simd_dispatch::level(level);
+
+        const char* names[] = {"batch SSE", "batch AVX2", "batch AVX512"};
+        BENCHMARK(names[static_cast<std::size_t>(level)])
+        {
+            bounding_box_batch::frustum_culling(
+                soa_min.data(),
+                soa_max.data(),
+                frustum,
+                visible.data(),
+                nullptr,
+                COUNT);
+            return visible[0];
+        };
+    }
+    simd_dispatch::level(detected);
+}
+} // namespace ash::test
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include "test_common.hpp"
+#include <cmath>
+#include <limits>
+
+using namespace ash::math;
+
+namespace ash::test
+{
+TEST_CASE("compress::to_half", "[compress]")
+{
+    CHECK(compress::to_half(0.0f).value == 0x0000);
+    CHECK(compress::to_half(-0.0f).value == 0x8000);
+    CHECK(compress::to_half(1.0f).value == 0x3C00);
+    CHECK(compress::to_half(-2.0f).value == 0xC000);
+    CHECK(compress::to_half(65504.0f).value == 0x7BFF);
+    CHECK(compress::to_half(1.0e6f).value == 0x7C00);
+    CHECK(compress::to_half(std::numeric_limits<float>::infinity()).value == 0x7C00);
+    CHECK((compress::to_half(std::numeric_limits<float>::quiet_NaN()).value & 0x7E00) == 0x7E00);
+
+    // Smallest subnormal.
+    CHECK(compress::to_half(5.96046448e-8f).value == 0x0001);
+
+    // Round to nearest even.
+    CHECK(compress::to_half(1.0f + 1.0f / 2048.0f).value == 0x3C00);
+    CHECK(compress::to_half(1.0f + 3.0f / 2048.0f).value == 0x3C02);
+}
+
+TEST_CASE("compress::to_float", "[compress]")
+{
+    // Every half survives the round trip.
+    std::uint32_t mismatch = 0;
+    for (std::uint32_t i = 0; i < 0x10000; ++i)
+    {
+        half h = {static_cast<std::uint16_t>(i)};
+        float f = compress::to_float(h);
+
+        if ((i & 0x7C00) == 0x7C00 && (i & 0x03FF) != 0)
+            mismatch += std::isnan(f) ? 0 : 1;
+        else
+            mismatch += compress::to_half(f).value == h.value ? 0 : 1;
+    }
+    CHECK(mismatch == 0);
+
+    CHECK(compress::to_float(half{0x3555}) == 0.333251953f);
+    CHECK(compress::to_float(half{0x0001}) == 5.96046448e-8f);
+}
+
+TEST_CASE("compress_simd::load half", "[compress][simd]")
+{
+    half4 h4 = compress::to_half(float4{1.0f, -2.5f, 0.333251953f, 65504.0f});
+    float4 r4;
+    simd::store(compress_simd::load(h4), r4);
+    CHECK(equal(r4, float4{1.0f, -2.5f, 0.333251953f, 65504.0f}));
+
+    half3 h3 = compress::to_half(float3{-0.125f, 3.0f, 5.96046448e-8f});
+    float4 r3;
+    simd::store(compress_simd::load(h3), r3);
+    CHECK(equal(r3, float4{-0.125f, 3.0f, 5.96046448e-8f, 0.0f}));
+
+    half4 source[3];
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        for (std::size_t j = 0; j < 4; ++j)
+            source[i][j] = {static_cast<std::uint16_t>(0x3C00 + i * 4 + j)};
+    }
+
+    float4 destination[3];
+    compress_simd::decompress(source, destination, 3);
+    for (std::size_t i = 0; i < 3; ++i)
+        CHECK(equal(destination[i], compress::to_float(source[i])));
+}
+
+TEST_CASE("compress::to_quaternion48", "[compress]")
+{
+    float4 axes[] = {
+        float4{1.0f,  0.0f,  0.0f,  0.0f},
+        float4{0.0f,  1.0f,  0.0f,  0.0f},
+        float4{0.0f,  0.0f,  1.0f,  0.0f},
+        float4{0.3f,  -0.5f, 0.2f,  0.0f},
+        float4{-0.7f, 0.1f,  -0.4f, 0.0f}
+    };
+
+    for (const float4& axis : axes)
+    {
+        for (float angle : {0.0f, 0.5f, 1.5f, 3.0f, -2.0f})
+        {
+            float4 q = quaternion::rotation_axis(vector::normalize(axis), angle);
+            quaternion48 packed = compress::to_quaternion48(q);
+
+            float4 scalar = compress::to_quaternion(packed);
+            float4 simd_result;
+            simd::store(compress_simd::load(packed), simd_result);
+
+            // q and -q are the same rotation.
+            float sign = vector::dot(scalar, q) < 0.0f ? -1.0f : 1.0f;
+            for (std::size_t i = 0; i < 4; ++i)
+            {
+                CHECK(std::abs(scalar[i] * sign - q[i]) < 5e-5f);
+                CHECK(std::abs(simd_result[i] - scalar[i]) < 1e-6f);
+            }
+        }
+    }
+}
+} // namespace ash::test
\ No newline at end of file
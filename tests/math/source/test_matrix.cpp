@@ -92,6 +92,45 @@ TEST_CASE("matrix::inverse", "[matrix]")
     }));
 }
 
+TEST_CASE("matrix::inverse general", "[matrix]")
+{
+    math::float4x4 m = {
+        math::float4{1.0f, 7.0f, 8.0f, 5.0f},
+        math::float4{6.0f, 5.0f, 4.0f, 4.0f},
+        math::float4{5.0f, 4.0f, 2.0f, 8.0f},
+        math::float4{1.0f, 6.0f, 4.0f, 9.0f}
+    };
+
+    CHECK(equal(
+        matrix::inverse(m),
+        math::float4x4{
+            math::float4{0.02f,         0.06f,         0.16f,         -0.18f},
+            math::float4{-0.533333333f, 0.733333333f,  -0.933333333f, 0.8f  },
+            math::float4{0.51f,         -0.47f,        0.58f,         -0.59f},
+            math::float4{0.126666667f,  -0.286666667f, 0.346666667f,  -0.14f}
+    }));
+}
+
+TEST_CASE("matrix::inverse_affine", "[matrix]")
+{
+    math::float4x4 m = matrix::affine_transform(
+        math::float3{0.5f, 0.2f, 0.3f},
+        math::float4{0.0661214888f, 0.132242978f, 0.198364466f, 0.968912423f},
+        math::float3{6.0f, 5.0f, 4.5f});
+
+    CHECK(equal(matrix::inverse_affine(m), matrix::inverse(m)));
+}
+
+TEST_CASE("matrix::inverse_rigid", "[matrix]")
+{
+    math::float4x4 m = matrix::affine_transform(
+        math::float3{1.0f, 1.0f, 1.0f},
+        math::float4{0.0661214888f, 0.132242978f, 0.198364466f, 0.968912423f},
+        math::float3{6.0f, 5.0f, 4.5f});
+
+    CHECK(equal(matrix::inverse_rigid(m), matrix::inverse(m)));
+}
+
 TEST_CASE("matrix::identity", "[matrix]")
 {
     math::float4x4 result = math::matrix::identity();
@@ -238,6 +277,27 @@ TEST_CASE("matrix::orthographic center", "[matrix]")
     }));
 }
 
+TEST_CASE("matrix constexpr", "[matrix]")
+{
+    constexpr math::float4x4 m = matrix::affine_transform(
+        math::float3{0.5f, 0.2f, 0.3f},
+        math::float4{0.0661214888f, 0.132242978f, 0.198364466f, 0.968912423f},
+        math::float3{6.0f, 5.0f, 4.5f});
+    constexpr math::float4x4 inverse = matrix::inverse(m);
+    constexpr math::float4x4 rotation = matrix::rotation_axis(math::float4{0.0f, 1.0f, 0.0f}, PI);
+    static_assert(matrix::determinant(matrix::identity()) == 1.0f);
+
+    constexpr math::float4 scale = [&]() {
+        math::float4 s = {}, r = {}, t = {};
+        matrix::decompose(m, s, r, t);
+        return s;
+    }();
+
+    CHECK(equal(inverse, matrix::inverse(math::float4x4(m))));
+    CHECK(equal(rotation, matrix::rotation_y_axis(PI)));
+    CHECK(equal(scale, math::float4{0.5f, 0.2f, 0.3f, 0.0f}));
+}
+
 TEST_CASE("matrix_simd::mul", "[matrix][simd]")
 {
     math::float4x4_simd a = math::simd::set(
@@ -361,6 +421,98 @@ TEST_CASE("matrix_simd::transpose", "[matrix][simd]")
     }));
 }
 
+TEST_CASE("matrix_simd::determinant", "[matrix][simd]")
+{
+    math::float4x4_simd m = math::simd::set(
+        1.0f,
+        7.0f,
+        8.0f,
+        5.0f,
+        6.0f,
+        5.0f,
+        4.0f,
+        4.0f,
+        5.0f,
+        4.0f,
+        2.0f,
+        8.0f,
+        1.0f,
+        6.0f,
+        4.0f,
+        9.0f);
+
+    CHECK(equal(math::matrix_simd::determinant(m), -300.0f));
+}
+
+TEST_CASE("matrix_simd::inverse", "[matrix][simd]")
+{
+    math::float4x4_simd m = math::simd::set(
+        1.0f,
+        7.0f,
+        8.0f,
+        5.0f,
+        6.0f,
+        5.0f,
+        4.0f,
+        4.0f,
+        5.0f,
+        4.0f,
+        2.0f,
+        8.0f,
+        1.0f,
+        6.0f,
+        4.0f,
+        9.0f);
+
+    math::float4x4 result;
+    math::simd::store(math::matrix_simd::inverse(m), result);
+
+    CHECK(equal(
+        result,
+        math::float4x4{
+            math::float4{0.02f,         0.06f,         0.16f,         -0.18f},
+            math::float4{-0.533333333f, 0.733333333f,  -0.933333333f, 0.8f  },
+            math::float4{0.51f,         -0.47f,        0.58f,         -0.59f},
+            math::float4{0.126666667f,  -0.286666667f, 0.346666667f,  -0.14f}
+    }));
+}
+
+TEST_CASE("matrix_simd::inverse_affine", "[matrix][simd]")
+{
+    math::float4_simd scale = math::simd::set(0.5f, 0.2f, 0.3f, 0.0f);
+    math::float4_simd rotation =
+        math::simd::set(0.0661214888f, 0.132242978f, 0.198364466f, 0.968912423f);
+    math::float4_simd translation = math::simd::set(6.0f, 5.0f, 4.5f, 0.0f);
+    math::float4x4_simd m = math::matrix_simd::affine_transform(scale, rotation, translation);
+
+    math::float4x4 result;
+    math::simd::store(math::matrix_simd::inverse_affine(m), result);
+
+    math::float4x4 expected;
+    math::simd::store(m, expected);
+    expected = math::matrix::inverse(expected);
+
+    CHECK(equal(result, expected));
+}
+
+TEST_CASE("matrix_simd::inverse_rigid", "[matrix][simd]")
+{
+    math::float4_simd scale = math::simd::set(1.0f, 1.0f, 1.0f, 0.0f);
+    math::float4_simd rotation =
+        math::simd::set(0.0661214888f, 0.132242978f, 0.198364466f, 0.968912423f);
+    math::float4_simd translation = math::simd::set(6.0f, 5.0f, 4.5f, 0.0f);
+    math::float4x4_simd m = math::matrix_simd::affine_transform(scale, rotation, translation);
+
+    math::float4x4 result;
+    math::simd::store(math::matrix_simd::inverse_rigid(m), result);
+
+    math::float4x4 expected;
+    math::simd::store(m, expected);
+    expected = math::matrix::inverse(expected);
+
+    CHECK(equal(result, expected));
+}
+
 TEST_CASE("matrix_simd::identity", "[matrix][simd]")
 {
     math::float4x4_simd a = math::matrix_simd::identity();
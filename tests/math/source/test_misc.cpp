@@ -11,4 +11,18 @@ TEST_CASE("sin_cos", "[misc]")
     CHECK(equal(s, sin(0.358f)));
     CHECK(equal(c, cos(0.358f)));
 }
+
+TEST_CASE("constexpr sqrt", "[misc]")
+{
+    constexpr float a = math::sqrt(2.0f);
+    constexpr float b = math::sqrt(1e-6f);
+    constexpr float c = math::sqrt(1e12f);
+    static_assert(math::sqrt(0.0f) == 0.0f);
+    static_assert(math::sqrt(16.0f) == 4.0f);
+
+    CHECK(a == std::sqrt(2.0f));
+    CHECK(b == std::sqrt(1e-6f));
+    CHECK(c == std::sqrt(1e12f));
+    CHECK(std::isnan(math::sqrt(-1.0f)));
+}
 } // namespace ash::test
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "test_common.hpp"
+#include <vector>
 
 using namespace ash::math;
 
@@ -39,4 +40,68 @@ TEST_CASE("simd::store", "[simd]")
     simd::store(v, r3);
     CHECK(equal(r3, float3{1.0f, 2.0f, 3.0f}));
 }
+
+// Hidden by default, run with: test-math [benchmark]
+TEST_CASE("simd inverse benchmark", "[simd][.benchmark]")
+{
+    constexpr std::size_t COUNT = 1024;
+
+    std::vector<float4x4> m(COUNT);
+    for (std::size_t i = 0; i < COUNT; ++i)
+    {
+        m[i] = matrix::affine_transform(
+            float3{1.0f, 1.0f, 1.0f},
+            quaternion::rotation_axis(float4{0.0f, 1.0f, 0.0f, 0.0f}, 0.001f * i),
+            float3{static_cast<float>(i), 2.0f, 3.0f});
+    }
+
+    std::vector<float4x4_simd> m_simd(COUNT);
+    for (std::size_t i = 0; i < COUNT; ++i)
+        m_simd[i] = simd::load(m[i]);
+
+    std::vector<float> m_soa(COUNT * 16);
+    for (std::size_t i = 0; i < COUNT; ++i)
+    {
+        for (std::size_t c = 0; c < 16; ++c)
+            m_soa[c * COUNT + i] = m[i][c / 4][c % 4];
+    }
+
+    std::vector<float4x4> result(COUNT);
+    std::vector<float4x4_simd> result_simd(COUNT);
+    std::vector<float> result_soa(COUNT * 16);
+
+    BENCHMARK("matrix::inverse")
+    {
+        for (std::size_t i = 0; i < COUNT; ++i)
+            result[i] = matrix::inverse(m[i]);
+        return result[0][0][0];
+    };
+
+    BENCHMARK("matrix_simd::inverse")
+    {
+        for (std::size_t i = 0; i < COUNT; ++i)
+            result_simd[i] = matrix_simd::inverse(m_simd[i]);
+        return result_simd[0][0];
+    };
+
+    BENCHMARK("matrix_simd::inverse_affine")
+    {
+        for (std::size_t i = 0; i < COUNT; ++i)
+            result_simd[i] = matrix_simd::inverse_affine(m_simd[i]);
+        return result_simd[0][0];
+    };
+
+    BENCHMARK("matrix_simd::inverse_rigid")
+    {
+        for (std::size_t i = 0; i < COUNT; ++i)
+            result_simd[i] = matrix_simd::inverse_rigid(m_simd[i]);
+        return result_simd[0][0];
+    };
+
+    BENCHMARK("matrix_batch::inverse")
+    {
+        matrix_batch::inverse(m_soa.data(), result_soa.data(), COUNT);
+        return result_soa[0];
+    };
+}
 } // namespace ash::test
\ No newline at end of file
@@ -0,0 +1,569 @@
+#include "scene/bvh_tree.hpp"
+#include "task/task_manager.hpp"
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <map>
+#include <random>
+
+using namespace ash::math;
+using namespace ash::scene;
+
+namespace ash::test
+{
+namespace
+{
+class test_boxes
+{
+public:
+    test_boxes(std::uint32_t seed) : m_engine(seed) {}
+
+    bounding_volume_aabb random_box()
+    {
+        std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+        std::uniform_real_distribution<float> size(0.1f, 5.0f);
+
+        bounding_volume_aabb result;
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            result.min[i] = position(m_engine);
+            result.max[i] = result.min[i] + size(m_engine);
+        }
+        return result;
+    }
+
+    // Moves the box by up to distance on every axis.
+    bounding_volume_aabb move(const bounding_volume_aabb& box, float distance)
+    {
+        std::uniform_real_distribution<float> offset(-distance, distance);
+
+        bounding_volume_aabb result = box;
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            float d = offset(m_engine);
+            result.min[i] += d;
+            result.max[i] += d;
+        }
+        return result;
+    }
+
+    float3 random_point()
+    {
+        std::uniform_real_distribution<float> position(-120.0f, 120.0f);
+        return {position(m_engine), position(m_engine), position(m_engine)};
+    }
+
+    float3 random_direction()
+    {
+        std::uniform_real_distribution<float> component(-1.0f, 1.0f);
+        return vector::normalize(float3{component(m_engine), component(m_engine), 0.5f});
+    }
+
+    std::size_t random_index(std::size_t count)
+    {
+        return std::uniform_int_distribution<std::size_t>(0, count - 1)(m_engine);
+    }
+
+private:
+    std::mt19937 m_engine;
+};
+
+// Pyramid with its apex behind the boxes, cut by a near and a far plane.
+std::vector<float4> make_frustum()
+{
+    float3 apex = {10.0f, -5.0f, -150.0f};
+    float3 normals[] = {
+        vector::normalize(float3{1.0f, 0.0f, 0.8f}),
+        vector::normalize(float3{-1.0f, 0.0f, 0.8f}),
+        vector::normalize(float3{0.0f, 1.0f, 1.2f}),
+        vector::normalize(float3{0.0f, -1.0f, 1.2f})};
+
+    std::vector<float4> result;
+    for (const float3& n : normals)
+        result.push_back({n[0], n[1], n[2], -vector::dot(n, apex)});
+    result.push_back({0.0f, 0.0f, 1.0f, 60.0f});
+    result.push_back({0.0f, 0.0f, -1.0f, 40.0f});
+    return result;
+}
+
+bool overlap(const bounding_volume_aabb& a, const bounding_volume_aabb& b)
+{
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        if (a.min[i] > b.max[i] || a.max[i] < b.min[i])
+            return false;
+    }
+    return true;
+}
+
+float distance_squared(const bounding_volume_aabb& box, const float3& point)
+{
+    float result = 0.0f;
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        float d = std::max(std::max(box.min[i] - point[i], point[i] - box.max[i]), 0.0f);
+        result += d * d;
+    }
+    return result;
+}
+
+bool intersect_frustum(const bounding_volume_aabb& box, const std::vector<float4>& frustum)
+{
+    for (const float4& plane : frustum)
+    {
+        // The corner farthest along the normal.
+        float d = plane[3];
+        for (std::size_t i = 0; i < 3; ++i)
+            d += plane[i] * (plane[i] >= 0.0f ? box.max[i] : box.min[i]);
+        if (d < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+// Entry distance of the ray into the box, negative when it misses within max_distance.
+float intersect_ray(
+    const bounding_volume_aabb& box,
+    const float3& origin,
+    const float3& direction,
+    float max_distance)
+{
+    float near = 0.0f;
+    float far = max_distance;
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        if (direction[i] == 0.0f)
+        {
+            if (origin[i] < box.min[i] || origin[i] > box.max[i])
+                return -1.0f;
+            continue;
+        }
+
+        float t1 = (box.min[i] - origin[i]) * (1.0f / direction[i]);
+        float t2 = (box.max[i] - origin[i]) * (1.0f / direction[i]);
+        near = std::max(near, std::min(t1, t2));
+        far = std::min(far, std::max(t1, t2));
+    }
+    return near <= far ? near : -1.0f;
+}
+
+class test_task_manager
+{
+public:
+    test_task_manager(std::size_t num_thread)
+    {
+        dictionary config;
+        config["threads"] = num_thread;
+        m_manager.initialize(config);
+        m_manager.run();
+    }
+
+    ~test_task_manager() { m_manager.stop(); }
+
+    task::task_manager* get() noexcept { return &m_manager; }
+
+private:
+    task::task_manager m_manager;
+};
+
+// The boxes in the tree by proxy id, queries are compared with a brute force test over them.
+using box_map = std::map<std::size_t, bounding_volume_aabb>;
+
+void check_frustum_culling(const bvh_tree& tree, const box_map& boxes)
+{
+    std::vector<float4> frustum = make_frustum();
+
+    std::vector<std::size_t> visible;
+    bvh_tree::culling_scratch scratch;
+    tree.frustum_culling(frustum, visible, scratch);
+    std::sort(visible.begin(), visible.end());
+
+    // A reused scratch gives the same result.
+    std::vector<std::size_t> visible_again;
+    tree.frustum_culling(frustum, visible_again, scratch);
+    std::sort(visible_again.begin(), visible_again.end());
+    REQUIRE(visible_again == visible);
+
+    std::vector<std::size_t> expected;
+    for (auto& [proxy_id, box] : boxes)
+    {
+        if (intersect_frustum(box, frustum))
+            expected.push_back(proxy_id);
+    }
+
+    REQUIRE(visible == expected);
+}
+
+void check_queries(const bvh_tree& tree, const box_map& boxes, test_boxes& random)
+{
+    check_frustum_culling(tree, boxes);
+
+    for (std::size_t query = 0; query < 8; ++query)
+    {
+        // Boxes.
+        bounding_volume_aabb aabb = random.random_box();
+        for (std::size_t i = 0; i < 3; ++i)
+            aabb.max[i] += 20.0f;
+
+        std::vector<std::size_t> result;
+        tree.query_aabb(aabb, [&](std::size_t proxy_id) { result.push_back(proxy_id); });
+        std::sort(result.begin(), result.end());
+
+        std::vector<std::size_t> expected;
+        for (auto& [proxy_id, box] : boxes)
+        {
+            if (overlap(box, aabb))
+                expected.push_back(proxy_id);
+        }
+        REQUIRE(result == expected);
+
+        std::vector<std::size_t> first(2);
+        CHECK(tree.query_aabb(aabb, std::span<std::size_t>(first)) == expected.size());
+
+        // Spheres.
+        float3 center = random.random_point();
+        float radius = 15.0f;
+
+        result.clear();
+        tree.query_sphere(center, radius, [&](std::size_t proxy_id) {
+            result.push_back(proxy_id);
+        });
+        std::sort(result.begin(), result.end());
+
+        expected.clear();
+        for (auto& [proxy_id, box] : boxes)
+        {
+            if (distance_squared(box, center) <= radius * radius)
+                expected.push_back(proxy_id);
+        }
+        REQUIRE(result == expected);
+
+        // Rays, max_distance is returned to keep every hit.
+        float3 origin = random.random_point();
+        float3 direction = random.random_direction();
+        float max_distance = 150.0f;
+
+        std::vector<std::pair<std::size_t, float>> hits;
+        tree.raycast(origin, direction, max_distance, [&](std::size_t proxy_id, float distance) {
+            hits.emplace_back(proxy_id, distance);
+            return max_distance;
+        });
+        std::sort(hits.begin(), hits.end());
+
+        std::vector<std::pair<std::size_t, float>> expected_hits;
+        for (auto& [proxy_id, box] : boxes)
+        {
+            float distance = intersect_ray(box, origin, direction, max_distance);
+            if (distance >= 0.0f)
+                expected_hits.emplace_back(proxy_id, distance);
+        }
+        REQUIRE(hits == expected_hits);
+
+        // Closest hit, the functor shortens the ray to every hit.
+        float closest = max_distance;
+        tree.raycast(origin, direction, max_distance, [&](std::size_t, float distance) {
+            closest = std::min(closest, distance);
+            return distance;
+        });
+
+        float expected_closest = max_distance;
+        for (auto& [proxy_id, distance] : expected_hits)
+            expected_closest = std::min(expected_closest, distance);
+        REQUIRE(closest == expected_closest);
+
+        // Nearest neighbors.
+        float3 point = random.random_point();
+
+        std::vector<float> distances;
+        for (auto& [proxy_id, box] : boxes)
+            distances.push_back(std::sqrt(distance_squared(box, point)));
+        std::sort(distances.begin(), distances.end());
+
+        std::vector<std::size_t> nearest(10);
+        std::vector<float> nearest_distance(10);
+        std::size_t count = tree.k_nearest(point, nearest, nearest_distance);
+        REQUIRE(count == std::min(nearest.size(), boxes.size()));
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            REQUIRE(boxes.count(nearest[i]) == 1);
+            REQUIRE(nearest_distance[i] == Approx(distances[i]).margin(1e-4f));
+            REQUIRE(
+                nearest_distance[i] ==
+                Approx(std::sqrt(distance_squared(boxes.at(nearest[i]), point))).margin(1e-4f));
+        }
+    }
+}
+} // namespace
+
+TEST_CASE("bvh tree add and remove", "[bvh tree]")
+{
+    std::size_t count = GENERATE(as<std::size_t>{}, 1, 2, 3, 17, 100, 1000, 5000);
+    test_boxes random(static_cast<std::uint32_t>(count));
+
+    bvh_tree tree;
+    box_map boxes;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        bounding_volume_aabb box = random.random_box();
+        std::size_t proxy_id = tree.add(box);
+        REQUIRE(boxes.count(proxy_id) == 0);
+        boxes[proxy_id] = box;
+    }
+
+    tree.flatten();
+    check_queries(tree, boxes, random);
+
+    // Remove half of the boxes and add new ones, which reuse the free proxy ids.
+    std::vector<std::size_t> removed;
+    for (auto& [proxy_id, box] : boxes)
+    {
+        if (random.random_index(2) == 0)
+            removed.push_back(proxy_id);
+    }
+    for (std::size_t proxy_id : removed)
+    {
+        tree.remove(proxy_id);
+        boxes.erase(proxy_id);
+    }
+
+    tree.flatten();
+    check_queries(tree, boxes, random);
+
+    for (std::size_t i = 0; i < removed.size() / 2; ++i)
+    {
+        bounding_volume_aabb box = random.random_box();
+        std::size_t proxy_id = tree.add(box);
+        REQUIRE(boxes.count(proxy_id) == 0);
+        boxes[proxy_id] = box;
+    }
+
+    tree.flatten();
+    check_queries(tree, boxes, random);
+
+    for (auto& [proxy_id, box] : boxes)
+        tree.remove(proxy_id);
+
+    tree.flatten();
+    check_queries(tree, {}, random);
+}
+
+TEST_CASE("bvh tree build", "[bvh tree]")
+{
+    std::size_t count = GENERATE(as<std::size_t>{}, 1, 2, 3, 17, 100, 1000, 5000, 40000);
+    test_boxes random(static_cast<std::uint32_t>(count));
+
+    std::vector<bounding_volume_aabb> build_boxes;
+    for (std::size_t i = 0; i < count; ++i)
+        build_boxes.push_back(random.random_box());
+
+    // Some boxes share a centroid, so that a bin holds every box.
+    for (std::size_t i = 0; i < count; i += 7)
+        build_boxes[i] = build_boxes[0];
+
+    bvh_tree tree;
+    SECTION("serial")
+    {
+        tree.build(build_boxes);
+    }
+
+    SECTION("task manager")
+    {
+        test_task_manager manager(4);
+        tree.build(build_boxes, manager.get());
+    }
+
+    // The proxy id of a box is its index.
+    box_map boxes;
+    for (std::size_t i = 0; i < count; ++i)
+        boxes[i] = build_boxes[i];
+
+    tree.flatten();
+    check_queries(tree, boxes, random);
+
+    // The built tree takes adds and removes like any other.
+    for (std::size_t i = 0; i < count; i += 3)
+    {
+        tree.remove(i);
+        boxes.erase(i);
+    }
+    for (std::size_t i = 0; i < count / 4; ++i)
+    {
+        bounding_volume_aabb box = random.random_box();
+        std::size_t proxy_id = tree.add(box);
+        REQUIRE(boxes.count(proxy_id) == 0);
+        boxes[proxy_id] = box;
+    }
+
+    tree.flatten();
+    check_queries(tree, boxes, random);
+
+    // Building again replaces the tree.
+    build_boxes.resize(count / 2 + 1);
+    tree.build(build_boxes);
+
+    boxes.clear();
+    for (std::size_t i = 0; i < build_boxes.size(); ++i)
+        boxes[i] = build_boxes[i];
+
+    tree.flatten();
+    check_queries(tree, boxes, random);
+}
+
+TEST_CASE("bvh tree update", "[bvh tree]")
+{
+    std::size_t count = GENERATE(as<std::size_t>{}, 1, 2, 3, 17, 100, 1000, 5000);
+    test_boxes random(static_cast<std::uint32_t>(count));
+
+    std::vector<bounding_volume_aabb> build_boxes;
+    for (std::size_t i = 0; i < count; ++i)
+        build_boxes.push_back(random.random_box());
+
+    bvh_tree tree;
+    tree.build(build_boxes);
+
+    box_map boxes;
+    for (std::size_t i = 0; i < count; ++i)
+        boxes[i] = build_boxes[i];
+
+    SECTION("update")
+    {
+        // Small moves are refitted in place, large ones reinsert the leaf under a new proxy id.
+        for (float distance : {0.5f, 50.0f})
+        {
+            box_map moved;
+            for (auto& [proxy_id, box] : boxes)
+            {
+                bounding_volume_aabb new_box = random.move(box, distance);
+                std::size_t new_proxy_id = tree.update(proxy_id, new_box);
+                REQUIRE(moved.count(new_proxy_id) == 0);
+                moved[new_proxy_id] = new_box;
+            }
+            boxes.swap(moved);
+
+            tree.flatten();
+            check_queries(tree, boxes, random);
+        }
+    }
+
+    SECTION("update and batched refit")
+    {
+        // Like the scene, large moves reinsert their leaf and small ones are refitted together.
+        for (float distance : {0.5f, 5.0f, 50.0f})
+        {
+            box_map moved;
+            std::vector<std::size_t> proxy_ids;
+            std::vector<bounding_volume_aabb> new_boxes;
+            for (auto& [proxy_id, box] : boxes)
+            {
+                bounding_volume_aabb new_box = random.move(box, distance);
+                if (tree.refittable(proxy_id, new_box))
+                {
+                    proxy_ids.push_back(proxy_id);
+                    new_boxes.push_back(new_box);
+                    moved[proxy_id] = new_box;
+                }
+                else
+                {
+                    std::size_t new_proxy_id = tree.update(proxy_id, new_box);
+                    REQUIRE(moved.count(new_proxy_id) == 0);
+                    moved[new_proxy_id] = new_box;
+                }
+            }
+            tree.refit(proxy_ids, new_boxes, true);
+            boxes.swap(moved);
+
+            tree.flatten();
+            check_queries(tree, boxes, random);
+        }
+    }
+
+    SECTION("refit")
+    {
+        for (float distance : {0.5f, 50.0f})
+        {
+            for (auto& [proxy_id, box] : boxes)
+            {
+                box = random.move(box, distance);
+                tree.refit(proxy_id, box);
+            }
+
+            tree.flatten();
+            check_queries(tree, boxes, random);
+        }
+    }
+
+    SECTION("batched refit")
+    {
+        bool optimize = GENERATE(false, true);
+
+        for (float distance : {0.5f, 50.0f})
+        {
+            // A random subset, so that some ancestors are shared and some are not touched.
+            std::vector<std::size_t> proxy_ids;
+            std::vector<bounding_volume_aabb> new_boxes;
+            for (auto& [proxy_id, box] : boxes)
+            {
+                if (random.random_index(3) == 0)
+                    continue;
+
+                box = random.move(box, distance);
+                proxy_ids.push_back(proxy_id);
+                new_boxes.push_back(box);
+            }
+            tree.refit(proxy_ids, new_boxes, optimize);
+
+            tree.flatten();
+            check_queries(tree, boxes, random);
+        }
+
+        // Optimizing rotates nodes, the tree still takes removes and adds.
+        for (std::size_t i = 0; i < count; i += 2)
+        {
+            tree.remove(i);
+            boxes.erase(i);
+        }
+        bounding_volume_aabb box = random.random_box();
+        boxes[tree.add(box)] = box;
+
+        tree.flatten();
+        check_queries(tree, boxes, random);
+    }
+}
+
+TEST_CASE("bvh tree raycast parallel to an axis", "[bvh tree]")
+{
+    bvh_tree tree;
+    std::size_t proxy_id = tree.add({{0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f}});
+    tree.flatten();
+
+    auto hit_distance = [&](const float3& origin, const float3& direction) {
+        float result = -1.0f;
+        tree.raycast(origin, direction, 100.0f, [&](std::size_t id, float distance) {
+            CHECK(id == proxy_id);
+            result = distance;
+            return 100.0f;
+        });
+        return result;
+    };
+
+    // Rays on the faces and edges of the box hit it, the zero components of the direction must
+    // not turn the slab test into NaN.
+    for (float x : {0.0f, 0.5f, 1.0f})
+    {
+        for (float y : {0.0f, 0.5f, 1.0f})
+        {
+            CHECK(hit_distance({x, y, -5.0f}, {0.0f, 0.0f, 1.0f}) == 5.0f);
+            CHECK(hit_distance({x, y, 6.0f}, {-0.0f, 0.0f, -1.0f}) == 5.0f);
+            CHECK(hit_distance({-3.0f, x, y}, {1.0f, 0.0f, 0.0f}) == 3.0f);
+        }
+    }
+
+    CHECK(hit_distance({1.5f, 0.5f, -5.0f}, {0.0f, 0.0f, 1.0f}) < 0.0f);
+    CHECK(hit_distance({0.5f, -0.5f, -5.0f}, {0.0f, 0.0f, 1.0f}) < 0.0f);
+    CHECK(hit_distance({0.5f, 0.5f, -5.0f}, {0.0f, 0.0f, -1.0f}) < 0.0f);
+
+    // Diagonal rays with one zero component.
+    CHECK(hit_distance({1.0f, -1.0f, -1.0f}, vector::normalize(float3{0.0f, 1.0f, 1.0f})) >= 0.0f);
+    CHECK(hit_distance({1.01f, -1.0f, -1.0f}, vector::normalize(float3{0.0f, 1.0f, 1.0f})) < 0.0f);
+}
+} // namespace ash::test
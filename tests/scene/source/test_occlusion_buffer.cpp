@@ -0,0 +1,128 @@
+#include "scene/occlusion_buffer.hpp"
+#include <algorithm>
+#include <catch2/catch.hpp>
+
+using namespace ash::math;
+using namespace ash::scene;
+
+namespace ash::test
+{
+namespace
+{
+// Camera at the origin looking down +z.
+float4x4 make_view_projection()
+{
+    return matrix::perspective(PI * 0.5f, 2.0f, 0.1f, 100.0f);
+}
+
+// Quad at z = 10, far larger than the view.
+void add_wall(occlusion_buffer& buffer)
+{
+    float3 vertices[] = {
+        {-100.0f, -100.0f, 10.0f},
+        {100.0f,  -100.0f, 10.0f},
+        {100.0f,  100.0f,  10.0f},
+        {-100.0f, 100.0f,  10.0f}
+    };
+    std::uint32_t indices[] = {0, 1, 2, 0, 2, 3};
+    buffer.add_occluder(vertices, indices, matrix::identity());
+}
+} // namespace
+
+TEST_CASE("occlusion buffer empty", "[occlusion buffer]")
+{
+    occlusion_buffer buffer;
+    buffer.begin(make_view_projection());
+    buffer.rasterize();
+
+    CHECK(buffer.empty());
+    CHECK(buffer.test({{-1.0f, -1.0f, 20.0f}, {1.0f, 1.0f, 22.0f}}));
+}
+
+TEST_CASE("occlusion buffer full screen occluder", "[occlusion buffer]")
+{
+    occlusion_buffer buffer(100, 50);
+    CHECK(buffer.width() % occlusion_buffer::TILE_SIZE == 0);
+    CHECK(buffer.height() % occlusion_buffer::TILE_SIZE == 0);
+
+    buffer.begin(make_view_projection());
+    add_wall(buffer);
+    buffer.rasterize();
+    REQUIRE(!buffer.empty());
+
+    // Every pixel is covered by the wall.
+    const std::vector<float>& depth = buffer.depth();
+    REQUIRE(std::all_of(depth.begin(), depth.end(), [](float d) { return d < 1.0f; }));
+
+    SECTION("behind")
+    {
+        CHECK(!buffer.test({{-1.0f, -1.0f, 20.0f}, {1.0f, 1.0f, 22.0f}}));
+        CHECK(!buffer.test({{-50.0f, -50.0f, 11.0f}, {50.0f, 50.0f, 90.0f}}));
+    }
+
+    SECTION("in front")
+    {
+        CHECK(buffer.test({{-1.0f, -1.0f, 3.0f}, {1.0f, 1.0f, 4.0f}}));
+
+        // Starts in front of the wall and ends behind it.
+        CHECK(buffer.test({{-1.0f, -1.0f, 9.0f}, {1.0f, 1.0f, 11.0f}}));
+    }
+
+    SECTION("crossing near plane")
+    {
+        CHECK(buffer.test({{-1.0f, -1.0f, -1.0f}, {1.0f, 1.0f, 1.0f}}));
+        CHECK(buffer.test({{-1.0f, -1.0f, 0.05f}, {1.0f, 1.0f, 20.0f}}));
+    }
+
+    SECTION("begin clears")
+    {
+        buffer.begin(make_view_projection());
+        buffer.rasterize();
+
+        CHECK(buffer.empty());
+        CHECK(buffer.test({{-1.0f, -1.0f, 20.0f}, {1.0f, 1.0f, 22.0f}}));
+    }
+}
+
+TEST_CASE("occlusion buffer partial occluder", "[occlusion buffer]")
+{
+    occlusion_buffer buffer;
+    buffer.begin(make_view_projection());
+
+    // Covers the left half of the view only.
+    float3 vertices[] = {
+        {-100.0f, -100.0f, 10.0f},
+        {-1.0f,   -100.0f, 10.0f},
+        {-1.0f,   100.0f,  10.0f},
+        {-100.0f, 100.0f,  10.0f}
+    };
+    std::uint32_t indices[] = {0, 1, 2, 0, 2, 3};
+    buffer.add_occluder(vertices, indices, matrix::identity());
+    buffer.rasterize();
+
+    CHECK(!buffer.test({{-10.0f, -1.0f, 20.0f}, {-5.0f, 1.0f, 22.0f}}));
+    CHECK(buffer.test({{5.0f, -1.0f, 20.0f}, {10.0f, 1.0f, 22.0f}}));
+
+    // Partly behind the occluder.
+    CHECK(buffer.test({{-10.0f, -1.0f, 20.0f}, {10.0f, 1.0f, 22.0f}}));
+}
+
+TEST_CASE("occlusion buffer occluder crossing near plane", "[occlusion buffer]")
+{
+    occlusion_buffer buffer;
+    buffer.begin(make_view_projection());
+
+    // Dropped, the buffer stays conservative.
+    float3 vertices[] = {
+        {-100.0f, -100.0f, -1.0f},
+        {100.0f,  -100.0f, 10.0f},
+        {100.0f,  100.0f,  10.0f}
+    };
+    std::uint32_t indices[] = {0, 1, 2};
+    buffer.add_occluder(vertices, indices, matrix::identity());
+    buffer.rasterize();
+
+    CHECK(buffer.empty());
+    CHECK(buffer.test({{-1.0f, -1.0f, 20.0f}, {1.0f, 1.0f, 22.0f}}));
+}
+} // namespace ash::test
\ No newline at end of file
@@ -1,4 +1,4 @@
-#include "lock_free_queue.hpp"
+#include "task/lock_free_queue.hpp"
 #include "test_common.hpp"
 #include <set>
 #include <thread>
@@ -29,7 +29,7 @@ TEST_CASE("Concurrent allocate and deallocate of nodes", "[lock_free_node_pool][
                 auto node = c.allocate();
                 if (node->node_data != 0)
                 {
-                    data[i].push_back(node.get_pointer());
+                    data[i].push_back(node.pointer());
                 }
                 else
                 {
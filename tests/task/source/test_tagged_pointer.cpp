@@ -1,5 +1,6 @@
-#include "tagged_pointer.hpp"
+#include "task/tagged_pointer.hpp"
 #include "test_common.hpp"
+#include <atomic>
 #include <limits>
 
 using namespace ash::task;
@@ -13,17 +14,17 @@ TEST_CASE("atomic operation on a tagged_pointer is lock-free", "[tagged_pointer]
 TEST_CASE("construct pointer", "[tagged_pointer]")
 {
     tagged_pointer<int> tp1;
-    CHECK(tp1.get_tag() == 0);
-    CHECK(tp1.get_pointer() == nullptr);
+    CHECK(tp1.tag() == 0);
+    CHECK(tp1.pointer() == nullptr);
 
     int data = 99;
     tagged_pointer<int> tp2(&data);
-    CHECK(tp2.get_tag() == 0);
-    CHECK(tp2.get_pointer() == &data);
+    CHECK(tp2.tag() == 0);
+    CHECK(tp2.pointer() == &data);
 
     tagged_pointer<int> tp3(&data, 1);
-    CHECK(tp3.get_tag() == 1);
-    CHECK(tp3.get_pointer() == &data);
+    CHECK(tp3.tag() == 1);
+    CHECK(tp3.pointer() == &data);
 }
 
 TEST_CASE("geter and seter", "[tagged_pointer]")
@@ -32,14 +33,14 @@ TEST_CASE("geter and seter", "[tagged_pointer]")
 
     int data = 99;
 
-    tp1.set_pointer(&data);
-    CHECK(tp1.get_pointer() == &data);
+    tp1.pointer(&data);
+    CHECK(tp1.pointer() == &data);
 
-    CHECK(tp1.get_tag() == 0);
-    CHECK(tp1.get_next_tag() == 1);
+    CHECK(tp1.tag() == 0);
+    CHECK(tp1.next_tag() == 1);
 
     tagged_pointer<int> tp2(nullptr, std::numeric_limits<tagged_pointer<int>::tag_type>::max());
-    CHECK(tp2.get_next_tag() == 0);
+    CHECK(tp2.next_tag() == 0);
 }
 
 TEST_CASE("operator overloading", "[tagged_pointer]")
@@ -58,6 +59,6 @@ TEST_CASE("operator overloading", "[tagged_pointer]")
     tagged_pointer<test_struct> tp2(&data);
     CHECK(tp1 == tp2);
 
-    tagged_pointer<test_struct> tp3(&data, tp2.get_next_tag());
+    tagged_pointer<test_struct> tp3(&data, tp2.next_tag());
     CHECK(tp1 != tp3);
 }
\ No newline at end of file
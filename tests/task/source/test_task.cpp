@@ -1,4 +1,4 @@
-#include "task.hpp"
+#include "task/task.hpp"
 #include "test_common.hpp"
 
 using namespace ash::task;
@@ -8,7 +8,7 @@ namespace ash::test
 class test_task : public task
 {
 public:
-    using task::task;
+    test_task(std::string_view name) : task(name, task_type::NONE) {}
 
     virtual void execute() override {}
 };
@@ -16,17 +16,17 @@ public:
 TEST_CASE("dependencies between tasks", "[task]")
 {
     test_task task1("task 1");
-    CHECK(task1.get_reachable_tasks_size() == 1);
+    CHECK(task1.reachable_tasks_count()[to_integer_v<task_type::NONE>] == 1);
 
     test_task task2("task 2");
     task2.add_dependency(task1);
-    CHECK(task1.get_reachable_tasks_size() == 2);
+    CHECK(task1.reachable_tasks_count()[to_integer_v<task_type::NONE>] == 2);
 
     test_task task3("task 3");
     task2.add_dependency(task3);
-    CHECK(task1.get_reachable_tasks_size() == 1);
+    CHECK(task1.reachable_tasks_count()[to_integer_v<task_type::NONE>] == 1);
 
     task3.add_dependency(task1);
-    CHECK(task1.get_reachable_tasks_size() == 3);
+    CHECK(task1.reachable_tasks_count()[to_integer_v<task_type::NONE>] == 3);
 }
 } // namespace ash::test
\ No newline at end of file
@@ -1,46 +1,208 @@
-#include "task_manager.hpp"
+#include "task/task_manager.hpp"
 #include "test_common.hpp"
-#include <iostream>
+#include <mutex>
 
 using namespace ash::task;
-using namespace ash::test;
 
-TEST_CASE("test_task_manager", "[task_manager]")
+namespace ash::test
 {
-    task_manager manager(1);
+namespace
+{
+class test_task_manager
+{
+public:
+    test_task_manager(std::size_t num_thread, bool run = true) : m_run(run)
+    {
+        dictionary config;
+        config["threads"] = num_thread;
+        m_manager.initialize(config);
+
+        if (m_run)
+            m_manager.run();
+    }
+
+    ~test_task_manager()
+    {
+        if (m_run)
+            m_manager.stop();
+    }
+
+    task_manager* operator->() { return &m_manager; }
+
+private:
+    task_manager m_manager;
+    bool m_run;
+};
+
+// Records the chunks and how many times each element was visited.
+class chunk_recorder
+{
+public:
+    chunk_recorder(std::size_t count) : m_visits(count) {}
+
+    void operator()(std::size_t begin, std::size_t end)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+            m_visits[i].fetch_add(1, std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_chunks.emplace_back(begin, end);
+    }
+
+    void check(std::size_t grain)
+    {
+        for (std::size_t i = 0; i < m_visits.size(); ++i)
+            REQUIRE(m_visits[i].load() == 1);
+
+        std::sort(m_chunks.begin(), m_chunks.end());
+
+        std::size_t next = 0;
+        for (auto [begin, end] : m_chunks)
+        {
+            REQUIRE(begin == next);
+            REQUIRE(end > begin);
+            REQUIRE((end - begin == grain || end == m_visits.size()));
+            next = end;
+        }
+        CHECK(next == m_visits.size());
+    }
+
+    std::size_t chunk_count() const noexcept { return m_chunks.size(); }
+
+private:
+    std::vector<std::atomic<std::size_t>> m_visits;
+
+    std::mutex m_lock;
+    std::vector<std::pair<std::size_t, std::size_t>> m_chunks;
+};
+} // namespace
+
+TEST_CASE("task manager graph", "[task manager]")
+{
+    test_task_manager manager(NUM_THREAD);
 
     std::vector<int> data(30);
 
-    auto task1 = manager.schedule("task 1", [&data]() {
+    auto task1 = manager->schedule("task 1", [&data]() {
         for (std::size_t i = 0; i < 10; ++i)
             data[i] = 1;
     });
 
-    auto task2 = manager.schedule("task 2", [&data]() {
+    auto task2 = manager->schedule("task 2", [&data]() {
         for (std::size_t i = 10; i < 20; ++i)
             data[i] = data[i - 10] + 1;
     });
     task2->add_dependency(*task1);
 
-    auto task3 = manager.schedule("task 3", [&data]() {
+    auto task3 = manager->schedule("task 3", [&data]() {
         for (std::size_t i = 20; i < 30; ++i)
             data[i] = data[i - 20] + 2;
     });
     task3->add_dependency(*task1);
 
-    std::thread t([&manager]() {
-        std::this_thread::sleep_for(std::chrono::seconds(1));
-        manager.stop();
-    });
-    manager.run(task1);
-
-    t.join();
+    manager->execute(task1);
 
     for (std::size_t i = 0; i < 3; ++i)
     {
         for (std::size_t j = 0; j < 10; ++j)
-        {
             REQUIRE(data[i * 10 + j] == i + 1);
-        }
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("task manager parallel for", "[task manager]")
+{
+    test_task_manager manager(NUM_THREAD);
+
+    SECTION("chunks")
+    {
+        std::size_t count =
+            GENERATE(as<std::size_t>{}, 0, 1, 7, 64, 1000, NUM_DATA_PER_THREAD * NUM_THREAD + 3);
+        std::size_t grain = GENERATE(as<std::size_t>{}, 1, 16, 100, 4096);
+
+        chunk_recorder recorder(count);
+        manager->parallel_for(count, grain, recorder);
+        recorder.check(grain);
+        CHECK(recorder.chunk_count() == (count + grain - 1) / grain);
+    }
+
+    SECTION("zero grain")
+    {
+        // Treated as a grain of one element.
+        chunk_recorder recorder(10);
+        manager->parallel_for(10, 0, recorder);
+        recorder.check(1);
+    }
+
+    SECTION("nested")
+    {
+        constexpr std::size_t OUTER_COUNT = 64;
+        constexpr std::size_t INNER_COUNT = 1000;
+
+        std::vector<std::atomic<std::size_t>> visits(OUTER_COUNT * INNER_COUNT);
+        manager->parallel_for(OUTER_COUNT, 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                auto visit = [&](std::size_t inner_begin, std::size_t inner_end) {
+                    for (std::size_t j = inner_begin; j < inner_end; ++j)
+                        visits[i * INNER_COUNT + j].fetch_add(1, std::memory_order_relaxed);
+                };
+                manager->parallel_for(INNER_COUNT, 10, visit);
+            }
+        });
+
+        for (auto& visit : visits)
+            REQUIRE(visit.load() == 1);
+    }
+}
+
+TEST_CASE("task manager parallel for inside a task", "[task manager]")
+{
+    test_task_manager manager(NUM_THREAD);
+
+    // Every task of the graph splits its work again, as the parallel bvh build does. The workers
+    // that wait on their helpers keep executing the other tasks and helpers meanwhile.
+    constexpr std::size_t TASK_COUNT = 8;
+    constexpr std::size_t COUNT = 10000;
+
+    std::vector<std::vector<std::atomic<std::size_t>>> visits(TASK_COUNT);
+    for (auto& task_visits : visits)
+        task_visits = std::vector<std::atomic<std::size_t>>(COUNT);
+
+    auto root = manager->schedule("root", []() {});
+    for (std::size_t t = 0; t < TASK_COUNT; ++t)
+    {
+        auto child = manager->schedule("task " + std::to_string(t), [&, t]() {
+            manager->parallel_for(COUNT, 100, [&](std::size_t begin, std::size_t end) {
+                auto visit = [&](std::size_t inner_begin, std::size_t inner_end) {
+                    for (std::size_t i = begin + inner_begin; i < begin + inner_end; ++i)
+                        visits[t][i].fetch_add(1, std::memory_order_relaxed);
+                };
+                manager->parallel_for(end - begin, 10, visit);
+            });
+        });
+        child->add_dependency(*root);
+    }
+
+    manager->execute(root);
+
+    for (auto& task_visits : visits)
+    {
+        for (auto& visit : task_visits)
+            REQUIRE(visit.load() == 1);
+    }
+}
+
+TEST_CASE("task manager parallel for without workers", "[task manager]")
+{
+    // The worker threads are never started, so no helper job is ever picked up. The caller
+    // processes every chunk and then drains the helpers itself before the job goes out of scope.
+    test_task_manager manager(NUM_THREAD, false);
+
+    for (int i = 0; i < 3; ++i)
+    {
+        chunk_recorder recorder(1000);
+        manager->parallel_for(1000, 10, recorder);
+        recorder.check(10);
+    }
+}
+} // namespace ash::test